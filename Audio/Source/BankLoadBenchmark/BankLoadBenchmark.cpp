@@ -0,0 +1,401 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the memory and time of loading an in-memory bank a number of
+// times, as several engines loading the same wave bank do:
+//
+//   Copy     reads the file into one buffer and copies it into another,
+//            as File::ReadAllBytes and the new BYTE[] did before the file
+//            mappings, see NativeFileMapping.h
+//   Mapping  opens the file through the MappingCache, as Native::WaveBank
+//            does now
+//
+// Every loaded bank is read through once, as XACT does when it plays from
+// it. Private memory is what the process alone pays for; mapped pages of
+// the file are shared with the file cache and other processes.
+//
+// Plain C++ on top of NativeFileMapping.cpp, so it builds and runs on any
+// platform, for example with
+//   g++ -O2 -I../Bnoerj.Audio BankLoadBenchmark.cpp ../Bnoerj.Audio/NativeFileMapping.cpp -lpthread
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <time.h>
+#endif
+
+#include "NativeFileMapping.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int loadCount;
+		unsigned int megabytes;
+		const char* path;
+	};
+
+	struct Memory
+	{
+		// Bytes of the process alone, and resident bytes of mapped files
+		unsigned long long privateBytes;
+		unsigned long long fileBytes;
+	};
+
+#if defined(_WIN32)
+	bool GetMemory(Memory& memory)
+	{
+		PROCESS_MEMORY_COUNTERS_EX counters;
+		if (::GetProcessMemoryInfo(::GetCurrentProcess(),
+			reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)) == FALSE)
+		{
+			return false;
+		}
+		memory.privateBytes = counters.PrivateUsage;
+		// Not told apart by the counters, the working set holds both
+		memory.fileBytes = counters.WorkingSetSize > counters.PrivateUsage ?
+			counters.WorkingSetSize - counters.PrivateUsage : 0;
+		return true;
+	}
+
+	double GetSeconds()
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&counter);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+#else
+	bool GetMemory(Memory& memory)
+	{
+		FILE* pFile = fopen("/proc/self/status", "r");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+
+		memory.privateBytes = 0;
+		memory.fileBytes = 0;
+		char line[256];
+		while (fgets(line, sizeof(line), pFile) != NULL)
+		{
+			unsigned long long kilobytes;
+			if (sscanf(line, "RssAnon: %llu", &kilobytes) == 1)
+			{
+				memory.privateBytes = kilobytes * 1024;
+			}
+			else if (sscanf(line, "RssFile: %llu", &kilobytes) == 1)
+			{
+				memory.fileBytes = kilobytes * 1024;
+			}
+		}
+		fclose(pFile);
+		return true;
+	}
+
+	double GetSeconds()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+#endif
+
+	// Stands in for XACT reading the bank, touches every page
+	unsigned int ReadThrough(const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		unsigned int sum = 0;
+		for (size_t i = 0; i < size; i += 512)
+		{
+			sum += pBytes[i];
+		}
+		return sum;
+	}
+
+	std::vector<FilePathChar> ToNativePath(const char* path)
+	{
+		std::vector<FilePathChar> nativePath;
+#if defined(_WIN32)
+		size_t length = mbstowcs(NULL, path, 0);
+		if (length != static_cast<size_t>(-1))
+		{
+			nativePath.resize(length + 1);
+			mbstowcs(&nativePath[0], path, length + 1);
+		}
+#else
+		nativePath.assign(path, path + strlen(path) + 1);
+#endif
+		return nativePath;
+	}
+
+	bool WriteTestFile(const char* path, unsigned int megabytes)
+	{
+		FILE* pFile = fopen(path, "wb");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+
+		std::vector<unsigned char> block(1024 * 1024);
+		bool succeeded = true;
+		for (unsigned int i = 0; i < megabytes && succeeded == true; i++)
+		{
+			for (size_t j = 0; j < block.size(); j++)
+			{
+				block[j] = static_cast<unsigned char>(i + j * 7);
+			}
+			succeeded = fwrite(&block[0], 1, block.size(), pFile) == block.size();
+		}
+		return fclose(pFile) == 0 && succeeded;
+	}
+
+	void PrintMemory(const char* mode, const Memory& base, const Memory& peak, const Memory& loaded, double seconds)
+	{
+		printf("%-8s %10.1f MB %10.1f MB %10.1f MB %10.1f ms\n", mode,
+			(peak.privateBytes - base.privateBytes) / 1048576.0,
+			(loaded.privateBytes - base.privateBytes) / 1048576.0,
+			loaded.fileBytes > base.fileBytes ? (loaded.fileBytes - base.fileBytes) / 1048576.0 : 0.0,
+			seconds * 1000);
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.loadCount = 4;
+		parameters.megabytes = 64;
+		parameters.path = NULL;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			if (arg[0] != '/' && arg[0] != '-')
+			{
+				if (parameters.path != NULL)
+				{
+					fprintf(stderr, "error: unexpected argument %s\n", arg);
+					return false;
+				}
+				parameters.path = arg;
+				continue;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'N': pValue = &parameters.loadCount; break;
+			case 'M': pValue = &parameters.megabytes; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		if (parameters.loadCount == 0 || (parameters.path == NULL && parameters.megabytes == 0))
+		{
+			fprintf(stderr, "error: the load count and size must be at least 1\n");
+			return false;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Bank Load Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: BANKLOADBENCHMARK [options] [bank]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /N:<count>      Times the bank is loaded, default is 4.\n");
+		printf("   /M:<megabytes>  Size of the file written when no bank is given,\n");
+		printf("                   default is 64.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	const char* path = parameters.path;
+	const char* testPath = "BankLoadBenchmark.tmp";
+	if (path == NULL)
+	{
+		if (WriteTestFile(testPath, parameters.megabytes) == false)
+		{
+			fprintf(stderr, "error: cannot write %s\n", testPath);
+			return 1;
+		}
+		path = testPath;
+	}
+	std::vector<FilePathChar> nativePath = ToNativePath(path);
+
+	Memory base;
+	if (nativePath.empty() == true || GetMemory(base) == false)
+	{
+		fprintf(stderr, "error: cannot read the memory counters\n");
+		return 1;
+	}
+
+	FileMapping probe;
+	int error = probe.Open(&nativePath[0], FileMapping::AccessReadOnly);
+	size_t size = probe.GetSize();
+	probe.Close();
+	if (error != 0 || size == 0)
+	{
+		fprintf(stderr, "error: cannot map %s, error %d\n", path, error);
+		return 1;
+	}
+
+	printf("%s, %.1f MB, loaded %u times\n\n", path, size / 1048576.0, parameters.loadCount);
+	printf("Mode       private peak     private   file mapped        time\n");
+
+	unsigned int sum = 0;
+
+	// Copy
+	{
+		GetMemory(base);
+		Memory peak = base;
+		std::vector<unsigned char*> banks;
+		double start = GetSeconds();
+		for (unsigned int i = 0; i < parameters.loadCount; i++)
+		{
+			FILE* pFile = fopen(path, "rb");
+			if (pFile == NULL)
+			{
+				fprintf(stderr, "error: cannot read %s\n", path);
+				return 1;
+			}
+			unsigned char* pRead = new unsigned char[size];
+			size_t read = fread(pRead, 1, size, pFile);
+			fclose(pFile);
+			if (read != size)
+			{
+				fprintf(stderr, "error: cannot read %s\n", path);
+				return 1;
+			}
+
+			unsigned char* pBank = new unsigned char[size];
+			memcpy(pBank, pRead, size);
+
+			// Both buffers are alive until the read one is collected
+			Memory memory;
+			GetMemory(memory);
+			if (memory.privateBytes > peak.privateBytes)
+			{
+				peak = memory;
+			}
+			delete[] pRead;
+
+			sum += ReadThrough(pBank, size);
+			banks.push_back(pBank);
+		}
+		double seconds = GetSeconds() - start;
+
+		Memory loaded;
+		GetMemory(loaded);
+		PrintMemory("Copy", base, peak, loaded, seconds);
+
+		for (size_t i = 0; i < banks.size(); i++)
+		{
+			delete[] banks[i];
+		}
+	}
+
+	// Mapping
+	{
+		GetMemory(base);
+		Memory peak = base;
+		std::vector<FileMapping*> banks;
+		double start = GetSeconds();
+		for (unsigned int i = 0; i < parameters.loadCount; i++)
+		{
+			FileMapping* pMapping = new FileMapping();
+			error = MappingCache::Open(&nativePath[0], *pMapping);
+			if (error != 0)
+			{
+				fprintf(stderr, "error: cannot map %s, error %d\n", path, error);
+				return 1;
+			}
+			sum += ReadThrough(pMapping->GetData(), pMapping->GetSize());
+			banks.push_back(pMapping);
+
+			Memory memory;
+			GetMemory(memory);
+			if (memory.privateBytes > peak.privateBytes)
+			{
+				peak = memory;
+			}
+		}
+		double seconds = GetSeconds() - start;
+
+		Memory loaded;
+		GetMemory(loaded);
+		PrintMemory("Mapping", base, peak, loaded, seconds);
+
+		for (size_t i = 0; i < banks.size(); i++)
+		{
+			delete banks[i];
+		}
+	}
+
+	printf("\nPrivate peak and private are above the start of the mode, with all\n");
+	printf("banks loaded. Sum of the bytes read %u.\n", sum);
+
+	if (path == testPath)
+	{
+		remove(testPath);
+	}
+	return 0;
+}
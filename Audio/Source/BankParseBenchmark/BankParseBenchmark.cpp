@@ -0,0 +1,377 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the bank parsers of Bnoerj.Audio, see NativeWaveBankFile.h and
+// NativeSoundBankFile.h, on the banks given on the command line or on a
+// generated wave bank and sound bank with many entries. Only the tables of
+// the wave bank are generated; the wave data lies past the end of the data,
+// as in the header of a streaming bank.
+//
+// Plain C++ on top of the parsers, so it builds and runs on any platform,
+// for example with
+//   g++ -O2 -I../Bnoerj.Audio BankParseBenchmark.cpp ../Bnoerj.Audio/NativeWaveBankFile.cpp ../Bnoerj.Audio/NativeSoundBankFile.cpp
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "NativeSoundBankFile.h"
+#include "NativeWaveBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int entryCount;
+		unsigned int repeatCount;
+		std::vector<const char*> paths;
+	};
+
+#if defined(_WIN32)
+	double GetSeconds()
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&counter);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+#else
+	double GetSeconds()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+#endif
+
+	void Put16(std::vector<uint8>& data, size_t offset, uint32 value)
+	{
+		data[offset] = static_cast<uint8>(value);
+		data[offset + 1] = static_cast<uint8>(value >> 8);
+	}
+
+	void Put32(std::vector<uint8>& data, size_t offset, uint32 value)
+	{
+		data[offset] = static_cast<uint8>(value);
+		data[offset + 1] = static_cast<uint8>(value >> 8);
+		data[offset + 2] = static_cast<uint8>(value >> 16);
+		data[offset + 3] = static_cast<uint8>(value >> 24);
+	}
+
+	// A wave bank of 16 bit PCM entries with names, see xact3wb.h
+	void GenerateWaveBank(uint32 entryCount, std::vector<uint8>& data)
+	{
+		const uint32 HeaderSize = 52;
+		const uint32 BankDataSize = 96;
+		const uint32 EntrySize = 24;
+		const uint32 NameSize = 64;
+		const uint32 Alignment = 2048;
+
+		uint32 metaDataOffset = HeaderSize + BankDataSize;
+		uint32 namesOffset = metaDataOffset + entryCount * EntrySize;
+		uint32 waveDataOffset = (namesOffset + entryCount * NameSize + Alignment - 1) / Alignment * Alignment;
+
+		data.assign(namesOffset + entryCount * NameSize, 0);
+		memcpy(&data[0], "WBND", 4);
+		Put32(data, 4, 46);
+		Put32(data, 8, WaveBankFile::HeaderVersion);
+		const uint32 segments[WaveBankSegmentCount][2] =
+		{
+			{ HeaderSize, BankDataSize },
+			{ metaDataOffset, entryCount * EntrySize },
+			{ namesOffset, 0 },
+			{ namesOffset, entryCount * NameSize },
+			{ waveDataOffset, entryCount * Alignment },
+		};
+		for (int i = 0; i < WaveBankSegmentCount; i++)
+		{
+			Put32(data, 12 + i * 8, segments[i][0]);
+			Put32(data, 16 + i * 8, segments[i][1]);
+		}
+
+		Put32(data, HeaderSize, WaveBankFile::BankFlagStreaming | WaveBankFile::BankFlagEntryNames);
+		Put32(data, HeaderSize + 4, entryCount);
+		strcpy(reinterpret_cast<char*>(&data[HeaderSize + 8]), "Generated");
+		Put32(data, HeaderSize + 72, EntrySize);
+		Put32(data, HeaderSize + 76, NameSize);
+		Put32(data, HeaderSize + 80, Alignment);
+
+		// 16 bit stereo at 44100 Hz
+		uint32 format = 0 | (2 << 2) | (44100 << 5) | (4 << 23) | (1u << 31);
+		for (uint32 i = 0; i < entryCount; i++)
+		{
+			size_t offset = metaDataOffset + i * EntrySize;
+			uint32 length = 1024 + i % 1024;
+			Put32(data, offset, (length / 4) << 4);
+			Put32(data, offset + 4, format);
+			Put32(data, offset + 8, i * Alignment);
+			Put32(data, offset + 12, length);
+			sprintf(reinterpret_cast<char*>(&data[namesOffset + i * NameSize]), "wave%u", i);
+		}
+	}
+
+	// A sound bank of one simple sound per cue, see SoundBankFile. Every
+	// other cue plays its sound, the ones between choose from four waves.
+	void GenerateSoundBank(uint32 cueCount, std::vector<uint8>& data)
+	{
+		const uint32 HeaderSize = 138;
+		const uint32 WaveBankNameSize = 64;
+		const uint32 SoundSize = 12;
+		const uint32 VariationSize = 8 + 4 * 5;
+		const uint32 SimpleCueSize = 5;
+		const uint32 ComplexCueSize = 15;
+		const uint32 CueNameIndexSize = 6;
+		const uint32 NameSize = 12;
+
+		uint32 simpleCueCount = (cueCount + 1) / 2;
+		uint32 complexCueCount = cueCount / 2;
+		uint32 soundOffset = HeaderSize + WaveBankNameSize;
+		uint32 variationOffset = soundOffset + cueCount * SoundSize;
+		uint32 simpleCueOffset = variationOffset + complexCueCount * VariationSize;
+		uint32 complexCueOffset = simpleCueOffset + simpleCueCount * SimpleCueSize;
+		uint32 cueNameIndexOffset = complexCueOffset + complexCueCount * ComplexCueSize;
+		uint32 namesOffset = cueNameIndexOffset + cueCount * CueNameIndexSize;
+
+		data.assign(namesOffset + cueCount * NameSize, 0);
+		memcpy(&data[0], "SDBK", 4);
+		Put16(data, 4, 46);
+		Put16(data, 6, SoundBankFile::FormatVersion);
+		Put16(data, 19, simpleCueCount);
+		Put16(data, 21, complexCueCount);
+		Put16(data, 25, cueCount);
+		data[27] = 1;
+		Put16(data, 28, cueCount);
+		Put32(data, 34, simpleCueOffset);
+		Put32(data, 38, complexCueOffset);
+		Put32(data, 58, HeaderSize);
+		Put32(data, 66, cueNameIndexOffset);
+		Put32(data, 70, soundOffset);
+		strcpy(reinterpret_cast<char*>(&data[74]), "Generated");
+		strcpy(reinterpret_cast<char*>(&data[HeaderSize]), "Generated");
+
+		for (uint32 i = 0; i < cueCount; i++)
+		{
+			// Flags, category, volume, pitch, priority, length, then the wave
+			size_t sound = soundOffset + i * SoundSize;
+			Put16(data, sound + 7, SoundSize);
+			Put16(data, sound + 9, i);
+
+			// Simple and complex cues take turns in the name table
+			uint32 cue = i / 2;
+			if (i % 2 == 0)
+			{
+				Put32(data, simpleCueOffset + cue * SimpleCueSize + 1, static_cast<uint32>(sound));
+			}
+			else
+			{
+				size_t variation = variationOffset + cue * VariationSize;
+				Put16(data, variation, 4);
+				for (uint32 wave = 0; wave < 4; wave++)
+				{
+					Put16(data, variation + 8 + wave * 5, (i + wave * 7) & 0xFFFF);
+				}
+				size_t complexCue = complexCueOffset + cue * ComplexCueSize;
+				Put32(data, complexCue + 1, static_cast<uint32>(variation));
+				data[complexCue + 9] = 0xFF;
+			}
+
+			uint32 index = i % 2 == 0 ? cue : simpleCueCount + cue;
+			size_t name = namesOffset + i * NameSize;
+			Put32(data, cueNameIndexOffset + index * CueNameIndexSize, static_cast<uint32>(name));
+			Put16(data, cueNameIndexOffset + index * CueNameIndexSize + 4, 0xFFFF);
+			sprintf(reinterpret_cast<char*>(&data[name]), "cue%u", i);
+		}
+	}
+
+	bool ReadFile(const char* path, std::vector<uint8>& data)
+	{
+		data.clear();
+		FILE* pFile = fopen(path, "rb");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+		uint8 buffer[65536];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		{
+			data.insert(data.end(), buffer, buffer + read);
+		}
+		bool succeeded = ferror(pFile) == 0;
+		fclose(pFile);
+		return succeeded;
+	}
+
+	uint32 GetEntryCount(const WaveBankFile& file)
+	{
+		return file.GetEntryCount();
+	}
+
+	uint32 GetEntryCount(const SoundBankFile& file)
+	{
+		return file.GetCueCount();
+	}
+
+	// Parses the bank repeatCount times and prints the time per parse
+	template<class File>
+	bool Measure(const char* name, const std::vector<uint8>& data, unsigned int repeatCount)
+	{
+		File file;
+		BankParseResult result = file.Parse(data.empty() == false ? &data[0] : NULL, data.size());
+		if (result != BankParseOk)
+		{
+			fprintf(stderr, "error: %s cannot be parsed, result %d\n", name, static_cast<int>(result));
+			return false;
+		}
+		uint32 entryCount = GetEntryCount(file);
+
+		double start = GetSeconds();
+		for (unsigned int i = 0; i < repeatCount; i++)
+		{
+			file.Parse(&data[0], data.size());
+		}
+		double seconds = (GetSeconds() - start) / repeatCount;
+
+		printf("%-24s %9u %10.1f KB %10.1f us %8.1f ns %9.0f MB/s\n", name, entryCount, data.size() / 1024.0,
+			seconds * 1e6, entryCount > 0 ? seconds * 1e9 / entryCount : 0, data.size() / seconds / 1048576.0);
+		return true;
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.entryCount = 50000;
+		parameters.repeatCount = 100;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			if (arg[0] != '/' && arg[0] != '-')
+			{
+				parameters.paths.push_back(arg);
+				continue;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'E': pValue = &parameters.entryCount; break;
+			case 'N': pValue = &parameters.repeatCount; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		// Sound banks count their cues and sounds in 16 bits
+		if (parameters.repeatCount == 0 || parameters.entryCount == 0 || parameters.entryCount > 65535)
+		{
+			fprintf(stderr, "error: the repeat count must be at least 1, the entry count between 1 and 65535\n");
+			return false;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Bank Parse Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: BANKPARSEBENCHMARK [options] [banks]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /E:<count>      Entries of the generated wave bank and cues of the\n");
+		printf("                   generated sound bank, default is 50000.\n");
+		printf("   /N:<count>      Parses per bank, default is 100.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	printf("Bank              entries or cues        size      parse  per entry   throughput\n");
+
+	bool succeeded = true;
+	std::vector<uint8> data;
+	if (parameters.paths.empty() == true)
+	{
+		GenerateWaveBank(parameters.entryCount, data);
+		succeeded &= Measure<WaveBankFile>("generated.xwb", data, parameters.repeatCount);
+		GenerateSoundBank(parameters.entryCount, data);
+		succeeded &= Measure<SoundBankFile>("generated.xsb", data, parameters.repeatCount);
+	}
+	for (size_t i = 0; i < parameters.paths.size(); i++)
+	{
+		const char* path = parameters.paths[i];
+		if (ReadFile(path, data) == false)
+		{
+			fprintf(stderr, "error: cannot read %s\n", path);
+			succeeded = false;
+			continue;
+		}
+		// Sound banks start with SDBK, or KBDS byte swapped
+		bool isSoundBank = data.size() >= 4 &&
+			(memcmp(&data[0], "SDBK", 4) == 0 || memcmp(&data[0], "KBDS", 4) == 0);
+		if (isSoundBank == true)
+		{
+			succeeded &= Measure<SoundBankFile>(path, data, parameters.repeatCount);
+		}
+		else
+		{
+			succeeded &= Measure<WaveBankFile>(path, data, parameters.repeatCount);
+		}
+	}
+	return succeeded == true ? 0 : 1;
+}
@@ -1,108 +1,600 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "StringResources.h"
-
-#include "AudioEmitter.h"
-
-using namespace Bnoerj::Audio;
-
-AudioEmitter::AudioEmitter()
-{
-	emitterData = new X3DAUDIO_EMITTER();
-	ZeroMemory(emitterData, sizeof(X3DAUDIO_EMITTER));
-
-	emitterData->OrientFront.x = XnaVector3::Forward.X;
-	emitterData->OrientFront.y = XnaVector3::Forward.Y;
-	emitterData->OrientFront.z = -XnaVector3::Forward.Z;
-
-	emitterData->OrientTop.x = XnaVector3::Up.X;
-	emitterData->OrientTop.y = XnaVector3::Up.Y;
-	emitterData->OrientTop.z = -XnaVector3::Up.Z;
-
-	emitterData->DopplerScaler = 1;
-	emitterData->ChannelCount = 1;
-	emitterData->ChannelRadius = 1;
-	emitterData->CurveDistanceScaler = 1;
-}
-
-AudioEmitter::~AudioEmitter()
-{
-	this->!AudioEmitter();
-	GC::SuppressFinalize(this);
-}
-
-AudioEmitter::!AudioEmitter()
-{
-	delete emitterData;
-	emitterData = NULL;
-}
-
-float AudioEmitter::DopplerScale::get()
-{
-	return emitterData->DopplerScaler;
-}
-
-void AudioEmitter::DopplerScale::set(float value)
-{
-	if (value < 0)
-	{
-		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterDopplerScale);
-	}
-
-	emitterData->DopplerScaler = value;
-}
-
-XnaVector3 AudioEmitter::Position::get()
-{
-	return XnaVector3(emitterData->Position.x, emitterData->Position.y, -emitterData->Position.z);
-}
-
-void AudioEmitter::Position::set(XnaVector3 value)
-{
-	emitterData->Position.x = value.X;
-	emitterData->Position.y = value.Y;
-	emitterData->Position.z = -value.Z;
-}
-
-XnaVector3 AudioEmitter::Forward::get()
-{
-	return XnaVector3(emitterData->OrientFront.x, emitterData->OrientFront.y, -emitterData->OrientFront.z);
-}
-
-void AudioEmitter::Forward::set(XnaVector3 value)
-{
-	emitterData->OrientFront.x = value.X;
-	emitterData->OrientFront.y = value.Y;
-	emitterData->OrientFront.z = -value.Z;
-}
-
-XnaVector3 AudioEmitter::Up::get()
-{
-	return XnaVector3(emitterData->OrientTop.x, emitterData->OrientTop.y, -emitterData->OrientTop.z);
-}
-
-void AudioEmitter::Up::set(XnaVector3 value)
-{
-	emitterData->OrientTop.x = value.X;
-	emitterData->OrientTop.y = value.Y;
-	emitterData->OrientTop.z = -value.Z;
-}
-
-XnaVector3 AudioEmitter::Velocity::get()
-{
-	return XnaVector3(emitterData->Velocity.x, emitterData->Velocity.y, -emitterData->Velocity.z);
-}
-
-void AudioEmitter::Velocity::set(XnaVector3 value)
-{
-	emitterData->Velocity.x = value.X;
-	emitterData->Velocity.y = value.Y;
-	emitterData->Velocity.z = -value.Z;
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "NativeEngine.h"
+#include "AudioEmitter.h"
+
+using namespace Bnoerj::Audio;
+using Bnoerj::Audio::Native::EmitterStore;
+using Bnoerj::Audio::Native::Engine;
+using Bnoerj::Audio::Native::ScopedLock;
+
+// Emitters of a bulk setter handed to the store at a time
+static const int BulkChunkSize = 64;
+
+// True if value is further than epsilon from the tracked value
+static bool Exceeds(XnaVector3 value, XnaVector3 tracked, float epsilon)
+{
+	return XnaVector3::DistanceSquared(value, tracked) > epsilon * epsilon;
+}
+
+AudioEmitter::AudioEmitter()
+	: storeEngine(nullptr)
+	, slot(-1)
+	, forward(XnaVector3::Forward)
+	, up(XnaVector3::Up)
+	, dopplerScale(1)
+	, channelCount(1)
+	, channelRadius(1)
+	, audibleRadius(Native::DefaultAudibleRadius)
+	, trackedForward(XnaVector3::Forward)
+	, trackedUp(XnaVector3::Up)
+	, generation(1)
+{
+}
+
+AudioEmitter::AudioEmitter(Native::Engine^ engine)
+	: storeEngine(engine)
+	, slot(engine->pEmitterStore->Add())
+{
+}
+
+AudioEmitter::~AudioEmitter()
+{
+	if (storeEngine != nullptr && slot >= 0)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		// Gone with the engine if it was disposed first
+		if (storeEngine->pEmitterStore != NULL)
+		{
+			storeEngine->pEmitterStore->Remove(slot);
+		}
+		slot = -1;
+	}
+}
+
+EmitterStore* AudioEmitter::GetStore()
+{
+	EmitterStore* pStore = storeEngine->pEmitterStore;
+	if (slot < 0 || pStore == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+	return pStore;
+}
+
+void AudioEmitter::CheckDisposed()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore();
+	}
+}
+
+long long AudioEmitter::Generation::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->GetGeneration(slot);
+	}
+	return generation;
+}
+
+void AudioEmitter::GetEmitter(X3DAUDIO_EMITTER* pEmitter, FLOAT32* pChannelAzimuths)
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->GetEmitter(slot, pEmitter, pChannelAzimuths);
+		return;
+	}
+
+	ZeroMemory(pEmitter, sizeof(X3DAUDIO_EMITTER));
+
+	pEmitter->OrientFront.x = forward.X;
+	pEmitter->OrientFront.y = forward.Y;
+	pEmitter->OrientFront.z = -forward.Z;
+
+	pEmitter->OrientTop.x = up.X;
+	pEmitter->OrientTop.y = up.Y;
+	pEmitter->OrientTop.z = -up.Z;
+
+	pEmitter->Position.x = position.X;
+	pEmitter->Position.y = position.Y;
+	pEmitter->Position.z = -position.Z;
+
+	pEmitter->Velocity.x = velocity.X;
+	pEmitter->Velocity.y = velocity.Y;
+	pEmitter->Velocity.z = -velocity.Z;
+
+	pEmitter->DopplerScaler = dopplerScale;
+	pEmitter->ChannelCount = channelCount;
+	pEmitter->ChannelRadius = channelRadius;
+	pEmitter->CurveDistanceScaler = 1;
+
+	if (channelAzimuths != nullptr)
+	{
+		for (int i = 0; i < channelCount; i++)
+		{
+			pChannelAzimuths[i] = channelAzimuths[i];
+		}
+		pEmitter->pChannelAzimuths = pChannelAzimuths;
+	}
+}
+
+XnaVector3 AudioEmitter::GetVector(int field)
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		float xyz[3];
+		GetStore()->GetVector(slot, static_cast<EmitterStore::Field>(field), xyz);
+		return XnaVector3(xyz[0], xyz[1], xyz[2]);
+	}
+
+	switch (field)
+	{
+	case EmitterStore::FieldPositionX:
+		return position;
+	case EmitterStore::FieldFrontX:
+		return forward;
+	case EmitterStore::FieldTopX:
+		return up;
+	default:
+		return velocity;
+	}
+}
+
+void AudioEmitter::SetVector(int field, XnaVector3 value)
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		float xyz[3] = { value.X, value.Y, value.Z };
+		GetStore()->SetVector(slot, static_cast<EmitterStore::Field>(field), xyz);
+		return;
+	}
+
+	switch (field)
+	{
+	case EmitterStore::FieldPositionX:
+		position = value;
+		if (Exceeds(value, trackedPosition, positionEpsilon) == true)
+		{
+			trackedPosition = value;
+			generation++;
+		}
+		break;
+	case EmitterStore::FieldFrontX:
+		forward = value;
+		if (Exceeds(value, trackedForward, orientationEpsilon) == true)
+		{
+			trackedForward = value;
+			generation++;
+		}
+		break;
+	case EmitterStore::FieldTopX:
+		up = value;
+		if (Exceeds(value, trackedUp, orientationEpsilon) == true)
+		{
+			trackedUp = value;
+			generation++;
+		}
+		break;
+	case EmitterStore::FieldVelocityX:
+		// Any change moves the doppler shift
+		if (value != velocity)
+		{
+			generation++;
+		}
+		velocity = value;
+		break;
+	}
+}
+
+void AudioEmitter::SetVectors(array<AudioEmitter^>^ emitters, array<XnaVector3>^ values, int count, int field)
+{
+	// Held across the checks, so no store goes with its engine before the
+	// emitters are set
+	ScopedLock lock(Engine::emitterSyncRoot);
+
+	// Check everything first, so a bad entry leaves all emitters as they are
+	for (int i = 0; i < count; i++)
+	{
+		if (emitters[i] == nullptr)
+		{
+			throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+		}
+		emitters[i]->CheckDisposed();
+	}
+	if (count == 0)
+	{
+		return;
+	}
+
+	pin_ptr<XnaVector3> pValues = &values[0];
+	const float* pXyz = reinterpret_cast<const float*>(pValues);
+
+	LONG slots[BulkChunkSize];
+	int i = 0;
+	while (i < count)
+	{
+		AudioEmitter^ emitter = emitters[i];
+		if (emitter->storeEngine == nullptr)
+		{
+			emitter->SetVector(field, values[i]);
+			i++;
+			continue;
+		}
+
+		// A run of emitters from the same store
+		int first = i;
+		int slotCount = 0;
+		while (i < count && slotCount < BulkChunkSize && emitters[i]->storeEngine == emitter->storeEngine)
+		{
+			slots[slotCount++] = emitters[i]->slot;
+			i++;
+		}
+		emitter->GetStore()->SetVectors(static_cast<EmitterStore::Field>(field), slots, pXyz + first * 3, slotCount);
+	}
+}
+
+void AudioEmitter::SetPositions(array<AudioEmitter^>^ emitters, array<XnaVector3>^ positions, int count)
+{
+	if (emitters == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+	}
+	if (positions == nullptr)
+	{
+		throw gcnew ArgumentNullException("positions", StringResources::NullNotAllowed);
+	}
+	if (count < 0 || count > emitters->Length || count > positions->Length)
+	{
+		throw gcnew ArgumentOutOfRangeException("count", StringResources::InvalidEmitterBulkCount);
+	}
+
+	SetVectors(emitters, positions, count, EmitterStore::FieldPositionX);
+}
+
+void AudioEmitter::SetVelocities(array<AudioEmitter^>^ emitters, array<XnaVector3>^ velocities, int count)
+{
+	if (emitters == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+	}
+	if (velocities == nullptr)
+	{
+		throw gcnew ArgumentNullException("velocities", StringResources::NullNotAllowed);
+	}
+	if (count < 0 || count > emitters->Length || count > velocities->Length)
+	{
+		throw gcnew ArgumentOutOfRangeException("count", StringResources::InvalidEmitterBulkCount);
+	}
+
+	SetVectors(emitters, velocities, count, EmitterStore::FieldVelocityX);
+}
+
+void AudioEmitter::SetOrientations(array<AudioEmitter^>^ emitters, array<XnaVector3>^ forwards,
+	array<XnaVector3>^ ups, int count)
+{
+	if (emitters == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+	}
+	if (forwards == nullptr)
+	{
+		throw gcnew ArgumentNullException("forwards", StringResources::NullNotAllowed);
+	}
+	if (ups == nullptr)
+	{
+		throw gcnew ArgumentNullException("ups", StringResources::NullNotAllowed);
+	}
+	if (count < 0 || count > emitters->Length || count > forwards->Length || count > ups->Length)
+	{
+		throw gcnew ArgumentOutOfRangeException("count", StringResources::InvalidEmitterBulkCount);
+	}
+
+	SetVectors(emitters, forwards, count, EmitterStore::FieldFrontX);
+	SetVectors(emitters, ups, count, EmitterStore::FieldTopX);
+}
+
+float AudioEmitter::DopplerScale::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->Get(EmitterStore::FieldDopplerScaler, slot);
+	}
+	return dopplerScale;
+}
+
+void AudioEmitter::DopplerScale::set(float value)
+{
+	if (value < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterDopplerScale);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->Set(EmitterStore::FieldDopplerScaler, slot, value);
+	}
+	else if (value != dopplerScale)
+	{
+		dopplerScale = value;
+		generation++;
+	}
+}
+
+XnaVector3 AudioEmitter::Position::get()
+{
+	return GetVector(EmitterStore::FieldPositionX);
+}
+
+void AudioEmitter::Position::set(XnaVector3 value)
+{
+	SetVector(EmitterStore::FieldPositionX, value);
+}
+
+XnaVector3 AudioEmitter::Forward::get()
+{
+	return GetVector(EmitterStore::FieldFrontX);
+}
+
+void AudioEmitter::Forward::set(XnaVector3 value)
+{
+	SetVector(EmitterStore::FieldFrontX, value);
+}
+
+XnaVector3 AudioEmitter::Up::get()
+{
+	return GetVector(EmitterStore::FieldTopX);
+}
+
+void AudioEmitter::Up::set(XnaVector3 value)
+{
+	SetVector(EmitterStore::FieldTopX, value);
+}
+
+XnaVector3 AudioEmitter::Velocity::get()
+{
+	return GetVector(EmitterStore::FieldVelocityX);
+}
+
+void AudioEmitter::Velocity::set(XnaVector3 value)
+{
+	SetVector(EmitterStore::FieldVelocityX, value);
+}
+
+int AudioEmitter::ChannelCount::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->GetChannelCount(slot);
+	}
+	return channelCount;
+}
+
+void AudioEmitter::ChannelCount::set(int value)
+{
+	if (value < 1 || value > MaxChannelCount)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterChannelCount);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->SetChannelCount(slot, value);
+	}
+	else if (value != channelCount)
+	{
+		channelCount = value;
+		channelAzimuths = nullptr;
+		generation++;
+	}
+}
+
+float AudioEmitter::ChannelRadius::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->Get(EmitterStore::FieldChannelRadius, slot);
+	}
+	return channelRadius;
+}
+
+void AudioEmitter::ChannelRadius::set(float value)
+{
+	if (value < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterChannelRadius);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->Set(EmitterStore::FieldChannelRadius, slot, value);
+	}
+	else if (value != channelRadius)
+	{
+		channelRadius = value;
+		generation++;
+	}
+}
+
+array<float>^ AudioEmitter::ChannelAzimuths::get()
+{
+	if (storeEngine == nullptr)
+	{
+		return channelAzimuths != nullptr ? safe_cast<array<float>^>(channelAzimuths->Clone()) : nullptr;
+	}
+
+	ScopedLock lock(Engine::emitterSyncRoot);
+
+	// One call, so the count matches the azimuths
+	FLOAT32 channelAzimuths[MaxChannelCount];
+	UINT azimuthCount;
+	if (GetStore()->GetChannelAzimuths(slot, channelAzimuths, &azimuthCount) == false)
+	{
+		return nullptr;
+	}
+
+	array<float>^ azimuths = gcnew array<float>(azimuthCount);
+	for (int i = 0; i < azimuths->Length; i++)
+	{
+		azimuths[i] = channelAzimuths[i];
+	}
+	return azimuths;
+}
+
+void AudioEmitter::ChannelAzimuths::set(array<float>^ value)
+{
+	if (value != nullptr)
+	{
+		if (value->Length != ChannelCount)
+		{
+			throw gcnew ArgumentException(StringResources::EmitterChannelAzimuthsLengthMismatch, "value");
+		}
+		for (int i = 0; i < value->Length; i++)
+		{
+			// Written so NaN fails as well
+			if ((value[i] >= 0 && value[i] <= X3DAUDIO_2PI) == false)
+			{
+				throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterChannelAzimuth);
+			}
+		}
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		if (value == nullptr)
+		{
+			GetStore()->SetChannelAzimuths(slot, NULL, 0);
+			return;
+		}
+
+		// ChannelCount may have changed on another thread since the check
+		pin_ptr<float> pValue = &value[0];
+		if (GetStore()->SetChannelAzimuths(slot, pValue, value->Length) == false)
+		{
+			throw gcnew ArgumentException(StringResources::EmitterChannelAzimuthsLengthMismatch, "value");
+		}
+		return;
+	}
+
+	channelAzimuths = value != nullptr ? safe_cast<array<float>^>(value->Clone()) : nullptr;
+	generation++;
+}
+
+float AudioEmitter::PositionEpsilon::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->Get(EmitterStore::FieldPositionEpsilon, slot);
+	}
+	return positionEpsilon;
+}
+
+void AudioEmitter::PositionEpsilon::set(float value)
+{
+	if (value < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidChangeEpsilon);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->Set(EmitterStore::FieldPositionEpsilon, slot, value);
+		return;
+	}
+	positionEpsilon = value;
+}
+
+float AudioEmitter::OrientationEpsilon::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->Get(EmitterStore::FieldOrientationEpsilon, slot);
+	}
+	return orientationEpsilon;
+}
+
+void AudioEmitter::OrientationEpsilon::set(float value)
+{
+	if (value < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidChangeEpsilon);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->Set(EmitterStore::FieldOrientationEpsilon, slot, value);
+		return;
+	}
+	orientationEpsilon = value;
+}
+
+float AudioEmitter::AudibleRadius::get()
+{
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		return GetStore()->GetAudibleRadius(slot);
+	}
+	return audibleRadius;
+}
+
+void AudioEmitter::AudibleRadius::set(float value)
+{
+	if (value <= 0 || Single::IsNaN(value) == true)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterAudibleRadius);
+	}
+
+	if (storeEngine != nullptr)
+	{
+		ScopedLock lock(Engine::emitterSyncRoot);
+
+		GetStore()->SetAudibleRadius(slot, value);
+		return;
+	}
+	audibleRadius = value;
+}
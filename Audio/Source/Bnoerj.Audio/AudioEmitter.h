@@ -1,56 +1,186 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class AudioEmitter
-	{
-	internal:
-		X3DAUDIO_EMITTER* emitterData;
-
-		//FIXME: needs to be non-IDisposable
-		~AudioEmitter();
-		!AudioEmitter();
-
-	public:
-		AudioEmitter();
-
-		property float DopplerScale
-		{
-			float get();
-			void set(float value);
-		}
-
-		property XnaVector3 Position
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Forward
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Up
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Velocity
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-	};
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	namespace Native
+	{
+		ref class Engine;
+		class EmitterStore;
+	}
+
+	// Emitters from AudioEngine::CreateEmitter may be set and read on any
+	// thread, also while others are created, disposed or queried, while
+	// cues are positioned with them and while their engine is disposed:
+	// every property and bulk setter takes Engine::emitterSyncRoot, which
+	// the engine holds to delete its EmitterStore, and the lock of the
+	// store. Each call is atomic on its own, a cue positioned on another
+	// thread between setting Position and Velocity sees the new position
+	// with the old velocity. Emitters created with the constructor are
+	// not synchronized; set them on one thread, or lock around them and
+	// the Apply3D calls taking them.
+	public ref class AudioEmitter
+	{
+		// Emitters from AudioEngine::CreateEmitter are a slot in the
+		// engine's EmitterStore, which keeps all their values and their
+		// generation. The fields below are only used by emitters of their
+		// own, created with the public constructor.
+		Native::Engine^ storeEngine;
+		LONG slot;
+
+		XnaVector3 position;
+		XnaVector3 forward;
+		XnaVector3 up;
+		XnaVector3 velocity;
+		float dopplerScale;
+		int channelCount;
+		float channelRadius;
+		array<float>^ channelAzimuths;
+		float audibleRadius;
+
+		// Values as of the last generation, see PositionEpsilon
+		XnaVector3 trackedPosition;
+		XnaVector3 trackedForward;
+		XnaVector3 trackedUp;
+		float positionEpsilon;
+		float orientationEpsilon;
+		long long generation;
+
+		// Throws once the emitter or its engine is disposed. The caller
+		// holds Engine::emitterSyncRoot while it uses the store.
+		Native::EmitterStore* GetStore();
+		// field is an EmitterStore::Field of a vector, as for its SetVector
+		XnaVector3 GetVector(int field);
+		void SetVector(int field, XnaVector3 value);
+		static void SetVectors(array<AudioEmitter^>^ emitters, array<XnaVector3>^ values, int count, int field);
+
+	internal:
+		// Source channels XACT3DApply positions, see ChannelCount
+		literal int MaxChannelCount = 8;
+
+		// A slot in the engine's EmitterStore
+		AudioEmitter(Native::Engine^ engine);
+
+		// -1 for emitters of their own
+		property LONG Slot { LONG get() { return slot; } }
+
+		// Bumped whenever a setter changes the 3D settings, see
+		// Cue::Apply3D
+		property long long Generation { long long get(); }
+
+		// Throws ObjectDisposedException as the other members would
+		void CheckDisposed();
+
+		// The emitter as XACT3DCalculate takes it, pChannelAzimuths holds
+		// MaxChannelCount
+		void GetEmitter(X3DAUDIO_EMITTER* pEmitter, FLOAT32* pChannelAzimuths);
+
+		// Emitters from AudioEngine::CreateEmitter give their slot back,
+		// for the others there is nothing to release. Slots of emitters
+		// collected without it are freed by AudioEngine::Update.
+		//FIXME: needs to be non-IDisposable
+		~AudioEmitter();
+
+	public:
+		AudioEmitter();
+
+		// Set the emitters' values in order, emitters from the same
+		// AudioEngine::CreateEmitter engine in one pass over its store
+		static void SetPositions(array<AudioEmitter^>^ emitters, array<XnaVector3>^ positions, int count);
+		static void SetVelocities(array<AudioEmitter^>^ emitters, array<XnaVector3>^ velocities, int count);
+		static void SetOrientations(array<AudioEmitter^>^ emitters, array<XnaVector3>^ forwards,
+			array<XnaVector3>^ ups, int count);
+
+		property float DopplerScale
+		{
+			float get();
+			void set(float value);
+		}
+
+		property XnaVector3 Position
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Forward
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Up
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Velocity
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		// Position and orientation changes smaller than these, summed
+		// since the last change that counted, leave the 3D settings of
+		// the cues positioned with this emitter as they are. The
+		// orientation epsilon is about the angle in radians. Zero by
+		// default, only setting the same value again is ignored.
+		property float PositionEpsilon
+		{
+			float get();
+			void set(float value);
+		}
+
+		property float OrientationEpsilon
+		{
+			float get();
+			void set(float value);
+		}
+
+		// Must match the channels of the sounds the emitter plays, the 3D
+		// settings are calculated for that many source channels. Changing
+		// it drops the channel azimuths.
+		property int ChannelCount
+		{
+			int get();
+			void set(int value);
+		}
+
+		// Distance of the channels from the emitter position
+		property float ChannelRadius
+		{
+			float get();
+			void set(float value);
+		}
+
+		// One azimuth per channel, in radians clockwise from the front
+		// around Up. Null for the default layout XACT3DCalculate picks.
+		property array<float>^ ChannelAzimuths
+		{
+			array<float>^ get();
+			void set(array<float>^ value);
+		}
+
+		// Distance beyond which the emitter is not heard, usually where the
+		// attenuation curve of its sounds ends. AudioEngine::GetAudibleEmitters
+		// leaves out emitters further from the listener. 100 by default,
+		// the default AudioEngine::EmitterCellSize. Only used by that query:
+		// Apply3D and the 3D PlayCue overloads position cues at any
+		// distance, culling is left to the caller.
+		property float AudibleRadius
+		{
+			float get();
+			void set(float value);
+		}
+
+	};
+}}
@@ -1,255 +1,762 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "StringResources.h"
-
-#include "AudioStopOptions.h"
-#include "AudioCategory.h"
-#include "RendererDetail.h"
-#include "AudioEngine.h"
-#include "AudioListener.h"
-#include "AudioEmitter.h"
-#include "AudioObject.h"
-#include "Cue.h"
-#include "WaveBank.h"
-#include "SoundBank.h"
-
-#include "NativeEngine.h"
-#include "NativeAudioObject.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio;
-
-
-AudioEngine::AudioEngine(String^ settingsFile)
-	: isDisposed(false)
-{
-	Initialize(settingsFile, TimeSpan(0, 0, 0, 0, XACT_ENGINE_LOOKAHEAD_DEFAULT), Guid::Empty);
-}
-
-AudioEngine::AudioEngine(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId)
-	: isDisposed(false)
-{
-	Initialize(settingsFile, lookAheadTime, rendererId);
-}
-
-void AudioEngine::Initialize(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId)
-{
-	if (String::IsNullOrEmpty(settingsFile) == true)
-	{
-		throw gcnew ArgumentNullException("settingsFile", StringResources::NullNotAllowed);
-	}
-
-	// Create XACT3 engine
-	String^ fullPath = Path::GetFullPath(settingsFile);
-	engine = gcnew Native::Engine(fullPath, (UInt32)lookAheadTime.TotalMilliseconds, rendererId);
-	if (engine == nullptr)
-	{
-		throw gcnew InvalidOperationException(StringResources::CouldNotCreateResource);
-	}
-	pEngine = engine->pEngine;
-
-	if (hookedCueDestroy == false)
-	{
-		Native::Engine::CueDestroyed += gcnew Native::CueDestroyedEventHandler(&AudioEngine::NotifyCueDestroyed);
-		hookedCueDestroy = true;
-	}
-}
-
-AudioEngine::~AudioEngine()
-{
-	msclr::lock lock(AudioEngine::syncRoot);
-
-	// Save dispose state to raise the disposed event properly
-	bool wasDisposed = isDisposed;
-
-	lock.release();
-
-	this->!AudioEngine();
-
-	if (wasDisposed == false)
-	{
-		Disposing(this, EventArgs::Empty);
-	}
-
-	GC::SuppressFinalize(this);
-}
-
-AudioEngine::!AudioEngine()
-{
-	msclr::lock lock(AudioEngine::syncRoot);
-
-	if (isDisposed == false)
-	{
-		isDisposed = true;
-		if (engine != nullptr)
-		{
-			NotifyEngineDestroyed(this);
-
-			delete engine;
-			engine = nullptr;
-		}
-	}
-}
-
-bool AudioEngine::IsDisposed::get()
-{
-	return isDisposed;
-}
-
-ReadOnlyCollection<RendererDetail^>^ AudioEngine::RendererDetails::get()
-{
-	int rendererCount = engine->GetRendererCount();
-	if (rendererCount <= 0)
-	{
-		return nullptr;
-	}
-
-	List<RendererDetail^> renderers(rendererCount);
-	for (int i = 0; i < rendererCount; i++)
-	{
-		String^ friendlyName = String::Empty;
-		String^ guid = String::Empty;
-		engine->GetRendererDetail(i, friendlyName, guid);
-		renderers.Add(gcnew RendererDetail(friendlyName, Guid(guid)));
-	}
-	return gcnew ReadOnlyCollection<RendererDetail^>(%renderers);
-}
-
-//event Disposing;
-
-AudioCategory^ AudioEngine::GetCategory(String^ name)
-{
-	return gcnew AudioCategory(this, name);
-}
-
-float AudioEngine::GetGlobalVariable(String^ name)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-	return engine->GetGlobalVariable(name);
-}
-
-void AudioEngine::SetGlobalVariable(String^ name, float value)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-	engine->SetGlobalVariable(name, value);
-}
-
-void AudioEngine::Update()
-{
-	engine->Update();
-}
-
-void AudioEngine::AddAudioInstance(void* ptr, Object^ instance)
-{
-	audioInstances->Add(IntPtr(ptr), gcnew WeakReference(instance, false));
-}
-
-void AudioEngine::RemoveAudioInstance(void* ptr)
-{
-	audioInstances->Remove(IntPtr(ptr));
-}
-
-void AudioEngine::NotifyCueDestroyed(IntPtr pCue)
-{
-	msclr::lock lock(syncRoot);
-
-	WeakReference^ ref;
-	if (audioInstances->TryGetValue(pCue, ref) == true)
-	{
-		audioInstances->Remove(pCue);
-		Object^ target = nullptr;
-		try
-		{
-			target = ref->Target;
-		}
-		catch(InvalidOperationException^)
-		{
-		}
-
-		if (target != nullptr)
-		{
-			Cue^ cue = safe_cast<Cue^>(target);
-			delete cue;
-		}
-	}
-}
-
-void AudioEngine::NotifyEngineDestroyed(AudioEngine^ engine)
-{
-	msclr::lock lock(syncRoot);
-
-	List<WeakReference^>^ instances = gcnew List<WeakReference^>(audioInstances->Values);
-	for each (WeakReference^ ref in instances)
-	{
-		Object^ target = nullptr;
-		try
-		{
-			target = ref->Target;
-		}
-		catch(InvalidOperationException^)
-		{
-			continue;
-		}
-
-		if (target != nullptr)
-		{
-			AudioObject^ audioObject = dynamic_cast<AudioObject^>(target);
-			Native::AudioObject^ nativeAudioObject = audioObject->nativeObject;
-			if (audioObject != nullptr && nativeAudioObject != nullptr &&
-				nativeAudioObject->pEngine == engine->pEngine)
-			{
-				delete audioObject;
-			}
-#if 0
-			Cue^ cue = dynamic_cast<Cue^>(target);
-			if (cue != nullptr)
-			{
-				if (cue->pEngine == engine->pEngine)
-				{
-					audioInstances->Remove(cue->pObject);
-					cue->pObject = IntPtr::Zero;
-					delete cue;
-				}
-				continue;
-			}
-
-			WaveBank^ waveBank = dynamic_cast<WaveBank^>(target);
-			if (waveBank != nullptr)
-			{
-				if (waveBank->pEngine == engine->pEngine)
-				{
-					audioInstances->Remove(waveBank->pObject);
-					waveBank->pObject = IntPtr::Zero;
-					delete waveBank;
-				}
-				continue;
-			}
-
-			SoundBank^ soundBank = dynamic_cast<SoundBank^>(target);
-			if (soundBank != nullptr)
-			{
-				if (soundBank->pEngine == engine->pEngine)
-				{
-					audioInstances->Remove(soundBank->pObject);
-					soundBank->pObject = IntPtr::Zero;
-					delete soundBank;
-				}
-				continue;
-			}
-#endif
-		}
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngineStatistics.h"
+#include "BankBudget.h"
+#include "BankLoadOperation.h"
+#include "BankPack.h"
+#include "AudioEngine.h"
+#include "AudioListener.h"
+#include "AudioEmitter.h"
+#include "AudioObject.h"
+#include "AudioInstanceTable.h"
+#include "Cue.h"
+#include "WaveBank.h"
+#include "SoundBank.h"
+#include "VariableHandle.h"
+
+#include "NativeEngine.h"
+#include "NativeAudioObject.h"
+#include "NativeCue.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio;
+
+
+AudioEngine::AudioEngine(String^ settingsFile)
+	: isDisposed(false)
+{
+	Initialize(settingsFile, TimeSpan(0, 0, 0, 0, XACT_ENGINE_LOOKAHEAD_DEFAULT), Guid::Empty);
+}
+
+AudioEngine::AudioEngine(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId)
+	: isDisposed(false)
+{
+	Initialize(settingsFile, lookAheadTime, rendererId);
+}
+
+AudioEngine::AudioEngine(BankPack^ pack, String^ settingsName)
+	: isDisposed(false)
+{
+	Initialize(pack, settingsName, TimeSpan(0, 0, 0, 0, XACT_ENGINE_LOOKAHEAD_DEFAULT), Guid::Empty);
+}
+
+AudioEngine::AudioEngine(BankPack^ pack, String^ settingsName, TimeSpan lookAheadTime, Guid rendererId)
+	: isDisposed(false)
+{
+	Initialize(pack, settingsName, lookAheadTime, rendererId);
+}
+
+void AudioEngine::Initialize(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId)
+{
+	if (String::IsNullOrEmpty(settingsFile) == true)
+	{
+		throw gcnew ArgumentNullException("settingsFile", StringResources::NullNotAllowed);
+	}
+
+	String^ fullPath = Path::GetFullPath(settingsFile);
+	Create(Native::Engine::MapFile(fullPath, Native::FileMapping::AccessCopyOnWrite), lookAheadTime, rendererId);
+}
+
+void AudioEngine::Initialize(BankPack^ pack, String^ settingsName, TimeSpan lookAheadTime, Guid rendererId)
+{
+	if (pack == nullptr)
+	{
+		throw gcnew ArgumentNullException("pack", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(settingsName) == true)
+	{
+		throw gcnew ArgumentNullException("settingsName", StringResources::NullNotAllowed);
+	}
+
+	Native::BankPackEntry entry = pack->GetEntry(settingsName);
+	if (entry.type != Native::BankPackEntrySettings)
+	{
+		throw gcnew ArgumentException(String::Format(StringResources::PackEntryTypeMismatch, settingsName), "settingsName");
+	}
+	Create(pack->MapEntry(entry, Native::FileMapping::AccessCopyOnWrite), lookAheadTime, rendererId);
+}
+
+void AudioEngine::Create(Native::FileMapping* pSettingsMapping, TimeSpan lookAheadTime, Guid rendererId)
+{
+	// Create XACT3 engine
+	engine = gcnew Native::Engine(pSettingsMapping, (UInt32)lookAheadTime.TotalMilliseconds, rendererId);
+	if (engine == nullptr)
+	{
+		throw gcnew InvalidOperationException(StringResources::CouldNotCreateResource);
+	}
+	pEngine = engine->pEngine;
+
+	loadOperations = gcnew List<BankLoadOperation^>();
+	budget = gcnew BankBudget();
+	apply3DThreadCount = 1;
+
+	instances = gcnew AudioInstanceTable();
+	engine->CueDestroyed += gcnew Native::CueDestroyedEventHandler(this, &AudioEngine::NotifyCueDestroyed);
+}
+
+AudioEngine::~AudioEngine()
+{
+	// Save dispose state to raise the disposed event properly
+	bool wasDisposed;
+	{
+		Native::ScopedLock lock(AudioEngine::syncRoot);
+		wasDisposed = isDisposed;
+	}
+
+	this->!AudioEngine();
+
+	if (wasDisposed == false)
+	{
+		Disposing(this, EventArgs::Empty);
+	}
+
+	GC::SuppressFinalize(this);
+}
+
+AudioEngine::!AudioEngine()
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	if (isDisposed == false)
+	{
+		isDisposed = true;
+		if (engine != nullptr)
+		{
+			// Pending loads can no longer create their banks
+			msclr::lock loadLock(loadOperations);
+			for each (BankLoadOperation^ operation in loadOperations)
+			{
+				operation->Cancel();
+			}
+			loadOperations->Clear();
+			loadLock.release();
+
+			// A sweep over the objects of this engine only
+			instances->DisposeAll();
+			budget->Clear();
+
+			delete engine;
+			engine = nullptr;
+		}
+	}
+}
+
+bool AudioEngine::IsDisposed::get()
+{
+	return isDisposed;
+}
+
+ReadOnlyCollection<RendererDetail^>^ AudioEngine::RendererDetails::get()
+{
+	int rendererCount = engine->GetRendererCount();
+	if (rendererCount <= 0)
+	{
+		return nullptr;
+	}
+
+	List<RendererDetail^> renderers(rendererCount);
+	for (int i = 0; i < rendererCount; i++)
+	{
+		String^ friendlyName = String::Empty;
+		String^ guid = String::Empty;
+		engine->GetRendererDetail(i, friendlyName, guid);
+		renderers.Add(gcnew RendererDetail(friendlyName, Guid(guid)));
+	}
+	return gcnew ReadOnlyCollection<RendererDetail^>(%renderers);
+}
+
+bool AudioEngine::DeferCommands::get()
+{
+	return engine->deferCommands;
+}
+
+void AudioEngine::DeferCommands::set(bool value)
+{
+	engine->SetDeferCommands(value);
+}
+
+long long AudioEngine::MemoryBudget::get()
+{
+	return budget->Budget;
+}
+
+void AudioEngine::MemoryBudget::set(long long value)
+{
+	if (value < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidMemoryBudget);
+	}
+	budget->Budget = value;
+}
+
+int AudioEngine::Apply3DThreadCount::get()
+{
+	return apply3DThreadCount;
+}
+
+void AudioEngine::Apply3DThreadCount::set(int value)
+{
+	if (value < 1)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidApply3DThreadCount);
+	}
+	apply3DThreadCount = value;
+}
+
+float AudioEngine::EmitterCellSize::get()
+{
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	Native::ScopedLock lock(Native::Engine::emitterSyncRoot);
+
+	return GetEmitterStore()->GetCellSize();
+}
+
+void AudioEngine::EmitterCellSize::set(float value)
+{
+	if (value <= 0 || Single::IsNaN(value) == true || Single::IsInfinity(value) == true)
+	{
+		throw gcnew ArgumentOutOfRangeException("value", StringResources::InvalidEmitterCellSize);
+	}
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	Native::ScopedLock lock(Native::Engine::emitterSyncRoot);
+
+	GetEmitterStore()->SetCellSize(value);
+}
+
+//event Disposing;
+
+AudioCategory^ AudioEngine::GetCategory(String^ name)
+{
+	return gcnew AudioCategory(this, name);
+}
+
+AudioCategory^ AudioEngine::GetCategory(int index)
+{
+	String^ name = index >= 0 ? engine->GetCategoryName(static_cast<XACTCATEGORY>(index)) : nullptr;
+	if (name == nullptr)
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidCategory);
+	}
+	return gcnew AudioCategory(this, name, static_cast<XACTCATEGORY>(index));
+}
+
+float AudioEngine::GetGlobalVariable(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	return engine->GetGlobalVariable(name);
+}
+
+void AudioEngine::SetGlobalVariable(String^ name, float value)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	engine->SetGlobalVariable(name, value);
+}
+
+VariableHandle AudioEngine::GetGlobalVariableHandle(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	return VariableHandle(engine->GetGlobalVariableIndex(name), true);
+}
+
+float AudioEngine::GetGlobalVariable(VariableHandle variable)
+{
+	if (variable.IsGlobal == false)
+	{
+		throw gcnew ArgumentException(StringResources::VariableHandleMismatch, "variable");
+	}
+	return engine->GetGlobalVariable(variable.Index);
+}
+
+void AudioEngine::SetGlobalVariable(VariableHandle variable, float value)
+{
+	if (variable.IsGlobal == false)
+	{
+		throw gcnew ArgumentException(StringResources::VariableHandleMismatch, "variable");
+	}
+	engine->SetGlobalVariable(variable.Index, value);
+}
+
+float AudioEngine::GetGlobalVariable(int index)
+{
+	if (index < 0 || index >= XACTVARIABLEINDEX_INVALID)
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidVariableIndex);
+	}
+	return engine->GetGlobalVariable(static_cast<XACTVARIABLEINDEX>(index));
+}
+
+void AudioEngine::SetGlobalVariable(int index, float value)
+{
+	if (index < 0 || index >= XACTVARIABLEINDEX_INVALID)
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidVariableIndex);
+	}
+	engine->SetGlobalVariable(static_cast<XACTVARIABLEINDEX>(index), value);
+}
+
+void AudioEngine::Update()
+{
+	engine->Update();
+
+	if (loadOperations->Count > 0)
+	{
+		RegisterLoadedBanks();
+	}
+	budget->Update();
+
+	if (storeEmitters != nullptr && GC::CollectionCount(0) != sweptCollectionCount)
+	{
+		Native::ScopedLock lock(Native::Engine::emitterSyncRoot);
+
+		Native::EmitterStore* pStore = GetEmitterStore();
+		Native::ScopedLock storeLock(pStore->GetLock());
+		SweepEmitters(pStore);
+	}
+}
+
+void AudioEngine::SweepEmitters(Native::EmitterStore* pStore)
+{
+	sweptCollectionCount = GC::CollectionCount(0);
+	for (int i = 0; i < storeEmitters->Length; i++)
+	{
+		// Remove ignores slots already given back by a disposed emitter
+		if (storeEmitters[i] != nullptr && storeEmitters[i]->Target == nullptr)
+		{
+			pStore->Remove(i);
+		}
+	}
+}
+
+BankLoadOperation^ AudioEngine::BeginLoadBanks(array<String^>^ waveBankFilenames, array<String^>^ soundBankFilenames)
+{
+	if (waveBankFilenames == nullptr)
+	{
+		throw gcnew ArgumentNullException("waveBankFilenames", StringResources::NullNotAllowed);
+	}
+	if (soundBankFilenames == nullptr)
+	{
+		throw gcnew ArgumentNullException("soundBankFilenames", StringResources::NullNotAllowed);
+	}
+	for each (String^ filename in waveBankFilenames)
+	{
+		if (String::IsNullOrEmpty(filename) == true)
+		{
+			throw gcnew ArgumentNullException("waveBankFilenames", StringResources::NullNotAllowed);
+		}
+	}
+	for each (String^ filename in soundBankFilenames)
+	{
+		if (String::IsNullOrEmpty(filename) == true)
+		{
+			throw gcnew ArgumentNullException("soundBankFilenames", StringResources::NullNotAllowed);
+		}
+	}
+
+	BankLoadOperation^ operation = gcnew BankLoadOperation(this, waveBankFilenames, soundBankFilenames);
+	{
+		msclr::lock lock(loadOperations);
+		loadOperations->Add(operation);
+	}
+	operation->Start();
+	return operation;
+}
+
+BankLoadOperation^ AudioEngine::BeginLoadBanks(BankPack^ pack)
+{
+	if (pack == nullptr)
+	{
+		throw gcnew ArgumentNullException("pack", StringResources::NullNotAllowed);
+	}
+
+	BankLoadOperation^ operation = gcnew BankLoadOperation(this, pack);
+	{
+		msclr::lock lock(loadOperations);
+		loadOperations->Add(operation);
+	}
+	operation->Start();
+	return operation;
+}
+
+void AudioEngine::RegisterLoadedBanks()
+{
+	// Take the ready operations out under the lock, but create the banks
+	// and raise Completed without holding it
+	List<BankLoadOperation^> ready;
+	{
+		msclr::lock lock(loadOperations);
+		for (int i = loadOperations->Count - 1; i >= 0; i--)
+		{
+			if (loadOperations[i]->IsReady == true)
+			{
+				ready.Insert(0, loadOperations[i]);
+				loadOperations->RemoveAt(i);
+			}
+		}
+	}
+
+	for each (BankLoadOperation^ operation in ready)
+	{
+		operation->Register();
+	}
+}
+
+void AudioEngine::StartServiceThread(TimeSpan period)
+{
+	if (period <= TimeSpan::Zero)
+	{
+		throw gcnew ArgumentOutOfRangeException("period", StringResources::InvalidServicePeriod);
+	}
+	// One tick is 100 nanoseconds
+	engine->StartServiceThread(period.Ticks / 10);
+}
+
+void AudioEngine::StopServiceThread()
+{
+	engine->StopServiceThread();
+}
+
+bool AudioEngine::IsServiceThreadRunning::get()
+{
+	return engine->IsServiceThreadRunning();
+}
+
+AudioEngineStatistics^ AudioEngine::GetStatistics()
+{
+	// Dispose frees the counters
+	Native::ScopedLock lock(syncRoot);
+
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	return gcnew AudioEngineStatistics(engine, budget);
+}
+
+Native::EmitterStore* AudioEngine::GetEmitterStore()
+{
+	// Read once, Dispose clears it on another thread
+	Native::Engine^ engine = this->engine;
+	if (engine == nullptr || engine->pEmitterStore == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+	return engine->pEmitterStore;
+}
+
+AudioEmitter^ AudioEngine::CreateEmitter()
+{
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	// GetAudibleEmitters on another thread must not find the slot before
+	// its emitter is recorded, nor the array while it is replaced
+	Native::ScopedLock lock(Native::Engine::emitterSyncRoot);
+	Native::EmitterStore* pStore = GetEmitterStore();
+	Native::ScopedLock storeLock(pStore->GetLock());
+
+	AudioEmitter^ emitter = gcnew AudioEmitter(engine);
+	LONG capacity = pStore->GetCapacity();
+	if (storeEmitters == nullptr || storeEmitters->Length < capacity)
+	{
+		Array::Resize(storeEmitters, capacity);
+	}
+	if (storeEmitters[emitter->Slot] == nullptr)
+	{
+		storeEmitters[emitter->Slot] = gcnew WeakReference(emitter, false);
+	}
+	else
+	{
+		storeEmitters[emitter->Slot]->Target = emitter;
+	}
+	return emitter;
+}
+
+int AudioEngine::GetAudibleEmitters(AudioListener^ listener, float maxDistance, array<AudioEmitter^>^ emitters)
+{
+	if (listener == nullptr)
+	{
+		throw gcnew ArgumentNullException("listener", StringResources::NullNotAllowed);
+	}
+	if (emitters == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+	}
+	if (maxDistance < 0 || Single::IsNaN(maxDistance) == true)
+	{
+		throw gcnew ArgumentOutOfRangeException("maxDistance", StringResources::InvalidAudibleDistance);
+	}
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	Native::ScopedLock lock(Native::Engine::emitterSyncRoot);
+	Native::EmitterStore* pStore = GetEmitterStore();
+	Native::ScopedLock storeLock(pStore->GetLock());
+
+	if (emitters->Length == 0 || storeEmitters == nullptr)
+	{
+		return 0;
+	}
+	if (GC::CollectionCount(0) != sweptCollectionCount)
+	{
+		SweepEmitters(pStore);
+	}
+	if (audibleSlots == nullptr || audibleSlots->Length < emitters->Length)
+	{
+		audibleSlots = gcnew array<int>(emitters->Length);
+		audibleDistances = gcnew array<float>(emitters->Length);
+	}
+
+	// Emitters collected since the sweep still have their slot. They are
+	// removed and the query repeated, so they do not take the places of
+	// audible emitters further away.
+	LONG count;
+	int found;
+	int removed;
+	do
+	{
+		{
+			pin_ptr<int> pSlots = &audibleSlots[0];
+			pin_ptr<float> pDistances = &audibleDistances[0];
+			count = pStore->QueryAudible(listener->listenerData->Position, maxDistance,
+				emitters->Length, pSlots, pDistances);
+		}
+
+		found = 0;
+		removed = 0;
+		for (int i = 0; i < count; i++)
+		{
+			AudioEmitter^ emitter = static_cast<AudioEmitter^>(storeEmitters[audibleSlots[i]]->Target);
+			if (emitter != nullptr)
+			{
+				emitters[found++] = emitter;
+			}
+			else
+			{
+				pStore->Remove(audibleSlots[i]);
+				removed++;
+			}
+		}
+	}
+	while (removed > 0 && count == emitters->Length);
+	return found;
+}
+
+void AudioEngine::Apply3D(array<Cue^>^ cues, AudioListener^ listener, array<AudioEmitter^>^ emitters, int count)
+{
+	if (listener == nullptr)
+	{
+		throw gcnew ArgumentNullException("listener", StringResources::NullNotAllowed);
+	}
+	Apply3D(cues, nullptr, listener, emitters, count);
+}
+
+void AudioEngine::Apply3D(array<Cue^>^ cues, array<AudioListener^>^ listeners, array<AudioEmitter^>^ emitters, int count)
+{
+	if (listeners == nullptr)
+	{
+		throw gcnew ArgumentNullException("listeners", StringResources::NullNotAllowed);
+	}
+	if (count > listeners->Length)
+	{
+		throw gcnew ArgumentOutOfRangeException("count", StringResources::InvalidApply3DCount);
+	}
+	Apply3D(cues, listeners, nullptr, emitters, count);
+}
+
+void AudioEngine::Apply3D(array<Cue^>^ cues, array<AudioListener^>^ listeners, AudioListener^ listener,
+	array<AudioEmitter^>^ emitters, int count)
+{
+	if (cues == nullptr)
+	{
+		throw gcnew ArgumentNullException("cues", StringResources::NullNotAllowed);
+	}
+	if (emitters == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+	}
+	if (count < 0 || count > cues->Length || count > emitters->Length)
+	{
+		throw gcnew ArgumentOutOfRangeException("count", StringResources::InvalidApply3DCount);
+	}
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	// Check everything first, so a bad entry leaves all cues as they are
+	for (int i = 0; i < count; i++)
+	{
+		if (cues[i] == nullptr)
+		{
+			throw gcnew ArgumentNullException("cues", StringResources::NullNotAllowed);
+		}
+		if (emitters[i] == nullptr)
+		{
+			throw gcnew ArgumentNullException("emitters", StringResources::NullNotAllowed);
+		}
+		if (listeners != nullptr && listeners[i] == nullptr)
+		{
+			throw gcnew ArgumentNullException("listeners", StringResources::NullNotAllowed);
+		}
+		if (cues[i]->IsDisposed == true)
+		{
+			throw gcnew ObjectDisposedException(cues[i]->GetType()->Name);
+		}
+		emitters[i]->CheckDisposed();
+		cues[i]->Check3D();
+	}
+
+	Native::ScopedLock lock(engine->pSpatializerLock);
+
+	// Cues whose listener and emitter did not change are left out, see
+	// Cue::Apply3D
+	Native::Spatializer* pSpatializer = engine->GetSpatializer();
+	pSpatializer->Reset(count);
+	int entryCount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		AudioListener^ entryListener = listeners != nullptr ? listeners[i] : listener;
+		if (cues[i]->Is3DCurrent(entryListener, emitters[i]) == false)
+		{
+			X3DAUDIO_EMITTER emitterData;
+			FLOAT32 channelAzimuths[AudioEmitter::MaxChannelCount];
+			emitters[i]->GetEmitter(&emitterData, channelAzimuths);
+			IXACT3Cue* pCue = cues[i]->Begin3D(entryListener, emitters[i]);
+			pSpatializer->Set(entryCount++, pCue, entryListener->listenerData, emitterData);
+		}
+	}
+	pSpatializer->Truncate(entryCount);
+	::InterlockedExchangeAdd(&engine->pStatistics->apply3DSkips, count - entryCount);
+
+	engine->Apply3DBatch(apply3DThreadCount);
+
+	// Entries are in the order of the cues set
+	int entry = 0;
+	for (int i = 0; i < count && entry < entryCount; i++)
+	{
+		if (pSpatializer->GetCue(entry) != static_cast<IXACT3Cue*>(cues[i]->nativeObject->pObject))
+		{
+			continue;
+		}
+		HRESULT hr = pSpatializer->GetResult(entry++);
+		if (FAILED(hr) && hr != E_PENDING)
+		{
+			cues[i]->Fail3D();
+		}
+	}
+}
+
+int AudioEngine::GetCueStates(array<Cue^>^ cues, array<CueState>^ states)
+{
+	if (cues == nullptr)
+	{
+		throw gcnew ArgumentNullException("cues", StringResources::NullNotAllowed);
+	}
+	if (states == nullptr)
+	{
+		throw gcnew ArgumentNullException("states", StringResources::NullNotAllowed);
+	}
+	if (cues->Length != states->Length)
+	{
+		throw gcnew ArgumentException(StringResources::CueStateArrayLengthMismatch, "states");
+	}
+
+	Native::ScopedLock lock(syncRoot);
+
+	if (isDisposed == true)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	Native::ScopedLock engineLock(Native::Engine::syncRoot);
+
+	// The table holds the cues of this engine only, each slot has the
+	// handle of its managed cue
+	Native::CueStateTable* pCueStates = engine->pCueStates;
+	int count = 0;
+	for (LONG slot = 0; slot < pCueStates->GetSlotCount(); slot++)
+	{
+		if (pCueStates->GetCue(slot) == NULL)
+		{
+			continue;
+		}
+
+		Cue^ cue = static_cast<Cue^>(instances->Get(pCueStates->GetInstance(slot)));
+		if (cue == nullptr)
+		{
+			continue;
+		}
+
+		if (count < cues->Length)
+		{
+			cues[count] = cue;
+			states[count] = static_cast<CueState>(pCueStates->GetState(slot));
+		}
+		count++;
+	}
+	return count;
+}
+
+void AudioEngine::AddAudioInstance(AudioObject^ instance)
+{
+	Native::ScopedLock lock(syncRoot);
+
+	instance->instanceHandle = instances->Add(instance);
+}
+
+void AudioEngine::RemoveAudioInstance(AudioObject^ instance)
+{
+	Native::ScopedLock lock(syncRoot);
+
+	instances->Remove(instance->instanceHandle);
+	instance->instanceHandle = AudioInstanceTable::InvalidHandle;
+}
+
+void AudioEngine::NotifyCueDestroyed(long long instance)
+{
+	Native::ScopedLock lock(syncRoot);
+
+	// Stale notifications were dropped by the engine, see
+	// Native::CueStateTable::Destroyed
+	Cue^ cue = static_cast<Cue^>(instances->Get(instance));
+	if (cue != nullptr)
+	{
+		// XACT has destroyed the cue already
+		cue->nativeObject->pObject = NULL;
+		delete cue;
+	}
+}
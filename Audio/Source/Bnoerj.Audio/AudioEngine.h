@@ -1,76 +1,226 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-#include "NativeEngine.h"
-
-using namespace System;
-using namespace System::Collections::Generic;
-using namespace System::Collections::ObjectModel;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class AudioEngine
-	{
-		static Dictionary<IntPtr, WeakReference^>^ audioInstances;
-		static bool hookedCueDestroy;
-
-		bool isDisposed;
-
-	internal:
-		static Object^ syncRoot;
-
-		Native::Engine^ engine;
-		IXACT3Engine* pEngine;
-
-	private:
-		static AudioEngine()
-		{
-			syncRoot = gcnew Object();
-			audioInstances = gcnew Dictionary<IntPtr, WeakReference^>();
-			hookedCueDestroy = false;
-		}
-
-	public:
-		AudioEngine(String^ settingsFile);
-		AudioEngine(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId);
-
-		~AudioEngine();
-
-		property bool IsDisposed
-		{
-			bool get();
-		}
-
-		property ReadOnlyCollection<RendererDetail^>^ RendererDetails
-		{
-			ReadOnlyCollection<RendererDetail^>^ get();
-		}
-
-		event EventHandler^ Disposing;
-
-		AudioCategory^ GetCategory(String^ name);
-
-		float GetGlobalVariable(String^ name);
-		void SetGlobalVariable(String^ name, float value);
-
-		void Update();
-
-	protected:
-		!AudioEngine();
-
-		void Initialize(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId);
-
-	internal:
-		static void AddAudioInstance(void* ptr, Object^ instance);
-		static void RemoveAudioInstance(void* ptr);
-
-		static void NotifyCueDestroyed(IntPtr ptrCue);
-		static void NotifyEngineDestroyed(AudioEngine^ engine);
-	};
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeEngine.h"
+#include "CueState.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Collections::ObjectModel;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class AudioEmitter;
+	ref class AudioEngineStatistics;
+	ref class AudioInstanceTable;
+	ref class AudioListener;
+	ref class AudioObject;
+	ref class BankBudget;
+	ref class BankLoadOperation;
+	ref class BankPack;
+	ref class Cue;
+	value struct VariableHandle;
+
+	public ref class AudioEngine
+	{
+		bool isDisposed;
+
+		// Bank loads started with BeginLoadBanks, also used as the lock
+		// for itself
+		List<BankLoadOperation^>^ loadOperations;
+
+		void RegisterLoadedBanks();
+		// Frees the store slots of emitters collected without being
+		// disposed. The caller holds Engine::emitterSyncRoot and the lock
+		// of the store.
+		void SweepEmitters(Native::EmitterStore* pStore);
+		// Throws once the engine is disposed. The caller holds
+		// Engine::emitterSyncRoot while it uses the store.
+		Native::EmitterStore* GetEmitterStore();
+
+	internal:
+		// Guards the engines and their audio objects, their disposal and
+		// the bank budget. Native, so the per-call paths taking it do not
+		// allocate as msclr::lock does.
+		static Native::CriticalSection* syncRoot;
+
+		Native::Engine^ engine;
+		IXACT3Engine* pEngine;
+		BankBudget^ budget;
+		// The cues and banks of this engine, disposed with it
+		AudioInstanceTable^ instances;
+		int apply3DThreadCount;
+		// The emitters of CreateEmitter by their slot in the engine's
+		// EmitterStore, weak so emitters not disposed are still collected.
+		// SweepEmitters frees the slots of collected ones. Slots keep their
+		// WeakReference, as in AudioInstanceTable. Guarded by the lock of
+		// the store, like audibleSlots and audibleDistances.
+		array<WeakReference^>^ storeEmitters;
+		// GC::CollectionCount(0) as of the last sweep, emitters are only
+		// collected by a collection
+		int sweptCollectionCount;
+		// Results of the EmitterStore query of GetAudibleEmitters
+		array<int>^ audibleSlots;
+		array<float>^ audibleDistances;
+
+	private:
+		static AudioEngine()
+		{
+			syncRoot = new Native::CriticalSection();
+		}
+
+	public:
+		AudioEngine(String^ settingsFile);
+		AudioEngine(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId);
+		// Reads the global settings from the file of that name in the pack
+		AudioEngine(BankPack^ pack, String^ settingsName);
+		AudioEngine(BankPack^ pack, String^ settingsName, TimeSpan lookAheadTime, Guid rendererId);
+
+		~AudioEngine();
+
+		property bool IsDisposed
+		{
+			bool get();
+		}
+
+		property ReadOnlyCollection<RendererDetail^>^ RendererDetails
+		{
+			ReadOnlyCollection<RendererDetail^>^ get();
+		}
+
+		// When true, cue and category calls and Apply3D do not take the engine
+		// lock but are queued and executed at the start of the next Update.
+		property bool DeferCommands
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		// Bytes of in-memory sound bank and wave bank data to keep loaded,
+		// 0 for no limit. Above it, banks not in use are unloaded, least
+		// recently used first, and loaded again from their file the next
+		// time a cue of them is asked for. Banks created from a pack are
+		// unloaded only while the pack is open, streaming wave banks never.
+		property long long MemoryBudget
+		{
+			long long get();
+			void set(long long value);
+		}
+
+		// Threads, including the calling one, that Apply3D of many cues
+		// splits the calculation across. 1, the default, uses the calling
+		// thread only, more take thread pool threads for large batches.
+		property int Apply3DThreadCount
+		{
+			int get();
+			void set(int value);
+		}
+
+		// Edge length of the grid cells GetAudibleEmitters looks up the
+		// emitters of CreateEmitter in, 100 by default. Best close to the
+		// typical AudioEmitter::AudibleRadius; much smaller cells make the
+		// query look at many empty cells, much larger ones at many
+		// emitters out of range. Setting it rebuilds the grid.
+		property float EmitterCellSize
+		{
+			float get();
+			void set(float value);
+		}
+
+		event EventHandler^ Disposing;
+
+		AudioCategory^ GetCategory(String^ name);
+
+		float GetGlobalVariable(String^ name);
+		void SetGlobalVariable(String^ name, float value);
+
+		// Take the indices Xidgen generates from the global settings,
+		// without a name lookup
+		AudioCategory^ GetCategory(int index);
+		float GetGlobalVariable(int index);
+		void SetGlobalVariable(int index, float value);
+
+		VariableHandle GetGlobalVariableHandle(String^ name);
+		float GetGlobalVariable(VariableHandle variable);
+		void SetGlobalVariable(VariableHandle variable, float value);
+
+		void Update();
+
+		// Runs XACT's DoWork and the deferred commands on an engine owned
+		// thread every period. Update then only raises cue notifications.
+		void StartServiceThread(TimeSpan period);
+		void StopServiceThread();
+
+		property bool IsServiceThreadRunning
+		{
+			bool get();
+		}
+
+		AudioEngineStatistics^ GetStatistics();
+
+		// An emitter kept in the engine's emitter store, with the fields of
+		// all such emitters in arrays. Its slot is returned by the first
+		// Update or GetAudibleEmitters after it is collected; it cannot be
+		// used after the engine is disposed. Emitters created with the
+		// AudioEmitter constructor work with any engine.
+		AudioEmitter^ CreateEmitter();
+
+		// Fills emitters with up to its length emitters of CreateEmitter the
+		// listener can hear: within their AudibleRadius and within
+		// maxDistance of it. They come ordered by their distance relative
+		// to their audible radius, so with equal radii the closest first,
+		// otherwise roughly the loudest first. Returns the number of
+		// emitters written. Cues of the other emitters need neither be
+		// prepared nor positioned. Only a grid of cells around the listener
+		// is searched, see EmitterCellSize. May be called on any thread,
+		// see AudioEmitter.
+		int GetAudibleEmitters(AudioListener^ listener, float maxDistance, array<AudioEmitter^>^ emitters);
+
+		// Apply3D for the first count cues, each with the emitter at the
+		// same index and one listener or the listener at the same index.
+		// The settings of all cues are calculated in one pass and applied
+		// with one engine lock, cheaper than Cue::Apply3D for every cue.
+		// Nothing is applied if any cue cannot take 3D settings.
+		void Apply3D(array<Cue^>^ cues, AudioListener^ listener, array<AudioEmitter^>^ emitters, int count);
+		void Apply3D(array<Cue^>^ cues, array<AudioListener^>^ listeners, array<AudioEmitter^>^ emitters, int count);
+
+		// Copies the cues of this engine not yet disposed and their state as
+		// of the last Update, see Cue::State, without calling into XACT.
+		// Returns the number of cues, which may be more than the arrays
+		// hold; the rest is left out.
+		int GetCueStates(array<Cue^>^ cues, array<CueState>^ states);
+
+		// Starts loading in-memory wave banks and sound banks in parallel
+		// on the thread pool. Either array may be empty. The banks are
+		// created during Update once all files have been read.
+		BankLoadOperation^ BeginLoadBanks(array<String^>^ waveBankFilenames, array<String^>^ soundBankFilenames);
+		// Loads every in-memory wave bank and sound bank in the pack, in
+		// pack order with large sequential reads. Streaming wave banks are
+		// created with the WaveBank constructor taking a pack.
+		BankLoadOperation^ BeginLoadBanks(BankPack^ pack);
+
+	protected:
+		!AudioEngine();
+
+		void Initialize(String^ settingsFile, TimeSpan lookAheadTime, Guid rendererId);
+		void Initialize(BankPack^ pack, String^ settingsName, TimeSpan lookAheadTime, Guid rendererId);
+		void Create(Native::FileMapping* pSettingsMapping, TimeSpan lookAheadTime, Guid rendererId);
+
+	private:
+		void Apply3D(array<Cue^>^ cues, array<AudioListener^>^ listeners, AudioListener^ listener,
+			array<AudioEmitter^>^ emitters, int count);
+
+	internal:
+		// Sets the handle of the object, see AudioObject::instanceHandle
+		void AddAudioInstance(AudioObject^ instance);
+		void RemoveAudioInstance(AudioObject^ instance);
+
+		void NotifyCueDestroyed(long long instance);
+	};
+}}
@@ -0,0 +1,247 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeEngine.h"
+#include "NativeHelpers.h"
+#include "NativeStreamReader.h"
+#include "BankBudget.h"
+#include "AudioEngineStatistics.h"
+
+using namespace Bnoerj::Audio;
+
+AudioEngineStatistics::AudioEngineStatistics(Native::Engine^ engine, BankBudget^ budget)
+{
+	Native::EngineStatistics* pStatistics = engine->pStatistics;
+	commandsSubmitted = pStatistics->commandsSubmitted;
+	commandsExecuted = pStatistics->commandsExecuted;
+	commandsFailed = pStatistics->commandsFailed;
+	commandQueueOverflows = pStatistics->commandQueueOverflows;
+	pendingCommandCount = engine->GetPendingCommandCount();
+	peakCommandCount = pStatistics->peakCommandCount;
+	pendingNotificationCount = engine->GetPendingNotificationCount();
+	peakNotificationCount = pStatistics->peakNotificationCount;
+	droppedNotificationCount = engine->GetDroppedNotificationCount();
+	serviceIterations = pStatistics->serviceIterations;
+	missedDeadlines = pStatistics->missedDeadlines;
+	if (serviceIterations > 0)
+	{
+		LONGLONG totalJitter = ::InterlockedCompareExchange64(&pStatistics->totalJitterMicroseconds, 0, 0);
+		averageJitter = TimeSpan::FromTicks(totalJitter * 10 / serviceIterations);
+	}
+	maxJitter = TimeSpan::FromTicks(pStatistics->maxJitterMicroseconds * 10LL);
+	marshalHeapAllocations = Bnoerj::Native::Helpers::allocationCounters.marshalHeapAllocations;
+	cacheAllocations = Bnoerj::Native::Helpers::allocationCounters.cacheAllocations;
+
+	Native::StreamStatistics streamStatistics;
+	Native::StreamReader::GetStatistics(streamStatistics);
+	streamRequests = streamStatistics.requests;
+	streamPrefetchHits = streamStatistics.prefetchHits;
+	streamReads = streamStatistics.reads;
+	streamDeadlineMisses = streamStatistics.deadlineMisses;
+	if (streamStatistics.requests > 0)
+	{
+		averageStreamLatency = TimeSpan::FromTicks(
+			streamStatistics.totalLatencyMicroseconds * 10 / static_cast<long long>(streamStatistics.requests));
+	}
+	maxStreamLatency = TimeSpan::FromTicks(streamStatistics.maxLatencyMicroseconds * 10);
+
+	bankMemoryUsage = budget->Usage;
+	peakBankMemoryUsage = budget->PeakUsage;
+	bankEvictions = budget->Evictions;
+	bankReloads = budget->Reloads;
+
+	Native::MappingCacheStatistics cacheStatistics;
+	Native::MappingCache::GetStatistics(cacheStatistics);
+	bankCacheHits = static_cast<long long>(cacheStatistics.hits);
+	bankCacheMisses = static_cast<long long>(cacheStatistics.misses);
+	sharedBankBytes = static_cast<long long>(cacheStatistics.viewBytes);
+
+	cuePoolHits = pStatistics->cuePoolHits;
+	cuePoolMisses = pStatistics->cuePoolMisses;
+	cuePoolRecycles = pStatistics->cuePoolRecycles;
+	apply3DBatches = pStatistics->apply3DBatches;
+	apply3DBatchCues = pStatistics->apply3DBatchCues;
+	apply3DCalculations = pStatistics->apply3DCalculations;
+	apply3DSkips = pStatistics->apply3DSkips;
+}
+
+int AudioEngineStatistics::CommandsSubmitted::get()
+{
+	return commandsSubmitted;
+}
+
+int AudioEngineStatistics::CommandsExecuted::get()
+{
+	return commandsExecuted;
+}
+
+int AudioEngineStatistics::CommandsFailed::get()
+{
+	return commandsFailed;
+}
+
+int AudioEngineStatistics::CommandQueueOverflows::get()
+{
+	return commandQueueOverflows;
+}
+
+int AudioEngineStatistics::PendingCommandCount::get()
+{
+	return pendingCommandCount;
+}
+
+int AudioEngineStatistics::PeakCommandCount::get()
+{
+	return peakCommandCount;
+}
+
+int AudioEngineStatistics::PendingNotificationCount::get()
+{
+	return pendingNotificationCount;
+}
+
+int AudioEngineStatistics::PeakNotificationCount::get()
+{
+	return peakNotificationCount;
+}
+
+int AudioEngineStatistics::DroppedNotificationCount::get()
+{
+	return droppedNotificationCount;
+}
+
+int AudioEngineStatistics::ServiceIterations::get()
+{
+	return serviceIterations;
+}
+
+int AudioEngineStatistics::MissedDeadlines::get()
+{
+	return missedDeadlines;
+}
+
+TimeSpan AudioEngineStatistics::AverageJitter::get()
+{
+	return averageJitter;
+}
+
+TimeSpan AudioEngineStatistics::MaxJitter::get()
+{
+	return maxJitter;
+}
+
+int AudioEngineStatistics::MarshalHeapAllocations::get()
+{
+	return marshalHeapAllocations;
+}
+
+int AudioEngineStatistics::CacheAllocations::get()
+{
+	return cacheAllocations;
+}
+
+long long AudioEngineStatistics::StreamRequests::get()
+{
+	return streamRequests;
+}
+
+long long AudioEngineStatistics::StreamPrefetchHits::get()
+{
+	return streamPrefetchHits;
+}
+
+long long AudioEngineStatistics::StreamReads::get()
+{
+	return streamReads;
+}
+
+long long AudioEngineStatistics::StreamDeadlineMisses::get()
+{
+	return streamDeadlineMisses;
+}
+
+TimeSpan AudioEngineStatistics::AverageStreamLatency::get()
+{
+	return averageStreamLatency;
+}
+
+TimeSpan AudioEngineStatistics::MaxStreamLatency::get()
+{
+	return maxStreamLatency;
+}
+
+long long AudioEngineStatistics::BankMemoryUsage::get()
+{
+	return bankMemoryUsage;
+}
+
+long long AudioEngineStatistics::PeakBankMemoryUsage::get()
+{
+	return peakBankMemoryUsage;
+}
+
+int AudioEngineStatistics::BankEvictions::get()
+{
+	return bankEvictions;
+}
+
+int AudioEngineStatistics::BankReloads::get()
+{
+	return bankReloads;
+}
+
+long long AudioEngineStatistics::BankCacheHits::get()
+{
+	return bankCacheHits;
+}
+
+long long AudioEngineStatistics::BankCacheMisses::get()
+{
+	return bankCacheMisses;
+}
+
+long long AudioEngineStatistics::SharedBankBytes::get()
+{
+	return sharedBankBytes;
+}
+
+int AudioEngineStatistics::CuePoolHits::get()
+{
+	return cuePoolHits;
+}
+
+int AudioEngineStatistics::CuePoolMisses::get()
+{
+	return cuePoolMisses;
+}
+
+int AudioEngineStatistics::CuePoolRecycles::get()
+{
+	return cuePoolRecycles;
+}
+
+int AudioEngineStatistics::Apply3DBatches::get()
+{
+	return apply3DBatches;
+}
+
+int AudioEngineStatistics::Apply3DBatchCues::get()
+{
+	return apply3DBatchCues;
+}
+
+int AudioEngineStatistics::Apply3DCalculations::get()
+{
+	return apply3DCalculations;
+}
+
+int AudioEngineStatistics::Apply3DSkips::get()
+{
+	return apply3DSkips;
+}
@@ -0,0 +1,131 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class BankBudget;
+
+	// Snapshot of the counters kept by an AudioEngine.
+	public ref class AudioEngineStatistics
+	{
+		int commandsSubmitted;
+		int commandsExecuted;
+		int commandsFailed;
+		int commandQueueOverflows;
+		int pendingCommandCount;
+		int peakCommandCount;
+		int pendingNotificationCount;
+		int peakNotificationCount;
+		int droppedNotificationCount;
+		int serviceIterations;
+		int missedDeadlines;
+		TimeSpan averageJitter;
+		TimeSpan maxJitter;
+		int marshalHeapAllocations;
+		int cacheAllocations;
+		long long streamRequests;
+		long long streamPrefetchHits;
+		long long streamReads;
+		long long streamDeadlineMisses;
+		TimeSpan averageStreamLatency;
+		TimeSpan maxStreamLatency;
+		long long bankMemoryUsage;
+		long long peakBankMemoryUsage;
+		int bankEvictions;
+		int bankReloads;
+		long long bankCacheHits;
+		long long bankCacheMisses;
+		long long sharedBankBytes;
+		int cuePoolHits;
+		int cuePoolMisses;
+		int cuePoolRecycles;
+		int apply3DBatches;
+		int apply3DBatchCues;
+		int apply3DCalculations;
+		int apply3DSkips;
+
+	internal:
+		AudioEngineStatistics(Native::Engine^ engine, BankBudget^ budget);
+
+	public:
+		// Deferred calls queued since the engine was created
+		property int CommandsSubmitted { int get(); }
+		// Deferred calls executed since the engine was created
+		property int CommandsExecuted { int get(); }
+		// Deferred calls that returned an error when executed
+		property int CommandsFailed { int get(); }
+		// Calls that found the command queue full, flushed it and queued
+		// their command again
+		property int CommandQueueOverflows { int get(); }
+		// Calls waiting in the command queue
+		property int PendingCommandCount { int get(); }
+		// Most calls found in the command queue by a single Update
+		property int PeakCommandCount { int get(); }
+		// Cue notifications waiting to be delivered by Update
+		property int PendingNotificationCount { int get(); }
+		// Most cue notifications found in the queue by a single Update
+		property int PeakNotificationCount { int get(); }
+		// Cue notifications lost because the queue was full
+		property int DroppedNotificationCount { int get(); }
+		// Service thread iterations since StartServiceThread
+		property int ServiceIterations { int get(); }
+		// Service thread iterations that started more than a period late
+		property int MissedDeadlines { int get(); }
+		// Mean and largest delay between a service deadline and the wake up
+		property TimeSpan AverageJitter { TimeSpan get(); }
+		property TimeSpan MaxJitter { TimeSpan get(); }
+		// Name conversions too long for the stack buffer, for all engines
+		property int MarshalHeapAllocations { int get(); }
+		// Entries added to the name lookup caches, for all engines
+		property int CacheAllocations { int get(); }
+		// Streaming wave bank reads asked for by XACT, for all engines
+		property long long StreamRequests { long long get(); }
+		// Stream requests served from data read ahead, for all engines
+		property long long StreamPrefetchHits { long long get(); }
+		// Disk reads made for stream requests, for all engines
+		property long long StreamReads { long long get(); }
+		// Stream requests completed later than the estimated time the
+		// stream had data left for, for all engines
+		property long long StreamDeadlineMisses { long long get(); }
+		// Mean and largest time from a stream request to its completion
+		property TimeSpan AverageStreamLatency { TimeSpan get(); }
+		property TimeSpan MaxStreamLatency { TimeSpan get(); }
+		// Bytes of in-memory bank data loaded, see AudioEngine::MemoryBudget
+		property long long BankMemoryUsage { long long get(); }
+		// Most bytes of bank data loaded at once since the engine was created
+		property long long PeakBankMemoryUsage { long long get(); }
+		// Banks unloaded to stay within the memory budget
+		property int BankEvictions { int get(); }
+		// Unloaded banks loaded again on demand
+		property int BankReloads { int get(); }
+		// In-memory wave bank loads that shared the data of a bank already
+		// loaded from the same file, and loads that mapped it, for all
+		// engines
+		property long long BankCacheHits { long long get(); }
+		property long long BankCacheMisses { long long get(); }
+		// Bytes of wave bank data currently shared, for all engines
+		property long long SharedBankBytes { long long get(); }
+		// 3D PlayCue calls that took a prepared cue from a cue pool, and
+		// calls that found the pool empty and prepared one
+		property int CuePoolHits { int get(); }
+		property int CuePoolMisses { int get(); }
+		// Pooled cues destroyed after they stopped to be prepared again
+		property int CuePoolRecycles { int get(); }
+		// AudioEngine::Apply3D batches and the cues positioned by them
+		property int Apply3DBatches { int get(); }
+		property int Apply3DBatchCues { int get(); }
+		// Cues whose 3D settings were calculated, and Apply3D calls that
+		// left a cue as it was because its listener and emitter had not
+		// changed, see AudioEmitter::PositionEpsilon
+		property int Apply3DCalculations { int get(); }
+		property int Apply3DSkips { int get(); }
+	};
+}}
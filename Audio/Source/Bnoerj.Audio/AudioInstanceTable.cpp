@@ -0,0 +1,126 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "AudioObject.h"
+#include "AudioInstanceTable.h"
+
+using namespace Bnoerj::Audio;
+
+AudioInstanceTable::AudioInstanceTable()
+	: count(0)
+	, firstFree(-1)
+	, usedCount(0)
+{
+	references = gcnew array<WeakReference^>(InitialCapacity);
+	generations = gcnew array<long long>(InitialCapacity);
+	nextFree = gcnew array<int>(InitialCapacity);
+}
+
+int AudioInstanceTable::Count::get()
+{
+	return usedCount;
+}
+
+void AudioInstanceTable::Grow()
+{
+	int capacity = references->Length * 2;
+	if (capacity > IndexMask + 1)
+	{
+		throw gcnew InvalidOperationException(StringResources::CouldNotCreateResource);
+	}
+	Array::Resize(references, capacity);
+	Array::Resize(generations, capacity);
+	Array::Resize(nextFree, capacity);
+}
+
+long long AudioInstanceTable::Add(AudioObject^ instance)
+{
+	int index = firstFree;
+	if (index >= 0)
+	{
+		firstFree = nextFree[index];
+		references[index]->Target = instance;
+	}
+	else
+	{
+		if (count == references->Length)
+		{
+			Grow();
+		}
+		index = count++;
+		references[index] = gcnew WeakReference(instance, false);
+	}
+
+	nextFree[index] = -1;
+	usedCount++;
+	return (generations[index] << IndexBits) | index;
+}
+
+void AudioInstanceTable::Remove(long long handle)
+{
+	if (handle == InvalidHandle)
+	{
+		return;
+	}
+
+	// Removing bumps the generation, handles to free slots are stale
+	int index = static_cast<int>(handle & IndexMask);
+	if (index >= count || (handle >> IndexBits) != generations[index])
+	{
+		return;
+	}
+
+	references[index]->Target = nullptr;
+	generations[index] = (generations[index] + 1) & GenerationMask;
+	nextFree[index] = firstFree;
+	firstFree = index;
+	usedCount--;
+}
+
+AudioObject^ AudioInstanceTable::Get(long long handle)
+{
+	if (handle == InvalidHandle)
+	{
+		return nullptr;
+	}
+
+	int index = static_cast<int>(handle & IndexMask);
+	if (index >= count || (handle >> IndexBits) != generations[index])
+	{
+		return nullptr;
+	}
+
+	try
+	{
+		return static_cast<AudioObject^>(references[index]->Target);
+	}
+	catch(InvalidOperationException^)
+	{
+		return nullptr;
+	}
+}
+
+void AudioInstanceTable::DisposeAll()
+{
+	// Disposing removes the object, which only touches its own slot
+	for (int i = 0; i < count; i++)
+	{
+		AudioObject^ instance = Get((generations[i] << IndexBits) | i);
+		if (instance != nullptr)
+		{
+			delete instance;
+		}
+	}
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class AudioObject;
+
+	// The cues and banks of an engine by handle. A handle is a slot index
+	// and the generation of the slot, so it stays invalid once its object
+	// is removed, also after the slot is reused. Generations have 43 bits,
+	// a slot reused a million times a second wraps after 100 days. Slots keep their
+	// WeakReference and only change its target, once the table has grown
+	// adding and removing objects allocates nothing.
+	//
+	// Guarded by AudioEngine::syncRoot.
+	ref class AudioInstanceTable
+	{
+		literal int IndexBits = 20;
+		literal int IndexMask = (1 << IndexBits) - 1;
+		// Keeps handles positive
+		literal long long GenerationMask = (1LL << (63 - IndexBits)) - 1;
+		literal int InitialCapacity = 64;
+
+		array<WeakReference^>^ references;
+		array<long long>^ generations;
+		// Next free slot while not used, -1 for none
+		array<int>^ nextFree;
+		// Slots handed out at least once
+		int count;
+		int firstFree;
+		int usedCount;
+
+		void Grow();
+
+	internal:
+		literal long long InvalidHandle = -1;
+
+		AudioInstanceTable();
+
+		property int Count { int get(); }
+
+		long long Add(AudioObject^ instance);
+		// Ignores stale handles
+		void Remove(long long handle);
+		// Null for stale handles and objects already collected
+		AudioObject^ Get(long long handle);
+		// Disposes every object in the table, the engine is going away
+		void DisposeAll();
+	};
+
+}}
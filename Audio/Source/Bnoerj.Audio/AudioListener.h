@@ -1,50 +1,83 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class AudioListener
-	{
-	internal:
-		X3DAUDIO_LISTENER* listenerData;
-
-		//FIXME: needs to be non-IDisposable
-		~AudioListener();
-		!AudioListener();
-
-	public:
-		AudioListener();
-
-		property XnaVector3 Position
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Forward
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Up
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-
-		property XnaVector3 Velocity
-		{
-			XnaVector3 get();
-			void set(XnaVector3 value);
-		}
-	};
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	public ref class AudioListener
+	{
+		static long long nextGeneration;
+
+		// Values as of the last generation, see PositionEpsilon
+		XnaVector3 trackedPosition;
+		XnaVector3 trackedForward;
+		XnaVector3 trackedUp;
+		float positionEpsilon;
+		float orientationEpsilon;
+
+		void Touch();
+
+	internal:
+		// Taken from a counter shared by all listeners whenever a setter
+		// changes the 3D settings, see Cue::Apply3D. Generations of
+		// different listeners never match.
+		long long generation;
+
+		X3DAUDIO_LISTENER* listenerData;
+
+		//FIXME: needs to be non-IDisposable
+		~AudioListener();
+		!AudioListener();
+
+	public:
+		AudioListener();
+
+		property XnaVector3 Position
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Forward
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Up
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		property XnaVector3 Velocity
+		{
+			XnaVector3 get();
+			void set(XnaVector3 value);
+		}
+
+		// Position and orientation changes smaller than these, summed
+		// since the last change that counted, leave the 3D settings of
+		// the cues positioned with this listener as they are. The
+		// orientation epsilon is about the angle in radians. Zero by
+		// default, only setting the same value again is ignored.
+		property float PositionEpsilon
+		{
+			float get();
+			void set(float value);
+		}
+
+		property float OrientationEpsilon
+		{
+			float get();
+			void set(float value);
+		}
+	};
+}}
@@ -0,0 +1,388 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "BankBudget.h"
+#include "AudioObject.h"
+
+#include "NativeWaveBank.h"
+#include "NativeSoundBank.h"
+
+using namespace System::Threading;
+using namespace Bnoerj::Audio;
+
+BankBudget::BankBudget()
+	: budget(0)
+	, usage(0)
+	, peakUsage(0)
+	, evictions(0)
+	, reloads(0)
+	, unloadedCount(0)
+	, useClock(0)
+	, busyCount(0)
+	, trimPending(false)
+{
+	entries = gcnew Dictionary<Native::Bank^, Entry^>();
+	waveBanks = gcnew Dictionary<String^, Entry^>(StringComparer::Ordinal);
+	candidates = gcnew array<Entry^>(0);
+	candidateUses = gcnew array<Int64>(0);
+	busyBanks = gcnew array<Native::Bank^>(0);
+}
+
+Int64 BankBudget::Budget::get()
+{
+	return budget;
+}
+
+void BankBudget::Budget::set(Int64 value)
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	budget = value;
+	Trim(Interlocked::Increment(useClock));
+}
+
+Int64 BankBudget::Usage::get()
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+	return usage;
+}
+
+Int64 BankBudget::PeakUsage::get()
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+	return peakUsage;
+}
+
+int BankBudget::Evictions::get()
+{
+	return evictions;
+}
+
+int BankBudget::Reloads::get()
+{
+	return reloads;
+}
+
+void BankBudget::Add(AudioObject^ bank)
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	Native::Bank^ nativeBank = static_cast<Native::Bank^>(bank->nativeObject);
+
+	Entry^ entry = gcnew Entry();
+	entry->nativeBank = nativeBank;
+	entry->size = static_cast<Int64>(nativeBank->GetDataSize());
+
+	Native::WaveBank^ waveBank = dynamic_cast<Native::WaveBank^>(nativeBank);
+	entry->isWaveBank = waveBank != nullptr;
+	if (waveBank != nullptr)
+	{
+		entry->name = waveBank->name;
+		if (entry->name != nullptr && entry->size > 0)
+		{
+			waveBanks[entry->name] = entry;
+		}
+	}
+	else
+	{
+		entry->waveBankNames = static_cast<Native::SoundBank^>(nativeBank)->waveBankNames;
+	}
+	entries->Add(nativeBank, entry);
+
+	usage += entry->size;
+	if (usage > peakUsage)
+	{
+		peakUsage = usage;
+	}
+
+	// The new bank is about to be used, unload others first
+	nativeBank->lastUse = Interlocked::Increment(useClock);
+	Trim(nativeBank->lastUse);
+}
+
+void BankBudget::Remove(Native::AudioObject^ nativeObject)
+{
+	Native::Bank^ nativeBank = dynamic_cast<Native::Bank^>(nativeObject);
+	if (nativeBank == nullptr)
+	{
+		return;
+	}
+
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	Entry^ entry;
+	if (entries->TryGetValue(nativeBank, entry) == false)
+	{
+		return;
+	}
+	entries->Remove(nativeBank);
+
+	Entry^ namedEntry;
+	if (entry->name != nullptr && waveBanks->TryGetValue(entry->name, namedEntry) == true && namedEntry == entry)
+	{
+		waveBanks->Remove(entry->name);
+	}
+
+	if (nativeBank->IsLoaded() == true)
+	{
+		usage -= entry->size;
+	}
+	else
+	{
+		unloadedCount--;
+	}
+
+	// The bank may be one of the busy banks, these are found again by the
+	// next Trim
+	Array::Clear(busyBanks, 0, busyCount);
+	busyCount = 0;
+	trimPending = true;
+}
+
+void BankBudget::Use(Native::Bank^ soundBank)
+{
+	// Without the lock, stamps need not be exact for a least recently
+	// used order
+	Int64 stamp = Interlocked::Increment(useClock);
+	soundBank->lastUse = stamp;
+	if (unloadedCount == 0)
+	{
+		return;
+	}
+
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	Entry^ entry;
+	if (entries->TryGetValue(soundBank, entry) == false)
+	{
+		// Released, or the engine is gone
+		return;
+	}
+
+	bool loaded = false;
+	if (soundBank->IsLoaded() == false)
+	{
+		Load(entry);
+		loaded = true;
+	}
+
+	for each (Entry^ waveBankEntry in waveBanks->Values)
+	{
+		// All wave banks if the sound bank file could not be read
+		bool isUsed = entry->waveBankNames == nullptr ||
+			Array::IndexOf(entry->waveBankNames, waveBankEntry->name) >= 0;
+		if (isUsed == true && waveBankEntry->nativeBank->IsLoaded() == false)
+		{
+			Load(waveBankEntry);
+			waveBankEntry->nativeBank->lastUse = stamp;
+			loaded = true;
+		}
+	}
+
+	if (loaded == true)
+	{
+		Trim(stamp);
+	}
+}
+
+void BankBudget::Update()
+{
+	// Read without the lock, a torn value at most defers the Trim
+	if (budget <= 0 || usage <= budget)
+	{
+		return;
+	}
+
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	if (IsTrimDue() == true)
+	{
+		Trim(Interlocked::Increment(useClock));
+	}
+}
+
+void BankBudget::Clear()
+{
+	Native::ScopedLock lock(AudioEngine::syncRoot);
+
+	// The banks, also unloaded ones, are disposed with the engine through
+	// its audio instance table
+	entries->Clear();
+	waveBanks->Clear();
+	usage = 0;
+	unloadedCount = 0;
+	Array::Clear(busyBanks, 0, busyCount);
+	busyCount = 0;
+	trimPending = false;
+}
+
+void BankBudget::Load(Entry^ entry)
+{
+	Native::Bank^ nativeBank = entry->nativeBank;
+	nativeBank->Reload(nativeBank->source->Map());
+
+	unloadedCount--;
+	reloads++;
+	usage += entry->size;
+	if (usage > peakUsage)
+	{
+		peakUsage = usage;
+	}
+}
+
+void BankBudget::Unload(Entry^ entry)
+{
+	Native::Bank^ nativeBank = entry->nativeBank;
+
+	nativeBank->Release();
+
+	unloadedCount++;
+	evictions++;
+	usage -= entry->size;
+}
+
+void BankBudget::UpdateTrimUses()
+{
+	for each (Entry^ entry in entries->Values)
+	{
+		entry->trimUse = entry->nativeBank->lastUse;
+	}
+
+	// A wave bank is used as often as the sound banks playing from it
+	Int64 allUse = 0;
+	for each (Entry^ entry in entries->Values)
+	{
+		if (entry->isWaveBank == true)
+		{
+			continue;
+		}
+
+		Int64 lastUse = entry->nativeBank->lastUse;
+		array<String^>^ waveBankNames = entry->waveBankNames;
+		if (waveBankNames == nullptr)
+		{
+			// All wave banks if the sound bank file could not be read
+			if (lastUse > allUse)
+			{
+				allUse = lastUse;
+			}
+			continue;
+		}
+
+		for (int i = 0; i < waveBankNames->Length; i++)
+		{
+			Entry^ waveBankEntry;
+			if (waveBanks->TryGetValue(waveBankNames[i], waveBankEntry) == true && lastUse > waveBankEntry->trimUse)
+			{
+				waveBankEntry->trimUse = lastUse;
+			}
+		}
+	}
+
+	for each (Entry^ waveBankEntry in waveBanks->Values)
+	{
+		if (allUse > waveBankEntry->trimUse)
+		{
+			waveBankEntry->trimUse = allUse;
+		}
+	}
+}
+
+bool BankBudget::IsTrimDue()
+{
+	if (trimPending == true)
+	{
+		return true;
+	}
+
+	for (int i = 0; i < busyCount; i++)
+	{
+		if (busyBanks[i]->IsInUse() == false)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void BankBudget::Trim(Int64 pinnedUse)
+{
+	Array::Clear(busyBanks, 0, busyCount);
+	busyCount = 0;
+	trimPending = false;
+	if (budget <= 0 || usage <= budget)
+	{
+		return;
+	}
+
+	int entryCount = entries->Count;
+	if (candidates->Length < entryCount)
+	{
+		candidates = gcnew array<Entry^>(entryCount);
+		candidateUses = gcnew array<Int64>(entryCount);
+		busyBanks = gcnew array<Native::Bank^>(entryCount);
+	}
+
+	UpdateTrimUses();
+
+	// Banks that can be loaded again and are not in use, least recently
+	// used first
+	int count = 0;
+	for each (Entry^ entry in entries->Values)
+	{
+		Native::Bank^ nativeBank = entry->nativeBank;
+		if (entry->size == 0 || nativeBank->source == nullptr || nativeBank->IsLoaded() == false ||
+			nativeBank->source->IsAvailable == false)
+		{
+			continue;
+		}
+		// Wave banks without a name cannot be found from their sound banks
+		if (entry->isWaveBank == true && entry->name == nullptr)
+		{
+			continue;
+		}
+
+		if (entry->trimUse >= pinnedUse)
+		{
+			// Free to go with the next Trim from Update
+			trimPending = true;
+			continue;
+		}
+		if (nativeBank->IsInUse() == true)
+		{
+			busyBanks[busyCount++] = nativeBank;
+			continue;
+		}
+
+		candidates[count] = entry;
+		candidateUses[count] = entry->trimUse;
+		count++;
+	}
+
+	Array::Sort<Int64, Entry^>(candidateUses, candidates, 0, count);
+	for (int i = 0; i < count && usage > budget; i++)
+	{
+		Unload(candidates[i]);
+	}
+	// Removed entries are not kept alive
+	Array::Clear(candidates, 0, count);
+
+	if (usage <= budget)
+	{
+		Array::Clear(busyBanks, 0, busyCount);
+		busyCount = 0;
+		trimPending = false;
+	}
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBank.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class AudioObject;
+
+	// Accounts the data of the in-memory banks of an engine. While more
+	// than the budget is loaded, banks not in use are unloaded, least
+	// recently used first. A sound bank and the wave banks it plays from
+	// are loaded again the next time one of its cues is asked for.
+	//
+	// Guarded by AudioEngine::syncRoot, except for the use stamps written
+	// by Use.
+	ref class BankBudget
+	{
+		ref class Entry
+		{
+		internal:
+			Native::Bank^ nativeBank;
+			Int64 size;
+			bool isWaveBank;
+			// Name of a wave bank, null for sound banks
+			String^ name;
+			// Wave banks a sound bank plays from, null for wave banks
+			array<String^>^ waveBankNames;
+			// Last use, for a wave bank also of the sound banks playing from
+			// it, set by Trim
+			Int64 trimUse;
+		};
+
+		Dictionary<Native::Bank^, Entry^>^ entries;
+		// In-memory wave banks by name, to find the wave banks of a sound bank
+		Dictionary<String^, Entry^>^ waveBanks;
+
+		Int64 budget;
+		Int64 usage;
+		Int64 peakUsage;
+		int evictions;
+		int reloads;
+		// Entries unloaded, read without the lock by Use
+		volatile int unloadedCount;
+		Int64 useClock;
+
+		// Reused by Trim, grown with the entries
+		array<Entry^>^ candidates;
+		array<Int64>^ candidateUses;
+		// Banks the last Trim skipped because they were in use, while the
+		// usage stayed above the budget
+		array<Native::Bank^>^ busyBanks;
+		int busyCount;
+		// Set when the last Trim skipped banks used after its pinned stamp,
+		// or lost track of the busy banks
+		bool trimPending;
+
+		void Load(Entry^ entry);
+		void Unload(Entry^ entry);
+		// Sets trimUse of all entries
+		void UpdateTrimUses();
+		// Whether another Trim may unload something, i.e. a busy bank went
+		// idle or a pinned bank was skipped
+		bool IsTrimDue();
+		// Unloads banks used before pinnedUse until the usage fits
+		void Trim(Int64 pinnedUse);
+
+	internal:
+		BankBudget();
+
+		// Bytes of bank data, 0 for no limit
+		property Int64 Budget { Int64 get(); void set(Int64 value); }
+		property Int64 Usage { Int64 get(); }
+		property Int64 PeakUsage { Int64 get(); }
+		property int Evictions { int get(); }
+		property int Reloads { int get(); }
+
+		// Accounts a bank just created, which may unload others
+		void Add(AudioObject^ bank);
+		// Called for every AudioObject released, ignores non-banks
+		void Remove(Native::AudioObject^ nativeObject);
+		// Marks a sound bank used, loading it and its wave banks again if
+		// they were unloaded. Throws if that fails.
+		void Use(Native::Bank^ soundBank);
+		// Unloads idle banks if the usage is above the budget, e.g. once
+		// banks in use at the last Trim went idle
+		void Update();
+		// Forgets all banks, the engine is going away
+		void Clear();
+	};
+
+}}
@@ -0,0 +1,321 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "BankBudget.h"
+#include "AudioListener.h"
+#include "AudioEmitter.h"
+#include "AudioObject.h"
+#include "Cue.h"
+#include "WaveBank.h"
+#include "SoundBank.h"
+#include "BankLoadOperation.h"
+#include "BankPack.h"
+
+#include "NativeEngine.h"
+#include "NativeFileMapping.h"
+#include "NativeSoundBankFile.h"
+#include "NativeWaveBankFile.h"
+
+using namespace System::Collections::Generic;
+using namespace System::IO;
+using namespace Bnoerj::Audio;
+
+// Files are read in slices so progress and cancellation stay responsive
+static const int ReadSliceSize = 256 * 1024;
+static const int PageSize = 4096;
+
+BankLoadOperation::BankLoadOperation(AudioEngine^ engine, array<String^>^ waveBankFilenames, array<String^>^ soundBankFilenames)
+	: engine(engine)
+	, waveBankCount(waveBankFilenames->Length)
+	, totalBytes(0)
+	, bytesLoaded(0)
+	, pendingFiles(0)
+	, cancelRequested(false)
+	, isReady(false)
+	, isCompleted(false)
+{
+	int fileCount = waveBankFilenames->Length + soundBankFilenames->Length;
+	filenames = gcnew array<String^>(fileCount);
+	for (int i = 0; i < fileCount; i++)
+	{
+		String^ filename = i < waveBankCount ? waveBankFilenames[i] : soundBankFilenames[i - waveBankCount];
+
+		// Resolve relative paths now, the working directory may change
+		filenames[i] = Path::GetFullPath(filename);
+		totalBytes += (gcnew FileInfo(filenames[i]))->Length;
+	}
+
+	mappings = gcnew array<IntPtr>(fileCount);
+	completedEvent = gcnew ManualResetEvent(false);
+}
+
+BankLoadOperation::BankLoadOperation(AudioEngine^ engine, BankPack^ pack)
+	: engine(engine)
+	, waveBankCount(0)
+	, pack(pack)
+	, totalBytes(0)
+	, bytesLoaded(0)
+	, pendingFiles(0)
+	, cancelRequested(false)
+	, isReady(false)
+	, isCompleted(false)
+{
+	// Wave banks first, in pack order, which Xpack made the file order
+	const Native::BankPackFile* pTable = pack->Table;
+	List<String^>^ waveBankNames = gcnew List<String^>();
+	List<String^>^ soundBankNames = gcnew List<String^>();
+	for (Native::uint32 i = 0; i < pTable->GetEntryCount(); i++)
+	{
+		const Native::BankPackEntry& entry = pTable->GetEntry(i);
+		if (entry.type == Native::BankPackEntryWaveBank)
+		{
+			waveBankNames->Add(gcnew String(entry.name));
+		}
+		else if (entry.type == Native::BankPackEntrySoundBank)
+		{
+			soundBankNames->Add(gcnew String(entry.name));
+		}
+		else
+		{
+			continue;
+		}
+		totalBytes += static_cast<Int64>(entry.size);
+	}
+
+	waveBankCount = waveBankNames->Count;
+	waveBankNames->AddRange(soundBankNames);
+	filenames = waveBankNames->ToArray();
+
+	mappings = gcnew array<IntPtr>(filenames->Length);
+	completedEvent = gcnew ManualResetEvent(false);
+}
+
+BankLoadOperation::~BankLoadOperation()
+{
+	Cancel();
+	if (isReady == true)
+	{
+		ReleaseMappings();
+	}
+}
+
+BankLoadOperation::!BankLoadOperation()
+{
+	// Not reachable while files are read, no worker uses the mappings
+	ReleaseMappings();
+}
+
+void BankLoadOperation::Start()
+{
+	pendingFiles = filenames->Length;
+	if (pendingFiles == 0)
+	{
+		isReady = true;
+		return;
+	}
+
+	for (int i = 0; i < filenames->Length; i++)
+	{
+		ThreadPool::QueueUserWorkItem(gcnew WaitCallback(this, &BankLoadOperation::LoadFile), i);
+	}
+}
+
+void BankLoadOperation::LoadFile(Object^ state)
+{
+	int index = safe_cast<int>(state);
+	bool isWaveBank = index < waveBankCount;
+
+	try
+	{
+		if (cancelRequested == false && error == nullptr)
+		{
+			// Sound banks are written to by XACT, see Native::SoundBank
+			Native::FileMapping::Access access =
+				isWaveBank == true ? Native::FileMapping::AccessReadOnly : Native::FileMapping::AccessCopyOnWrite;
+			Native::FileMapping* pMapping = pack != nullptr
+				? pack->MapEntry(pack->GetEntry(filenames[index]), access)
+				: Native::Engine::MapFile(filenames[index], access);
+			mappings[index] = IntPtr(pMapping);
+
+			const BYTE* pData = static_cast<const BYTE*>(pMapping->GetData());
+			size_t size = pMapping->GetSize();
+			bool isValid;
+			if (isWaveBank == true)
+			{
+				// Checks the tables fit the file before XACT sees it
+				Native::WaveBankFile waveBankFile;
+				isValid = waveBankFile.Parse(pData, size) == Native::BankParseOk &&
+					waveBankFile.IsStreaming() == false;
+			}
+			else
+			{
+				Native::SoundBankFile soundBankFile;
+				isValid = soundBankFile.Parse(pData, size) == Native::BankParseOk;
+			}
+			if (isValid == false)
+			{
+				throw gcnew InvalidDataException(String::Format(StringResources::InvalidBankFile, filenames[index]));
+			}
+
+			// Touch every page so the file is read here and not when XACT
+			// first accesses it on the engine thread
+			for (size_t offset = 0; offset < size && cancelRequested == false; offset += ReadSliceSize)
+			{
+				size_t end = offset + ReadSliceSize < size ? offset + ReadSliceSize : size;
+				volatile BYTE sum = 0;
+				for (size_t page = offset; page < end; page += PageSize)
+				{
+					sum += pData[page];
+				}
+				Interlocked::Add(bytesLoaded, static_cast<Int64>(end - offset));
+			}
+		}
+	}
+	catch (Exception^ e)
+	{
+		// Keep the first error, the other files stop early
+		Interlocked::CompareExchange<Exception^>(error, e, nullptr);
+	}
+
+	if (Interlocked::Decrement(pendingFiles) == 0)
+	{
+		if (cancelRequested == true)
+		{
+			ReleaseMappings();
+		}
+		isReady = true;
+	}
+}
+
+void BankLoadOperation::ReleaseMappings()
+{
+	for (int i = 0; i < mappings->Length; i++)
+	{
+		IntPtr mapping = Interlocked::Exchange(mappings[i], IntPtr::Zero);
+		delete static_cast<Native::FileMapping*>(mapping.ToPointer());
+	}
+}
+
+bool BankLoadOperation::IsReady::get()
+{
+	return isReady;
+}
+
+void BankLoadOperation::Register()
+{
+	if (cancelRequested == false && error == nullptr)
+	{
+		array<WaveBank^>^ waveBanks = gcnew array<WaveBank^>(waveBankCount);
+		array<SoundBank^>^ soundBanks = gcnew array<SoundBank^>(filenames->Length - waveBankCount);
+		try
+		{
+			// Wave banks first, sound banks resolve their waves on creation.
+			// The banks take ownership of the mappings.
+			for (int i = 0; i < filenames->Length; i++)
+			{
+				Native::FileMapping::Access access =
+					i < waveBankCount ? Native::FileMapping::AccessReadOnly : Native::FileMapping::AccessCopyOnWrite;
+				Native::BankSource^ source = pack != nullptr
+					? pack->CreateSource(filenames[i], access)
+					: gcnew Native::FileBankSource(filenames[i], access);
+
+				IntPtr mapping = Interlocked::Exchange(mappings[i], IntPtr::Zero);
+				Native::FileMapping* pMapping = static_cast<Native::FileMapping*>(mapping.ToPointer());
+				if (i < waveBankCount)
+				{
+					waveBanks[i] = gcnew WaveBank(engine, pMapping, source);
+				}
+				else
+				{
+					soundBanks[i - waveBankCount] = gcnew SoundBank(engine, pMapping, source);
+				}
+			}
+
+			this->waveBanks = waveBanks;
+			this->soundBanks = soundBanks;
+		}
+		catch (Exception^ e)
+		{
+			// All or nothing, dispose the banks created so far
+			error = e;
+			for each (SoundBank^ soundBank in soundBanks)
+			{
+				delete soundBank;
+			}
+			for each (WaveBank^ waveBank in waveBanks)
+			{
+				delete waveBank;
+			}
+		}
+	}
+
+	ReleaseMappings();
+	Complete();
+}
+
+void BankLoadOperation::Complete()
+{
+	isCompleted = true;
+	completedEvent->Set();
+	Completed(this, EventArgs::Empty);
+}
+
+Int64 BankLoadOperation::TotalBytes::get()
+{
+	return totalBytes;
+}
+
+Int64 BankLoadOperation::BytesLoaded::get()
+{
+	return Interlocked::Read(bytesLoaded);
+}
+
+bool BankLoadOperation::IsCompleted::get()
+{
+	return isCompleted;
+}
+
+bool BankLoadOperation::IsCanceled::get()
+{
+	return isCompleted == true && cancelRequested == true && waveBanks == nullptr;
+}
+
+Exception^ BankLoadOperation::Error::get()
+{
+	return error;
+}
+
+WaitHandle^ BankLoadOperation::AsyncWaitHandle::get()
+{
+	return completedEvent;
+}
+
+array<WaveBank^>^ BankLoadOperation::WaveBanks::get()
+{
+	return waveBanks;
+}
+
+array<SoundBank^>^ BankLoadOperation::SoundBanks::get()
+{
+	return soundBanks;
+}
+
+void BankLoadOperation::Cancel()
+{
+	if (isCompleted == false)
+	{
+		cancelRequested = true;
+	}
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+using namespace System::Threading;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class WaveBank;
+	ref class SoundBank;
+	ref class BankPack;
+
+	// Wave and sound banks loading in the background, see
+	// AudioEngine::BeginLoadBanks. The files are mapped, checked and read
+	// in parallel on the thread pool. Once all of them are read, the next
+	// AudioEngine::Update creates the banks with XACT and completes the
+	// operation on the thread calling Update.
+	public ref class BankLoadOperation
+	{
+		AudioEngine^ engine;
+		// In-memory wave bank files first, sound bank files after them.
+		// Names of the packed files when loading from a pack.
+		array<String^>^ filenames;
+		int waveBankCount;
+		array<IntPtr>^ mappings;
+		BankPack^ pack;
+
+		array<WaveBank^>^ waveBanks;
+		array<SoundBank^>^ soundBanks;
+
+		Int64 totalBytes;
+		Int64 bytesLoaded;
+		int pendingFiles;
+		volatile bool cancelRequested;
+		volatile bool isReady;
+		volatile bool isCompleted;
+		Exception^ error;
+		ManualResetEvent^ completedEvent;
+
+		void LoadFile(Object^ state);
+		void ReleaseMappings();
+		void Complete();
+
+	internal:
+		BankLoadOperation(AudioEngine^ engine, array<String^>^ waveBankFilenames, array<String^>^ soundBankFilenames);
+		// Every in-memory wave bank and sound bank in the pack
+		BankLoadOperation(AudioEngine^ engine, BankPack^ pack);
+
+		void Start();
+
+		// True once every file has been read, or loading stopped early
+		property bool IsReady { bool get(); }
+
+		// Creates the banks, must be called from AudioEngine::Update
+		void Register();
+
+	public:
+		~BankLoadOperation();
+		!BankLoadOperation();
+
+		property Int64 TotalBytes { Int64 get(); }
+		property Int64 BytesLoaded { Int64 get(); }
+
+		property bool IsCompleted { bool get(); }
+		// True if the operation completed because Cancel was called
+		property bool IsCanceled { bool get(); }
+		// The first error loading or creating a bank, null on success
+		property Exception^ Error { Exception^ get(); }
+
+		// Signaled when the operation completes
+		property WaitHandle^ AsyncWaitHandle { WaitHandle^ get(); }
+
+		// The banks in the order their files were passed, null until the
+		// operation completed successfully
+		property array<WaveBank^>^ WaveBanks { array<WaveBank^>^ get(); }
+		property array<SoundBank^>^ SoundBanks { array<SoundBank^>^ get(); }
+
+		// Stops reading files, no bank is created. The operation completes
+		// in the next AudioEngine::Update.
+		void Cancel();
+
+		// Raised from AudioEngine::Update when the operation completes
+		event EventHandler^ Completed;
+	};
+}}
@@ -0,0 +1,206 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "BankPack.h"
+
+#include "NativeHelpers.h"
+#include "ErrorToException.h"
+
+using namespace System::Collections::Generic;
+using namespace System::IO;
+using namespace Bnoerj::Audio;
+using namespace Bnoerj::Native::Helpers;
+
+namespace Bnoerj { namespace Audio {
+
+	ref class PackBankSource : public Native::BankSource
+	{
+		BankPack^ pack;
+		String^ name;
+		Native::FileMapping::Access access;
+
+	public:
+		PackBankSource(BankPack^ pack, String^ name, Native::FileMapping::Access access)
+			: pack(pack)
+			, name(name)
+			, access(access)
+		{}
+
+		virtual property bool IsAvailable
+		{
+			bool get() override { return pack->IsDisposed == false; }
+		}
+
+		virtual Native::FileMapping* Map() override
+		{
+			return pack->MapEntry(pack->GetEntry(name), access);
+		}
+	};
+
+}}
+
+BankPack::BankPack(String^ filename)
+	: pFile(NULL)
+	, pTable(NULL)
+{
+	if (String::IsNullOrEmpty(filename) == true)
+	{
+		throw gcnew ArgumentNullException("filename", StringResources::NullNotAllowed);
+	}
+
+	// Resolve relative paths now, the working directory may change
+	this->filename = Path::GetFullPath(filename);
+
+	Native::MappableFile* pFile = new Native::MappableFile();
+	Native::BankPackFile* pTable = new Native::BankPackFile();
+	try
+	{
+		NativeStringUni nativeFilename(this->filename);
+		int error = pFile->Open(nativeFilename);
+		if (error != 0)
+		{
+			Native::ErrorToException::ThrowFileError(error);
+		}
+
+		// The header tells the size of the table of contents
+		Native::FileMapping header;
+		Native::FileMapping table;
+		Native::uint32 tableSize = 0;
+		bool isValid = pFile->GetSize() >= Native::BankPackFile::HeaderSize;
+		if (isValid == true)
+		{
+			error = pFile->Map(0, Native::BankPackFile::HeaderSize, Native::FileMapping::AccessReadOnly, header);
+			if (error != 0)
+			{
+				Native::ErrorToException::ThrowFileError(error);
+			}
+			isValid = Native::BankPackFile::GetTableSize(header.GetData(), header.GetSize(), tableSize) == Native::BankParseOk &&
+				tableSize <= pFile->GetSize();
+		}
+		if (isValid == true)
+		{
+			error = pFile->Map(0, tableSize, Native::FileMapping::AccessReadOnly, table);
+			if (error != 0)
+			{
+				Native::ErrorToException::ThrowFileError(error);
+			}
+			isValid = pTable->Parse(table.GetData(), table.GetSize(), pFile->GetSize()) == Native::BankParseOk;
+		}
+		if (isValid == false)
+		{
+			throw gcnew InvalidDataException(String::Format(StringResources::InvalidBankFile, this->filename));
+		}
+	}
+	catch (Exception^)
+	{
+		delete pTable;
+		delete pFile;
+		throw;
+	}
+
+	List<String^>^ names = gcnew List<String^>(pTable->GetEntryCount());
+	for (Native::uint32 i = 0; i < pTable->GetEntryCount(); i++)
+	{
+		names->Add(gcnew String(pTable->GetEntry(i).name));
+	}
+	this->names = names->AsReadOnly();
+
+	this->pFile = pFile;
+	this->pTable = pTable;
+}
+
+BankPack::~BankPack()
+{
+	this->!BankPack();
+}
+
+BankPack::!BankPack()
+{
+	// Mapped regions and the handles of streaming banks stay valid
+	delete pTable;
+	pTable = NULL;
+	delete pFile;
+	pFile = NULL;
+}
+
+bool BankPack::IsDisposed::get()
+{
+	return pFile == NULL;
+}
+
+ReadOnlyCollection<String^>^ BankPack::Names::get()
+{
+	return names;
+}
+
+String^ BankPack::Filename::get()
+{
+	return filename;
+}
+
+const Native::BankPackFile* BankPack::Table::get()
+{
+	if (pTable == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+	return pTable;
+}
+
+Native::BankPackEntry BankPack::GetEntry(String^ name)
+{
+	if (pTable == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	NativeString nativeName(name);
+	Native::uint32 index = pTable->FindEntry(nativeName);
+	if (index == Native::BankPackFile::InvalidIndex)
+	{
+		throw gcnew ArgumentException(String::Format(StringResources::PackEntryNotFound, name), "name");
+	}
+	return pTable->GetEntry(index);
+}
+
+Native::FileMapping* BankPack::MapEntry(const Native::BankPackEntry& entry, Native::FileMapping::Access access)
+{
+	if (pFile == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+
+	// Read only views are shared with other engines loading the same pack
+	Native::FileMapping* pMapping = new Native::FileMapping();
+	int error = access == Native::FileMapping::AccessReadOnly
+		? Native::MappingCache::Map(*pFile, entry.offset, static_cast<size_t>(entry.size), *pMapping)
+		: pFile->Map(entry.offset, static_cast<size_t>(entry.size), access, *pMapping);
+	if (error != 0)
+	{
+		delete pMapping;
+		Native::ErrorToException::ThrowFileError(error);
+	}
+	return pMapping;
+}
+
+Native::BankSource^ BankPack::CreateSource(String^ name, Native::FileMapping::Access access)
+{
+	return gcnew PackBankSource(this, name, access);
+}
+
+HANDLE BankPack::GetFileHandle()
+{
+	if (pFile == NULL)
+	{
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	}
+	return pFile->GetHandle();
+}
@@ -0,0 +1,56 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBank.h"
+#include "NativeBankPackFile.h"
+#include "NativeFileMapping.h"
+
+using namespace System;
+using namespace System::Collections::ObjectModel;
+
+namespace Bnoerj { namespace Audio {
+
+	// The global settings, sound banks and wave banks of a scene packed
+	// into one file by Xpack. The pack is opened once, engines and banks
+	// are created from regions of it with the AudioEngine, SoundBank and
+	// WaveBank constructors taking a pack, or all at once with
+	// AudioEngine::BeginLoadBanks. Banks keep working after the pack is
+	// disposed.
+	public ref class BankPack
+	{
+		String^ filename;
+		Native::MappableFile* pFile;
+		Native::BankPackFile* pTable;
+		ReadOnlyCollection<String^>^ names;
+
+	internal:
+		// Throws if there is no file of that name in the pack
+		Native::BankPackEntry GetEntry(String^ name);
+		// Throws if the entry cannot be mapped
+		Native::FileMapping* MapEntry(const Native::BankPackEntry& entry, Native::FileMapping::Access access);
+		// Maps the entry of that name while the pack is open, for banks
+		// unloaded by the memory budget
+		Native::BankSource^ CreateSource(String^ name, Native::FileMapping::Access access);
+		// Opened for overlapped reads, see Native::WaveBank
+		HANDLE GetFileHandle();
+
+		property String^ Filename { String^ get(); }
+		property const Native::BankPackFile* Table { const Native::BankPackFile* get(); }
+
+	public:
+		BankPack(String^ filename);
+		~BankPack();
+		!BankPack();
+
+		property bool IsDisposed { bool get(); }
+
+		// Names of the packed files, e.g. "Level1.xwb"
+		property ReadOnlyCollection<String^>^ Names { ReadOnlyCollection<String^>^ get(); }
+	};
+}}
@@ -1,138 +1,233 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "StringResources.h"
-
-#include "AudioStopOptions.h"
-#include "AudioCategory.h"
-#include "RendererDetail.h"
-#include "AudioEngine.h"
-#include "AudioObject.h"
-#include "AudioListener.h"
-#include "AudioEmitter.h"
-#include "Cue.h"
-
-#include "NativeEngine.h"
-#include "NativeCue.h"
-
-using namespace Bnoerj::Audio;
-
-Cue::Cue(AudioEngine^ engine, Native::AudioObject^ nativeObject, String^ name)
-	: AudioObject(engine, nativeObject)
-	, name(name)
-{
-}
-
-bool Cue::IsCreated::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_CREATED) != 0;
-}
-
-bool Cue::IsPrepared::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_PREPARED) != 0;
-}
-
-bool Cue::IsPreparing::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_PREPARING) != 0;
-}
-
-bool Cue::IsPlaying::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_PLAYING) != 0;
-}
-
-bool Cue::IsPaused::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_PAUSED) != 0;
-}
-
-bool Cue::IsStopped::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_STOPPED) != 0;
-}
-
-bool Cue::IsStopping::get()
-{
-	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
-	return (status & XACT_CUESTATE_STOPPING) != 0;
-}
-
-String^ Cue::Name::get()
-{
-	return name;
-}
-
-void Cue::Apply3D(AudioListener^ listener, AudioEmitter^ emitter)
-{
-	if (listener == nullptr)
-	{
-		throw gcnew ArgumentNullException("listener", StringResources::NullNotAllowed);
-	}
-	if (emitter == nullptr)
-	{
-		throw gcnew ArgumentNullException("emitter", StringResources::NullNotAllowed);
-	}
-
-	if (applied3D == false && played == true)
-	{
-		throw gcnew InvalidOperationException(StringResources::Apply3DBeforePlaying);
-	}
-
-	void* pCue = static_cast<Native::Cue^>(nativeObject)->pObject;
-	engine->engine->Apply3D(static_cast<IXACT3Cue*>(pCue), listener->listenerData, emitter->emitterData);
-
-	applied3D = true;
-}
-
-float Cue::GetVariable(String^ name)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-	return static_cast<Native::Cue^>(nativeObject)->GetVariable(name);
-}
-
-void Cue::SetVariable(String^ name, float value)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-	static_cast<Native::Cue^>(nativeObject)->SetVariable(name, value);
-}
-
-void Cue::Play()
-{
-	static_cast<Native::Cue^>(nativeObject)->Play();
-	played = true;
-}
-
-void Cue::Pause()
-{
-	static_cast<Native::Cue^>(nativeObject)->Pause(TRUE);
-}
-
-void Cue::Resume()
-{
-	static_cast<Native::Cue^>(nativeObject)->Pause(FALSE);
-}
-
-void Cue::Stop(AudioStopOptions options)
-{
-	static_cast<Native::Cue^>(nativeObject)->Stop(static_cast<DWORD>(options));
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "BankBudget.h"
+#include "AudioObject.h"
+#include "AudioListener.h"
+#include "AudioEmitter.h"
+#include "Cue.h"
+#include "VariableHandle.h"
+
+#include "NativeEngine.h"
+#include "NativeCue.h"
+
+using namespace Bnoerj::Audio;
+
+Cue::Cue(AudioEngine^ engine, Native::AudioObject^ nativeObject, String^ name)
+	: AudioObject(engine, nativeObject)
+	, name(name)
+{
+	engine->AddAudioInstance(this);
+	// Destroyed notifications find the cue through its state slot
+	static_cast<Native::Cue^>(nativeObject)->SetInstance(instanceHandle);
+}
+
+CueState Cue::State::get()
+{
+	return static_cast<CueState>(static_cast<Native::Cue^>(nativeObject)->GetStatus());
+}
+
+bool Cue::IsCreated::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_CREATED) != 0;
+}
+
+bool Cue::IsPrepared::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_PREPARED) != 0;
+}
+
+bool Cue::IsPreparing::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_PREPARING) != 0;
+}
+
+bool Cue::IsPlaying::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_PLAYING) != 0;
+}
+
+bool Cue::IsPaused::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_PAUSED) != 0;
+}
+
+bool Cue::IsStopped::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_STOPPED) != 0;
+}
+
+bool Cue::IsStopping::get()
+{
+	DWORD status = static_cast<Native::Cue^>(nativeObject)->GetStatus();
+	return (status & XACT_CUESTATE_STOPPING) != 0;
+}
+
+String^ Cue::Name::get()
+{
+	return name;
+}
+
+void Cue::Apply3D(AudioListener^ listener, AudioEmitter^ emitter)
+{
+	if (listener == nullptr)
+	{
+		throw gcnew ArgumentNullException("listener", StringResources::NullNotAllowed);
+	}
+	if (emitter == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitter", StringResources::NullNotAllowed);
+	}
+
+	Check3D();
+
+	// XACT keeps the settings applied last, as long as nothing moved
+	// they are still the ones XACT3DCalculate would give
+	Native::Engine^ nativeEngine = engine->engine;
+	if (Is3DCurrent(listener, emitter) == true)
+	{
+		::InterlockedIncrement(&nativeEngine->pStatistics->apply3DSkips);
+		return;
+	}
+
+	X3DAUDIO_EMITTER emitterData;
+	FLOAT32 channelAzimuths[AudioEmitter::MaxChannelCount];
+	emitter->GetEmitter(&emitterData, channelAzimuths);
+	HRESULT hr = nativeEngine->Apply3D(Begin3D(listener, emitter), listener->listenerData, &emitterData);
+	if (FAILED(hr))
+	{
+		Fail3D();
+	}
+}
+
+void Cue::Check3D()
+{
+	if (applied3D == false && played == true)
+	{
+		throw gcnew InvalidOperationException(StringResources::Apply3DBeforePlaying);
+	}
+}
+
+bool Cue::Is3DCurrent(AudioListener^ listener, AudioEmitter^ emitter)
+{
+	return listener == listener3D && emitter == emitter3D &&
+		listener->generation == listenerGeneration && emitter->Generation == emitterGeneration;
+}
+
+IXACT3Cue* Cue::Begin3D(AudioListener^ listener, AudioEmitter^ emitter)
+{
+	applied3D = true;
+	listener3D = listener;
+	emitter3D = emitter;
+	listenerGeneration = listener->generation;
+	emitterGeneration = emitter->Generation;
+	return static_cast<IXACT3Cue*>(static_cast<Native::Cue^>(nativeObject)->pObject);
+}
+
+void Cue::Fail3D()
+{
+	listener3D = nullptr;
+	emitter3D = nullptr;
+}
+
+float Cue::GetVariable(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	return static_cast<Native::Cue^>(nativeObject)->GetVariable(name);
+}
+
+void Cue::SetVariable(String^ name, float value)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	static_cast<Native::Cue^>(nativeObject)->SetVariable(name, value);
+}
+
+VariableHandle Cue::GetVariableHandle(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	return VariableHandle(static_cast<Native::Cue^>(nativeObject)->GetVariableIndex(name), false);
+}
+
+float Cue::GetVariable(VariableHandle variable)
+{
+	if (variable.IsGlobal == true)
+	{
+		throw gcnew ArgumentException(StringResources::VariableHandleMismatch, "variable");
+	}
+	return static_cast<Native::Cue^>(nativeObject)->GetVariable(variable.Index);
+}
+
+void Cue::SetVariable(VariableHandle variable, float value)
+{
+	if (variable.IsGlobal == true)
+	{
+		throw gcnew ArgumentException(StringResources::VariableHandleMismatch, "variable");
+	}
+	static_cast<Native::Cue^>(nativeObject)->SetVariable(variable.Index, value);
+}
+
+float Cue::GetVariable(int index)
+{
+	if (index < 0 || index >= XACTVARIABLEINDEX_INVALID)
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidVariableIndex);
+	}
+	return static_cast<Native::Cue^>(nativeObject)->GetVariable(static_cast<XACTVARIABLEINDEX>(index));
+}
+
+void Cue::SetVariable(int index, float value)
+{
+	if (index < 0 || index >= XACTVARIABLEINDEX_INVALID)
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidVariableIndex);
+	}
+	static_cast<Native::Cue^>(nativeObject)->SetVariable(static_cast<XACTVARIABLEINDEX>(index), value);
+}
+
+void Cue::Play()
+{
+	static_cast<Native::Cue^>(nativeObject)->Play();
+	played = true;
+}
+
+void Cue::Pause()
+{
+	static_cast<Native::Cue^>(nativeObject)->Pause(TRUE);
+}
+
+void Cue::Resume()
+{
+	static_cast<Native::Cue^>(nativeObject)->Pause(FALSE);
+}
+
+void Cue::Stop(AudioStopOptions options)
+{
+	static_cast<Native::Cue^>(nativeObject)->Stop(static_cast<DWORD>(options));
+}
@@ -1,47 +1,80 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-#include "NativeAudioObject.h"
-
-using namespace System;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class Cue : public AudioObject
-	{
-		String^ name;
-		bool played;
-		bool applied3D;
-
-	internal:
-		Cue(AudioEngine^ engine, Native::AudioObject^ nativeObject, String^ name);
-
-	public:
-		property bool IsCreated { bool get(); }
-		property bool IsPrepared { bool get(); }
-		property bool IsPreparing { bool get(); }
-
-		property bool IsPlaying { bool get(); }
-		property bool IsPaused { bool get(); }
-		property bool IsStopped { bool get(); }
-		property bool IsStopping { bool get(); }
-
-		property String^ Name { String^ get(); }
-
-		void Apply3D(AudioListener^ listener, AudioEmitter^ emitter);
-
-		float GetVariable(String^ name);
-		void SetVariable(String^ name, float value);
-
-		void Play();
-		void Pause();
-		void Resume();
-		void Stop(AudioStopOptions options);
-	};
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeAudioObject.h"
+#include "CueState.h"
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	public ref class Cue : public AudioObject
+	{
+		String^ name;
+		bool played;
+		bool applied3D;
+		// The listener and emitter the 3D settings were last applied with
+		// and their generations, null if they have to be calculated
+		AudioListener^ listener3D;
+		AudioEmitter^ emitter3D;
+		long long listenerGeneration;
+		long long emitterGeneration;
+
+	internal:
+		Cue(AudioEngine^ engine, Native::AudioObject^ nativeObject, String^ name);
+
+		// Throws if 3D settings cannot be applied any more, see Apply3D
+		void Check3D();
+		// True if neither the listener nor the emitter changed since the
+		// settings were applied with them
+		bool Is3DCurrent(AudioListener^ listener, AudioEmitter^ emitter);
+		// Marks the cue as positioned with the listener and emitter and
+		// returns it, for AudioEngine::Apply3D
+		IXACT3Cue* Begin3D(AudioListener^ listener, AudioEmitter^ emitter);
+		// The settings from Begin3D were not applied
+		void Fail3D();
+
+	public:
+		// The state as of the last AudioEngine::Update, or of the last call
+		// to Play, Pause, Resume or Stop while commands are not deferred.
+		// Reading it does not call into XACT.
+		property CueState State { CueState get(); }
+
+		property bool IsCreated { bool get(); }
+		property bool IsPrepared { bool get(); }
+		property bool IsPreparing { bool get(); }
+
+		property bool IsPlaying { bool get(); }
+		property bool IsPaused { bool get(); }
+		property bool IsStopped { bool get(); }
+		property bool IsStopping { bool get(); }
+
+		property String^ Name { String^ get(); }
+
+		void Apply3D(AudioListener^ listener, AudioEmitter^ emitter);
+
+		float GetVariable(String^ name);
+		void SetVariable(String^ name, float value);
+
+		// Handles are shared by all cues of the same cue definition
+		VariableHandle GetVariableHandle(String^ name);
+		float GetVariable(VariableHandle variable);
+		void SetVariable(VariableHandle variable, float value);
+
+		// Take the cue variable indices Xidgen generates from the global
+		// settings
+		float GetVariable(int index);
+		void SetVariable(int index, float value);
+
+		void Play();
+		void Pause();
+		void Resume();
+		void Stop(AudioStopOptions options);
+	};
+}}
@@ -0,0 +1,60 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+#include "CueHandle.h"
+
+using namespace Bnoerj::Audio;
+
+CueHandle::CueHandle(XACTINDEX index, Native::SoundBank^ soundBank)
+	: value(index != XACTINDEX_INVALID ? index + 1 : 0)
+	, soundBank(soundBank)
+{}
+
+XACTINDEX CueHandle::Index::get()
+{
+	return value != 0 ? value - 1 : XACTINDEX_INVALID;
+}
+
+Native::SoundBank^ CueHandle::Owner::get()
+{
+	return soundBank;
+}
+
+bool CueHandle::IsValid::get()
+{
+	return value != 0;
+}
+
+bool CueHandle::Equals(CueHandle other)
+{
+	return value == other.value && Object::ReferenceEquals(soundBank, other.soundBank);
+}
+
+bool CueHandle::Equals(Object^ other)
+{
+	if (dynamic_cast<CueHandle^>(other) != nullptr)
+	{
+		return Equals(safe_cast<CueHandle>(other));
+	}
+	return false;
+}
+
+int CueHandle::GetHashCode()
+{
+	return value;
+}
+
+bool CueHandle::operator ==(CueHandle a, CueHandle b)
+{
+	return a.Equals(b);
+}
+
+bool CueHandle::operator !=(CueHandle a, CueHandle b)
+{
+	return !a.Equals(b);
+}
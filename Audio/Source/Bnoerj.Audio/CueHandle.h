@@ -0,0 +1,46 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	namespace Native
+	{
+		ref class SoundBank;
+	}
+
+	// A cue resolved by name once. PlayCue and GetCue calls taking a handle
+	// skip the name lookup. A handle is only valid for the sound bank that
+	// created it.
+	public value struct CueHandle : IEquatable<CueHandle>
+	{
+	private:
+		// Cue index plus one, zero for a default or unresolved handle
+		UInt16 value;
+		Native::SoundBank^ soundBank;
+
+	internal:
+		CueHandle(XACTINDEX index, Native::SoundBank^ soundBank);
+
+		property XACTINDEX Index { XACTINDEX get(); }
+		property Native::SoundBank^ Owner { Native::SoundBank^ get(); }
+
+	public:
+		// False if the name did not resolve to a cue
+		property bool IsValid { bool get(); }
+
+		virtual bool Equals(CueHandle other);
+		virtual bool Equals(Object^ other) override;
+		virtual int GetHashCode() override;
+
+		static bool operator ==(CueHandle a, CueHandle b);
+		static bool operator !=(CueHandle a, CueHandle b);
+	};
+}}
@@ -0,0 +1,27 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	// State of a cue as reported by XACT, see Cue::State
+	[Flags]
+	public enum class CueState
+	{
+		None = 0,
+		Created = XACT_CUESTATE_CREATED,
+		Preparing = XACT_CUESTATE_PREPARING,
+		Prepared = XACT_CUESTATE_PREPARED,
+		Playing = XACT_CUESTATE_PLAYING,
+		Stopping = XACT_CUESTATE_STOPPING,
+		Stopped = XACT_CUESTATE_STOPPED,
+		Paused = XACT_CUESTATE_PAUSED
+	};
+}}
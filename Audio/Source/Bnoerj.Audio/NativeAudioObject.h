@@ -1,42 +1,56 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-using namespace System::Runtime::InteropServices;
-
-namespace Bnoerj { namespace Audio { namespace Native {
-
-	ref class AudioObject abstract
-	{
-	internal:
-		IXACT3Engine* pEngine;
-		void* pObject;
-		void* pData;
-
-		AudioObject()
-			: pEngine(NULL)
-			, pObject(NULL)
-			, pData(NULL)
-		{}
-		AudioObject(IXACT3Engine* pEngine, void* pObject)
-			: pEngine(pEngine)
-			, pObject(pObject)
-			, pData(NULL)
-		{}
-		AudioObject(IXACT3Engine* pEngine, void* pObject, void* pData)
-			: pEngine(pEngine)
-			, pObject(pObject)
-			, pData(pData)
-		{}
-
-	public:
-		virtual void Release() = 0;
-	};
-
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeFileMapping.h"
+
+using namespace System;
+using namespace System::Runtime::InteropServices;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	ref class Engine;
+
+	ref class AudioObject abstract
+	{
+	internal:
+		// The engine wrapper owning this object, null for the engine itself
+		Engine^ engine;
+		IXACT3Engine* pEngine;
+		void* pObject;
+		void* pData;
+		// File the object was created from, mapped for its lifetime
+		FileMapping* pMapping;
+
+		AudioObject()
+			: engine(nullptr)
+			, pEngine(NULL)
+			, pObject(NULL)
+			, pData(NULL)
+			, pMapping(NULL)
+		{}
+		AudioObject(Engine^ engine, IXACT3Engine* pEngine, void* pObject)
+			: engine(engine)
+			, pEngine(pEngine)
+			, pObject(pObject)
+			, pData(NULL)
+			, pMapping(NULL)
+		{}
+		AudioObject(Engine^ engine, IXACT3Engine* pEngine, void* pObject, void* pData)
+			: engine(engine)
+			, pEngine(pEngine)
+			, pObject(pObject)
+			, pData(pData)
+			, pMapping(NULL)
+		{}
+
+	public:
+		virtual void Release() = 0;
+	};
+
+}}}
@@ -0,0 +1,75 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeEngine.h"
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Maps the data of an in-memory bank again after the bank was unloaded
+	// by the memory budget, see Bnoerj::Audio::BankBudget.
+	ref class BankSource abstract
+	{
+	public:
+		// False once the data can no longer be mapped, e.g. the pack the
+		// bank was created from is disposed
+		virtual property bool IsAvailable { bool get() { return true; } }
+
+		// Throws if the data cannot be mapped
+		virtual FileMapping* Map() = 0;
+	};
+
+	ref class FileBankSource : public BankSource
+	{
+		String^ filename;
+		FileMapping::Access access;
+
+	public:
+		FileBankSource(String^ filename, FileMapping::Access access)
+			: filename(System::IO::Path::GetFullPath(filename))
+			, access(access)
+		{}
+
+		virtual FileMapping* Map() override
+		{
+			return Engine::MapFile(filename, access);
+		}
+	};
+
+	// A sound bank or wave bank. In-memory banks with a source can be
+	// unloaded with Release and loaded again with Reload, keeping the
+	// wrapper and everything cached in it.
+	ref class Bank abstract : public AudioObject
+	{
+	internal:
+		// Null for streaming wave banks and banks created from mappings of
+		// unknown origin, these are never unloaded
+		BankSource^ source;
+		// Stamp of the last use, see BankBudget::Use
+		LONGLONG lastUse;
+
+		Bank()
+			: source(nullptr)
+			, lastUse(0)
+		{}
+
+	public:
+		bool IsLoaded() { return pObject != NULL; }
+		// Bytes of bank data mapped, 0 while unloaded
+		size_t GetDataSize() { return pMapping != NULL ? pMapping->GetSize() : 0; }
+
+		// False while unloaded
+		virtual bool IsInUse() = 0;
+		// Creates the XACT bank again from the data of the source after
+		// Release, takes ownership of the mapping, also if that fails
+		virtual void Reload(FileMapping* pMapping) = 0;
+	};
+
+}}}
@@ -0,0 +1,159 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeBankPackFile.h
+
+#include <string.h>
+
+#include "NativeBankPackFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Layout of an entry record
+	const size_t EntryTypeOffset = 64;
+	const size_t EntryPacketSizeOffset = 68;
+	const size_t EntryOffsetOffset = 72;
+	const size_t EntrySizeOffset = 80;
+
+	// XACT takes a short for the packet size
+	const uint32 MaxPacketSize = 0x7FFF;
+
+	char ToLower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	bool EqualsIgnoreCase(const char* a, const char* b)
+	{
+		for (; *a != '\0' && ToLower(*a) == ToLower(*b); a++, b++)
+		{
+		}
+		return ToLower(*a) == ToLower(*b);
+	}
+}
+
+BankPackFile::BankPackFile()
+	: alignment(DefaultAlignment)
+{}
+
+BankParseResult BankPackFile::GetTableSize(const void* pData, size_t size, uint32& tableSize)
+{
+	BankReader reader(pData, size);
+	if (reader.ReadSignature("XPAK") == false)
+	{
+		return BankParseInvalidSignature;
+	}
+	if (reader.Contains(0, HeaderSize) == false)
+	{
+		return BankParseTruncated;
+	}
+	if (reader.ReadUInt32(4) != Version)
+	{
+		return BankParseUnsupportedVersion;
+	}
+
+	uint32 entryCount = reader.ReadUInt32(12);
+	if (entryCount > (0xFFFFFFFF - HeaderSize) / EntrySize)
+	{
+		return BankParseInvalidData;
+	}
+	tableSize = HeaderSize + entryCount * EntrySize;
+	return BankParseOk;
+}
+
+BankParseResult BankPackFile::Parse(const void* pData, size_t size, uint64 fileSize)
+{
+	entries.Clear();
+	alignment = DefaultAlignment;
+
+	uint32 tableSize;
+	BankParseResult result = GetTableSize(pData, size, tableSize);
+	if (result != BankParseOk)
+	{
+		return result;
+	}
+
+	BankReader reader(pData, size);
+	reader.ReadSignature("XPAK");
+	if (reader.Contains(0, tableSize) == false || tableSize > fileSize)
+	{
+		return BankParseTruncated;
+	}
+
+	// A power of two multiple of the sector size
+	uint32 packAlignment = reader.ReadUInt32(8);
+	if (packAlignment < SectorSize || (packAlignment & (packAlignment - 1)) != 0)
+	{
+		return BankParseInvalidData;
+	}
+
+	uint32 entryCount = reader.ReadUInt32(12);
+	entries.Reserve(entryCount);
+	for (uint32 i = 0; i < entryCount; i++)
+	{
+		size_t entryOffset = HeaderSize + i * static_cast<size_t>(EntrySize);
+
+		BankPackEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		// Zero padded, with at least one zero
+		reader.ReadString(entryOffset, MaxNameLength, entry.name);
+		if (entry.name[0] == '\0' || reader.ReadUInt8(entryOffset + MaxNameLength) != 0)
+		{
+			entries.Clear();
+			return BankParseInvalidData;
+		}
+
+		uint32 type = reader.ReadUInt32(entryOffset + EntryTypeOffset);
+		entry.packetSize = reader.ReadUInt32(entryOffset + EntryPacketSizeOffset);
+		entry.offset = reader.ReadUInt64(entryOffset + EntryOffsetOffset);
+		entry.size = reader.ReadUInt64(entryOffset + EntrySizeOffset);
+		if (type >= BankPackEntryTypeCount ||
+			(type == BankPackEntryStreamingWaveBank) != (entry.packetSize != 0) ||
+			entry.packetSize > MaxPacketSize ||
+			entry.offset < tableSize || entry.offset % packAlignment != 0)
+		{
+			entries.Clear();
+			return BankParseInvalidData;
+		}
+		if (entry.offset > fileSize || entry.size > fileSize - entry.offset)
+		{
+			entries.Clear();
+			return BankParseTruncated;
+		}
+		entry.type = static_cast<BankPackEntryType>(type);
+
+		// Each entry was a file of its own, they cannot share data
+		for (uint32 j = 0; j < entries.GetCount(); j++)
+		{
+			const BankPackEntry& other = entries[j];
+			if (entry.offset < other.offset + other.size && other.offset < entry.offset + entry.size)
+			{
+				entries.Clear();
+				return BankParseInvalidData;
+			}
+		}
+		entries.Add(entry);
+	}
+
+	alignment = packAlignment;
+	return BankParseOk;
+}
+
+uint32 BankPackFile::FindEntry(const char* name) const
+{
+	for (uint32 i = 0; i < entries.GetCount(); i++)
+	{
+		if (EqualsIgnoreCase(entries[i].name, name) == true)
+		{
+			return i;
+		}
+	}
+	return InvalidIndex;
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	enum BankPackEntryType
+	{
+		BankPackEntrySettings = 0,
+		BankPackEntrySoundBank = 1,
+		BankPackEntryWaveBank = 2,
+		BankPackEntryStreamingWaveBank = 3,
+		BankPackEntryTypeCount,
+	};
+
+	struct BankPackEntry
+	{
+		// File name the entry was packed from, without the directory
+		char name[64];
+		BankPackEntryType type;
+		// DVD sectors XACT reads at a time, streaming wave banks only
+		uint32 packetSize;
+		// Position in the pack, a multiple of the pack alignment
+		uint64 offset;
+		uint64 size;
+	};
+
+	// Table of contents of a bank pack (.xpk), the global settings, sound
+	// banks and wave banks of a scene in one file written by Xpack.
+	//
+	// The header holds the signature "XPAK", the version, the alignment
+	// and the entry count, followed by one EntrySize record per entry.
+	// Entry data follows the table, each entry starting at a multiple of
+	// the alignment, which is a multiple of the DVD sector size, with no
+	// two entries overlapping. Streaming wave banks are thus read from the
+	// pack just like from their own file and in-memory banks can be mapped
+	// straight from it.
+	//
+	// Plain C++ without CLR or XACT dependencies, see NativeFileMapping.h.
+	class BankPackFile
+	{
+		uint32 alignment;
+		BankArray<BankPackEntry> entries;
+
+		BankPackFile(const BankPackFile&);
+		BankPackFile& operator=(const BankPackFile&);
+
+	public:
+		static const uint32 Version = 1;
+		static const uint32 HeaderSize = 16;
+		static const uint32 EntrySize = 96;
+		// Longest name, without the terminating zero
+		static const uint32 MaxNameLength = 63;
+		static const uint32 SectorSize = 2048;
+		static const uint32 DefaultAlignment = SectorSize;
+		static const uint32 InvalidIndex = 0xFFFFFFFF;
+
+		BankPackFile();
+
+		// Size of the header and table of contents, from the first
+		// HeaderSize bytes of a pack
+		static BankParseResult GetTableSize(const void* pData, size_t size, uint32& tableSize);
+
+		// Reads the header and table of contents at the start of a pack of
+		// fileSize bytes. Everything is copied, pData may be released
+		// afterwards.
+		BankParseResult Parse(const void* pData, size_t size, uint64 fileSize);
+
+		uint32 GetAlignment() const { return alignment; }
+		uint32 GetEntryCount() const { return entries.GetCount(); }
+		const BankPackEntry& GetEntry(uint32 index) const { return entries[index]; }
+
+		// Names are compared without regard to ASCII case, like file names.
+		// Returns InvalidIndex if there is no entry of that name.
+		uint32 FindEntry(const char* name) const;
+	};
+
+}}}
@@ -0,0 +1,220 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Fixed size integers for the bank file parsers, which build without
+	// windows.h and stdint.h
+#if defined(_MSC_VER)
+	typedef unsigned __int8 uint8;
+	typedef unsigned __int16 uint16;
+	typedef unsigned __int32 uint32;
+	typedef unsigned __int64 uint64;
+	typedef __int16 int16;
+	typedef __int32 int32;
+	typedef __int64 int64;
+#else
+	typedef unsigned char uint8;
+	typedef unsigned short uint16;
+	typedef unsigned int uint32;
+	typedef unsigned long long uint64;
+	typedef short int16;
+	typedef int int32;
+	typedef long long int64;
+#endif
+
+	enum BankParseResult
+	{
+		BankParseOk,
+		// Not a bank of the expected kind
+		BankParseInvalidSignature,
+		// A bank of a content or header version the parser does not know
+		BankParseUnsupportedVersion,
+		// A table or entry points past the end of the data
+		BankParseTruncated,
+		// A table holds values that cannot be right
+		BankParseInvalidData,
+	};
+
+	// Bounds checked reads from a bank file in memory. XACT writes banks
+	// in the byte order of the target platform, so values are swapped if
+	// the signature was found reversed.
+	class BankReader
+	{
+		const uint8* pData;
+		size_t size;
+		bool swap;
+
+	public:
+		BankReader(const void* pData, size_t size)
+			: pData(static_cast<const uint8*>(pData))
+			, size(size)
+			, swap(false)
+		{}
+
+		const uint8* GetData() const { return pData; }
+		size_t GetSize() const { return size; }
+		bool IsSwapped() const { return swap; }
+
+		// Checks the four character signature at the start of the data and
+		// detects the byte order from it
+		bool ReadSignature(const char* signature)
+		{
+			if (size < 4)
+			{
+				return false;
+			}
+			if (pData[0] == signature[0] && pData[1] == signature[1] &&
+				pData[2] == signature[2] && pData[3] == signature[3])
+			{
+				swap = false;
+				return true;
+			}
+			if (pData[0] == signature[3] && pData[1] == signature[2] &&
+				pData[2] == signature[1] && pData[3] == signature[0])
+			{
+				swap = true;
+				return true;
+			}
+			return false;
+		}
+
+		bool Contains(size_t offset, size_t length) const
+		{
+			return offset <= size && length <= size - offset;
+		}
+
+		uint8 ReadUInt8(size_t offset) const
+		{
+			return pData[offset];
+		}
+
+		uint16 ReadUInt16(size_t offset) const
+		{
+			const uint8* p = pData + offset;
+			return swap == false
+				? static_cast<uint16>(p[0] | (p[1] << 8))
+				: static_cast<uint16>(p[1] | (p[0] << 8));
+		}
+
+		uint32 ReadUInt32(size_t offset) const
+		{
+			const uint8* p = pData + offset;
+			return swap == false
+				? static_cast<uint32>(p[0]) | (static_cast<uint32>(p[1]) << 8) |
+					(static_cast<uint32>(p[2]) << 16) | (static_cast<uint32>(p[3]) << 24)
+				: static_cast<uint32>(p[3]) | (static_cast<uint32>(p[2]) << 8) |
+					(static_cast<uint32>(p[1]) << 16) | (static_cast<uint32>(p[0]) << 24);
+		}
+
+		uint64 ReadUInt64(size_t offset) const
+		{
+			uint64 low = ReadUInt32(offset);
+			uint64 high = ReadUInt32(offset + 4);
+			return swap == false ? low | (high << 32) : high | (low << 32);
+		}
+
+		float ReadFloat(size_t offset) const
+		{
+			union
+			{
+				uint32 u;
+				float f;
+			} value;
+			value.u = ReadUInt32(offset);
+			return value.f;
+		}
+
+		// Copies a zero padded string of up to length bytes, dest must hold
+		// length + 1 characters
+		void ReadString(size_t offset, size_t length, char* dest) const
+		{
+			size_t i = 0;
+			for (; i < length && offset + i < size && pData[offset + i] != '\0'; i++)
+			{
+				dest[i] = static_cast<char>(pData[offset + i]);
+			}
+			dest[i] = '\0';
+		}
+	};
+
+	// Growable array of plain structs for the tables the parsers build.
+	// Elements are copied with memcpy and never constructed.
+	template<typename T>
+	class BankArray
+	{
+		T* pItems;
+		uint32 count;
+		uint32 capacity;
+
+		BankArray(const BankArray&);
+		BankArray& operator=(const BankArray&);
+
+	public:
+		BankArray()
+			: pItems(NULL)
+			, count(0)
+			, capacity(0)
+		{}
+
+		~BankArray()
+		{
+			delete[] pItems;
+		}
+
+		uint32 GetCount() const { return count; }
+		T* GetData() { return pItems; }
+		const T* GetData() const { return pItems; }
+		T& operator[](uint32 index) { return pItems[index]; }
+		const T& operator[](uint32 index) const { return pItems[index]; }
+
+		void Reserve(uint32 newCapacity)
+		{
+			if (newCapacity > capacity)
+			{
+				T* pNewItems = new T[newCapacity];
+				if (count > 0)
+				{
+					memcpy(pNewItems, pItems, count * sizeof(T));
+				}
+				delete[] pItems;
+				pItems = pNewItems;
+				capacity = newCapacity;
+			}
+		}
+
+		// New elements are left uninitialized
+		void Resize(uint32 newCount)
+		{
+			Reserve(newCount);
+			count = newCount;
+		}
+
+		void Add(const T& item)
+		{
+			if (count == capacity)
+			{
+				Reserve(capacity < 8 ? 8 : capacity * 2);
+			}
+			pItems[count++] = item;
+		}
+
+		void Clear()
+		{
+			delete[] pItems;
+			pItems = NULL;
+			count = 0;
+			capacity = 0;
+		}
+	};
+
+}}}
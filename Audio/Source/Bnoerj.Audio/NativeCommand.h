@@ -0,0 +1,52 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Capacity of an engine's command queue, must be a power of two. Holds
+	// a frame of commands from a few threads, about 1 MB of them, so the
+	// queue only overflows when Update is late.
+	const LONG CommandQueueCapacity = 4096;
+
+	// Emitter channel azimuths a command holds, as DspArena::MaxChannelCount
+	const UINT CommandMaxChannelCount = 8;
+
+	enum CommandType
+	{
+		CommandCuePlay,
+		CommandCuePause,
+		CommandCueStop,
+		CommandCueSetVariable,
+		CommandCueDestroy,
+		CommandEnginePause,
+		CommandEngineStop,
+		CommandEngineSetVolume,
+		CommandEngineSetGlobalVariable,
+		CommandEngineApply3D,
+	};
+
+	// A deferred engine call. Commands are copied by value into the engine's
+	// command queue, so everything a command needs is stored inline,
+	// including copies of the 3D listener and emitter and the emitter's
+	// channel azimuths.
+	struct Command
+	{
+		CommandType type;
+		IXACT3Cue* pCue;
+		XACTCATEGORY category;
+		XACTVARIABLEINDEX variable;
+		// Pause flag or stop options
+		DWORD flags;
+		float value;
+		X3DAUDIO_LISTENER listener;
+		X3DAUDIO_EMITTER emitter;
+		FLOAT32 channelAzimuths[CommandMaxChannelCount];
+	};
+
+}}}
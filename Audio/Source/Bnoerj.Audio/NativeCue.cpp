@@ -1,121 +1,241 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "NativeEngine.h"
-#include "NativeCue.h"
-#include "NativeHelpers.h"
-#include "ErrorToException.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio::Native;
-using namespace Bnoerj::Native::Helpers;
-
-void Cue::Release()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-	pCue->Destroy();
-	pObject = NULL;
-}
-
-DWORD Cue::GetStatus()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-	DWORD state;
-	HRESULT hr = pCue->GetState(&state);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-	return state;
-}
-
-void Cue::Pause(BOOL pause)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-	HRESULT hr = pCue->Pause(pause);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-void Cue::Play()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-	HRESULT hr = pCue->Play();
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-void Cue::Stop(DWORD options)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-	HRESULT hr = pCue->Stop(options);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-float Cue::GetVariable(String^ name)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTVARIABLEINDEX index = pCue->GetVariableIndex(pName);
-	if (index == XACTVARIABLEINDEX_INVALID)
-	{
-		//ErrorToException::Throw(hr);
-		return 0.0f;
-	}
-
-	float value;
-	HRESULT hr = pCue->GetVariable(index, &value);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-
-	return value;
-}
-
-void Cue::SetVariable(String^ name, float value)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTVARIABLEINDEX index = pCue->GetVariableIndex(pName);
-	if (index == XACTVARIABLEINDEX_INVALID)
-	{
-		//ErrorToException::Throw(hr);
-		return;
-	}
-
-	HRESULT hr = pCue->SetVariable(index, value);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeEngine.h"
+#include "NativeCue.h"
+#include "NativeSoundBank.h"
+#include "NativeHelpers.h"
+#include "ErrorToException.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio::Native;
+using namespace Bnoerj::Native::Helpers;
+
+Cue::Cue(Engine^ engine, IXACT3Engine* pEngine, void* pObject, SoundBank^ soundBank, XACTINDEX cueIndex)
+	: AudioObject(engine, pEngine, pObject)
+	, soundBank(soundBank)
+	, cueIndex(cueIndex)
+	, sequence(Engine::GetNotificationSequence())
+{
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	DWORD state = 0;
+	pCue->GetState(&state);
+	stateSlot = engine->pCueStates->Add(pCue, static_cast<IXACT3SoundBank*>(soundBank->pObject), state, sequence);
+}
+
+void Cue::SetInstance(long long instance)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	if (stateSlot >= 0)
+	{
+		engine->pCueStates->SetInstance(stateSlot, instance);
+	}
+}
+
+void Cue::UpdateState()
+{
+	DWORD state;
+	if (stateSlot >= 0 && SUCCEEDED(static_cast<IXACT3Cue*>(pObject)->GetState(&state)))
+	{
+		engine->pCueStates->SetState(stateSlot, state);
+	}
+}
+
+void Cue::Release()
+{
+	if (stateSlot >= 0)
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		// Gone with the engine if it was released first
+		if (engine->pCueStates != NULL)
+		{
+			if (engine->pCueStates->IsDestroyed(stateSlot) == true)
+			{
+				// With its sound bank, the notification may not be in yet
+				pObject = NULL;
+			}
+			engine->pCueStates->Remove(stateSlot);
+		}
+		stateSlot = -1;
+	}
+
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	if (pCue == NULL)
+	{
+		// Already destroyed by XACT, e.g. with its sound bank
+		return;
+	}
+
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCueDestroy };
+		command.pCue = pCue;
+		engine->Submit(command);
+		pObject = NULL;
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	pCue->Destroy();
+	pObject = NULL;
+}
+
+DWORD Cue::GetStatus()
+{
+	if (stateSlot >= 0)
+	{
+		return engine->pCueStates->GetState(stateSlot);
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	DWORD state;
+	HRESULT hr = pCue->GetState(&state);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+	return state;
+}
+
+void Cue::Pause(BOOL pause)
+{
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCuePause };
+		command.pCue = pCue;
+		command.flags = pause;
+		engine->Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pCue->Pause(pause);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+
+	UpdateState();
+}
+
+void Cue::Play()
+{
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCuePlay };
+		command.pCue = pCue;
+		engine->Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pCue->Play();
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+
+	UpdateState();
+}
+
+void Cue::Stop(DWORD options)
+{
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCueStop };
+		command.pCue = pCue;
+		command.flags = options;
+		engine->Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pCue->Stop(options);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+
+	UpdateState();
+}
+
+XACTVARIABLEINDEX Cue::GetVariableIndex(String^ name)
+{
+	return soundBank->GetVariableIndex(cueIndex, static_cast<IXACT3Cue*>(pObject), name);
+}
+
+float Cue::GetVariable(String^ name)
+{
+	return GetVariable(GetVariableIndex(name));
+}
+
+void Cue::SetVariable(String^ name, float value)
+{
+	SetVariable(GetVariableIndex(name), value);
+}
+
+float Cue::GetVariable(XACTVARIABLEINDEX index)
+{
+	if (index == XACTVARIABLEINDEX_INVALID)
+	{
+		//ErrorToException::Throw(hr);
+		return 0.0f;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	float value;
+	HRESULT hr = pCue->GetVariable(index, &value);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+
+	return value;
+}
+
+void Cue::SetVariable(XACTVARIABLEINDEX index, float value)
+{
+	if (index == XACTVARIABLEINDEX_INVALID)
+	{
+		//ErrorToException::Throw(hr);
+		return;
+	}
+
+	IXACT3Cue* pCue = static_cast<IXACT3Cue*>(pObject);
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCueSetVariable };
+		command.pCue = pCue;
+		command.variable = index;
+		command.value = value;
+		engine->Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pCue->SetVariable(index, value);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+}
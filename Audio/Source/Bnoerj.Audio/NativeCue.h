@@ -1,36 +1,65 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-#include "NativeAudioObject.h"
-
-using namespace System;
-using namespace System::Runtime::InteropServices;
-
-namespace Bnoerj { namespace Audio { namespace Native {
-
-	ref class Cue : public Bnoerj::Audio::Native::AudioObject
-	{
-	public:
-		Cue(IXACT3Engine* pEngine, void* pObject)
-			: AudioObject(pEngine, pObject)
-		{}
-
-		virtual void Release() override;
-
-		DWORD GetStatus();
-
-		void Pause(BOOL pause);
-		void Play();
-		void Stop(DWORD options);
-
-		float GetVariable(String^ name);
-		void SetVariable(String^ name, float value);
-	};
-
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeAudioObject.h"
+#include "NativeEngine.h"
+
+using namespace System;
+using namespace System::Runtime::InteropServices;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	ref class SoundBank;
+
+	ref class Cue : public Bnoerj::Audio::Native::AudioObject
+	{
+	internal:
+		// Sound bank and cue definition, used to share variable indices
+		SoundBank^ soundBank;
+		XACTINDEX cueIndex;
+
+		// Notification sequence at the time the cue was prepared. XACT raises
+		// the destroyed notification before the cue memory is released, so
+		// notifications with a sequence up to this value are for an earlier
+		// cue at the same address.
+		LONG sequence;
+
+		// Slot in the engine's CueStateTable, -1 once released
+		LONG stateSlot;
+
+	private:
+		// Caller must hold syncRoot
+		void UpdateState();
+
+	public:
+		// Caller must hold syncRoot
+		Cue(Engine^ engine, IXACT3Engine* pEngine, void* pObject, SoundBank^ soundBank, XACTINDEX cueIndex);
+
+		virtual void Release() override;
+
+		// Handle of the Bnoerj::Audio::Cue, passed to Engine::CueDestroyed
+		void SetInstance(long long instance);
+
+		// The state as of the last Engine::Update or the last call on this
+		// cue not deferred, read without the lock
+		DWORD GetStatus();
+
+		void Pause(BOOL pause);
+		void Play();
+		void Stop(DWORD options);
+
+		XACTVARIABLEINDEX GetVariableIndex(String^ name);
+
+		float GetVariable(String^ name);
+		void SetVariable(String^ name, float value);
+		float GetVariable(XACTVARIABLEINDEX index);
+		void SetVariable(XACTVARIABLEINDEX index, float value);
+	};
+
+}}}
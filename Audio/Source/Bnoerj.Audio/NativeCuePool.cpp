@@ -0,0 +1,135 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeCuePool.h"
+
+using namespace Bnoerj::Audio::Native;
+
+// Cues kept for destruction until the list grows, doubled when full
+static const LONG InitialPlayingCapacity = 16;
+
+CuePool::CuePool(IXACT3SoundBank* pSoundBank, XACTINDEX cueCount)
+	: pSoundBank(pSoundBank)
+	, pDefinitions(new Definition[cueCount])
+	, definitionCount(cueCount)
+	, ppPlaying(new IXACT3Cue*[InitialPlayingCapacity])
+	, playingCount(0)
+	, playingCapacity(InitialPlayingCapacity)
+{
+	ZeroMemory(pDefinitions, cueCount * sizeof(Definition));
+}
+
+CuePool::~CuePool()
+{
+	for (XACTINDEX i = 0; i < definitionCount; i++)
+	{
+		SetCapacity(i, 0);
+	}
+	delete[] pDefinitions;
+
+	for (LONG i = 0; i < playingCount; i++)
+	{
+		ppPlaying[i]->Destroy();
+	}
+	delete[] ppPlaying;
+}
+
+LONG CuePool::GetCapacity(XACTINDEX cueIndex) const
+{
+	return pDefinitions[cueIndex].capacity;
+}
+
+void CuePool::SetCapacity(XACTINDEX cueIndex, LONG capacity)
+{
+	Definition& definition = pDefinitions[cueIndex];
+	if (capacity == definition.capacity)
+	{
+		return;
+	}
+
+	IXACT3Cue** ppCues = capacity > 0 ? new IXACT3Cue*[capacity] : NULL;
+	LONG count = 0;
+	for (LONG i = 0; i < definition.count; i++)
+	{
+		if (count < capacity)
+		{
+			ppCues[count++] = definition.ppCues[i];
+		}
+		else
+		{
+			definition.ppCues[i]->Destroy();
+		}
+	}
+
+	delete[] definition.ppCues;
+	definition.ppCues = ppCues;
+	definition.count = count;
+	definition.capacity = capacity;
+}
+
+IXACT3Cue* CuePool::Take(XACTINDEX cueIndex)
+{
+	Definition& definition = pDefinitions[cueIndex];
+	if (definition.count == 0)
+	{
+		return NULL;
+	}
+	return definition.ppCues[--definition.count];
+}
+
+void CuePool::AddPlaying(IXACT3Cue* pCue)
+{
+	if (playingCount == playingCapacity)
+	{
+		IXACT3Cue** ppCues = new IXACT3Cue*[playingCapacity * 2];
+		::memcpy(ppCues, ppPlaying, playingCount * sizeof(IXACT3Cue*));
+		delete[] ppPlaying;
+		ppPlaying = ppCues;
+		playingCapacity *= 2;
+	}
+	ppPlaying[playingCount++] = pCue;
+}
+
+LONG CuePool::Update()
+{
+	LONG destroyedCount = 0;
+	for (LONG i = 0; i < playingCount; )
+	{
+		DWORD state = 0;
+		HRESULT hr = ppPlaying[i]->GetState(&state);
+		if (SUCCEEDED(hr) && (state & XACT_CUESTATE_STOPPED) == 0)
+		{
+			i++;
+			continue;
+		}
+
+		// Order does not matter, move the last cue into the gap
+		ppPlaying[i]->Destroy();
+		ppPlaying[i] = ppPlaying[--playingCount];
+		destroyedCount++;
+	}
+
+	for (XACTINDEX i = 0; i < definitionCount; i++)
+	{
+		Definition& definition = pDefinitions[i];
+		while (definition.count < definition.capacity)
+		{
+			IXACT3Cue* pCue;
+			HRESULT hr = pSoundBank->Prepare(i, 0, 0, &pCue);
+			if (FAILED(hr))
+			{
+				// E.g. out of cue instances, try again with the next Update
+				break;
+			}
+			definition.ppCues[definition.count++] = pCue;
+		}
+	}
+
+	return destroyedCount;
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Cues of a sound bank prepared ahead for SoundBank::PlayCue3D, up to a
+	// capacity per cue definition, and the cues played from it. XACT cannot
+	// play a cue again once it stopped, so Update destroys stopped cues and
+	// prepares new ones in their place.
+	//
+	// Guarded by Engine::syncRoot.
+	class CuePool
+	{
+		struct Definition
+		{
+			LONG capacity;
+			LONG count;
+			IXACT3Cue** ppCues;
+		};
+
+		IXACT3SoundBank* pSoundBank;
+		Definition* pDefinitions;
+		XACTINDEX definitionCount;
+
+		// Cues played and not yet seen stopped
+		IXACT3Cue** ppPlaying;
+		LONG playingCount;
+		LONG playingCapacity;
+
+		CuePool(const CuePool&);
+		CuePool& operator=(const CuePool&);
+
+	public:
+		CuePool(IXACT3SoundBank* pSoundBank, XACTINDEX cueCount);
+		// Destroys the prepared and the playing cues
+		~CuePool();
+
+		LONG GetCapacity(XACTINDEX cueIndex) const;
+		// Destroys the prepared cues above the capacity, Update prepares
+		// cues up to it
+		void SetCapacity(XACTINDEX cueIndex, LONG capacity);
+
+		// A prepared cue of the definition, NULL if none is left
+		IXACT3Cue* Take(XACTINDEX cueIndex);
+		// Keeps a cue played from the pool, or prepared because the pool was
+		// empty, to destroy it once it stopped
+		void AddPlaying(IXACT3Cue* pCue);
+
+		// Destroys the stopped cues and prepares cues until every definition
+		// is at its capacity. Returns the number of cues destroyed.
+		LONG Update();
+	};
+
+}}}
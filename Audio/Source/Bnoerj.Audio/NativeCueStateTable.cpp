@@ -0,0 +1,331 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeCueStateTable.h"
+
+using namespace Bnoerj::Audio::Native;
+
+static const LONG InitialChunkCapacity = 16;
+static const LONG InitialHashCapacity = 64;
+static const LONG InitialActiveCapacity = 64;
+
+namespace
+{
+	// States that change without a call on the cue, see Refresh
+	bool IsActive(DWORD state)
+	{
+		return state != XACT_CUESTATE_PREPARED && (state & XACT_CUESTATE_STOPPED) == 0;
+	}
+}
+
+CueStateTable::CueStateTable()
+	: ppChunks(new Slot*[InitialChunkCapacity])
+	, chunkCapacity(InitialChunkCapacity)
+	, chunkCount(0)
+	, retiredCount(0)
+	, slotCount(0)
+	, firstFree(-1)
+	, usedCount(0)
+	, pHash(new HashEntry[InitialHashCapacity])
+	, hashCapacity(InitialHashCapacity)
+	, hashCount(0)
+	, pActive(new LONG[InitialActiveCapacity])
+	, activeCount(0)
+	, activeCapacity(InitialActiveCapacity)
+{
+	ZeroMemory(ppChunks, InitialChunkCapacity * sizeof(Slot*));
+	ZeroMemory(pHash, InitialHashCapacity * sizeof(HashEntry));
+}
+
+CueStateTable::~CueStateTable()
+{
+	for (LONG i = 0; i < chunkCount; i++)
+	{
+		delete[] ppChunks[i];
+	}
+	delete[] ppChunks;
+	for (LONG i = 0; i < retiredCount; i++)
+	{
+		delete[] ppRetired[i];
+	}
+	delete[] pHash;
+	delete[] pActive;
+}
+
+LONG CueStateTable::Hash(IXACT3Cue* pCue, LONG capacity)
+{
+	// Cues are at least 16 byte aligned, multiplicative hash of the rest
+	UINT_PTR value = reinterpret_cast<UINT_PTR>(pCue) >> 4;
+	return static_cast<LONG>((static_cast<DWORD>(value) * 2654435761U) & static_cast<DWORD>(capacity - 1));
+}
+
+void CueStateTable::Insert(IXACT3Cue* pCue, LONG slot)
+{
+	if ((hashCount + 1) * 2 > hashCapacity)
+	{
+		HashEntry* pOld = pHash;
+		LONG oldCapacity = hashCapacity;
+		hashCapacity *= 2;
+		pHash = new HashEntry[hashCapacity];
+		ZeroMemory(pHash, hashCapacity * sizeof(HashEntry));
+		hashCount = 0;
+		for (LONG i = 0; i < oldCapacity; i++)
+		{
+			if (pOld[i].pCue != NULL)
+			{
+				Insert(pOld[i].pCue, pOld[i].slot);
+			}
+		}
+		delete[] pOld;
+	}
+
+	LONG mask = hashCapacity - 1;
+	LONG i = Hash(pCue, hashCapacity);
+	while (pHash[i].pCue != NULL)
+	{
+		i = (i + 1) & mask;
+	}
+	pHash[i].pCue = pCue;
+	pHash[i].slot = slot;
+	hashCount++;
+}
+
+LONG CueStateTable::Find(IXACT3Cue* pCue) const
+{
+	LONG mask = hashCapacity - 1;
+	for (LONG i = Hash(pCue, hashCapacity); pHash[i].pCue != NULL; i = (i + 1) & mask)
+	{
+		if (pHash[i].pCue == pCue)
+		{
+			return pHash[i].slot;
+		}
+	}
+	return -1;
+}
+
+void CueStateTable::Erase(IXACT3Cue* pCue)
+{
+	LONG mask = hashCapacity - 1;
+	LONG i = Hash(pCue, hashCapacity);
+	while (pHash[i].pCue != pCue)
+	{
+		if (pHash[i].pCue == NULL)
+		{
+			return;
+		}
+		i = (i + 1) & mask;
+	}
+
+	// Shift back the entries of the probe run that follow, so lookups
+	// need no tombstones
+	LONG hole = i;
+	for (LONG j = (i + 1) & mask; pHash[j].pCue != NULL; j = (j + 1) & mask)
+	{
+		LONG home = Hash(pHash[j].pCue, hashCapacity);
+		// Move the entry unless its home lies cyclically in (hole, j]
+		bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+		if (stays == false)
+		{
+			pHash[hole] = pHash[j];
+			hole = j;
+		}
+	}
+	pHash[hole].pCue = NULL;
+	hashCount--;
+}
+
+void CueStateTable::Detach(Slot& entry)
+{
+	Erase(entry.pCue);
+	entry.pCue = NULL;
+	entry.isDestroyed = true;
+	entry.state = XACT_CUESTATE_STOPPED;
+}
+
+void CueStateTable::Activate(LONG slot, DWORD state)
+{
+	Slot& entry = GetSlot(slot);
+	if (entry.isActive == true || IsActive(state) == false)
+	{
+		return;
+	}
+
+	if (activeCount == activeCapacity)
+	{
+		LONG* pOld = pActive;
+		pActive = new LONG[activeCapacity * 2];
+		CopyMemory(pActive, pOld, activeCount * sizeof(LONG));
+		activeCapacity *= 2;
+		delete[] pOld;
+	}
+	pActive[activeCount++] = slot;
+	entry.isActive = true;
+}
+
+LONG CueStateTable::Add(IXACT3Cue* pCue, IXACT3SoundBank* pSoundBank, DWORD state, LONG sequence)
+{
+	LONG slot = firstFree;
+	if (slot >= 0)
+	{
+		firstFree = GetSlot(slot).nextFree;
+	}
+	else
+	{
+		if (slotCount == chunkCount * ChunkSize)
+		{
+			if (chunkCount == chunkCapacity)
+			{
+				// GetState may be reading the old directory, which is kept
+				Slot** ppOld = ppChunks;
+				Slot** ppNew = new Slot*[chunkCapacity * 2];
+				ZeroMemory(ppNew, chunkCapacity * 2 * sizeof(Slot*));
+				CopyMemory(ppNew, ppOld, chunkCount * sizeof(Slot*));
+				::MemoryBarrier();
+				ppChunks = ppNew;
+				chunkCapacity *= 2;
+				ppRetired[retiredCount++] = ppOld;
+			}
+			Slot* pChunk = new Slot[ChunkSize];
+			ZeroMemory(pChunk, ChunkSize * sizeof(Slot));
+			ppChunks[chunkCount] = pChunk;
+			chunkCount++;
+		}
+		slot = slotCount++;
+	}
+
+	// A cue destroyed by XACT may still be in the hash if its notification
+	// was not dispatched yet, the new cue at its address replaces it
+	LONG previous = Find(pCue);
+	if (previous >= 0)
+	{
+		Detach(GetSlot(previous));
+	}
+
+	Slot& entry = GetSlot(slot);
+	entry.pCue = pCue;
+	entry.pSoundBank = pSoundBank;
+	entry.state = static_cast<LONG>(state);
+	entry.sequence = sequence;
+	entry.instance = -1;
+	entry.isDestroyed = false;
+	entry.nextFree = -1;
+	usedCount++;
+	Insert(pCue, slot);
+	Activate(slot, state);
+	return slot;
+}
+
+void CueStateTable::Remove(LONG slot)
+{
+	Slot& entry = GetSlot(slot);
+	if (entry.pCue != NULL)
+	{
+		Erase(entry.pCue);
+	}
+	entry.pCue = NULL;
+	entry.pSoundBank = NULL;
+	entry.instance = -1;
+	entry.nextFree = firstFree;
+	firstFree = slot;
+	usedCount--;
+}
+
+void CueStateTable::SetInstance(LONG slot, LONGLONG instance)
+{
+	GetSlot(slot).instance = instance;
+}
+
+bool CueStateTable::IsDestroyed(LONG slot) const
+{
+	return GetSlot(slot).isDestroyed;
+}
+
+LONGLONG CueStateTable::Destroyed(IXACT3Cue* pCue, LONG sequence)
+{
+	LONG slot = Find(pCue);
+	if (slot < 0)
+	{
+		return -1;
+	}
+
+	// Wraps like the sequence
+	Slot& entry = GetSlot(slot);
+	LONG age = sequence - entry.sequence;
+	if (age <= 0)
+	{
+		return -1;
+	}
+	Detach(entry);
+	return entry.instance;
+}
+
+void CueStateTable::SetState(LONG slot, DWORD state)
+{
+	GetSlot(slot).state = static_cast<LONG>(state);
+	Activate(slot, state);
+}
+
+void CueStateTable::UpdateState(IXACT3Cue* pCue)
+{
+	LONG slot = Find(pCue);
+	DWORD state;
+	if (slot >= 0 && SUCCEEDED(pCue->GetState(&state)))
+	{
+		SetState(slot, state);
+	}
+}
+
+void CueStateTable::Orphan(IXACT3SoundBank* pSoundBank)
+{
+	for (LONG i = 0; i < slotCount; i++)
+	{
+		Slot& entry = GetSlot(i);
+		if (entry.pSoundBank == pSoundBank && entry.pCue != NULL)
+		{
+			entry.isDestroyed = true;
+			entry.state = XACT_CUESTATE_STOPPED;
+		}
+	}
+}
+
+void CueStateTable::Refresh()
+{
+	for (LONG i = 0; i < activeCount;)
+	{
+		Slot& entry = GetSlot(pActive[i]);
+		if (entry.pCue != NULL && entry.isDestroyed == false)
+		{
+			// Keep the last state if the query fails
+			DWORD state;
+			if (SUCCEEDED(entry.pCue->GetState(&state)))
+			{
+				entry.state = static_cast<LONG>(state);
+			}
+			if (IsActive(static_cast<DWORD>(entry.state)) == true)
+			{
+				i++;
+				continue;
+			}
+		}
+
+		entry.isActive = false;
+		pActive[i] = pActive[--activeCount];
+	}
+}
+
+IXACT3Cue* CueStateTable::GetCue(LONG slot) const
+{
+	const Slot& entry = GetSlot(slot);
+	return entry.isDestroyed == false ? entry.pCue : NULL;
+}
+
+LONGLONG CueStateTable::GetInstance(LONG slot) const
+{
+	return GetSlot(slot).instance;
+}
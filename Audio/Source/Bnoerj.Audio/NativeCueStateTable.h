@@ -0,0 +1,137 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Last known state of the prepared cues of an engine. Engine::Update
+	// queries the state of the cues that may change state on their own,
+	// the Cue properties then read it without the lock. Slots live in
+	// chunks that never move, and outgrown chunk directories are kept until
+	// the table is deleted, so a slot can be read while other cues are
+	// added.
+	//
+	// Slots also map the cue pointers of destroyed notifications to the
+	// handle of the Bnoerj::Audio::Cue, see AudioInstanceTable, through an
+	// open addressing hash of the live cue pointers.
+	//
+	// Everything but GetState must be called with Engine::syncRoot held.
+	class CueStateTable
+	{
+		static const LONG ChunkShift = 8;
+		static const LONG ChunkSize = 1 << ChunkShift;
+		// Directories double from 16 chunks, a LONG slot needs at most 19
+		// of them retired
+		static const LONG MaxRetiredDirectories = 32;
+
+		struct Slot
+		{
+			// NULL for free slots and once the destroyed notification is in
+			IXACT3Cue* pCue;
+			IXACT3SoundBank* pSoundBank;
+			volatile LONG state;
+			// Notification sequence when the cue was prepared, see Native::Cue
+			LONG sequence;
+			// Handle of the managed cue, -1 until set
+			LONGLONG instance;
+			// Destroyed by XACT, no longer queried
+			bool isDestroyed;
+			// In the active list, see Refresh. Also while the slot is free,
+			// until Refresh drops it.
+			bool isActive;
+			// Next free slot while not used, -1 for none
+			LONG nextFree;
+		};
+
+		struct HashEntry
+		{
+			// NULL for empty entries
+			IXACT3Cue* pCue;
+			LONG slot;
+		};
+
+		Slot** volatile ppChunks;
+		LONG chunkCapacity;
+		LONG chunkCount;
+		Slot** ppRetired[MaxRetiredDirectories];
+		LONG retiredCount;
+		// Slots handed out at least once, used ones are all below
+		LONG slotCount;
+		LONG firstFree;
+		LONG usedCount;
+
+		// Power of two capacity, grown to keep it at most half full
+		HashEntry* pHash;
+		LONG hashCapacity;
+		LONG hashCount;
+
+		// Slots whose cue may change state without a call on it
+		LONG* pActive;
+		LONG activeCount;
+		LONG activeCapacity;
+
+		static LONG Hash(IXACT3Cue* pCue, LONG capacity);
+		void Insert(IXACT3Cue* pCue, LONG slot);
+		LONG Find(IXACT3Cue* pCue) const;
+		void Erase(IXACT3Cue* pCue);
+		// Drops a destroyed cue from the hash
+		void Detach(Slot& entry);
+		void Activate(LONG slot, DWORD state);
+
+		Slot& GetSlot(LONG slot) const
+		{
+			return ppChunks[slot >> ChunkShift][slot & (ChunkSize - 1)];
+		}
+
+		CueStateTable(const CueStateTable&);
+		CueStateTable& operator=(const CueStateTable&);
+
+	public:
+		CueStateTable();
+		~CueStateTable();
+
+		// Returns the slot of the cue, the table grows as needed
+		LONG Add(IXACT3Cue* pCue, IXACT3SoundBank* pSoundBank, DWORD state, LONG sequence);
+		void Remove(LONG slot);
+		void SetInstance(LONG slot, LONGLONG instance);
+		// True once XACT destroyed the cue, it must not be destroyed again
+		bool IsDestroyed(LONG slot) const;
+
+		// For a destroyed notification, returns the handle of the managed
+		// cue and detaches the slot. Returns -1 for cues not in the table
+		// and for notifications with a sequence up to the one of the slot,
+		// which are for an earlier cue at the same address.
+		LONGLONG Destroyed(IXACT3Cue* pCue, LONG sequence);
+
+		DWORD GetState(LONG slot) const
+		{
+			return GetSlot(slot).state;
+		}
+		void SetState(LONG slot, DWORD state);
+		// For calls executed from the command queue, which only have the
+		// cue. Cues not in the table are ignored.
+		void UpdateState(IXACT3Cue* pCue);
+
+		// XACT destroys the cues of a sound bank with it, they are no longer
+		// queried and read as stopped. Their destroyed notifications still
+		// find them.
+		void Orphan(IXACT3SoundBank* pSoundBank);
+		// Queries the state of the cues preparing, playing, stopping or
+		// paused. Prepared and stopped cues only change with a call on them,
+		// which sets their state.
+		void Refresh();
+
+		// For bulk queries, GetCue returns NULL for free slots and for
+		// destroyed cues
+		LONG GetSlotCount() const { return slotCount; }
+		LONG GetUsedCount() const { return usedCount; }
+		IXACT3Cue* GetCue(LONG slot) const;
+		LONGLONG GetInstance(LONG slot) const;
+	};
+
+}}}
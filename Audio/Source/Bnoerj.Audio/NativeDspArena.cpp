@@ -0,0 +1,123 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeDspArena.h
+
+#include <windows.h>
+#include <string.h>
+#pragma warning(push)
+#pragma warning(disable: 4793) // xact3wb.h(130): '__asm': causes native code generation for function 'void XACTWaveBank::SwapBytes(DWORD &)'
+#include <xact3.h>
+#pragma warning(pop)
+#include <xact3d3.h>
+
+#include "NativeDspArena.h"
+
+using namespace Bnoerj::Audio::Native;
+
+// Settings carved out of a slab at a time
+static const UINT BlocksPerSlab = 16;
+
+static UINT RoundUp(UINT size)
+{
+	return (size + 15) & ~15u;
+}
+
+// The settings come first, Free gets the block back from them. The delay
+// times and matrix coefficients follow the block.
+struct DspArena::Block
+{
+	X3DAUDIO_DSP_SETTINGS settings;
+	UINT sourceChannelCount;
+	Block* pNext;
+};
+
+struct DspArena::Slab
+{
+	Slab* pNext;
+};
+
+DspArena::DspArena(UINT destinationChannelCount)
+	: destinationChannelCount(destinationChannelCount)
+	, pSlabs(NULL)
+{
+	::memset(freeLists, 0, sizeof(freeLists));
+}
+
+DspArena::~DspArena()
+{
+	while (pSlabs != NULL)
+	{
+		Slab* pSlab = pSlabs;
+		pSlabs = pSlab->pNext;
+		delete[] reinterpret_cast<BYTE*>(pSlab);
+	}
+}
+
+X3DAUDIO_DSP_SETTINGS* DspArena::Allocate(UINT sourceChannelCount)
+{
+	if (sourceChannelCount == 0 || sourceChannelCount > MaxChannelCount)
+	{
+		return NULL;
+	}
+
+	ScopedLock scopedLock(&lock);
+
+	Block*& pFree = freeLists[sourceChannelCount - 1];
+	if (pFree == NULL)
+	{
+		UINT coefficientCount = sourceChannelCount * destinationChannelCount;
+		UINT headerSize = RoundUp(sizeof(Block));
+		UINT blockSize = headerSize + RoundUp((coefficientCount + sourceChannelCount) * sizeof(FLOAT32));
+		UINT slabHeaderSize = RoundUp(sizeof(Slab));
+		UINT slabSize = slabHeaderSize + BlocksPerSlab * blockSize;
+
+		// Zeroed, XACT3DCalculate leaves the delay times alone
+		BYTE* pMemory = new BYTE[slabSize];
+		::memset(pMemory, 0, slabSize);
+
+		Slab* pSlab = reinterpret_cast<Slab*>(pMemory);
+		pSlab->pNext = pSlabs;
+		pSlabs = pSlab;
+
+		for (UINT i = 0; i < BlocksPerSlab; i++)
+		{
+			BYTE* pBlockMemory = pMemory + slabHeaderSize + i * blockSize;
+			Block* pBlock = reinterpret_cast<Block*>(pBlockMemory);
+			FLOAT32* pData = reinterpret_cast<FLOAT32*>(pBlockMemory + headerSize);
+			pBlock->settings.pMatrixCoefficients = pData;
+			pBlock->settings.pDelayTimes = pData + coefficientCount;
+			pBlock->settings.SrcChannelCount = sourceChannelCount;
+			pBlock->settings.DstChannelCount = destinationChannelCount;
+			pBlock->sourceChannelCount = sourceChannelCount;
+			pBlock->pNext = pFree;
+			pFree = pBlock;
+		}
+	}
+
+	Block* pBlock = pFree;
+	pFree = pBlock->pNext;
+	pBlock->pNext = NULL;
+	return &pBlock->settings;
+}
+
+void DspArena::Free(X3DAUDIO_DSP_SETTINGS* pSettings)
+{
+	if (pSettings == NULL)
+	{
+		return;
+	}
+
+	Block* pBlock = reinterpret_cast<Block*>(pSettings);
+
+	ScopedLock scopedLock(&lock);
+
+	Block*& pFree = freeLists[pBlock->sourceChannelCount - 1];
+	pBlock->pNext = pFree;
+	pFree = pBlock;
+}
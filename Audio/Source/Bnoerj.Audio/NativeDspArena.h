@@ -0,0 +1,56 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeLock.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// DSP settings for XACT3DCalculate, each with its own delay times and
+	// matrix coefficients for SrcChannelCount by the final mix channels.
+	// Settings are carved out of slabs and kept on a free list per source
+	// channel count, so a 3D calculation takes its buffers without going to
+	// the heap once the first few have been handed out. Slabs are returned
+	// when the arena is deleted.
+	//
+	// Every 3D calculation works on settings of its own, calculations on
+	// different threads share nothing. Allocate and Free take a lock of
+	// their own and can be called from any thread.
+	class DspArena
+	{
+	public:
+		// Emitter channels, as for the final mix up to 7.1
+		static const UINT MaxChannelCount = 8;
+
+	private:
+		struct Block;
+		struct Slab;
+
+		UINT destinationChannelCount;
+		Block* freeLists[MaxChannelCount];
+		Slab* pSlabs;
+		CriticalSection lock;
+
+		DspArena(const DspArena&);
+		DspArena& operator=(const DspArena&);
+
+	public:
+		explicit DspArena(UINT destinationChannelCount);
+		~DspArena();
+
+		UINT GetDestinationChannelCount() const { return destinationChannelCount; }
+
+		// Settings for sourceChannelCount channels, with SrcChannelCount,
+		// DstChannelCount and the buffers set. NULL for counts of zero or
+		// above MaxChannelCount.
+		X3DAUDIO_DSP_SETTINGS* Allocate(UINT sourceChannelCount);
+		// Takes back settings from Allocate, NULL is ignored
+		void Free(X3DAUDIO_DSP_SETTINGS* pSettings);
+	};
+
+}}}
@@ -0,0 +1,370 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeEmitterStore.h
+
+#include <windows.h>
+#include <malloc.h>
+#include <string.h>
+#pragma warning(push)
+#pragma warning(disable: 4793) // xact3wb.h(130): '__asm': causes native code generation for function 'void XACTWaveBank::SwapBytes(DWORD &)'
+#include <xact3.h>
+#pragma warning(pop)
+#include <xact3d3.h>
+
+#include "NativeEmitterStore.h"
+
+using namespace Bnoerj::Audio::Native;
+
+// Slots of a typical scene, doubled whenever the store is full. A multiple
+// of four keeps every field array 16 byte aligned.
+static const LONG InitialCapacity = 64;
+
+static const LONG SlotInUse = -2;
+
+EmitterStore::EmitterStore()
+	: pFields(NULL)
+	, pGenerations(NULL)
+	, pChannelCounts(NULL)
+	, pAzimuths(NULL)
+	, pHasAzimuths(NULL)
+	, pNextFree(NULL)
+	, firstFree(-1)
+	, capacity(0)
+	, count(0)
+	, index(DefaultAudibleRadius)
+{
+}
+
+EmitterStore::~EmitterStore()
+{
+	::_aligned_free(pFields);
+	delete[] pGenerations;
+	delete[] pChannelCounts;
+	delete[] pAzimuths;
+	delete[] pHasAzimuths;
+	delete[] pNextFree;
+}
+
+void EmitterStore::Grow()
+{
+	LONG newCapacity = capacity > 0 ? capacity * 2 : InitialCapacity;
+
+	float* pNewFields = static_cast<float*>(::_aligned_malloc(FieldCount * newCapacity * sizeof(float), 16));
+	LONGLONG* pNewGenerations = new LONGLONG[newCapacity];
+	UINT* pNewChannelCounts = new UINT[newCapacity];
+	FLOAT32* pNewAzimuths = new FLOAT32[newCapacity * MaxChannelCount];
+	bool* pNewHasAzimuths = new bool[newCapacity];
+	LONG* pNewNextFree = new LONG[newCapacity];
+
+	if (capacity > 0)
+	{
+		for (int field = 0; field < FieldCount; field++)
+		{
+			::memcpy(pNewFields + field * newCapacity, pFields + field * capacity, capacity * sizeof(float));
+		}
+		::memcpy(pNewGenerations, pGenerations, capacity * sizeof(LONGLONG));
+		::memcpy(pNewChannelCounts, pChannelCounts, capacity * sizeof(UINT));
+		::memcpy(pNewAzimuths, pAzimuths, capacity * MaxChannelCount * sizeof(FLOAT32));
+		::memcpy(pNewHasAzimuths, pHasAzimuths, capacity * sizeof(bool));
+		::memcpy(pNewNextFree, pNextFree, capacity * sizeof(LONG));
+	}
+
+	::_aligned_free(pFields);
+	delete[] pGenerations;
+	delete[] pChannelCounts;
+	delete[] pAzimuths;
+	delete[] pHasAzimuths;
+	delete[] pNextFree;
+
+	pFields = pNewFields;
+	pGenerations = pNewGenerations;
+	pChannelCounts = pNewChannelCounts;
+	pAzimuths = pNewAzimuths;
+	pHasAzimuths = pNewHasAzimuths;
+	pNextFree = pNewNextFree;
+
+	// The new slots go to the free list lowest first
+	for (LONG slot = newCapacity - 1; slot >= capacity; slot--)
+	{
+		pNextFree[slot] = firstFree;
+		firstFree = slot;
+	}
+	capacity = newCapacity;
+}
+
+LONG EmitterStore::Add()
+{
+	ScopedLock scopedLock(&lock);
+
+	if (firstFree < 0)
+	{
+		Grow();
+	}
+
+	LONG slot = firstFree;
+	firstFree = pNextFree[slot];
+	pNextFree[slot] = SlotInUse;
+	count++;
+
+	for (int field = 0; field < FieldCount; field++)
+	{
+		GetFieldArray(static_cast<Field>(field))[slot] = 0;
+	}
+
+	// XNA's forward is -z, which is +z in the X3DAudio space
+	GetFieldArray(FieldFrontZ)[slot] = 1;
+	GetFieldArray(FieldTopY)[slot] = 1;
+	GetFieldArray(FieldTrackedFrontZ)[slot] = 1;
+	GetFieldArray(FieldTrackedTopY)[slot] = 1;
+	GetFieldArray(FieldDopplerScaler)[slot] = 1;
+	GetFieldArray(FieldChannelRadius)[slot] = 1;
+
+	pGenerations[slot] = 1;
+	pChannelCounts[slot] = 1;
+	pHasAzimuths[slot] = false;
+	index.Insert(slot, 0, 0, 0, DefaultAudibleRadius);
+	return slot;
+}
+
+void EmitterStore::Remove(LONG slot)
+{
+	ScopedLock scopedLock(&lock);
+
+	if (slot < 0 || slot >= capacity || pNextFree[slot] != SlotInUse)
+	{
+		return;
+	}
+
+	pNextFree[slot] = firstFree;
+	firstFree = slot;
+	count--;
+	index.Remove(slot);
+}
+
+void EmitterStore::StoreVector(LONG slot, Field first, float x, float y, float z)
+{
+	z = -z;
+
+	float* pX = GetFieldArray(first);
+	float* pY = GetFieldArray(static_cast<Field>(first + 1));
+	float* pZ = GetFieldArray(static_cast<Field>(first + 2));
+
+	if (first == FieldVelocityX)
+	{
+		// Any change moves the doppler shift
+		if (x != pX[slot] || y != pY[slot] || z != pZ[slot])
+		{
+			pGenerations[slot]++;
+		}
+	}
+	else
+	{
+		// Position, front and top have their tracked values in the same order
+		Field tracked = static_cast<Field>(FieldTrackedPositionX + (first - FieldPositionX));
+		float* pTrackedX = GetFieldArray(tracked);
+		float* pTrackedY = GetFieldArray(static_cast<Field>(tracked + 1));
+		float* pTrackedZ = GetFieldArray(static_cast<Field>(tracked + 2));
+		float epsilon = GetFieldArray(first == FieldPositionX ? FieldPositionEpsilon : FieldOrientationEpsilon)[slot];
+
+		float dx = x - pTrackedX[slot];
+		float dy = y - pTrackedY[slot];
+		float dz = z - pTrackedZ[slot];
+		if (dx * dx + dy * dy + dz * dz > epsilon * epsilon)
+		{
+			pTrackedX[slot] = x;
+			pTrackedY[slot] = y;
+			pTrackedZ[slot] = z;
+			pGenerations[slot]++;
+		}
+	}
+
+	pX[slot] = x;
+	pY[slot] = y;
+	pZ[slot] = z;
+
+	if (first == FieldPositionX)
+	{
+		index.Move(slot, x, y, z);
+	}
+}
+
+LONG EmitterStore::GetCount() const
+{
+	ScopedLock scopedLock(&lock);
+	return count;
+}
+
+LONG EmitterStore::GetCapacity() const
+{
+	ScopedLock scopedLock(&lock);
+	return capacity;
+}
+
+LONGLONG EmitterStore::GetGeneration(LONG slot) const
+{
+	ScopedLock scopedLock(&lock);
+	return pGenerations[slot];
+}
+
+float EmitterStore::Get(Field field, LONG slot) const
+{
+	ScopedLock scopedLock(&lock);
+	return GetFieldArray(field)[slot];
+}
+
+void EmitterStore::Set(Field field, LONG slot, float value)
+{
+	ScopedLock scopedLock(&lock);
+
+	float* pValues = GetFieldArray(field);
+	if ((field == FieldDopplerScaler || field == FieldChannelRadius) && value != pValues[slot])
+	{
+		pGenerations[slot]++;
+	}
+	pValues[slot] = value;
+}
+
+void EmitterStore::GetVector(LONG slot, Field first, float* pXyz) const
+{
+	ScopedLock scopedLock(&lock);
+
+	pXyz[0] = GetFieldArray(first)[slot];
+	pXyz[1] = GetFieldArray(static_cast<Field>(first + 1))[slot];
+	pXyz[2] = -GetFieldArray(static_cast<Field>(first + 2))[slot];
+}
+
+void EmitterStore::SetVector(LONG slot, Field first, const float* pXyz)
+{
+	ScopedLock scopedLock(&lock);
+
+	StoreVector(slot, first, pXyz[0], pXyz[1], pXyz[2]);
+}
+
+void EmitterStore::SetVectors(Field first, const LONG* pSlots, const float* pXyz, LONG slotCount)
+{
+	ScopedLock scopedLock(&lock);
+
+	for (LONG i = 0; i < slotCount; i++)
+	{
+		StoreVector(pSlots[i], first, pXyz[0], pXyz[1], pXyz[2]);
+		pXyz += 3;
+	}
+}
+
+UINT EmitterStore::GetChannelCount(LONG slot) const
+{
+	ScopedLock scopedLock(&lock);
+	return pChannelCounts[slot];
+}
+
+void EmitterStore::SetChannelCount(LONG slot, UINT channelCount)
+{
+	ScopedLock scopedLock(&lock);
+
+	if (channelCount != pChannelCounts[slot])
+	{
+		pChannelCounts[slot] = channelCount;
+		pHasAzimuths[slot] = false;
+		pGenerations[slot]++;
+	}
+}
+
+bool EmitterStore::GetChannelAzimuths(LONG slot, FLOAT32* pChannelAzimuths, UINT* pChannelCount) const
+{
+	ScopedLock scopedLock(&lock);
+
+	*pChannelCount = pChannelCounts[slot];
+	if (pHasAzimuths[slot] == false)
+	{
+		return false;
+	}
+	::memcpy(pChannelAzimuths, pAzimuths + slot * MaxChannelCount, pChannelCounts[slot] * sizeof(FLOAT32));
+	return true;
+}
+
+bool EmitterStore::SetChannelAzimuths(LONG slot, const FLOAT32* pChannelAzimuths, UINT channelCount)
+{
+	ScopedLock scopedLock(&lock);
+
+	if (pChannelAzimuths != NULL)
+	{
+		if (channelCount != pChannelCounts[slot])
+		{
+			return false;
+		}
+		::memcpy(pAzimuths + slot * MaxChannelCount, pChannelAzimuths, channelCount * sizeof(FLOAT32));
+	}
+	pHasAzimuths[slot] = pChannelAzimuths != NULL;
+	pGenerations[slot]++;
+	return true;
+}
+
+float EmitterStore::GetAudibleRadius(LONG slot) const
+{
+	ScopedLock scopedLock(&lock);
+	return index.GetRadius(slot);
+}
+
+void EmitterStore::SetAudibleRadius(LONG slot, float radius)
+{
+	ScopedLock scopedLock(&lock);
+
+	index.SetRadius(slot, radius);
+}
+
+float EmitterStore::GetCellSize() const
+{
+	ScopedLock scopedLock(&lock);
+	return index.GetCellSize();
+}
+
+void EmitterStore::SetCellSize(float cellSize)
+{
+	ScopedLock scopedLock(&lock);
+
+	index.SetCellSize(cellSize);
+}
+
+LONG EmitterStore::QueryAudible(const X3DAUDIO_VECTOR& position, float maxDistance, LONG maxCount,
+	int32* pSlots, float* pRelativeDistances)
+{
+	ScopedLock scopedLock(&lock);
+	return static_cast<LONG>(index.Query(position.x, position.y, position.z, maxDistance,
+		static_cast<uint32>(maxCount), pSlots, pRelativeDistances));
+}
+
+void EmitterStore::GetEmitter(LONG slot, X3DAUDIO_EMITTER* pEmitter, FLOAT32* pChannelAzimuths) const
+{
+	ScopedLock scopedLock(&lock);
+
+	ZeroMemory(pEmitter, sizeof(X3DAUDIO_EMITTER));
+
+	pEmitter->OrientFront.x = GetFieldArray(FieldFrontX)[slot];
+	pEmitter->OrientFront.y = GetFieldArray(FieldFrontY)[slot];
+	pEmitter->OrientFront.z = GetFieldArray(FieldFrontZ)[slot];
+	pEmitter->OrientTop.x = GetFieldArray(FieldTopX)[slot];
+	pEmitter->OrientTop.y = GetFieldArray(FieldTopY)[slot];
+	pEmitter->OrientTop.z = GetFieldArray(FieldTopZ)[slot];
+	pEmitter->Position.x = GetFieldArray(FieldPositionX)[slot];
+	pEmitter->Position.y = GetFieldArray(FieldPositionY)[slot];
+	pEmitter->Position.z = GetFieldArray(FieldPositionZ)[slot];
+	pEmitter->Velocity.x = GetFieldArray(FieldVelocityX)[slot];
+	pEmitter->Velocity.y = GetFieldArray(FieldVelocityY)[slot];
+	pEmitter->Velocity.z = GetFieldArray(FieldVelocityZ)[slot];
+	pEmitter->DopplerScaler = GetFieldArray(FieldDopplerScaler)[slot];
+	pEmitter->ChannelRadius = GetFieldArray(FieldChannelRadius)[slot];
+	pEmitter->ChannelCount = pChannelCounts[slot];
+	pEmitter->CurveDistanceScaler = 1;
+
+	if (pHasAzimuths[slot] == true)
+	{
+		::memcpy(pChannelAzimuths, pAzimuths + slot * MaxChannelCount, pChannelCounts[slot] * sizeof(FLOAT32));
+		pEmitter->pChannelAzimuths = pChannelAzimuths;
+	}
+}
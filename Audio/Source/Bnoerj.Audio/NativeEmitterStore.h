@@ -0,0 +1,152 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeLock.h"
+#include "NativeSpatialIndex.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// World units, the audible radius of new emitters and the cell size of
+	// a new store
+	const float DefaultAudibleRadius = 100;
+
+	// The emitters AudioEngine::CreateEmitter hands out, kept by the engine
+	// as a structure of arrays. Every field is an array of floats indexed
+	// by slot, 16 byte aligned, so bulk updates and the 3D calculation walk
+	// memory in order. Vectors are kept in the left handed X3DAudio space,
+	// the setters take XNA vectors and negate z.
+	//
+	// Every slot has a generation, bumped by the setters as AudioEmitter
+	// does for emitters of their own: when a position or orientation moved
+	// further than its epsilon from the value tracked at the last bump,
+	// and on any other change.
+	//
+	// The positions are also kept in a SpatialIndex, updated as they are
+	// set, with the audible radius of every slot, to find the emitters a
+	// listener can hear without looking at all of them.
+	//
+	// Every member takes the lock of the store, so emitters can be set and
+	// read on any thread while others are added, removed, queried or grown
+	// into new arrays. Callers holding GetLock across several calls see
+	// them as one, as AudioEngine::CreateEmitter does to add a slot and
+	// record its emitter. Compiled without /clr.
+	class EmitterStore
+	{
+	public:
+		static const UINT MaxChannelCount = 8;
+
+		enum Field
+		{
+			FieldPositionX,
+			FieldPositionY,
+			FieldPositionZ,
+			FieldFrontX,
+			FieldFrontY,
+			FieldFrontZ,
+			FieldTopX,
+			FieldTopY,
+			FieldTopZ,
+			FieldVelocityX,
+			FieldVelocityY,
+			FieldVelocityZ,
+			FieldDopplerScaler,
+			FieldChannelRadius,
+			FieldPositionEpsilon,
+			FieldOrientationEpsilon,
+			// Values as of the last generation
+			FieldTrackedPositionX,
+			FieldTrackedPositionY,
+			FieldTrackedPositionZ,
+			FieldTrackedFrontX,
+			FieldTrackedFrontY,
+			FieldTrackedFrontZ,
+			FieldTrackedTopX,
+			FieldTrackedTopY,
+			FieldTrackedTopZ,
+			FieldCount,
+		};
+
+	private:
+		float* pFields;
+		LONGLONG* pGenerations;
+		UINT* pChannelCounts;
+		// MaxChannelCount per slot, used while pHasAzimuths is set
+		FLOAT32* pAzimuths;
+		bool* pHasAzimuths;
+		// Free list through the free slots, ended by -1, -2 for slots in
+		// use
+		LONG* pNextFree;
+		LONG firstFree;
+		LONG capacity;
+		LONG count;
+		SpatialIndex index;
+		mutable CriticalSection lock;
+
+		float* GetFieldArray(Field field) const { return pFields + field * capacity; }
+		void Grow();
+		// Stores the XNA vector at first, z negated, and bumps the
+		// generation as the field asks for
+		void StoreVector(LONG slot, Field first, float x, float y, float z);
+
+		EmitterStore(const EmitterStore&);
+		EmitterStore& operator=(const EmitterStore&);
+
+	public:
+		EmitterStore();
+		~EmitterStore();
+
+		// A slot with the defaults of a new AudioEmitter
+		LONG Add();
+		void Remove(LONG slot);
+		// Recursive, see the class comment
+		CriticalSection* GetLock() const { return &lock; }
+		// Slots in use
+		LONG GetCount() const;
+		// Slots, in use or not, the field arrays hold
+		LONG GetCapacity() const;
+
+		LONGLONG GetGeneration(LONG slot) const;
+
+		float Get(Field field, LONG slot) const;
+		// For the scalars. Bumps the generation when the doppler scaler or
+		// channel radius changes, not for the epsilons.
+		void Set(Field field, LONG slot, float value);
+
+		// first is FieldPositionX, FieldFrontX, FieldTopX or FieldVelocityX,
+		// pXyz an XNA vector
+		void GetVector(LONG slot, Field first, float* pXyz) const;
+		void SetVector(LONG slot, Field first, const float* pXyz);
+		// pXyz holds count XNA vectors, one for each slot in pSlots
+		void SetVectors(Field first, const LONG* pSlots, const float* pXyz, LONG count);
+
+		UINT GetChannelCount(LONG slot) const;
+		// Drops the channel azimuths when the count changes
+		void SetChannelCount(LONG slot, UINT channelCount);
+		// Copies the azimuths to pChannelAzimuths, which holds
+		// MaxChannelCount, and their count. False for the default layout.
+		bool GetChannelAzimuths(LONG slot, FLOAT32* pChannelAzimuths, UINT* pChannelCount) const;
+		// NULL for the default layout. False if channelCount no longer is
+		// the channel count of the slot.
+		bool SetChannelAzimuths(LONG slot, const FLOAT32* pChannelAzimuths, UINT channelCount);
+
+		float GetAudibleRadius(LONG slot) const;
+		void SetAudibleRadius(LONG slot, float radius);
+		float GetCellSize() const;
+		void SetCellSize(float cellSize);
+		// The slots audible at the position in the X3DAudio space, see
+		// SpatialIndex::Query
+		LONG QueryAudible(const X3DAUDIO_VECTOR& position, float maxDistance, LONG maxCount,
+			int32* pSlots, float* pRelativeDistances);
+
+		// The emitter as XACT3DCalculate takes it. Azimuths are copied to
+		// pChannelAzimuths, which holds MaxChannelCount.
+		void GetEmitter(LONG slot, X3DAUDIO_EMITTER* pEmitter, FLOAT32* pChannelAzimuths) const;
+	};
+
+}}}
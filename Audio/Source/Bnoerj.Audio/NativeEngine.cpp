@@ -1,320 +1,997 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "NativeEngine.h"
-#include "NativeHelpers.h"
-#include "ErrorToException.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio::Native;
-using namespace Bnoerj::Native::Helpers;
-
-//-----------------------------------------------------------------------------------------
-// This is the callback for handling XACT notifications.  This callback can be executed on a
-// different thread than the app thread so shared data must be thread safe.  The game
-// also needs to minimize the amount of time spent in this callbacks to avoid glitching,
-// and a limited subset of XACT API can be called from inside the callback so
-// it is sometimes necessary to handle the notification outside of this callback.
-//-----------------------------------------------------------------------------------------
-void WINAPI XACTNotificationCallback(const XACT_NOTIFICATION* pNotification)
-{
-	// Use the critical section properly to make shared data thread safe while avoiding deadlocks.  
-	//
-	// To do this follow this advice:
-	// 1) Use a specific CS only to protect the specific shared data structures between the callback and the app thread.
-	// 2) Dont make any API calls while holding the CS. Use it to access the shared data, make a local copy of the data, release the CS and then make the API call.
-	// 3) Spend minimal amount of time in the CS (to prevent the callback thread from waiting too long causing a glitch).   
-	// 
-	// Instead of using a CS, you can also use a non-blocking queues to keep track of notifications meaning 
-	// callback will push never pop only push and the app thread will only pop never push
-
-	if (pNotification->type == XACTNOTIFICATIONTYPE_CUEDESTROYED)
-	{
-		msclr::lock lock(Engine::syncRoot);
-
-		Engine::CueDestroyed(IntPtr(pNotification->cue.pCue));
-	}
-}
-
-Engine::Engine(String^ settingsFilename, unsigned int lookAheadTime, Guid rendererId)
-	: AudioObject()
-	, p3DAudioData(NULL)
-	, pDsp(NULL)
-	, pDelayTimes(NULL)
-	, pMatrixCoefficients(NULL)
-{
-    // Enable run-time memory check for debug builds.
-#if defined(DEBUG) | defined(_DEBUG) | defined(CHECKED_BUILD)
-	::_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
-#endif
-
-	//
-	// Create the XACT3 engine
-	//
-
-	HRESULT hr;
-	{
-		DWORD dwCreationFlags = 0;
-#if defined(DEBUG) | defined(_DEBUG) | defined(CHECKED_BUILD)
-	    dwCreationFlags |= XACT_FLAG_API_DEBUG_MODE;
-#endif
-		IXACT3Engine* pEngine = NULL;
-		HRESULT hr = ::XACT3CreateEngine(dwCreationFlags, &pEngine);
-		if (FAILED(hr) || pEngine == NULL)
-		{
-			ErrorToException::Throw(hr);
-		}
-		this->pEngine = pEngine;
-	}
-
-	//
-	// Get sttings data
-	//
-
-	array<Byte>^ aData = File::ReadAllBytes(settingsFilename);
-	if (aData != nullptr && aData->Length > 0)
-	{
-		pin_ptr<Byte> pSettings = &aData[0];
-		pData = new BYTE[aData->Length];
-		memcpy_s(pData, aData->Length, pSettings, aData->Length);
-	}
-
-	//
-	// Initialize XACT
-	//
-
-	XACT_RUNTIME_PARAMETERS xactRtParams = { 0 };
-	xactRtParams.lookAheadTime = lookAheadTime;
-	if (pData != NULL && aData->Length > 0)
-	{
-		xactRtParams.pGlobalSettingsBuffer = pData;
-		xactRtParams.globalSettingsBufferSize = aData->Length;
-	}
-	xactRtParams.fnNotificationCallback = XACTNotificationCallback;
-	if (rendererId != Guid::Empty)
-	{
-		xactRtParams.pRendererID = StringConverter::ToNativeStringUni(rendererId.ToString("B"));
-	}
-    hr = pEngine->Initialize(&xactRtParams);
-    if (FAILED(hr))
-	{
-		pEngine->Release();
-		delete[] pData;
-        ErrorToException::Throw(hr);
-	}
-
-	// Get the number of channels on the final mix
-	WAVEFORMATEXTENSIBLE wfxFinalMixFormat;
-	hr = pEngine->GetFinalMixFormat(&wfxFinalMixFormat);
-	if (FAILED(hr))
-	{
-		pEngine->Release();
-		delete[] pData;
-		ErrorToException::Throw(hr);
-	}
-	destinationChannelCount = wfxFinalMixFormat.Format.nChannels;
-
-	//
-	// Register for XACT notifications
-	//
-
-	XACT_NOTIFICATION_DESCRIPTION desc = {0};
-	// Use "cue destroyed" notification to cleanup the managed cues
-	desc.flags = XACT_FLAG_NOTIFICATION_PERSIST;
-	desc.type = XACTNOTIFICATIONTYPE_CUEDESTROYED;
-	desc.cueIndex = XACTINDEX_INVALID;
-	pEngine->RegisterNotification(&desc);
-
-	//
-	// Initialize 3D audio
-	//
-
-	X3DAUDIO_HANDLE h3DAudio;
-	hr = ::XACT3DInitialize(pEngine, h3DAudio);
-	if (FAILED(hr))
-	{
-		pEngine->Release();
-		delete[] pData;
-		ErrorToException::Throw(hr);
-	}
-
-	p3DAudioData = new BYTE[X3DAUDIO_HANDLE_BYTESIZE];
-	memcpy_s(p3DAudioData, X3DAUDIO_HANDLE_BYTESIZE, h3DAudio, X3DAUDIO_HANDLE_BYTESIZE);
-
-	pDelayTimes = new FLOAT32[2];
-	::memset(pDelayTimes, 0, 2 * sizeof(FLOAT32));
-
-	// Alloc coefficients for 7.1
-	pMatrixCoefficients = new FLOAT32[2 * 8];
-	::memset(pMatrixCoefficients, 0, 2 * 8 * sizeof(FLOAT32));
-}
-
-void Engine::Release()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	pEngine->ShutDown();
-	pEngine->Release();
-
-	delete[] pData;
-	pData = NULL;
-
-	delete p3DAudioData;
-	p3DAudioData = NULL;
-
-	delete pDsp;
-	pDsp = NULL;
-
-	delete[] pDelayTimes;
-	pDelayTimes = NULL;
-
-	delete[] pMatrixCoefficients;
-	pMatrixCoefficients = NULL;
-}
-
-int Engine::GetRendererCount()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	XACTINDEX count = 0;
-	pEngine->GetRendererCount(&count);
-
-	return count;
-}
-
-void Engine::GetRendererDetail(int index, String^% friendlyName, String^% guid)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	XACT_RENDERER_DETAILS rendererDetails = { 0 };
-	pEngine->GetRendererDetails((XACTINDEX)index, &rendererDetails);
-	friendlyName = StringConverter::ToString(rendererDetails.displayName);
-	guid = StringConverter::ToString(rendererDetails.rendererID);
-}
-
-float Engine::GetGlobalVariable(String^ name)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTVARIABLEINDEX index = pEngine->GetGlobalVariableIndex(pName);
-	if (index == XACTVARIABLEINDEX_INVALID)
-	{
-		//ErrorToException::Throw(hr);
-		return 0.0f;
-	}
-
-	XACTVARIABLEVALUE varValue;
-	HRESULT hr = pEngine->GetGlobalVariable(index, &varValue);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-
-	return varValue;
-}
-
-void Engine::SetGlobalVariable(String^ name, float value)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTVARIABLEINDEX index = pEngine->GetGlobalVariableIndex(pName);
-	if (index == XACTVARIABLEINDEX_INVALID)
-	{
-		//ErrorToException::Throw(hr);
-		return;
-	}
-
-	XACTVARIABLEVALUE varValue = value;
-	HRESULT hr = pEngine->SetGlobalVariable(index, varValue);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-XACTCATEGORY Engine::GetCategory(String^ name)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTCATEGORY category = pEngine->GetCategory(pName);
-	if (category == XACTCATEGORY_INVALID)
-	{
-		throw gcnew InvalidOperationException(StringResources::CouldNotCreateResource);
-	}
-
-	return category;
-}
-
-void Engine::Update()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	pEngine->DoWork();
-}
-
-void Engine::Pause(XACTCATEGORY cateorgy, BOOL pause)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	HRESULT hr = pEngine->Pause(cateorgy, pause);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-void Engine::Stop(XACTCATEGORY cateorgy, DWORD options)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	HRESULT hr = pEngine->Stop(cateorgy, options);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-void Engine::SetVolume(XACTCATEGORY cateorgy, float volume)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	HRESULT hr = pEngine->SetVolume(cateorgy, volume);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-}
-
-void Engine::Apply3D(IXACT3Cue* pCue, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	if (pDsp == NULL)
-	{
-		pDsp = new X3DAUDIO_DSP_SETTINGS();
-		ZeroMemory(pDsp, sizeof(X3DAUDIO_DSP_SETTINGS));
-	}
-
-	if (pDsp->pDelayTimes != pDelayTimes || destinationChannelCount != pDsp->DstChannelCount)
-	{
-		pDsp->pMatrixCoefficients = pMatrixCoefficients;
-		pDsp->pDelayTimes = pDelayTimes;
-		pDsp->SrcChannelCount = 2;
-		pDsp->DstChannelCount = destinationChannelCount;
-	}
-
-	HRESULT hr = ::XACT3DCalculate(p3DAudioData, pListener, pEmitter, pDsp);
-	if (SUCCEEDED(hr))
-	{
-		::XACT3DApply(pDsp, pCue);
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeEngine.h"
+#include "NativeSoundBank.h"
+#include "NativeGlobalSettingsFile.h"
+#include "NativeHelpers.h"
+#include "NativeStreamReader.h"
+#include "ErrorToException.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio::Native;
+using namespace Bnoerj::Native::Helpers;
+
+// Entries calculated by a thread at a time in Apply3DBatch
+static const LONG Calculate3DChunkSize = 32;
+
+// Incremented for every cue destroyed by any engine, see Notification
+static volatile LONG notificationSequence = 0;
+
+//-----------------------------------------------------------------------------------------
+// This is the callback for handling XACT notifications.  This callback can be executed on a
+// different thread than the app thread so shared data must be thread safe.  The game
+// also needs to minimize the amount of time spent in this callbacks to avoid glitching,
+// and a limited subset of XACT API can be called from inside the callback so
+// it is sometimes necessary to handle the notification outside of this callback.
+//-----------------------------------------------------------------------------------------
+void WINAPI XACTNotificationCallback(const XACT_NOTIFICATION* pNotification)
+{
+	// Use the critical section properly to make shared data thread safe while avoiding deadlocks.  
+	//
+	// To do this follow this advice:
+	// 1) Use a specific CS only to protect the specific shared data structures between the callback and the app thread.
+	// 2) Dont make any API calls while holding the CS. Use it to access the shared data, make a local copy of the data, release the CS and then make the API call.
+	// 3) Spend minimal amount of time in the CS (to prevent the callback thread from waiting too long causing a glitch).   
+	// 
+	// Instead of using a CS, you can also use a non-blocking queues to keep track of notifications meaning 
+	// callback will push never pop only push and the app thread will only pop never push
+
+	if (pNotification->type == XACTNOTIFICATIONTYPE_CUEDESTROYED)
+	{
+		NotificationQueue* pQueue = static_cast<NotificationQueue*>(pNotification->pvContext);
+
+		Notification notification;
+		notification.pCue = pNotification->cue.pCue;
+		notification.sequence = ::InterlockedIncrement(&notificationSequence);
+		notification.instance = -1;
+		if (pQueue->notifications.Push(notification) == false)
+		{
+			::InterlockedIncrement(&pQueue->droppedCount);
+		}
+	}
+}
+
+Engine::Engine(FileMapping* pSettingsMapping, unsigned int lookAheadTime, Guid rendererId)
+	: AudioObject()
+	, p3DAudioData(NULL)
+	, pDspArena(NULL)
+	, pSpatializer(NULL)
+	, calculate3DChunkCount(0)
+	, calculate3DNextChunk(0)
+	, calculate3DPendingWorkers(0)
+	, pCommands(NULL)
+	, pNotifications(NULL)
+	, pPendingNotifications(NULL)
+	, serviceThread(nullptr)
+	, hServiceStopEvent(NULL)
+	, servicePeriodMicroseconds(0)
+	, hasSettingsTables(false)
+	, deferCommands(false)
+	, pStatistics(NULL)
+	, pCueStates(NULL)
+	, pSpatializerLock(NULL)
+	, pEmitterStore(NULL)
+{
+    // Enable run-time memory check for debug builds.
+#if defined(DEBUG) | defined(_DEBUG) | defined(CHECKED_BUILD)
+	::_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	//
+	// Create the XACT3 engine
+	//
+
+	HRESULT hr;
+	{
+		DWORD dwCreationFlags = 0;
+#if defined(DEBUG) | defined(_DEBUG) | defined(CHECKED_BUILD)
+	    dwCreationFlags |= XACT_FLAG_API_DEBUG_MODE;
+#endif
+		IXACT3Engine* pEngine = NULL;
+		HRESULT hr = ::XACT3CreateEngine(dwCreationFlags, &pEngine);
+		if (FAILED(hr) || pEngine == NULL)
+		{
+			delete pSettingsMapping;
+			ErrorToException::Throw(hr);
+		}
+		this->pEngine = pEngine;
+	}
+
+	// XACT may write to the settings, pages written become private
+	pMapping = pSettingsMapping;
+
+	// Read the names before XACT gets to write to the settings
+	categoryIndices = gcnew Dictionary<String^, XACTCATEGORY>(StringComparer::Ordinal);
+	globalVariableIndices = gcnew Dictionary<String^, XACTVARIABLEINDEX>(StringComparer::Ordinal);
+	hasSettingsTables = BuildSettingsTables();
+
+	cuePools = gcnew List<SoundBank^>();
+
+	//
+	// Initialize XACT
+	//
+
+	XACT_RUNTIME_PARAMETERS xactRtParams = { 0 };
+	xactRtParams.lookAheadTime = lookAheadTime;
+	if (pMapping->IsOpen() == true)
+	{
+		xactRtParams.pGlobalSettingsBuffer = pMapping->GetData();
+		xactRtParams.globalSettingsBufferSize = static_cast<DWORD>(pMapping->GetSize());
+	}
+	xactRtParams.fnNotificationCallback = XACTNotificationCallback;
+	// Streaming wave banks are read through the shared scheduler, see
+	// WaveBank. Without a reader the callbacks read files directly.
+	StreamReader::Acquire();
+	xactRtParams.fileIOCallbacks.readFileCallback = StreamReader::ReadFile;
+	xactRtParams.fileIOCallbacks.getOverlappedResultCallback = StreamReader::GetOverlappedResult;
+	pNotifications = new NotificationQueue();
+	NativeStringUni nativeRendererId(rendererId.ToString("B"));
+	if (rendererId != Guid::Empty)
+	{
+		xactRtParams.pRendererID = nativeRendererId;
+	}
+    hr = pEngine->Initialize(&xactRtParams);
+    if (FAILED(hr))
+	{
+		pEngine->Release();
+		StreamReader::Release();
+		delete pMapping;
+		delete pNotifications;
+        ErrorToException::Throw(hr);
+	}
+
+	// Fall back to XACT for the names if it numbers anything differently
+	if (hasSettingsTables == true && VerifySettingsTables() == false)
+	{
+		hasSettingsTables = false;
+		categoryNames = nullptr;
+		categoryIndices->Clear();
+		globalVariableIndices->Clear();
+	}
+
+	// Get the number of channels on the final mix
+	WAVEFORMATEXTENSIBLE wfxFinalMixFormat;
+	hr = pEngine->GetFinalMixFormat(&wfxFinalMixFormat);
+	if (FAILED(hr))
+	{
+		pEngine->Release();
+		StreamReader::Release();
+		delete pMapping;
+		delete pNotifications;
+		ErrorToException::Throw(hr);
+	}
+	destinationChannelCount = wfxFinalMixFormat.Format.nChannels;
+
+	//
+	// Register for XACT notifications
+	//
+
+	XACT_NOTIFICATION_DESCRIPTION desc = {0};
+	// Use "cue destroyed" notification to cleanup the managed cues
+	desc.flags = XACT_FLAG_NOTIFICATION_PERSIST;
+	desc.type = XACTNOTIFICATIONTYPE_CUEDESTROYED;
+	desc.cueIndex = XACTINDEX_INVALID;
+	desc.pvContext = pNotifications;
+	pEngine->RegisterNotification(&desc);
+
+	//
+	// Initialize 3D audio
+	//
+
+	X3DAUDIO_HANDLE h3DAudio;
+	hr = ::XACT3DInitialize(pEngine, h3DAudio);
+	if (FAILED(hr))
+	{
+		pEngine->Release();
+		StreamReader::Release();
+		delete pMapping;
+		delete pNotifications;
+		ErrorToException::Throw(hr);
+	}
+
+	p3DAudioData = new BYTE[X3DAUDIO_HANDLE_BYTESIZE];
+	memcpy_s(p3DAudioData, X3DAUDIO_HANDLE_BYTESIZE, h3DAudio, X3DAUDIO_HANDLE_BYTESIZE);
+
+	pCommands = new RingBuffer<Command>(CommandQueueCapacity);
+	pPendingNotifications = new Notification[NotificationQueueCapacity];
+	pDispatchLock = new CriticalSection();
+
+	pStatistics = new EngineStatistics();
+	ZeroMemory(pStatistics, sizeof(EngineStatistics));
+
+	pCueStates = new CueStateTable();
+
+	// As XACT3DInitialize does, which keeps the speed of sound of the
+	// global settings
+	pDspArena = new DspArena(destinationChannelCount);
+	pSpatializer = new Spatializer(pDspArena);
+	pSpatializer->SetSpeakers(wfxFinalMixFormat.dwChannelMask, destinationChannelCount);
+	XACTVARIABLEINDEX speedOfSoundIndex = pEngine->GetGlobalVariableIndex("SpeedOfSound");
+	XACTVARIABLEVALUE speedOfSound = X3DAUDIO_SPEED_OF_SOUND;
+	if (speedOfSoundIndex != XACTVARIABLEINDEX_INVALID)
+	{
+		pEngine->GetGlobalVariable(speedOfSoundIndex, &speedOfSound);
+	}
+	pSpatializer->SetSpeedOfSound(speedOfSound);
+	pSpatializerLock = new CriticalSection();
+	calculate3DCallback = gcnew WaitCallback(this, &Engine::Calculate3DWorker);
+	calculate3DDone = gcnew AutoResetEvent(false);
+	pEmitterStore = new EmitterStore();
+}
+
+bool Engine::BuildSettingsTables()
+{
+	if (pMapping->IsOpen() == false)
+	{
+		return false;
+	}
+
+	GlobalSettingsFile settings;
+	if (settings.Parse(pMapping->GetData(), pMapping->GetSize()) != BankParseOk)
+	{
+		return false;
+	}
+
+	// Table indices are the ones XACT assigns
+	categoryNames = gcnew array<String^>(settings.GetCategoryCount());
+	for (uint32 i = 0; i < settings.GetCategoryCount(); i++)
+	{
+		categoryNames[i] = gcnew String(settings.GetCategoryName(i));
+		categoryIndices[categoryNames[i]] = static_cast<XACTCATEGORY>(i);
+	}
+	for (uint32 i = 0; i < settings.GetVariableCount(); i++)
+	{
+		// Per-cue variables are not visible through the engine
+		if (settings.IsGlobalVariable(i) == true)
+		{
+			globalVariableIndices[gcnew String(settings.GetVariableName(i))] = static_cast<XACTVARIABLEINDEX>(i);
+		}
+	}
+	return true;
+}
+
+bool Engine::VerifySettingsTables()
+{
+	// Once per name at load, XACT must be initialized
+	for (int i = 0; i < categoryNames->Length; i++)
+	{
+		NativeString nativeName(categoryNames[i]);
+		if (pEngine->GetCategory(nativeName) != static_cast<XACTCATEGORY>(i))
+		{
+			return false;
+		}
+	}
+	for each (KeyValuePair<String^, XACTVARIABLEINDEX> entry in globalVariableIndices)
+	{
+		NativeString nativeName(entry.Key);
+		if (pEngine->GetGlobalVariableIndex(nativeName) != entry.Value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void Engine::Release()
+{
+	StopServiceThread();
+
+	ScopedLock lock(Engine::syncRoot);
+
+	// Execute what is left so queued cue destroys reach XACT
+	FlushCommands();
+
+	pEngine->ShutDown();
+	pEngine->Release();
+
+	StreamReader::Release();
+
+	delete pMapping;
+	pMapping = NULL;
+
+	delete p3DAudioData;
+	p3DAudioData = NULL;
+
+	delete pCommands;
+	pCommands = NULL;
+
+	// ShutDown has stopped the callback, the queue is no longer used
+	delete pNotifications;
+	pNotifications = NULL;
+
+	delete[] pPendingNotifications;
+	pPendingNotifications = NULL;
+
+	delete pDispatchLock;
+	pDispatchLock = NULL;
+
+	delete pStatistics;
+	pStatistics = NULL;
+
+	delete pCueStates;
+	pCueStates = NULL;
+
+	// Before the arena it returns its settings to
+	delete pSpatializer;
+	pSpatializer = NULL;
+
+	delete pDspArena;
+	pDspArena = NULL;
+
+	delete pSpatializerLock;
+	pSpatializerLock = NULL;
+
+	// Emitters check for the store while they hold the lock
+	ScopedLock emitterLock(Engine::emitterSyncRoot);
+	delete pEmitterStore;
+	pEmitterStore = NULL;
+
+	calculate3DDone->Close();
+}
+
+int Engine::GetRendererCount()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	XACTINDEX count = 0;
+	pEngine->GetRendererCount(&count);
+
+	return count;
+}
+
+void Engine::GetRendererDetail(int index, String^% friendlyName, String^% guid)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	XACT_RENDERER_DETAILS rendererDetails = { 0 };
+	pEngine->GetRendererDetails((XACTINDEX)index, &rendererDetails);
+	friendlyName = StringConverter::ToString(rendererDetails.displayName);
+	guid = StringConverter::ToString(rendererDetails.rendererID);
+}
+
+XACTVARIABLEINDEX Engine::GetGlobalVariableIndex(String^ name)
+{
+	XACTVARIABLEINDEX index;
+	if (hasSettingsTables == true)
+	{
+		if (globalVariableIndices->TryGetValue(name, index) == false)
+		{
+			index = XACTVARIABLEINDEX_INVALID;
+		}
+		return index;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	// Unknown names are cached as well, as XACTVARIABLEINDEX_INVALID
+	if (globalVariableIndices->TryGetValue(name, index) == false)
+	{
+		NativeString nativeName(name);
+		index = pEngine->GetGlobalVariableIndex(nativeName);
+		globalVariableIndices->Add(name, index);
+		::InterlockedIncrement(&allocationCounters.cacheAllocations);
+	}
+	return index;
+}
+
+float Engine::GetGlobalVariable(String^ name)
+{
+	return GetGlobalVariable(GetGlobalVariableIndex(name));
+}
+
+void Engine::SetGlobalVariable(String^ name, float value)
+{
+	SetGlobalVariable(GetGlobalVariableIndex(name), value);
+}
+
+float Engine::GetGlobalVariable(XACTVARIABLEINDEX index)
+{
+	if (index == XACTVARIABLEINDEX_INVALID)
+	{
+		//ErrorToException::Throw(hr);
+		return 0.0f;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	XACTVARIABLEVALUE varValue;
+	HRESULT hr = pEngine->GetGlobalVariable(index, &varValue);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+
+	return varValue;
+}
+
+void Engine::SetGlobalVariable(XACTVARIABLEINDEX index, float value)
+{
+	if (index == XACTVARIABLEINDEX_INVALID)
+	{
+		//ErrorToException::Throw(hr);
+		return;
+	}
+
+	if (deferCommands == true)
+	{
+		Command command = { CommandEngineSetGlobalVariable };
+		command.variable = index;
+		command.value = value;
+		Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	XACTVARIABLEVALUE varValue = value;
+	HRESULT hr = pEngine->SetGlobalVariable(index, varValue);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+}
+
+XACTCATEGORY Engine::GetCategory(String^ name)
+{
+	XACTCATEGORY category;
+	if (hasSettingsTables == true)
+	{
+		if (categoryIndices->TryGetValue(name, category) == false)
+		{
+			category = XACTCATEGORY_INVALID;
+		}
+	}
+	else
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		NativeString nativeName(name);
+		category = pEngine->GetCategory(nativeName);
+	}
+	if (category == XACTCATEGORY_INVALID)
+	{
+		throw gcnew InvalidOperationException(StringResources::CouldNotCreateResource);
+	}
+
+	return category;
+}
+
+String^ Engine::GetCategoryName(XACTCATEGORY category)
+{
+	if (categoryNames == nullptr || category >= categoryNames->Length)
+	{
+		return nullptr;
+	}
+	return categoryNames[category];
+}
+
+void Engine::Update()
+{
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		if (serviceThread == nullptr)
+		{
+			FlushCommands();
+
+			pEngine->DoWork();
+		}
+
+		// Also with the service thread, to keep the pools off its period
+		for each (SoundBank^ soundBank in cuePools)
+		{
+			soundBank->UpdateCuePool();
+		}
+
+		// One query per active cue and Update, the Cue properties read the result
+		pCueStates->Refresh();
+	}
+
+	// Notifications are always raised on the thread calling Update
+	DispatchNotifications();
+}
+
+void Engine::AddCuePool(SoundBank^ soundBank)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	cuePools->Add(soundBank);
+}
+
+void Engine::RemoveCuePool(SoundBank^ soundBank)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	cuePools->Remove(soundBank);
+}
+
+void Engine::StartServiceThread(LONGLONG periodMicroseconds)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	if (serviceThread != nullptr)
+	{
+		throw gcnew InvalidOperationException(StringResources::ServiceThreadRunning);
+	}
+
+	hServiceStopEvent = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (hServiceStopEvent == NULL)
+	{
+		ErrorToException::Throw(E_FAIL);
+	}
+
+	servicePeriodMicroseconds = periodMicroseconds;
+	pStatistics->serviceIterations = 0;
+	pStatistics->missedDeadlines = 0;
+	pStatistics->maxJitterMicroseconds = 0;
+	::InterlockedExchange64(&pStatistics->totalJitterMicroseconds, 0);
+
+	serviceThread = gcnew Thread(gcnew ThreadStart(this, &Engine::ServiceThreadProc));
+	serviceThread->Name = "Bnoerj.Audio service thread";
+	serviceThread->IsBackground = true;
+	serviceThread->Priority = ThreadPriority::Highest;
+	serviceThread->Start();
+}
+
+void Engine::StopServiceThread()
+{
+	Thread^ thread;
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		thread = serviceThread;
+		if (thread == nullptr)
+		{
+			return;
+		}
+		::SetEvent(hServiceStopEvent);
+	}
+
+	// Join without holding the lock, the service thread needs it to finish
+	thread->Join();
+
+	ScopedLock lock(Engine::syncRoot);
+
+	::CloseHandle(hServiceStopEvent);
+	hServiceStopEvent = NULL;
+	serviceThread = nullptr;
+}
+
+bool Engine::IsServiceThreadRunning()
+{
+	return serviceThread != nullptr;
+}
+
+void Engine::ServiceThreadProc()
+{
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	LONGLONG periodTicks = servicePeriodMicroseconds * frequency.QuadPart / 1000000;
+
+	// Sleep granularity would otherwise be the default 10-15 ms
+	::timeBeginPeriod(1);
+
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter(&now);
+	LONGLONG deadline = now.QuadPart + periodTicks;
+
+	for (;;)
+	{
+		// Sleep most of the remaining time, then yield until the deadline
+		::QueryPerformanceCounter(&now);
+		LONGLONG remaining = deadline - now.QuadPart;
+		DWORD timeout = remaining > 0 ? static_cast<DWORD>(remaining * 1000 / frequency.QuadPart) : 0;
+		if (::WaitForSingleObject(hServiceStopEvent, timeout) == WAIT_OBJECT_0)
+		{
+			break;
+		}
+		for (::QueryPerformanceCounter(&now); now.QuadPart < deadline; ::QueryPerformanceCounter(&now))
+		{
+			::SwitchToThread();
+		}
+
+		LONGLONG lateness = now.QuadPart - deadline;
+		LONG jitter = static_cast<LONG>(lateness * 1000000 / frequency.QuadPart);
+		// 64-bit, a plain add could be read half written on 32-bit
+		::InterlockedExchangeAdd64(&pStatistics->totalJitterMicroseconds, jitter);
+		if (jitter > pStatistics->maxJitterMicroseconds)
+		{
+			pStatistics->maxJitterMicroseconds = jitter;
+		}
+
+		{
+			ScopedLock lock(Engine::syncRoot);
+
+			FlushCommands();
+
+			pEngine->DoWork();
+		}
+		pStatistics->serviceIterations++;
+
+		deadline += periodTicks;
+		if (lateness > periodTicks)
+		{
+			// Whole periods were missed, skip them instead of catching up
+			::InterlockedIncrement(&pStatistics->missedDeadlines);
+			deadline = now.QuadPart + periodTicks;
+		}
+	}
+
+	::timeEndPeriod(1);
+}
+
+FileMapping* Engine::MapFile(String^ filename, FileMapping::Access access)
+{
+	// Read only views of a file are shared by all engines and banks
+	FileMapping* pMapping = new FileMapping();
+	NativeStringUni nativeFilename(filename);
+	int error = access == FileMapping::AccessReadOnly
+		? MappingCache::Open(nativeFilename, *pMapping)
+		: pMapping->Open(nativeFilename, access);
+	if (error != 0)
+	{
+		delete pMapping;
+		ErrorToException::ThrowFileError(error);
+	}
+	return pMapping;
+}
+
+LONG Engine::GetNotificationSequence()
+{
+	return notificationSequence;
+}
+
+void Engine::DispatchNotifications()
+{
+	ScopedLock dispatchLock(pDispatchLock);
+
+	// Pop under the lock to remain the only consumer, but raise the events
+	// without holding it so handlers can call back into the engine freely.
+	int count = 0;
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		LONG pending = pNotifications->notifications.GetCount();
+		if (pending > pStatistics->peakNotificationCount)
+		{
+			pStatistics->peakNotificationCount = pending;
+		}
+
+		while (count < NotificationQueueCapacity &&
+			pNotifications->notifications.Pop(pPendingNotifications[count]) == true)
+		{
+			// Pooled and fire and forget cues have no managed cue
+			Notification& notification = pPendingNotifications[count];
+			notification.instance = pCueStates->Destroyed(notification.pCue, notification.sequence);
+			count++;
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (pPendingNotifications[i].instance >= 0)
+		{
+			CueDestroyed(pPendingNotifications[i].instance);
+		}
+	}
+}
+
+LONG Engine::GetPendingNotificationCount()
+{
+	return pNotifications->notifications.GetCount();
+}
+
+LONG Engine::GetDroppedNotificationCount()
+{
+	return pNotifications->droppedCount;
+}
+
+void Engine::SetDeferCommands(bool defer)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	if (defer == false)
+	{
+		// Keep the call order when switching back to immediate calls
+		FlushCommands();
+	}
+	deferCommands = defer;
+}
+
+LONG Engine::GetPendingCommandCount()
+{
+	return pCommands->GetCount();
+}
+
+void Engine::Submit(const Command& command)
+{
+	::InterlockedIncrement(&pStatistics->commandsSubmitted);
+
+	if (pCommands->Push(command) == false)
+	{
+		// The queue is full, flush it and queue the command again. Running
+		// it right away could overtake commands from this thread: a flush
+		// stops at a cell another thread is still writing, and whatever
+		// was queued behind it stays queued. The lock is released before
+		// the command is queued again, and the thread yields if the queue
+		// is still full, so that writer gets to finish.
+		::InterlockedIncrement(&pStatistics->commandQueueOverflows);
+		for (;;)
+		{
+			{
+				ScopedLock lock(Engine::syncRoot);
+				FlushCommands();
+			}
+			if (pCommands->Push(command) == true)
+			{
+				break;
+			}
+			::SwitchToThread();
+		}
+	}
+}
+
+void Engine::FlushCommands()
+{
+	// Caller must hold syncRoot, which makes this the single consumer
+	LONG count = pCommands->GetCount();
+	if (count > pStatistics->peakCommandCount)
+	{
+		pStatistics->peakCommandCount = count;
+	}
+
+	// Commands are executed without throwing, failures are only counted as
+	// the caller that queued them has long returned.
+	Command command;
+	while (pCommands->Pop(command) == true)
+	{
+		HRESULT hr = Execute(command);
+		if (FAILED(hr))
+		{
+			::InterlockedIncrement(&pStatistics->commandsFailed);
+		}
+		::InterlockedIncrement(&pStatistics->commandsExecuted);
+
+		// A prepared cue played here is only queried from now on
+		if (command.type == CommandCuePlay || command.type == CommandCuePause || command.type == CommandCueStop)
+		{
+			pCueStates->UpdateState(command.pCue);
+		}
+	}
+}
+
+HRESULT Engine::Execute(const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandCuePlay:
+		return command.pCue->Play();
+	case CommandCuePause:
+		return command.pCue->Pause(command.flags);
+	case CommandCueStop:
+		return command.pCue->Stop(command.flags);
+	case CommandCueSetVariable:
+		return command.pCue->SetVariable(command.variable, command.value);
+	case CommandCueDestroy:
+		return command.pCue->Destroy();
+	case CommandEnginePause:
+		return pEngine->Pause(command.category, command.flags);
+	case CommandEngineStop:
+		return pEngine->Stop(command.category, command.flags);
+	case CommandEngineSetVolume:
+		return pEngine->SetVolume(command.category, command.value);
+	case CommandEngineSetGlobalVariable:
+		return pEngine->SetGlobalVariable(command.variable, command.value);
+	case CommandEngineApply3D:
+		{
+			X3DAUDIO_LISTENER listener = command.listener;
+			X3DAUDIO_EMITTER emitter = command.emitter;
+			FLOAT32 channelAzimuths[CommandMaxChannelCount];
+			if (emitter.pChannelAzimuths != NULL)
+			{
+				::memcpy(channelAzimuths, command.channelAzimuths, sizeof(channelAzimuths));
+				emitter.pChannelAzimuths = channelAzimuths;
+			}
+			return Calculate3D(command.pCue, &listener, &emitter);
+		}
+	}
+	return E_INVALIDARG;
+}
+
+void Engine::Pause(XACTCATEGORY cateorgy, BOOL pause)
+{
+	if (deferCommands == true)
+	{
+		Command command = { CommandEnginePause };
+		command.category = cateorgy;
+		command.flags = pause;
+		Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pEngine->Pause(cateorgy, pause);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+}
+
+void Engine::Stop(XACTCATEGORY cateorgy, DWORD options)
+{
+	if (deferCommands == true)
+	{
+		Command command = { CommandEngineStop };
+		command.category = cateorgy;
+		command.flags = options;
+		Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pEngine->Stop(cateorgy, options);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+}
+
+void Engine::SetVolume(XACTCATEGORY cateorgy, float volume)
+{
+	if (deferCommands == true)
+	{
+		Command command = { CommandEngineSetVolume };
+		command.category = cateorgy;
+		command.value = volume;
+		Submit(command);
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	HRESULT hr = pEngine->SetVolume(cateorgy, volume);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+}
+
+HRESULT Engine::Apply3D(IXACT3Cue* pCue, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter)
+{
+	if (deferCommands == true)
+	{
+		Submit3D(pCue, pListener, pEmitter);
+		return S_OK;
+	}
+
+	return Calculate3D(pCue, pListener, pEmitter);
+}
+
+void Engine::Submit3D(IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, const X3DAUDIO_EMITTER* pEmitter)
+{
+	Command command = { CommandEngineApply3D };
+	command.pCue = pCue;
+	command.listener = *pListener;
+	command.emitter = *pEmitter;
+
+	// The emitter's azimuths may be gone or changed by the time the
+	// command executes. XACT3DCalculate fills in a default layout for
+	// emitters without them.
+	if (pEmitter->pChannelAzimuths != NULL && pEmitter->ChannelCount <= CommandMaxChannelCount)
+	{
+		::memcpy(command.channelAzimuths, pEmitter->pChannelAzimuths, pEmitter->ChannelCount * sizeof(FLOAT32));
+	}
+	else
+	{
+		command.emitter.pChannelAzimuths = NULL;
+	}
+	Submit(command);
+}
+
+void Engine::Apply3DBatch(int threadCount)
+{
+	LONG count = pSpatializer->GetCount();
+	if (count == 0)
+	{
+		return;
+	}
+
+	::InterlockedIncrement(&pStatistics->apply3DBatches);
+	::InterlockedExchangeAdd(&pStatistics->apply3DBatchCues, count);
+
+	if (deferCommands == true)
+	{
+		for (LONG i = 0; i < count; i++)
+		{
+			Submit3D(pSpatializer->GetCue(i), pSpatializer->GetListener(i), pSpatializer->GetEmitter(i));
+		}
+		return;
+	}
+
+	::InterlockedExchangeAdd(&pStatistics->apply3DCalculations, count);
+
+	// Thread pool workers only pay off for larger batches, the calling
+	// thread always takes part
+	calculate3DChunkCount = (count + Calculate3DChunkSize - 1) / Calculate3DChunkSize;
+	calculate3DNextChunk = 0;
+	int workerCount = threadCount - 1;
+	if (workerCount > calculate3DChunkCount - 1)
+	{
+		workerCount = calculate3DChunkCount - 1;
+	}
+	calculate3DPendingWorkers = workerCount;
+	for (int i = 0; i < workerCount; i++)
+	{
+		ThreadPool::QueueUserWorkItem(calculate3DCallback);
+	}
+
+	Calculate3DChunks();
+	if (workerCount > 0)
+	{
+		calculate3DDone->WaitOne();
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	pSpatializer->Apply();
+}
+
+void Engine::Calculate3DChunks()
+{
+	LONG count = pSpatializer->GetCount();
+	for (;;)
+	{
+		int chunk = Interlocked::Increment(calculate3DNextChunk) - 1;
+		if (chunk >= calculate3DChunkCount)
+		{
+			break;
+		}
+
+		LONG first = chunk * Calculate3DChunkSize;
+		LONG end = first + Calculate3DChunkSize < count ? first + Calculate3DChunkSize : count;
+		pSpatializer->Calculate(p3DAudioData, destinationChannelCount, first, end);
+	}
+}
+
+void Engine::Calculate3DWorker(Object^)
+{
+	Calculate3DChunks();
+
+	if (Interlocked::Decrement(calculate3DPendingWorkers) == 0)
+	{
+		calculate3DDone->Set();
+	}
+}
+
+HRESULT Engine::Calculate3D(IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter)
+{
+	// XACT3DApply sets the cue's matrix for as many source channels as the
+	// emitter has, which must be those of the cue's sound
+	X3DAUDIO_DSP_SETTINGS* pDsp = pDspArena->Allocate(pEmitter->ChannelCount);
+	if (pDsp == NULL)
+	{
+		return E_INVALIDARG;
+	}
+
+	::InterlockedIncrement(&pStatistics->apply3DCalculations);
+
+	HRESULT hr = ::XACT3DCalculate(p3DAudioData, pListener, pEmitter, pDsp);
+	if (SUCCEEDED(hr))
+	{
+		ScopedLock lock(Engine::syncRoot);
+
+		hr = ::XACT3DApply(pDsp, pCue);
+	}
+
+	pDspArena->Free(pDsp);
+	return hr;
+}
@@ -1,80 +1,228 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-#include "NativeAudioObject.h"
-
-using namespace System;
-using namespace System::Runtime::InteropServices;
-
-namespace Bnoerj { namespace Audio { namespace Native {
-
-	delegate void CueDestroyedEventHandler(IntPtr ptrCue);
-
-	ref class Engine : public AudioObject
-	{
-		static CueDestroyedEventHandler^ _CueDestroyed;
-
-		UINT destinationChannelCount;
-		BYTE* p3DAudioData;
-		FLOAT32* pDelayTimes;
-		FLOAT32* pMatrixCoefficients;
-		X3DAUDIO_DSP_SETTINGS* pDsp;
-
-	internal:
-		static Object^ syncRoot;
-
-		static event CueDestroyedEventHandler^ CueDestroyed
-		{
-		internal:
-			void add(CueDestroyedEventHandler^ handler)
-			{
-				_CueDestroyed += handler;
-			}
-			void remove(CueDestroyedEventHandler^ handler)
-			{
-				_CueDestroyed -= handler;
-			}
-			void raise(IntPtr ptrCue)
-			{
-				if (_CueDestroyed)
-				{
-					_CueDestroyed(ptrCue);
-				}
-			}
-		}
-
-	private:
-		static Engine()
-		{
-			syncRoot = gcnew Object();
-		}
-
-	public:
-		Engine(String^ settingsFilename, unsigned int lookAheadTime, Guid guid);
-		virtual void Release() override;
-
-		int GetRendererCount();
-		void GetRendererDetail(int index, String^% friendlyName, String^% guid);
-
-		float GetGlobalVariable(String^ name);
-		void SetGlobalVariable(String^ name, float value);
-
-		XACTCATEGORY GetCategory(String^ name);
-
-		void Update();
-
-		void Pause(XACTCATEGORY cateorgy, BOOL pause);
-		void Stop(XACTCATEGORY cateorgy, DWORD options);
-
-		void SetVolume(XACTCATEGORY cateorgy, float volume);
-
-		void Apply3D(IXACT3Cue* pCue, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter);
-	};
-
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeAudioObject.h"
+#include "NativeCommand.h"
+#include "NativeCueStateTable.h"
+#include "NativeEmitterStore.h"
+#include "NativeLock.h"
+#include "NativeNotification.h"
+#include "NativeRingBuffer.h"
+#include "NativeSpatializer.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Runtime::InteropServices;
+using namespace System::Threading;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// instance is the handle of the Bnoerj::Audio::Cue
+	delegate void CueDestroyedEventHandler(long long instance);
+
+	// Counters updated by the engine, read by AudioEngine::GetStatistics.
+	struct EngineStatistics
+	{
+		LONG commandsSubmitted;
+		LONG commandsExecuted;
+		LONG commandsFailed;
+		LONG commandQueueOverflows;
+		LONG peakCommandCount;
+		LONG peakNotificationCount;
+		// Written by the service thread only
+		LONG serviceIterations;
+		LONG missedDeadlines;
+		LONG maxJitterMicroseconds;
+		// Only changed and read with the Interlocked*64 functions
+		volatile LONGLONG totalJitterMicroseconds;
+		// Cues played through SoundBank::PlayCue3D that were taken from a
+		// pool, that had to be prepared, and pooled cues destroyed once stopped
+		LONG cuePoolHits;
+		LONG cuePoolMisses;
+		LONG cuePoolRecycles;
+		// Batched Apply3D calls and the cues they positioned
+		LONG apply3DBatches;
+		LONG apply3DBatchCues;
+		// 3D settings calculated, and Apply3D calls left out because
+		// neither the listener nor the emitter changed
+		LONG apply3DCalculations;
+		LONG apply3DSkips;
+	};
+
+	ref class SoundBank;
+
+	ref class Engine : public AudioObject
+	{
+		CueDestroyedEventHandler^ _CueDestroyed;
+
+		UINT destinationChannelCount;
+		BYTE* p3DAudioData;
+		// DSP settings of the single cue Apply3D and of the spatializer
+		DspArena* pDspArena;
+
+		// Batched Apply3D, see Apply3DBatch. Workers take chunks of
+		// Calculate3DChunkSize entries until none is left.
+		Spatializer* pSpatializer;
+		WaitCallback^ calculate3DCallback;
+		AutoResetEvent^ calculate3DDone;
+		int calculate3DChunkCount;
+		int calculate3DNextChunk;
+		int calculate3DPendingWorkers;
+
+		RingBuffer<Command>* pCommands;
+
+		NotificationQueue* pNotifications;
+		// Notifications popped in Update, raised once syncRoot is released.
+		// pDispatchLock keeps concurrent Update calls from sharing the buffer.
+		Notification* pPendingNotifications;
+		CriticalSection* pDispatchLock;
+
+		// Category and global variable indices by name. Filled from the
+		// settings file at load when it can be parsed and XACT agrees on
+		// every index, see BuildSettingsTables and VerifySettingsTables.
+		// Otherwise global variables are resolved through XACT and cached,
+		// guarded by syncRoot.
+		Dictionary<String^, XACTCATEGORY>^ categoryIndices;
+		array<String^>^ categoryNames;
+		Dictionary<String^, XACTVARIABLEINDEX>^ globalVariableIndices;
+		bool hasSettingsTables;
+
+		// Sound banks with a cue pool, updated in Update, guarded by syncRoot
+		List<SoundBank^>^ cuePools;
+
+		// Service thread calling DoWork on a fixed period, see StartServiceThread
+		Thread^ serviceThread;
+		HANDLE hServiceStopEvent;
+		LONGLONG servicePeriodMicroseconds;
+
+		void ServiceThreadProc();
+
+		void Calculate3DChunks();
+		void Calculate3DWorker(Object^);
+
+		bool BuildSettingsTables();
+		bool VerifySettingsTables();
+
+		HRESULT Execute(const Command& command);
+		void Submit3D(IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, const X3DAUDIO_EMITTER* pEmitter);
+		// Calculates in settings of its own without a lock, takes syncRoot
+		// to apply them
+		HRESULT Calculate3D(IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter);
+
+	internal:
+		// Guards every call into XACT, and the name caches
+		static CriticalSection* syncRoot;
+		// Held by AudioEmitter and AudioEngine around every use of
+		// pEmitterStore and by Release to delete it. Static like syncRoot,
+		// so it outlives the engines emitters still refer to.
+		static CriticalSection* emitterSyncRoot;
+
+		// When set, cue and engine calls are queued and executed in Update
+		bool deferCommands;
+		EngineStatistics* pStatistics;
+		// State of the prepared cues, refreshed in Update
+		CueStateTable* pCueStates;
+		// Held while the spatializer is filled and applied
+		CriticalSection* pSpatializerLock;
+		// Emitters of AudioEngine::CreateEmitter
+		EmitterStore* pEmitterStore;
+
+		// Raised in Update for the cues XACT destroyed
+		event CueDestroyedEventHandler^ CueDestroyed
+		{
+		internal:
+			void add(CueDestroyedEventHandler^ handler)
+			{
+				_CueDestroyed += handler;
+			}
+			void remove(CueDestroyedEventHandler^ handler)
+			{
+				_CueDestroyed -= handler;
+			}
+			void raise(long long instance)
+			{
+				if (_CueDestroyed)
+				{
+					_CueDestroyed(instance);
+				}
+			}
+		}
+
+	private:
+		static Engine()
+		{
+			syncRoot = new CriticalSection();
+			emitterSyncRoot = new CriticalSection();
+		}
+
+	public:
+		// Takes ownership of the settings mapping, which must be copy on
+		// write, also if creating the engine fails
+		Engine(FileMapping* pSettingsMapping, unsigned int lookAheadTime, Guid guid);
+		virtual void Release() override;
+
+		static LONG GetNotificationSequence();
+
+		// Maps a bank or settings file, throws if it cannot be opened. Read
+		// only views come from the MappingCache.
+		static FileMapping* MapFile(String^ filename, FileMapping::Access access);
+
+		int GetRendererCount();
+		void GetRendererDetail(int index, String^% friendlyName, String^% guid);
+
+		XACTVARIABLEINDEX GetGlobalVariableIndex(String^ name);
+
+		float GetGlobalVariable(String^ name);
+		void SetGlobalVariable(String^ name, float value);
+		float GetGlobalVariable(XACTVARIABLEINDEX index);
+		void SetGlobalVariable(XACTVARIABLEINDEX index, float value);
+
+		XACTCATEGORY GetCategory(String^ name);
+		// Null for unknown categories or without settings tables
+		String^ GetCategoryName(XACTCATEGORY category);
+
+		void Update();
+
+		// Called by SoundBank when it creates or deletes its cue pool
+		void AddCuePool(SoundBank^ soundBank);
+		void RemoveCuePool(SoundBank^ soundBank);
+
+		void SetDeferCommands(bool defer);
+		LONG GetPendingCommandCount();
+		LONG GetPendingNotificationCount();
+		LONG GetDroppedNotificationCount();
+		void Submit(const Command& command);
+		void FlushCommands();
+		void DispatchNotifications();
+
+		void StartServiceThread(LONGLONG periodMicroseconds);
+		void StopServiceThread();
+		bool IsServiceThreadRunning();
+
+		void Pause(XACTCATEGORY cateorgy, BOOL pause);
+		void Stop(XACTCATEGORY cateorgy, DWORD options);
+
+		void SetVolume(XACTCATEGORY cateorgy, float volume);
+
+		// The DSP settings are sized for the emitter's channels and taken
+		// from the arena for the call, Apply3D on different cues can run
+		// on several threads at once. S_OK when deferred.
+		HRESULT Apply3D(IXACT3Cue* pCue, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter);
+
+		// The spatializer to fill for Apply3DBatch, pSpatializerLock must
+		// be held until the batch is applied
+		Spatializer* GetSpatializer() { return pSpatializer; }
+		// Calculates the settings of every spatializer entry, split across
+		// up to threadCount threads including the calling one, and applies
+		// them in one locked section. With deferred commands the entries
+		// are queued as single Apply3D commands instead.
+		void Apply3DBatch(int threadCount);
+	};
+
+}}}
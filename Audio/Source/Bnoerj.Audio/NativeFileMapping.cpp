@@ -0,0 +1,599 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeFileMapping.h
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+#include "NativeFileMapping.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	struct SharedView
+	{
+		FileIdentity identity;
+		FileOffset offset;
+		size_t size;
+		// Of the whole region, see MappingCache
+		unsigned long long hash;
+		FileMapping view;
+		unsigned int referenceCount;
+		SharedView* pNext;
+	};
+
+}}}
+
+namespace
+{
+#if defined(_WIN32)
+	const int FileTooLargeError = ERROR_FILE_TOO_LARGE;
+
+	class CacheLock
+	{
+		CRITICAL_SECTION criticalSection;
+
+	public:
+		CacheLock() { ::InitializeCriticalSection(&criticalSection); }
+		~CacheLock() { ::DeleteCriticalSection(&criticalSection); }
+		void Enter() { ::EnterCriticalSection(&criticalSection); }
+		void Leave() { ::LeaveCriticalSection(&criticalSection); }
+	};
+#else
+	const int FileTooLargeError = EFBIG;
+
+	class CacheLock
+	{
+		pthread_mutex_t mutex;
+
+	public:
+		CacheLock() { ::pthread_mutex_init(&mutex, NULL); }
+		~CacheLock() { ::pthread_mutex_destroy(&mutex); }
+		void Enter() { ::pthread_mutex_lock(&mutex); }
+		void Leave() { ::pthread_mutex_unlock(&mutex); }
+	};
+#endif
+
+	// Guards the list of shared views and the statistics
+	CacheLock cacheLock;
+	SharedView* pFirstSharedView = NULL;
+	MappingCacheStatistics cacheStatistics = { 0, 0, 0, 0 };
+
+	class ScopedCacheLock
+	{
+	public:
+		ScopedCacheLock() { cacheLock.Enter(); }
+		~ScopedCacheLock() { cacheLock.Leave(); }
+	};
+
+	// The view of the region of the file as it is now, the caller holds
+	// the cache lock
+	SharedView* Find(const FileIdentity& identity, FileOffset offset, size_t size)
+	{
+		SharedView* pSharedView = pFirstSharedView;
+		while (pSharedView != NULL &&
+			(pSharedView->identity == identity && pSharedView->offset == offset && pSharedView->size == size) == false)
+		{
+			pSharedView = pSharedView->pNext;
+		}
+		return pSharedView;
+	}
+
+	// FNV-1a over 8 byte words, the whole region of every view mapped
+	unsigned long long Hash(const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		unsigned long long hash = 14695981039346656037ULL;
+		size_t i = 0;
+		for (; i + sizeof(unsigned long long) <= size; i += sizeof(unsigned long long))
+		{
+			unsigned long long word;
+			memcpy(&word, pBytes + i, sizeof(word));
+			hash = (hash ^ word) * 1099511628211ULL;
+		}
+		for (; i < size; i++)
+		{
+			hash = (hash ^ pBytes[i]) * 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+FileMapping::FileMapping()
+	: pView(NULL)
+	, size(0)
+	, pViewBase(NULL)
+	, viewSize(0)
+	, pSharedView(NULL)
+{}
+
+FileMapping::~FileMapping()
+{
+	Close();
+}
+
+void FileMapping::Close()
+{
+	if (pSharedView != NULL)
+	{
+		SharedView* pSharedView = this->pSharedView;
+		this->pSharedView = NULL;
+		MappingCache::Release(pSharedView);
+	}
+	else if (pViewBase != NULL)
+	{
+		Unmap();
+	}
+	pView = NULL;
+	size = 0;
+	pViewBase = NULL;
+	viewSize = 0;
+}
+
+int MappingCache::Map(const MappableFile& file, FileOffset offset, size_t size, FileMapping& mapping)
+{
+	mapping.Close();
+	if (size == 0)
+	{
+		// Checks the region, nothing to share
+		return file.Map(offset, size, FileMapping::AccessReadOnly, mapping);
+	}
+
+	{
+		ScopedCacheLock lock;
+
+		SharedView* pSharedView = Find(file.GetIdentity(), offset, size);
+		if (pSharedView != NULL)
+		{
+			cacheStatistics.hits++;
+			Share(pSharedView, mapping);
+			return 0;
+		}
+	}
+
+	// Mapped and hashed without the lock, since reading the region may
+	// wait for the disk. Another thread may have shared the same region
+	// meanwhile, then the new view is dropped again.
+	SharedView* pNewView = new SharedView();
+	int error = file.Map(offset, size, FileMapping::AccessReadOnly, pNewView->view);
+	if (error != 0)
+	{
+		delete pNewView;
+		return error;
+	}
+	pNewView->identity = file.GetIdentity();
+	pNewView->offset = offset;
+	pNewView->size = size;
+	pNewView->hash = Hash(pNewView->view.GetData(), size);
+	pNewView->referenceCount = 0;
+
+	ScopedCacheLock lock;
+
+	SharedView* pSharedView = Find(pNewView->identity, offset, size);
+	if (pSharedView == NULL)
+	{
+		// A file whose times changed but whose region did not, touched or
+		// written back unchanged, still shares the view of that region
+		pSharedView = pFirstSharedView;
+		while (pSharedView != NULL &&
+			(pSharedView->identity.volume == pNewView->identity.volume &&
+			pSharedView->identity.index == pNewView->identity.index &&
+			pSharedView->identity.size == pNewView->identity.size &&
+			pSharedView->offset == offset && pSharedView->size == size &&
+			pSharedView->hash == pNewView->hash) == false)
+		{
+			pSharedView = pSharedView->pNext;
+		}
+	}
+
+	if (pSharedView != NULL)
+	{
+		delete pNewView;
+		cacheStatistics.hits++;
+	}
+	else
+	{
+		pSharedView = pNewView;
+		pSharedView->pNext = pFirstSharedView;
+		pFirstSharedView = pSharedView;
+
+		cacheStatistics.misses++;
+		cacheStatistics.viewCount++;
+		cacheStatistics.viewBytes += size;
+	}
+
+	Share(pSharedView, mapping);
+	return 0;
+}
+
+int MappingCache::Open(const FilePathChar* path, FileMapping& mapping)
+{
+	mapping.Close();
+
+	MappableFile file;
+	int error = file.Open(path);
+	if (error != 0)
+	{
+		return error;
+	}
+	if (file.GetSize() > static_cast<size_t>(-1))
+	{
+		return FileTooLargeError;
+	}
+	// The view stays valid once the file is closed
+	return Map(file, 0, static_cast<size_t>(file.GetSize()), mapping);
+}
+
+void MappingCache::Share(SharedView* pSharedView, FileMapping& mapping)
+{
+	pSharedView->referenceCount++;
+	mapping.pView = pSharedView->view.GetData();
+	mapping.size = pSharedView->size;
+	mapping.pSharedView = pSharedView;
+}
+
+void MappingCache::Release(SharedView* pSharedView)
+{
+	ScopedCacheLock lock;
+
+	if (--pSharedView->referenceCount > 0)
+	{
+		return;
+	}
+
+	SharedView** ppLink = &pFirstSharedView;
+	while (*ppLink != pSharedView)
+	{
+		ppLink = &(*ppLink)->pNext;
+	}
+	*ppLink = pSharedView->pNext;
+
+	cacheStatistics.viewCount--;
+	cacheStatistics.viewBytes -= pSharedView->size;
+	delete pSharedView;
+}
+
+void MappingCache::GetStatistics(MappingCacheStatistics& statistics)
+{
+	ScopedCacheLock lock;
+	statistics = cacheStatistics;
+}
+
+#if defined(_WIN32)
+
+int FileMapping::Open(const FilePathChar* path, Access access)
+{
+	Close();
+
+	HANDLE hFile = ::CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return ::GetLastError();
+	}
+
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(hFile, &fileSize) == FALSE)
+	{
+		DWORD error = ::GetLastError();
+		::CloseHandle(hFile);
+		return error;
+	}
+	if (fileSize.QuadPart == 0)
+	{
+		::CloseHandle(hFile);
+		return 0;
+	}
+	if (static_cast<ULONGLONG>(fileSize.QuadPart) > static_cast<SIZE_T>(-1))
+	{
+		::CloseHandle(hFile);
+		return ERROR_FILE_TOO_LARGE;
+	}
+
+	// The view keeps the mapping and the file open, both handles can be
+	// closed right away
+	DWORD protect = access == AccessCopyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY;
+	HANDLE hMapping = ::CreateFileMappingW(hFile, NULL, protect, 0, 0, NULL);
+	DWORD error = hMapping == NULL ? ::GetLastError() : 0;
+	::CloseHandle(hFile);
+	if (hMapping == NULL)
+	{
+		return error;
+	}
+
+	DWORD viewAccess = access == AccessCopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ;
+	void* pView = ::MapViewOfFile(hMapping, viewAccess, 0, 0, 0);
+	error = pView == NULL ? ::GetLastError() : 0;
+	::CloseHandle(hMapping);
+	if (pView == NULL)
+	{
+		return error;
+	}
+
+	this->pView = pView;
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+	this->pViewBase = pView;
+	this->viewSize = this->size;
+	return 0;
+}
+
+void FileMapping::Unmap()
+{
+	::UnmapViewOfFile(pViewBase);
+}
+
+MappableFile::MappableFile()
+	: hFile(INVALID_HANDLE_VALUE)
+	, hMapping(NULL)
+	, size(0)
+	, identity()
+{}
+
+MappableFile::~MappableFile()
+{
+	Close();
+}
+
+int MappableFile::Open(const FilePathChar* path)
+{
+	Close();
+
+	HANDLE hFile = ::CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return ::GetLastError();
+	}
+
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(hFile, &fileSize) == FALSE)
+	{
+		DWORD error = ::GetLastError();
+		::CloseHandle(hFile);
+		return error;
+	}
+
+	BY_HANDLE_FILE_INFORMATION information;
+	if (::GetFileInformationByHandle(hFile, &information) == FALSE)
+	{
+		DWORD error = ::GetLastError();
+		::CloseHandle(hFile);
+		return error;
+	}
+
+	// Copy on write sections also allow read only views. Empty files
+	// cannot be mapped, and have no region to map either.
+	HANDLE hMapping = NULL;
+	if (fileSize.QuadPart > 0)
+	{
+		hMapping = ::CreateFileMappingW(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (hMapping == NULL)
+		{
+			DWORD error = ::GetLastError();
+			::CloseHandle(hFile);
+			return error;
+		}
+	}
+
+	this->hFile = hFile;
+	this->hMapping = hMapping;
+	this->size = static_cast<FileOffset>(fileSize.QuadPart);
+	identity.volume = information.dwVolumeSerialNumber;
+	identity.index = (static_cast<unsigned long long>(information.nFileIndexHigh) << 32) | information.nFileIndexLow;
+	identity.size = this->size;
+	identity.writeTime = (static_cast<unsigned long long>(information.ftLastWriteTime.dwHighDateTime) << 32) |
+		information.ftLastWriteTime.dwLowDateTime;
+	identity.changeTime = 0;
+	return 0;
+}
+
+void MappableFile::Close()
+{
+	if (hMapping != NULL)
+	{
+		::CloseHandle(hMapping);
+		hMapping = NULL;
+	}
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		::CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	size = 0;
+}
+
+bool MappableFile::IsOpen() const
+{
+	return hFile != INVALID_HANDLE_VALUE;
+}
+
+int MappableFile::Map(FileOffset offset, size_t size, FileMapping::Access access, FileMapping& mapping) const
+{
+	mapping.Close();
+
+	if (offset > this->size || size > this->size - offset)
+	{
+		return ERROR_HANDLE_EOF;
+	}
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	// Views start at a multiple of the allocation granularity
+	SYSTEM_INFO systemInfo;
+	::GetSystemInfo(&systemInfo);
+	FileOffset viewOffset = offset - offset % systemInfo.dwAllocationGranularity;
+	size_t delta = static_cast<size_t>(offset - viewOffset);
+	if (size > static_cast<SIZE_T>(-1) - delta)
+	{
+		return ERROR_FILE_TOO_LARGE;
+	}
+
+	DWORD viewAccess = access == FileMapping::AccessCopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ;
+	void* pViewBase = ::MapViewOfFile(hMapping, viewAccess,
+		static_cast<DWORD>(viewOffset >> 32), static_cast<DWORD>(viewOffset), delta + size);
+	if (pViewBase == NULL)
+	{
+		return ::GetLastError();
+	}
+
+	mapping.pViewBase = pViewBase;
+	mapping.viewSize = delta + size;
+	mapping.pView = static_cast<char*>(pViewBase) + delta;
+	mapping.size = size;
+	return 0;
+}
+
+#else
+
+int FileMapping::Open(const FilePathChar* path, Access access)
+{
+	Close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd == -1)
+	{
+		return errno;
+	}
+
+	struct stat status;
+	if (::fstat(fd, &status) == -1)
+	{
+		int error = errno;
+		::close(fd);
+		return error;
+	}
+	if (status.st_size == 0)
+	{
+		::close(fd);
+		return 0;
+	}
+
+	// The mapping keeps the file referenced, the descriptor can be closed
+	// right away
+	int protect = access == AccessCopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+	void* pView = ::mmap(NULL, static_cast<size_t>(status.st_size), protect, MAP_PRIVATE, fd, 0);
+	int error = pView == MAP_FAILED ? errno : 0;
+	::close(fd);
+	if (pView == MAP_FAILED)
+	{
+		return error;
+	}
+
+	this->pView = pView;
+	this->size = static_cast<size_t>(status.st_size);
+	this->pViewBase = pView;
+	this->viewSize = this->size;
+	return 0;
+}
+
+void FileMapping::Unmap()
+{
+	::munmap(pViewBase, viewSize);
+}
+
+MappableFile::MappableFile()
+	: fd(-1)
+	, size(0)
+	, identity()
+{}
+
+MappableFile::~MappableFile()
+{
+	Close();
+}
+
+int MappableFile::Open(const FilePathChar* path)
+{
+	Close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd == -1)
+	{
+		return errno;
+	}
+
+	struct stat status;
+	if (::fstat(fd, &status) == -1)
+	{
+		int error = errno;
+		::close(fd);
+		return error;
+	}
+
+	this->fd = fd;
+	this->size = static_cast<FileOffset>(status.st_size);
+	identity.volume = static_cast<unsigned long long>(status.st_dev);
+	identity.index = static_cast<unsigned long long>(status.st_ino);
+	identity.size = this->size;
+	identity.writeTime = static_cast<unsigned long long>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+	identity.changeTime = static_cast<unsigned long long>(status.st_ctim.tv_sec) * 1000000000 + status.st_ctim.tv_nsec;
+	return 0;
+}
+
+void MappableFile::Close()
+{
+	if (fd != -1)
+	{
+		::close(fd);
+		fd = -1;
+	}
+	size = 0;
+}
+
+bool MappableFile::IsOpen() const
+{
+	return fd != -1;
+}
+
+int MappableFile::Map(FileOffset offset, size_t size, FileMapping::Access access, FileMapping& mapping) const
+{
+	mapping.Close();
+
+	if (offset > this->size || size > this->size - offset)
+	{
+		return EINVAL;
+	}
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	// Views start at a multiple of the page size
+	FileOffset pageSize = static_cast<FileOffset>(::sysconf(_SC_PAGESIZE));
+	FileOffset viewOffset = offset - offset % pageSize;
+	size_t delta = static_cast<size_t>(offset - viewOffset);
+
+	int protect = access == FileMapping::AccessCopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+	void* pViewBase = ::mmap(NULL, delta + size, protect, MAP_PRIVATE, fd, static_cast<off_t>(viewOffset));
+	if (pViewBase == MAP_FAILED)
+	{
+		return errno;
+	}
+
+	mapping.pViewBase = pViewBase;
+	mapping.viewSize = delta + size;
+	mapping.pView = static_cast<char*>(pViewBase) + delta;
+	mapping.size = size;
+	return 0;
+}
+
+#endif
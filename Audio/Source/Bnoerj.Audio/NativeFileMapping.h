@@ -0,0 +1,168 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include <stddef.h>
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+#if defined(_WIN32)
+	typedef wchar_t FilePathChar;
+#else
+	typedef char FilePathChar;
+#endif
+	typedef unsigned long long FileOffset;
+
+	class MappableFile;
+	class MappingCache;
+	struct SharedView;
+
+	// Tells files apart independent of the path they were opened with. Two
+	// opens of one file compare equal while its contents are unchanged.
+	struct FileIdentity
+	{
+		// Volume serial number and file index, device and inode elsewhere
+		unsigned long long volume;
+		unsigned long long index;
+		unsigned long long size;
+		// Last write in 100 ns units, in nanoseconds elsewhere, where the
+		// status change time is kept as well since the write time can be
+		// set back. Zero on Windows.
+		unsigned long long writeTime;
+		unsigned long long changeTime;
+
+		bool operator==(const FileIdentity& other) const
+		{
+			return volume == other.volume && index == other.index &&
+				size == other.size && writeTime == other.writeTime && changeTime == other.changeTime;
+		}
+	};
+
+	// A whole file mapped into memory. Read only views share their pages
+	// with the file cache and every other process mapping the same file.
+	// Copy on write views start out shared as well, pages written to become
+	// private to the view.
+	//
+	// Plain C++ without CLR or XACT dependencies, so the load path can be
+	// built and tested on other platforms.
+	class FileMapping
+	{
+		friend class MappableFile;
+		friend class MappingCache;
+
+		// Start of the data, may lie past the start of the view when a
+		// region was mapped, see MappableFile
+		void* pView;
+		size_t size;
+		void* pViewBase;
+		size_t viewSize;
+		// Set for views handed out by the MappingCache, which unmaps the
+		// view once the last mapping of it is closed
+		SharedView* pSharedView;
+
+		void Unmap();
+
+		FileMapping(const FileMapping&);
+		FileMapping& operator=(const FileMapping&);
+
+	public:
+		enum Access
+		{
+			AccessReadOnly,
+			AccessCopyOnWrite,
+		};
+
+		FileMapping();
+		~FileMapping();
+
+		// Maps the file at path. Returns 0 on success, the system error
+		// code (GetLastError or errno) otherwise. An empty file maps to a
+		// null view of size 0.
+		int Open(const FilePathChar* path, Access access);
+		void Close();
+
+		bool IsOpen() const { return pView != NULL; }
+		void* GetData() const { return pView; }
+		size_t GetSize() const { return size; }
+	};
+
+	// A file opened once to map any number of regions of it, e.g. the
+	// banks in a bank pack. Mappings stay valid after the file is closed.
+	class MappableFile
+	{
+#if defined(_WIN32)
+		void* hFile;
+		void* hMapping;
+#else
+		int fd;
+#endif
+		FileOffset size;
+		FileIdentity identity;
+
+		MappableFile(const MappableFile&);
+		MappableFile& operator=(const MappableFile&);
+
+	public:
+		MappableFile();
+		~MappableFile();
+
+		// Returns 0 on success, the system error code otherwise. On
+		// Windows the file is opened for overlapped reads as well.
+		int Open(const FilePathChar* path);
+		void Close();
+
+		bool IsOpen() const;
+		FileOffset GetSize() const { return size; }
+		const FileIdentity& GetIdentity() const { return identity; }
+#if defined(_WIN32)
+		// For reads of streaming wave banks, see Native::WaveBank
+		void* GetHandle() const { return hFile; }
+#endif
+
+		// Maps size bytes at offset into mapping. Returns 0 on success, the
+		// system error code otherwise. An empty region maps to a null view.
+		int Map(FileOffset offset, size_t size, FileMapping::Access access, FileMapping& mapping) const;
+	};
+
+	struct MappingCacheStatistics
+	{
+		// Maps served by a view already mapped, and maps that mapped one
+		unsigned long long hits;
+		unsigned long long misses;
+		// Views currently shared through the cache, and their bytes
+		unsigned int viewCount;
+		unsigned long long viewBytes;
+	};
+
+	// Read only views shared by everyone in the process mapping the same
+	// region of the same file, e.g. a wave bank loaded by several engines.
+	// Views are looked up by file identity, offset and size, so a hit maps
+	// and reads nothing; rewritten files differ in their write and change
+	// times. A miss maps the region and hashes all of it, and still shares
+	// the view of a file whose times changed while that region did not.
+	// Views are reference counted by the FileMappings handed out and
+	// unmapped with the last of them.
+	class MappingCache
+	{
+		static void Release(SharedView* pSharedView);
+		// Hands out a reference to the view, the caller holds the cache lock
+		static void Share(SharedView* pSharedView, FileMapping& mapping);
+
+		friend class FileMapping;
+
+	public:
+		// Maps size bytes at offset of file read only into mapping. Returns 0
+		// on success, the system error code otherwise.
+		static int Map(const MappableFile& file, FileOffset offset, size_t size, FileMapping& mapping);
+		// Maps the whole file at path read only, see Map
+		static int Open(const FilePathChar* path, FileMapping& mapping);
+
+		static void GetStatistics(MappingCacheStatistics& statistics);
+	};
+
+}}}
@@ -0,0 +1,234 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeGlobalSettingsFile.h
+
+#include <string.h>
+
+#include "NativeGlobalSettingsFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const size_t HeaderSize = 77;
+	const size_t CategorySize = 10;
+	const size_t VariableSize = 13;
+	const size_t RpcHeaderSize = 5;
+	const size_t RpcPointSize = 9;
+	// Parent of the root category
+	const uint16 NoParentCategory = 0xFFFF;
+}
+
+GlobalSettingsFile::GlobalSettingsFile()
+{
+	Clear();
+}
+
+GlobalSettingsFile::~GlobalSettingsFile()
+{
+}
+
+void GlobalSettingsFile::Clear()
+{
+	contentVersion = 0;
+	formatVersion = 0;
+	categories.Clear();
+	variables.Clear();
+	rpcs.Clear();
+	rpcPoints.Clear();
+	categoryNames.Clear();
+	variableNames.Clear();
+	nameData.Clear();
+}
+
+BankParseResult GlobalSettingsFile::Parse(const void* pData, size_t size)
+{
+	Clear();
+
+	BankReader reader(pData, size);
+	if (reader.ReadSignature("XGSF") == false)
+	{
+		return BankParseInvalidSignature;
+	}
+	if (reader.Contains(0, HeaderSize) == false)
+	{
+		return BankParseTruncated;
+	}
+
+	contentVersion = reader.ReadUInt16(4);
+	formatVersion = reader.ReadUInt16(6);
+	if (formatVersion != FormatVersion)
+	{
+		return BankParseUnsupportedVersion;
+	}
+
+	// 8: CRC, 10: last modified, 18: platform, 31: DSP parameter count
+	uint32 categoryCount = reader.ReadUInt16(19);
+	uint32 variableCount = reader.ReadUInt16(21);
+	uint32 rpcCount = reader.ReadUInt16(27);
+	uint32 categoryOffset = reader.ReadUInt32(33);
+	uint32 variableOffset = reader.ReadUInt32(37);
+	uint32 categoryNameOffset = reader.ReadUInt32(57);
+	uint32 variableNameOffset = reader.ReadUInt32(61);
+	uint32 rpcOffset = reader.ReadUInt32(65);
+
+	//
+	// Categories
+	//
+
+	if (reader.Contains(categoryOffset, categoryCount * CategorySize) == false)
+	{
+		return BankParseTruncated;
+	}
+	categories.Resize(categoryCount);
+	for (uint32 i = 0; i < categoryCount; i++)
+	{
+		size_t offset = categoryOffset + i * CategorySize;
+
+		SettingsCategory& category = categories[i];
+		category.instanceLimit = reader.ReadUInt8(offset);
+		category.fadeInMilliseconds = reader.ReadUInt16(offset + 1);
+		category.fadeOutMilliseconds = reader.ReadUInt16(offset + 3);
+		category.maxInstanceBehavior = static_cast<uint8>(reader.ReadUInt8(offset + 5) >> 3);
+		uint16 parentCategory = reader.ReadUInt16(offset + 6);
+		category.parentCategory = parentCategory == NoParentCategory ? InvalidIndex : parentCategory;
+		category.volume = reader.ReadUInt8(offset + 8);
+		category.visibility = reader.ReadUInt8(offset + 9);
+
+		if (category.parentCategory != InvalidIndex && category.parentCategory >= categoryCount)
+		{
+			return BankParseInvalidData;
+		}
+	}
+
+	//
+	// Variables
+	//
+
+	if (reader.Contains(variableOffset, variableCount * VariableSize) == false)
+	{
+		return BankParseTruncated;
+	}
+	variables.Resize(variableCount);
+	for (uint32 i = 0; i < variableCount; i++)
+	{
+		size_t offset = variableOffset + i * VariableSize;
+
+		SettingsVariable& variable = variables[i];
+		variable.flags = reader.ReadUInt8(offset);
+		variable.initialValue = reader.ReadFloat(offset + 1);
+		variable.minValue = reader.ReadFloat(offset + 5);
+		variable.maxValue = reader.ReadFloat(offset + 9);
+	}
+
+	//
+	// RPC curves, stored back to back
+	//
+
+	size_t offset = rpcOffset;
+	rpcs.Resize(rpcCount);
+	for (uint32 i = 0; i < rpcCount; i++)
+	{
+		if (reader.Contains(offset, RpcHeaderSize) == false)
+		{
+			return BankParseTruncated;
+		}
+
+		SettingsRpc& rpc = rpcs[i];
+		rpc.offset = static_cast<uint32>(offset);
+		rpc.variable = reader.ReadUInt16(offset);
+		rpc.pointCount = reader.ReadUInt8(offset + 2);
+		rpc.parameter = reader.ReadUInt16(offset + 3);
+		rpc.firstPoint = rpcPoints.GetCount();
+		offset += RpcHeaderSize;
+
+		if (rpc.variable >= variableCount)
+		{
+			return BankParseInvalidData;
+		}
+		if (reader.Contains(offset, rpc.pointCount * RpcPointSize) == false)
+		{
+			return BankParseTruncated;
+		}
+		for (uint32 point = 0; point < rpc.pointCount; point++, offset += RpcPointSize)
+		{
+			SettingsRpcPoint rpcPoint;
+			rpcPoint.x = reader.ReadFloat(offset);
+			rpcPoint.y = reader.ReadFloat(offset + 4);
+			rpcPoint.type = reader.ReadUInt8(offset + 8);
+			rpcPoints.Add(rpcPoint);
+		}
+	}
+
+	//
+	// Names, zero terminated and back to back in index order
+	//
+
+	BankParseResult result = ParseNames(reader, categoryNameOffset, categoryCount, categoryNames);
+	if (result == BankParseOk)
+	{
+		result = ParseNames(reader, variableNameOffset, variableCount, variableNames);
+	}
+	return result;
+}
+
+BankParseResult GlobalSettingsFile::ParseNames(const BankReader& reader, size_t offset, uint32 count, BankArray<uint32>& names)
+{
+	names.Reserve(count);
+	for (uint32 i = 0; i < count; i++)
+	{
+		names.Add(nameData.GetCount());
+		for (;;)
+		{
+			if (reader.Contains(offset, 1) == false)
+			{
+				return BankParseTruncated;
+			}
+			char c = static_cast<char>(reader.ReadUInt8(offset++));
+			nameData.Add(c);
+			if (c == '\0')
+			{
+				break;
+			}
+		}
+	}
+	return BankParseOk;
+}
+
+uint32 GlobalSettingsFile::FindName(const BankArray<uint32>& names, const char* name) const
+{
+	for (uint32 i = 0; i < names.GetCount(); i++)
+	{
+		if (strcmp(nameData.GetData() + names[i], name) == 0)
+		{
+			return i;
+		}
+	}
+	return InvalidIndex;
+}
+
+uint32 GlobalSettingsFile::FindRpc(uint32 offset) const
+{
+	// Curves are parsed in file order, so sorted by offset
+	uint32 low = 0;
+	uint32 high = rpcs.GetCount();
+	while (low < high)
+	{
+		uint32 middle = low + (high - low) / 2;
+		if (rpcs[middle].offset < offset)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low < rpcs.GetCount() && rpcs[low].offset == offset ? low : InvalidIndex;
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	struct SettingsCategory
+	{
+		// Most instances playing at once, 0xFF for no limit
+		uint8 instanceLimit;
+		// See SoundBankCue::maxInstanceBehavior
+		uint8 maxInstanceBehavior;
+		uint16 fadeInMilliseconds;
+		uint16 fadeOutMilliseconds;
+		// Category index, GlobalSettingsFile::InvalidIndex for the root
+		uint32 parentCategory;
+		// Volume as stored by the authoring tool, 0 to 255
+		uint8 volume;
+		uint8 visibility;
+	};
+
+	struct SettingsVariable
+	{
+		// GlobalSettingsFile::VariableFlag* values
+		uint8 flags;
+		float initialValue;
+		float minValue;
+		float maxValue;
+	};
+
+	struct SettingsRpcPoint
+	{
+		float x;
+		float y;
+		// Curve shape towards the next point: linear, fast, slow, sin/cos
+		uint8 type;
+	};
+
+	// A runtime parameter control curve mapping a variable to a sound or
+	// track parameter
+	struct SettingsRpc
+	{
+		// Position of the curve in the file, what sound banks refer to it by
+		uint32 offset;
+		// Variable index the curve is evaluated for
+		uint16 variable;
+		uint16 parameter;
+		// Range in GlobalSettingsFile's point table
+		uint32 firstPoint;
+		uint32 pointCount;
+	};
+
+	// Index of XACT3 global settings (.xgs) built from the file contents
+	// alone, without an engine: categories, global and per-cue variables
+	// and RPC curves, each as a flat table. Category and variable indices
+	// are the XACTCATEGORY and XACTVARIABLEINDEX values XACT assigns, so
+	// names can be resolved once at load and the indices used from then
+	// on. Everything is copied out of the data passed to Parse.
+	//
+	// Plain C++ without CLR or XACT dependencies, see NativeFileMapping.h.
+	class GlobalSettingsFile
+	{
+		uint16 contentVersion;
+		uint16 formatVersion;
+
+		BankArray<SettingsCategory> categories;
+		BankArray<SettingsVariable> variables;
+		BankArray<SettingsRpc> rpcs;
+		BankArray<SettingsRpcPoint> rpcPoints;
+
+		// Offsets into nameData
+		BankArray<uint32> categoryNames;
+		BankArray<uint32> variableNames;
+		BankArray<char> nameData;
+
+		GlobalSettingsFile(const GlobalSettingsFile&);
+		GlobalSettingsFile& operator=(const GlobalSettingsFile&);
+
+		void Clear();
+		BankParseResult ParseNames(const BankReader& reader, size_t offset, uint32 count, BankArray<uint32>& names);
+		uint32 FindName(const BankArray<uint32>& names, const char* name) const;
+
+	public:
+		static const uint16 FormatVersion = 42;
+		static const uint32 InvalidIndex = 0xFFFFFFFF;
+
+		// Variable flags
+		static const uint8 VariableFlagPublic = 0x01;
+		static const uint8 VariableFlagReadOnly = 0x02;
+		// Per-cue variable, not visible through the engine
+		static const uint8 VariableFlagCue = 0x04;
+		// Set by XACT, like NumCueInstances or AttackTime
+		static const uint8 VariableFlagReserved = 0x08;
+
+		GlobalSettingsFile();
+		~GlobalSettingsFile();
+
+		BankParseResult Parse(const void* pData, size_t size);
+
+		uint16 GetContentVersion() const { return contentVersion; }
+		uint16 GetFormatVersion() const { return formatVersion; }
+
+		uint32 GetCategoryCount() const { return categories.GetCount(); }
+		const SettingsCategory& GetCategory(uint32 index) const { return categories[index]; }
+		const char* GetCategoryName(uint32 index) const { return nameData.GetData() + categoryNames[index]; }
+		// Returns InvalidIndex for unknown names
+		uint32 FindCategory(const char* name) const { return FindName(categoryNames, name); }
+
+		// Global and per-cue variables share one table, as in XACT
+		uint32 GetVariableCount() const { return variables.GetCount(); }
+		const SettingsVariable& GetVariable(uint32 index) const { return variables[index]; }
+		const char* GetVariableName(uint32 index) const { return nameData.GetData() + variableNames[index]; }
+		bool IsGlobalVariable(uint32 index) const { return (variables[index].flags & VariableFlagCue) == 0; }
+		// Returns InvalidIndex for unknown names
+		uint32 FindVariable(const char* name) const { return FindName(variableNames, name); }
+
+		uint32 GetRpcCount() const { return rpcs.GetCount(); }
+		const SettingsRpc& GetRpc(uint32 index) const { return rpcs[index]; }
+		const SettingsRpcPoint* GetRpcPoints() const { return rpcPoints.GetData(); }
+		// Looks a curve up by its file offset, returns InvalidIndex if
+		// there is none
+		uint32 FindRpc(uint32 offset) const;
+	};
+
+}}}
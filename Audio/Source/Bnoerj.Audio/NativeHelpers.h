@@ -1,79 +1,153 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-namespace Bnoerj { namespace Native { namespace Helpers {
-
-	using namespace System;
-	using namespace System::Runtime::InteropServices;
-
-	ref class StringConverter
-	{
-	private:
-		// Handle for marshalling the unmanged string pointer.
-		IntPtr unmanagedStringPointer;
-
-		// Constructor for the managed to native conversion.
-		StringConverter(String^ managedString)
-		{
-			this->unmanagedStringPointer = Marshal::StringToHGlobalAnsi(managedString);
-		}
-
-		// Constructor for the managed to native conversion.
-		StringConverter(String^ managedString, bool)
-		{
-			this->unmanagedStringPointer = Marshal::StringToHGlobalUni(managedString);
-		}
-
-		// Converts the marshalled pointer to a native string.
-		char* ToNativeString()
-		{
-			return static_cast<char*>(this->unmanagedStringPointer.ToPointer());
-		}
-
-		// Converts the marshalled pointer to a native string.
-		wchar_t* ToNativeStringUni()
-		{
-			return static_cast<wchar_t*>(this->unmanagedStringPointer.ToPointer());
-		}
-
-	public:
-		// Converts a managed string to a native string.
-		static char* ToNativeString(String^ managedString)
-		{
-			return (gcnew StringConverter(managedString))->ToNativeString();
-		}
-
-		// Converts a managed string to a native string.
-		static wchar_t* ToNativeStringUni(String^ managedString)
-		{
-			return (gcnew StringConverter(managedString, true))->ToNativeStringUni();
-		}
-
-		// Converts a native string to a managed string.
-		static String^ ToString(char* nativeString)
-		{
-			return Marshal::PtrToStringAnsi(static_cast<IntPtr>(nativeString));
-		}
-
-		// Converts a native string to a managed string.
-		static String^ ToString(wchar_t* nativeString)
-		{
-			return Marshal::PtrToStringUni(static_cast<IntPtr>(nativeString));
-		}
-
-		// Destructor (implicitly implements IDisposable)
-		~StringConverter()
-		{
-			if(this->unmanagedStringPointer != IntPtr::Zero)
-			{
-				Marshal::FreeHGlobal(this->unmanagedStringPointer);
-			}
-		}
-	};
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include <vcclr.h>
+
+namespace Bnoerj { namespace Native { namespace Helpers {
+
+	using namespace System;
+	using namespace System::Runtime::InteropServices;
+
+	// Heap allocations made by the per-call paths, shared by all engines.
+	// Both only grow while names are seen for the first time, so in steady
+	// state they stay flat.
+	struct AllocationCounters
+	{
+		// String conversions too long for the inline buffer
+		volatile LONG marshalHeapAllocations;
+		// Entries added to the cue, variable and category name caches
+		volatile LONG cacheAllocations;
+	};
+
+	__declspec(selectany) AllocationCounters allocationCounters = { 0, 0 };
+
+	// Zero terminated ANSI copy of a managed string for the lifetime of the
+	// scope. Strings converting to up to 255 bytes, which covers every name
+	// XACT knows in any code page, are converted into the inline buffer,
+	// longer ones fall back to the heap. Throws if the string cannot be
+	// converted.
+	class NativeString
+	{
+		static const int BufferSize = 256;
+
+		char buffer[BufferSize];
+		char* pString;
+
+		NativeString(const NativeString&);
+		NativeString& operator=(const NativeString&);
+
+	public:
+		explicit NativeString(String^ managedString)
+			: pString(buffer)
+		{
+			int length = managedString->Length;
+			if (length == 0)
+			{
+				buffer[0] = '\0';
+				return;
+			}
+
+			pin_ptr<const wchar_t> pChars = PtrToStringChars(managedString);
+			int count = ::WideCharToMultiByte(CP_ACP, 0, pChars, length, buffer, BufferSize - 1, NULL, NULL);
+			if (count == 0 && ::GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+			{
+				// A character may take more than two bytes, as in UTF-8, so
+				// the size is asked for
+				int size = ::WideCharToMultiByte(CP_ACP, 0, pChars, length, NULL, 0, NULL, NULL);
+				if (size > 0)
+				{
+					pString = new char[size + 1];
+					::InterlockedIncrement(&allocationCounters.marshalHeapAllocations);
+					count = ::WideCharToMultiByte(CP_ACP, 0, pChars, length, pString, size, NULL, NULL);
+				}
+			}
+			if (count == 0)
+			{
+				int error = ::GetLastError();
+				if (pString != buffer)
+				{
+					delete[] pString;
+				}
+				Marshal::ThrowExceptionForHR(HRESULT_FROM_WIN32(error));
+			}
+			pString[count] = '\0';
+		}
+
+		~NativeString()
+		{
+			if (pString != buffer)
+			{
+				delete[] pString;
+			}
+		}
+
+		operator const char*() const
+		{
+			return pString;
+		}
+	};
+
+	// Zero terminated UTF-16 copy of a managed string for the lifetime of
+	// the scope, see NativeString.
+	class NativeStringUni
+	{
+		static const int BufferSize = MAX_PATH;
+
+		wchar_t buffer[BufferSize];
+		wchar_t* pString;
+
+		NativeStringUni(const NativeStringUni&);
+		NativeStringUni& operator=(const NativeStringUni&);
+
+	public:
+		explicit NativeStringUni(String^ managedString)
+			: pString(buffer)
+		{
+			int length = managedString->Length;
+			if (length + 1 > BufferSize)
+			{
+				pString = new wchar_t[length + 1];
+				::InterlockedIncrement(&allocationCounters.marshalHeapAllocations);
+			}
+
+			pin_ptr<const wchar_t> pChars = PtrToStringChars(managedString);
+			::memcpy(pString, pChars, length * sizeof(wchar_t));
+			pString[length] = L'\0';
+		}
+
+		~NativeStringUni()
+		{
+			if (pString != buffer)
+			{
+				delete[] pString;
+			}
+		}
+
+		operator wchar_t*() const
+		{
+			return pString;
+		}
+	};
+
+	ref class StringConverter abstract sealed
+	{
+	public:
+		// Converts a native string to a managed string.
+		static String^ ToString(char* nativeString)
+		{
+			return Marshal::PtrToStringAnsi(static_cast<IntPtr>(nativeString));
+		}
+
+		// Converts a native string to a managed string.
+		static String^ ToString(wchar_t* nativeString)
+		{
+			return Marshal::PtrToStringUni(static_cast<IntPtr>(nativeString));
+		}
+	};
+}}}
@@ -0,0 +1,66 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Recursive lock for the per-call paths. Unlike msclr::lock, which is
+	// a managed object allocated for every scope it guards, taking this
+	// lock never allocates.
+	class CriticalSection
+	{
+		CRITICAL_SECTION criticalSection;
+
+		CriticalSection(const CriticalSection&);
+		CriticalSection& operator=(const CriticalSection&);
+
+	public:
+		CriticalSection()
+		{
+			// Spin a little before waiting, the lock is held only briefly
+			::InitializeCriticalSectionAndSpinCount(&criticalSection, 4000);
+		}
+
+		~CriticalSection()
+		{
+			::DeleteCriticalSection(&criticalSection);
+		}
+
+		void Enter()
+		{
+			::EnterCriticalSection(&criticalSection);
+		}
+
+		void Leave()
+		{
+			::LeaveCriticalSection(&criticalSection);
+		}
+	};
+
+	// Holds a CriticalSection for the lifetime of the scope.
+	class ScopedLock
+	{
+		CriticalSection* pCriticalSection;
+
+		ScopedLock(const ScopedLock&);
+		ScopedLock& operator=(const ScopedLock&);
+
+	public:
+		explicit ScopedLock(CriticalSection* pCriticalSection)
+			: pCriticalSection(pCriticalSection)
+		{
+			pCriticalSection->Enter();
+		}
+
+		~ScopedLock()
+		{
+			pCriticalSection->Leave();
+		}
+	};
+
+}}}
@@ -0,0 +1,41 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeRingBuffer.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Capacity of an engine's notification queue, must be a power of two
+	const LONG NotificationQueueCapacity = 1024;
+
+	struct Notification
+	{
+		IXACT3Cue* pCue;
+		// Value of the notification sequence when the cue was destroyed.
+		// Cues prepared after this value may reuse the same address.
+		LONG sequence;
+		// Handle of the managed cue, looked up when the notification is
+		// dispatched, see CueStateTable::Destroyed
+		LONGLONG instance;
+	};
+
+	// Shared by an engine and the XACT notification callback. The callback
+	// only pushes, the engine only pops during Update.
+	struct NotificationQueue
+	{
+		RingBuffer<Notification> notifications;
+		volatile LONG droppedCount;
+
+		NotificationQueue()
+			: notifications(NotificationQueueCapacity)
+			, droppedCount(0)
+		{}
+	};
+
+}}}
@@ -0,0 +1,120 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Bounded lock-free queue for any number of producers and a single
+	// consumer. Every cell carries a sequence number that tells producers
+	// and the consumer whether the cell is free, written or being written,
+	// so Push never waits on another thread. Push fails if the queue is full,
+	// Pop must only be called from one thread at a time.
+	template<typename T>
+	class RingBuffer
+	{
+		struct Cell
+		{
+			volatile LONG sequence;
+			T value;
+		};
+
+		Cell* cells;
+		LONG mask;
+
+		// Keep the producer and consumer positions on different cache lines
+		BYTE padding0[64];
+		volatile LONG enqueuePos;
+		BYTE padding1[64];
+		volatile LONG dequeuePos;
+		BYTE padding2[64];
+
+		RingBuffer(const RingBuffer&);
+		RingBuffer& operator=(const RingBuffer&);
+
+	public:
+		// Capacity must be a power of two.
+		explicit RingBuffer(LONG capacity)
+			: cells(new Cell[capacity])
+			, mask(capacity - 1)
+			, enqueuePos(0)
+			, dequeuePos(0)
+		{
+			for (LONG i = 0; i < capacity; i++)
+			{
+				cells[i].sequence = i;
+			}
+		}
+
+		~RingBuffer()
+		{
+			delete[] cells;
+		}
+
+		LONG GetCapacity() const
+		{
+			return mask + 1;
+		}
+
+		// Number of written cells not yet popped. Only a snapshot while
+		// producers are active.
+		LONG GetCount() const
+		{
+			return enqueuePos - dequeuePos;
+		}
+
+		bool Push(const T& value)
+		{
+			LONG pos = enqueuePos;
+			for (;;)
+			{
+				Cell* cell = &cells[pos & mask];
+				LONG dif = cell->sequence - pos;
+				if (dif == 0)
+				{
+					// The cell is free, try to claim it
+					LONG prev = ::InterlockedCompareExchange(&enqueuePos, pos + 1, pos);
+					if (prev == pos)
+					{
+						cell->value = value;
+						::InterlockedExchange(&cell->sequence, pos + 1);
+						return true;
+					}
+					pos = prev;
+				}
+				else if (dif < 0)
+				{
+					// The consumer has not yet released this cell, queue is full
+					return false;
+				}
+				else
+				{
+					// Another producer claimed the cell, reload the position
+					pos = enqueuePos;
+				}
+			}
+		}
+
+		bool Pop(T& value)
+		{
+			LONG pos = dequeuePos;
+			Cell* cell = &cells[pos & mask];
+			LONG dif = cell->sequence - (pos + 1);
+			if (dif < 0)
+			{
+				// Empty, or the producer of this cell has not finished writing
+				return false;
+			}
+
+			value = cell->value;
+			::InterlockedExchange(&cell->sequence, pos + mask + 1);
+			dequeuePos = pos + 1;
+			return true;
+		}
+	};
+
+}}}
@@ -1,113 +1,416 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "NativeEngine.h"
-#include "NativeCue.h"
-#include "NativeSoundBank.h"
-#include "NativeHelpers.h"
-#include "ErrorToException.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio::Native;
-using namespace Bnoerj::Native::Helpers;
-
-SoundBank::SoundBank(IXACT3Engine* pEngine, String^ filename)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	array<Byte>^ aData = File::ReadAllBytes(filename);
-	void* pData = NULL;
-	if (aData != nullptr && aData->Length > 0)
-	{
-		pin_ptr<Byte> pSettings = &aData[0];
-		pData = new BYTE[aData->Length];
-		memcpy_s(pData, aData->Length, pSettings, aData->Length);
-	}
-
-	IXACT3SoundBank* pSoundBank;
-	HRESULT hr = pEngine->CreateSoundBank(pData, aData->Length, 0, 0, &pSoundBank);
-	if (FAILED(hr))
-	{
-		delete[] pData;
-		ErrorToException::Throw(hr);
-	}
-
-	this->pEngine = pEngine;
-	this->pData = pData;
-	this->pObject = pSoundBank;
-}
-
-void SoundBank::Release()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
-	pSoundBank->Destroy();
-
-	BYTE* pData = static_cast<BYTE*>(this->pData);
-	delete[] pData;
-}
-
-Cue^ SoundBank::GetCue(String^ name)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTINDEX index = pSoundBank->GetCueIndex(pName);
-	if (index == XACTINDEX_INVALID)
-	{
-		return nullptr;
-	}
-
-	IXACT3Cue* pCue;
-	HRESULT hr = pSoundBank->Prepare(index, 0, 0, &pCue);
-	if (FAILED(hr))
-	{
-		return nullptr;
-	}
-	return gcnew Cue(pEngine, pCue);
-}
-
-DWORD SoundBank::GetStatus()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
-	DWORD state;
-	HRESULT hr = pSoundBank->GetState(&state);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-	return state;
-}
-
-void SoundBank::PlayCue(String^ name)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
-
-	PCSTR pName = StringConverter::ToNativeString(name);
-	XACTINDEX index = pSoundBank->GetCueIndex(pName);
-	if (index == XACTINDEX_INVALID)
-	{
-		return;
-		//ErrorToException::Throw(hr);
-	}
-
-	HRESULT hr = pSoundBank->Play(index, 0, 0, NULL);
-	if (FAILED(hr))
-	{
-		return;
-		//ErrorToException::Throw(hr);
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeEngine.h"
+#include "NativeCue.h"
+#include "NativeSoundBank.h"
+#include "NativeSoundBankFile.h"
+#include "NativeHelpers.h"
+#include "ErrorToException.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio::Native;
+using namespace Bnoerj::Native::Helpers;
+
+SoundBank::SoundBank(Engine^ engine, String^ filename)
+	: pCuePool(NULL)
+{
+	// XACT writes to sound bank data, pages written become private
+	Create(engine, Engine::MapFile(filename, FileMapping::AccessCopyOnWrite));
+	source = gcnew FileBankSource(filename, FileMapping::AccessCopyOnWrite);
+}
+
+SoundBank::SoundBank(Engine^ engine, FileMapping* pMapping, BankSource^ source)
+	: pCuePool(NULL)
+{
+	Create(engine, pMapping);
+	this->source = source;
+}
+
+void SoundBank::Create(Engine^ engine, FileMapping* pMapping)
+{
+	// Read before XACT writes to the data
+	SoundBankFile soundBankFile;
+	if (soundBankFile.Parse(pMapping->GetData(), pMapping->GetSize()) == BankParseOk)
+	{
+		waveBankNames = gcnew array<String^>(soundBankFile.GetWaveBankCount());
+		for (uint32 i = 0; i < soundBankFile.GetWaveBankCount(); i++)
+		{
+			waveBankNames[i] = gcnew String(soundBankFile.GetWaveBankName(i));
+		}
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3SoundBank* pSoundBank = CreateSoundBank(engine, pMapping);
+
+	XACTINDEX cueCount = 0;
+	pSoundBank->GetNumCues(&cueCount);
+	variableIndices = gcnew array<Dictionary<String^, XACTVARIABLEINDEX>^>(cueCount);
+
+	BuildCueTables(pSoundBank);
+}
+
+IXACT3SoundBank* SoundBank::CreateSoundBank(Engine^ engine, FileMapping* pMapping)
+{
+	IXACT3Engine* pEngine = engine->pEngine;
+
+	IXACT3SoundBank* pSoundBank;
+	HRESULT hr = pEngine->CreateSoundBank(pMapping->GetData(), static_cast<DWORD>(pMapping->GetSize()), 0, 0, &pSoundBank);
+	if (FAILED(hr))
+	{
+		delete pMapping;
+		ErrorToException::Throw(hr);
+	}
+
+	this->engine = engine;
+	this->pEngine = pEngine;
+	this->pMapping = pMapping;
+	this->pObject = pSoundBank;
+	return pSoundBank;
+}
+
+void SoundBank::Reload(FileMapping* pMapping)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	CreateSoundBank(engine, pMapping);
+
+	if (cuePoolSizes != nullptr)
+	{
+		// Fill the pool with the next Update rather than the first cue
+		GetCuePool();
+	}
+}
+
+bool SoundBank::IsInUse()
+{
+	return (GetStatus() & XACT_SOUNDBANKSTATE_INUSE) != 0;
+}
+
+void SoundBank::BuildCueTables(IXACT3SoundBank* pSoundBank)
+{
+	XACTINDEX cueCount = 0;
+	pSoundBank->GetNumCues(&cueCount);
+
+	cueIndices = gcnew Dictionary<String^, XACTINDEX>(cueCount, StringComparer::Ordinal);
+	cueNames = gcnew array<String^>(cueCount);
+	hasFriendlyNames = true;
+
+	for (XACTINDEX i = 0; i < cueCount; i++)
+	{
+		XACT_CUE_PROPERTIES properties;
+		HRESULT hr = pSoundBank->GetCueProperties(i, &properties);
+		if (FAILED(hr) || properties.friendlyName[0] == '\0')
+		{
+			// Sound banks built without friendly names still resolve
+			// names through XACT, see GetCueIndex
+			hasFriendlyNames = false;
+			cueIndices->Clear();
+			break;
+		}
+
+		String^ name = gcnew String(properties.friendlyName);
+		cueNames[i] = name;
+		cueIndices[name] = i;
+	}
+}
+
+XACTINDEX SoundBank::GetCueIndex(String^ name)
+{
+	XACTINDEX index;
+	if (hasFriendlyNames == true)
+	{
+		if (cueIndices->TryGetValue(name, index) == false)
+		{
+			index = XACTINDEX_INVALID;
+		}
+		return index;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	// Unknown names are cached as well, as XACTINDEX_INVALID
+	if (cueIndices->TryGetValue(name, index) == false)
+	{
+		IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+		if (pSoundBank == NULL)
+		{
+			// Not cached, the bank resolves it once loaded again
+			return XACTINDEX_INVALID;
+		}
+		NativeString nativeName(name);
+		index = pSoundBank->GetCueIndex(nativeName);
+		cueIndices->Add(name, index);
+		::InterlockedIncrement(&allocationCounters.cacheAllocations);
+		if (index != XACTINDEX_INVALID && index < static_cast<XACTINDEX>(cueNames->Length))
+		{
+			cueNames[index] = name;
+		}
+	}
+	return index;
+}
+
+String^ SoundBank::GetCueName(XACTINDEX index)
+{
+	if (index >= static_cast<XACTINDEX>(cueNames->Length))
+	{
+		return nullptr;
+	}
+	return cueNames[index];
+}
+
+XACTINDEX SoundBank::GetCueCount()
+{
+	return static_cast<XACTINDEX>(cueNames->Length);
+}
+
+void SoundBank::Release()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	// Queued commands hold cues of this bank, which go with it
+	engine->FlushCommands();
+
+	if (pCuePool != NULL)
+	{
+		engine->RemoveCuePool(this);
+		delete pCuePool;
+		pCuePool = NULL;
+	}
+
+	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+	if (pSoundBank != NULL)
+	{
+		// The cues of the bank are destroyed with it
+		engine->pCueStates->Orphan(pSoundBank);
+		pSoundBank->Destroy();
+	}
+	pObject = NULL;
+
+	delete pMapping;
+	pMapping = NULL;
+}
+
+Cue^ SoundBank::GetCue(String^ name)
+{
+	return GetCue(GetCueIndex(name));
+}
+
+Cue^ SoundBank::GetCue(XACTINDEX index)
+{
+	if (index >= GetCueCount())
+	{
+		return nullptr;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+	if (pSoundBank == NULL)
+	{
+		// Unloaded by the memory budget since it was last used
+		return nullptr;
+	}
+
+	IXACT3Cue* pCue;
+	HRESULT hr = pSoundBank->Prepare(index, 0, 0, &pCue);
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+	return gcnew Cue(engine, pEngine, pCue, this, index);
+}
+
+XACTVARIABLEINDEX SoundBank::GetVariableIndex(XACTINDEX cueIndex, IXACT3Cue* pCue, String^ name)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	Dictionary<String^, XACTVARIABLEINDEX>^ indices = variableIndices[cueIndex];
+	if (indices == nullptr)
+	{
+		indices = gcnew Dictionary<String^, XACTVARIABLEINDEX>();
+		variableIndices[cueIndex] = indices;
+		::InterlockedIncrement(&allocationCounters.cacheAllocations);
+	}
+
+	// Unknown names are cached as well, as XACTVARIABLEINDEX_INVALID
+	XACTVARIABLEINDEX index;
+	if (indices->TryGetValue(name, index) == false)
+	{
+		NativeString nativeName(name);
+		index = pCue->GetVariableIndex(nativeName);
+		indices->Add(name, index);
+		::InterlockedIncrement(&allocationCounters.cacheAllocations);
+	}
+	return index;
+}
+
+DWORD SoundBank::GetStatus()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+	if (pSoundBank == NULL)
+	{
+		// Unloaded by the memory budget
+		return 0;
+	}
+
+	DWORD state;
+	HRESULT hr = pSoundBank->GetState(&state);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+	return state;
+}
+
+void SoundBank::PlayCue(String^ name)
+{
+	PlayCue(GetCueIndex(name));
+}
+
+void SoundBank::PlayCue(XACTINDEX index)
+{
+	if (index >= GetCueCount())
+	{
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+	if (pSoundBank == NULL)
+	{
+		return;
+	}
+
+	HRESULT hr = pSoundBank->Play(index, 0, 0, NULL);
+	if (FAILED(hr))
+	{
+		return;
+		//ErrorToException::Throw(hr);
+	}
+}
+
+void SoundBank::PlayCue3D(XACTINDEX index, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter)
+{
+	if (index >= GetCueCount())
+	{
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3SoundBank* pSoundBank = static_cast<IXACT3SoundBank*>(pObject);
+	if (pSoundBank == NULL)
+	{
+		return;
+	}
+
+	CuePool* pPool = GetCuePool();
+	IXACT3Cue* pCue = pPool->Take(index);
+	if (pCue != NULL)
+	{
+		::InterlockedIncrement(&engine->pStatistics->cuePoolHits);
+	}
+	else
+	{
+		::InterlockedIncrement(&engine->pStatistics->cuePoolMisses);
+		HRESULT hr = pSoundBank->Prepare(index, 0, 0, &pCue);
+		if (FAILED(hr))
+		{
+			return;
+		}
+	}
+
+	// Queued like the calls on a Cue when commands are deferred
+	engine->Apply3D(pCue, pListener, pEmitter);
+	if (engine->deferCommands == true)
+	{
+		Command command = { CommandCuePlay };
+		command.pCue = pCue;
+		engine->Submit(command);
+	}
+	else
+	{
+		HRESULT hr = pCue->Play();
+		if (FAILED(hr))
+		{
+			pCue->Destroy();
+			return;
+		}
+	}
+
+	// Destroyed by UpdateCuePool once it stopped
+	pPool->AddPlaying(pCue);
+}
+
+CuePool* SoundBank::GetCuePool()
+{
+	// Caller must hold syncRoot and the bank must be loaded
+	if (pCuePool == NULL)
+	{
+		pCuePool = new CuePool(static_cast<IXACT3SoundBank*>(pObject), GetCueCount());
+		if (cuePoolSizes != nullptr)
+		{
+			for (int i = 0; i < cuePoolSizes->Length; i++)
+			{
+				pCuePool->SetCapacity(static_cast<XACTINDEX>(i), cuePoolSizes[i]);
+			}
+		}
+		engine->AddCuePool(this);
+	}
+	return pCuePool;
+}
+
+int SoundBank::GetCuePoolSize(XACTINDEX index)
+{
+	if (index >= GetCueCount())
+	{
+		return 0;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	return cuePoolSizes != nullptr ? cuePoolSizes[index] : 0;
+}
+
+void SoundBank::SetCuePoolSize(XACTINDEX index, int size)
+{
+	if (index >= GetCueCount())
+	{
+		return;
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	if (cuePoolSizes == nullptr)
+	{
+		cuePoolSizes = gcnew array<int>(GetCueCount());
+	}
+	cuePoolSizes[index] = size;
+
+	if (pObject != NULL)
+	{
+		GetCuePool()->SetCapacity(index, size);
+	}
+}
+
+void SoundBank::UpdateCuePool()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	if (pCuePool != NULL)
+	{
+		LONG recycled = pCuePool->Update();
+		::InterlockedExchangeAdd(&engine->pStatistics->cuePoolRecycles, recycled);
+	}
+}
@@ -1,31 +1,88 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-#include "NativeAudioObject.h"
-
-using namespace System;
-using namespace System::Runtime::InteropServices;
-
-namespace Bnoerj { namespace Audio { namespace Native {
-
-	ref class Cue;
-
-	ref class SoundBank : public AudioObject
-	{
-	public:
-		SoundBank(IXACT3Engine* pEngine, String^ filename);
-
-		virtual void Release() override;
-
-		Native::Cue^ GetCue(String^ name);
-		DWORD GetStatus();
-		void PlayCue(String^ name);
-	};
-
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBank.h"
+#include "NativeCuePool.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Runtime::InteropServices;
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	ref class Cue;
+
+	ref class SoundBank : public Bank
+	{
+		// Cue variable indices by name, one dictionary per cue definition,
+		// guarded by Engine::syncRoot.
+		array<Dictionary<String^, XACTVARIABLEINDEX>^>^ variableIndices;
+
+		// Cue indices by friendly name and friendly names by cue index, built
+		// once when the sound bank is created. Both are read-only afterwards,
+		// unless the sound bank was built without friendly names; the name
+		// table is then filled on demand under Engine::syncRoot.
+		Dictionary<String^, XACTINDEX>^ cueIndices;
+		array<String^>^ cueNames;
+		bool hasFriendlyNames;
+
+		// Pool sizes by cue index, null until one is set. Kept while the
+		// bank is unloaded, the pool is created again when it is loaded.
+		array<int>^ cuePoolSizes;
+		// Created on the first PlayCue3D or SetCuePoolSize, deleted in
+		// Release, guarded by Engine::syncRoot
+		CuePool* pCuePool;
+
+	internal:
+		// Names of the wave banks the cues play from, null if the file
+		// could not be read
+		array<String^>^ waveBankNames;
+
+	private:
+		void Create(Engine^ engine, FileMapping* pMapping);
+		IXACT3SoundBank* CreateSoundBank(Engine^ engine, FileMapping* pMapping);
+		void BuildCueTables(IXACT3SoundBank* pSoundBank);
+		CuePool* GetCuePool();
+
+	public:
+		SoundBank(Engine^ engine, String^ filename);
+		// Takes ownership of the mapping, also if creating the bank fails.
+		// source may be null, the bank is then never unloaded.
+		SoundBank(Engine^ engine, FileMapping* pMapping, BankSource^ source);
+
+		virtual void Release() override;
+		virtual bool IsInUse() override;
+		// Cue tables and variable indices are kept, the data is the same
+		virtual void Reload(FileMapping* pMapping) override;
+
+		XACTINDEX GetCueIndex(String^ name);
+		String^ GetCueName(XACTINDEX index);
+		XACTINDEX GetCueCount();
+
+		Native::Cue^ GetCue(String^ name);
+		Native::Cue^ GetCue(XACTINDEX index);
+		DWORD GetStatus();
+		void PlayCue(String^ name);
+		void PlayCue(XACTINDEX index);
+		// Plays a cue from the pool without a Cue wrapper, preparing one if
+		// the pool is empty
+		void PlayCue3D(XACTINDEX index, X3DAUDIO_LISTENER* pListener, X3DAUDIO_EMITTER* pEmitter);
+
+		// Prepared cues keep the bank in use, it is then never unloaded by
+		// the memory budget. Indices past the cues have no pool, their size
+		// is 0 and setting it does nothing.
+		int GetCuePoolSize(XACTINDEX index);
+		void SetCuePoolSize(XACTINDEX index, int size);
+		// Called by Engine::Update, destroys stopped cues and fills the pool
+		void UpdateCuePool();
+
+		XACTVARIABLEINDEX GetVariableIndex(XACTINDEX cueIndex, IXACT3Cue* pCue, String^ name);
+	};
+
+}}}
@@ -0,0 +1,630 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeSoundBankFile.h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "NativeSoundBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const size_t HeaderSize = 138;
+	const size_t BankNameOffset = 74;
+	const size_t BankNameLength = 64;
+	const size_t SimpleCueSize = 5;
+	const size_t ComplexCueSize = 15;
+	const size_t CueNameIndexSize = 6;
+	const uint32 NoOffset = 0xFFFFFFFF;
+
+	// Sound flags
+	const uint8 SoundFlagComplex = 0x01;
+	const uint8 SoundFlagRpcs = 0x0E;
+	const uint8 SoundFlagDsp = 0x10;
+
+	// Complex cues play a single sound instead of a variation table
+	const uint8 CueFlagSingleSound = 0x04;
+
+	// Track event types
+	enum EventType
+	{
+		EventStop = 0,
+		EventPlayWave = 1,
+		EventPlayWaveTrackVariation = 3,
+		EventPlayWaveEffectVariation = 4,
+		EventPlayWaveTrackEffectVariation = 6,
+		EventPitch = 7,
+		EventVolume = 8,
+		EventMarker = 9,
+		EventPitchRepeating = 16,
+		EventVolumeRepeating = 17,
+		EventMarkerRepeating = 18,
+	};
+
+	const size_t EventHeaderSize = 7;
+	const size_t PlayWaveSize = 9;
+	const size_t PlayWaveVariationSize = 6;
+	const size_t EffectVariationSize = 24;
+	const size_t TrackVariationHeaderSize = 8;
+	const size_t TrackVariationEntrySize = 5;
+
+	int CompareWaves(const void* a, const void* b)
+	{
+		const WaveReference* pA = static_cast<const WaveReference*>(a);
+		const WaveReference* pB = static_cast<const WaveReference*>(b);
+		if (pA->waveBank != pB->waveBank)
+		{
+			return pA->waveBank < pB->waveBank ? -1 : 1;
+		}
+		if (pA->wave != pB->wave)
+		{
+			return pA->wave < pB->wave ? -1 : 1;
+		}
+		return 0;
+	}
+
+	// Sorts the waves and drops duplicates, returns the new count
+	uint32 SortUnique(WaveReference* pWaves, uint32 count)
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+		qsort(pWaves, count, sizeof(WaveReference), CompareWaves);
+		uint32 unique = 1;
+		for (uint32 i = 1; i < count; i++)
+		{
+			if (CompareWaves(&pWaves[i], &pWaves[unique - 1]) != 0)
+			{
+				pWaves[unique++] = pWaves[i];
+			}
+		}
+		return unique;
+	}
+
+	WaveReference ReadWave(const BankReader& reader, size_t offset)
+	{
+		// Wave index followed by the wave bank index
+		WaveReference wave;
+		wave.wave = reader.ReadUInt16(offset);
+		wave.waveBank = reader.ReadUInt8(offset + 2);
+		return wave;
+	}
+}
+
+SoundBankFile::SoundBankFile()
+{
+	Clear();
+}
+
+SoundBankFile::~SoundBankFile()
+{
+}
+
+void SoundBankFile::Clear()
+{
+	contentVersion = 0;
+	formatVersion = 0;
+	name[0] = '\0';
+	waveBankNames.Clear();
+	sounds.Clear();
+	cues.Clear();
+	cueNames.Clear();
+	cueNameData.Clear();
+	cueSounds.Clear();
+	waves.Clear();
+}
+
+BankParseResult SoundBankFile::Parse(const void* pData, size_t size)
+{
+	Clear();
+
+	BankReader reader(pData, size);
+	if (reader.ReadSignature("SDBK") == false)
+	{
+		return BankParseInvalidSignature;
+	}
+	if (reader.Contains(0, HeaderSize) == false)
+	{
+		return BankParseTruncated;
+	}
+
+	contentVersion = reader.ReadUInt16(4);
+	formatVersion = reader.ReadUInt16(6);
+	if (formatVersion != FormatVersion)
+	{
+		return BankParseUnsupportedVersion;
+	}
+
+	// 8: CRC, 10: last modified, 18: platform
+	uint32 simpleCueCount = reader.ReadUInt16(19);
+	uint32 complexCueCount = reader.ReadUInt16(21);
+	uint32 totalCueCount = reader.ReadUInt16(25);
+	uint32 waveBankCount = reader.ReadUInt8(27);
+	uint32 soundCount = reader.ReadUInt16(28);
+	uint32 simpleCueOffset = reader.ReadUInt32(34);
+	uint32 complexCueOffset = reader.ReadUInt32(38);
+	uint32 waveBankNameOffset = reader.ReadUInt32(58);
+	uint32 cueNameIndexOffset = reader.ReadUInt32(66);
+	uint32 soundOffset = reader.ReadUInt32(70);
+	reader.ReadString(BankNameOffset, BankNameLength, name);
+
+	//
+	// Wave bank names
+	//
+
+	if (reader.Contains(waveBankNameOffset, waveBankCount * WaveBankNameLength) == false)
+	{
+		return BankParseTruncated;
+	}
+	waveBankNames.Resize(waveBankCount * (WaveBankNameLength + 1));
+	for (uint32 i = 0; i < waveBankCount; i++)
+	{
+		reader.ReadString(waveBankNameOffset + i * WaveBankNameLength, WaveBankNameLength,
+			waveBankNames.GetData() + i * (WaveBankNameLength + 1));
+	}
+
+	//
+	// Sounds, cues refer to them by offset
+	//
+
+	BankParseResult result = ParseSounds(reader, soundOffset, soundCount);
+	if (result != BankParseOk)
+	{
+		return result;
+	}
+
+	//
+	// Cues, simple ones first as XACT numbers them
+	//
+
+	if (reader.Contains(simpleCueOffset, simpleCueCount * SimpleCueSize) == false ||
+		reader.Contains(complexCueOffset, complexCueCount * ComplexCueSize) == false)
+	{
+		return BankParseTruncated;
+	}
+
+	cues.Reserve(simpleCueCount + complexCueCount);
+	for (uint32 i = 0; i < simpleCueCount; i++)
+	{
+		size_t offset = simpleCueOffset + i * SimpleCueSize;
+
+		SoundBankCue cue;
+		memset(&cue, 0, sizeof(cue));
+		cue.flags = reader.ReadUInt8(offset);
+		cue.instanceLimit = 0xFF;
+		result = ParseCue(reader, reader.ReadUInt32(offset + 1), false, cue);
+		if (result != BankParseOk)
+		{
+			return result;
+		}
+		cues.Add(cue);
+	}
+	for (uint32 i = 0; i < complexCueCount; i++)
+	{
+		size_t offset = complexCueOffset + i * ComplexCueSize;
+
+		// 5: transition table offset
+		SoundBankCue cue;
+		memset(&cue, 0, sizeof(cue));
+		cue.flags = reader.ReadUInt8(offset);
+		cue.instanceLimit = reader.ReadUInt8(offset + 9);
+		cue.fadeInMilliseconds = reader.ReadUInt16(offset + 10);
+		cue.fadeOutMilliseconds = reader.ReadUInt16(offset + 12);
+		cue.maxInstanceBehavior = static_cast<uint8>(reader.ReadUInt8(offset + 14) >> 3);
+		bool isVariation = (cue.flags & CueFlagSingleSound) == 0;
+		result = ParseCue(reader, reader.ReadUInt32(offset + 1), isVariation, cue);
+		if (result != BankParseOk)
+		{
+			return result;
+		}
+		cues.Add(cue);
+	}
+
+	//
+	// Cue names, offsets into the name strings by cue index
+	//
+
+	if (cueNameIndexOffset != NoOffset && totalCueCount > 0)
+	{
+		if (totalCueCount != cues.GetCount())
+		{
+			return BankParseInvalidData;
+		}
+		if (reader.Contains(cueNameIndexOffset, totalCueCount * CueNameIndexSize) == false)
+		{
+			return BankParseTruncated;
+		}
+
+		cueNames.Reserve(totalCueCount);
+		for (uint32 i = 0; i < totalCueCount; i++)
+		{
+			uint32 nameOffset = reader.ReadUInt32(cueNameIndexOffset + i * CueNameIndexSize);
+			if (nameOffset >= size)
+			{
+				return BankParseTruncated;
+			}
+
+			cueNames.Add(cueNameData.GetCount());
+			for (size_t offset = nameOffset; offset < size && reader.ReadUInt8(offset) != 0; offset++)
+			{
+				cueNameData.Add(static_cast<char>(reader.ReadUInt8(offset)));
+			}
+			cueNameData.Add('\0');
+		}
+	}
+
+	return BankParseOk;
+}
+
+BankParseResult SoundBankFile::ParseSounds(const BankReader& reader, size_t offset, uint32 count)
+{
+	sounds.Reserve(count);
+
+	BankArray<WaveReference> trackWaves;
+	for (uint32 i = 0; i < count; i++)
+	{
+		// 7: length of the sound entry
+		if (reader.Contains(offset, 9) == false)
+		{
+			return BankParseTruncated;
+		}
+
+		SoundBankSound sound;
+		sound.offset = static_cast<uint32>(offset);
+		sound.flags = reader.ReadUInt8(offset);
+		sound.category = reader.ReadUInt16(offset + 1);
+		sound.volume = reader.ReadUInt8(offset + 3);
+		sound.pitch = static_cast<int16>(reader.ReadUInt16(offset + 4));
+		sound.priority = reader.ReadUInt8(offset + 6);
+		sound.isComplete = true;
+		offset += 9;
+
+		trackWaves.Resize(0);
+		bool isComplex = (sound.flags & SoundFlagComplex) != 0;
+		if (isComplex == true)
+		{
+			if (reader.Contains(offset, 1) == false)
+			{
+				return BankParseTruncated;
+			}
+			sound.trackCount = reader.ReadUInt8(offset);
+			offset += 1;
+		}
+		else
+		{
+			// A simple sound plays a single wave on a single track
+			if (reader.Contains(offset, 3) == false)
+			{
+				return BankParseTruncated;
+			}
+			sound.trackCount = 1;
+			trackWaves.Add(ReadWave(reader, offset));
+			offset += 3;
+		}
+
+		// RPC and DSP preset tables, both lengths include themselves
+		for (int table = 0; table < 2; table++)
+		{
+			uint8 mask = table == 0 ? SoundFlagRpcs : SoundFlagDsp;
+			if ((sound.flags & mask) != 0)
+			{
+				if (reader.Contains(offset, 2) == false)
+				{
+					return BankParseTruncated;
+				}
+				uint16 length = reader.ReadUInt16(offset);
+				if (length < 2)
+				{
+					return BankParseInvalidData;
+				}
+				offset += length;
+			}
+		}
+
+		if (isComplex == true)
+		{
+			// Volume, event table offset, filter type, Q and frequency
+			if (reader.Contains(offset, sound.trackCount * 9) == false)
+			{
+				return BankParseTruncated;
+			}
+			for (uint32 track = 0; track < sound.trackCount; track++)
+			{
+				uint32 eventOffset = reader.ReadUInt32(offset + 1);
+				if (ParseTrack(reader, eventOffset, trackWaves) == false)
+				{
+					sound.isComplete = false;
+				}
+				offset += 9;
+			}
+		}
+
+		sound.waveCount = SortUnique(trackWaves.GetData(), trackWaves.GetCount());
+		sound.firstWave = waves.GetCount();
+		for (uint32 wave = 0; wave < sound.waveCount; wave++)
+		{
+			waves.Add(trackWaves[wave]);
+		}
+		sounds.Add(sound);
+	}
+
+	return BankParseOk;
+}
+
+bool SoundBankFile::ParseTrack(const BankReader& reader, size_t offset, BankArray<WaveReference>& trackWaves)
+{
+	// Event count followed by four unknown bytes
+	if (reader.Contains(offset, 5) == false)
+	{
+		return false;
+	}
+	uint32 eventCount = reader.ReadUInt8(offset);
+	offset += 5;
+
+	for (uint32 i = 0; i < eventCount; i++)
+	{
+		// Type and timestamp, random offset, one unknown byte
+		if (reader.Contains(offset, EventHeaderSize) == false)
+		{
+			return false;
+		}
+		uint32 type = reader.ReadUInt32(offset) & 0x1F;
+		offset += EventHeaderSize;
+
+		size_t length = 0;
+		size_t trackVariation = 0;
+		switch (type)
+		{
+		case EventStop:
+			length = 1;
+			break;
+		case EventPlayWave:
+		case EventPlayWaveEffectVariation:
+			// Flags, then the wave
+			if (reader.Contains(offset, PlayWaveSize) == false)
+			{
+				return false;
+			}
+			trackWaves.Add(ReadWave(reader, offset + 1));
+			length = PlayWaveSize;
+			if (type == EventPlayWaveEffectVariation)
+			{
+				length += EffectVariationSize;
+			}
+			break;
+		case EventPlayWaveTrackVariation:
+			trackVariation = offset + PlayWaveVariationSize;
+			break;
+		case EventPlayWaveTrackEffectVariation:
+			trackVariation = offset + PlayWaveVariationSize + EffectVariationSize;
+			break;
+		case EventPitch:
+		case EventVolume:
+		case EventPitchRepeating:
+		case EventVolumeRepeating:
+			{
+				if (reader.Contains(offset, 1) == false)
+				{
+					return false;
+				}
+				bool isRepeating = type == EventPitchRepeating || type == EventVolumeRepeating;
+				if ((reader.ReadUInt8(offset) & 0x01) != 0)
+				{
+					// Equation: flags, two values, unknown bytes, repeats
+					length = 1 + 1 + 4 + 4 + 5 + (isRepeating == true ? 4 : 0);
+				}
+				else
+				{
+					// Ramp: initial value, slope, slope delta, duration
+					length = 1 + 4 + 4 + 4 + 2;
+				}
+			}
+			break;
+		case EventMarker:
+			length = 4;
+			break;
+		case EventMarkerRepeating:
+			length = 8;
+			break;
+		default:
+			return false;
+		}
+
+		if (trackVariation != 0)
+		{
+			// Track count, variation type, unknown, then the tracks
+			if (reader.Contains(trackVariation, TrackVariationHeaderSize) == false)
+			{
+				return false;
+			}
+			uint32 trackCount = reader.ReadUInt16(trackVariation);
+			size_t tracks = trackVariation + TrackVariationHeaderSize;
+			if (reader.Contains(tracks, trackCount * TrackVariationEntrySize) == false)
+			{
+				return false;
+			}
+			for (uint32 track = 0; track < trackCount; track++)
+			{
+				trackWaves.Add(ReadWave(reader, tracks + track * TrackVariationEntrySize));
+			}
+			length = tracks + trackCount * TrackVariationEntrySize - offset;
+		}
+
+		offset += length;
+	}
+	return true;
+}
+
+BankParseResult SoundBankFile::ParseCue(const BankReader& reader, uint32 code, bool isVariation, SoundBankCue& cue)
+{
+	cue.firstSound = cueSounds.GetCount();
+	cue.isComplete = true;
+
+	BankArray<WaveReference> cueWaves;
+	if (isVariation == false)
+	{
+		uint32 sound = FindSound(code);
+		if (sound == InvalidIndex)
+		{
+			return BankParseInvalidData;
+		}
+		cueSounds.Add(sound);
+	}
+	else
+	{
+		// Entry count, flags, unknown, interactive variable
+		if (reader.Contains(code, 8) == false)
+		{
+			return BankParseTruncated;
+		}
+		uint32 entryCount = reader.ReadUInt16(code);
+		uint32 entryFormat = reader.ReadUInt16(code + 2) & 0x07;
+
+		size_t entrySize;
+		switch (entryFormat)
+		{
+		case 0:
+			// Wave, byte weights
+			entrySize = 5;
+			break;
+		case 1:
+			// Sound, byte weights
+			entrySize = 6;
+			break;
+		case 3:
+			// Sound, float weights and flags
+			entrySize = 16;
+			break;
+		case 4:
+			// Wave without weights
+			entrySize = 3;
+			break;
+		default:
+			entrySize = 0;
+			cue.isComplete = false;
+			break;
+		}
+
+		size_t offset = code + 8;
+		if (entrySize != 0 && reader.Contains(offset, entryCount * entrySize) == false)
+		{
+			return BankParseTruncated;
+		}
+		for (uint32 i = 0; i < entryCount && entrySize != 0; i++, offset += entrySize)
+		{
+			if (entryFormat == 0 || entryFormat == 4)
+			{
+				cueWaves.Add(ReadWave(reader, offset));
+				continue;
+			}
+
+			uint32 sound = FindSound(reader.ReadUInt32(offset));
+			if (sound == InvalidIndex)
+			{
+				return BankParseInvalidData;
+			}
+			cueSounds.Add(sound);
+		}
+	}
+	cue.soundCount = cueSounds.GetCount() - cue.firstSound;
+
+	AddCueWaves(cue, cueWaves);
+	return BankParseOk;
+}
+
+void SoundBankFile::AddCueWaves(SoundBankCue& cue, BankArray<WaveReference>& cueWaves)
+{
+	for (uint32 i = 0; i < cue.soundCount; i++)
+	{
+		const SoundBankSound& sound = sounds[cueSounds[cue.firstSound + i]];
+		for (uint32 wave = 0; wave < sound.waveCount; wave++)
+		{
+			cueWaves.Add(waves[sound.firstWave + wave]);
+		}
+		if (sound.isComplete == false)
+		{
+			cue.isComplete = false;
+		}
+	}
+
+	cue.waveCount = SortUnique(cueWaves.GetData(), cueWaves.GetCount());
+	cue.firstWave = waves.GetCount();
+	for (uint32 i = 0; i < cue.waveCount; i++)
+	{
+		waves.Add(cueWaves[i]);
+	}
+}
+
+uint32 SoundBankFile::FindSound(uint32 offset) const
+{
+	// Sounds are parsed in file order, so sorted by offset
+	uint32 low = 0;
+	uint32 high = sounds.GetCount();
+	while (low < high)
+	{
+		uint32 middle = low + (high - low) / 2;
+		if (sounds[middle].offset < offset)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low < sounds.GetCount() && sounds[low].offset == offset ? low : InvalidIndex;
+}
+
+const char* SoundBankFile::GetCueName(uint32 index) const
+{
+	if (index >= cueNames.GetCount())
+	{
+		return NULL;
+	}
+	return cueNameData.GetData() + cueNames[index];
+}
+
+uint32 SoundBankFile::FindCue(const char* name) const
+{
+	for (uint32 i = 0; i < cueNames.GetCount(); i++)
+	{
+		if (strcmp(cueNameData.GetData() + cueNames[i], name) == 0)
+		{
+			return i;
+		}
+	}
+	return InvalidIndex;
+}
+
+uint32 SoundBankFile::CollectWaves(const uint32* pCueIndices, uint32 cueCount, WaveReference* pWaves, uint32 capacity) const
+{
+	BankArray<WaveReference> collected;
+	for (uint32 i = 0; i < cueCount; i++)
+	{
+		if (pCueIndices[i] >= cues.GetCount())
+		{
+			continue;
+		}
+		const SoundBankCue& cue = cues[pCueIndices[i]];
+		for (uint32 wave = 0; wave < cue.waveCount; wave++)
+		{
+			collected.Add(waves[cue.firstWave + wave]);
+		}
+	}
+
+	uint32 count = SortUnique(collected.GetData(), collected.GetCount());
+	for (uint32 i = 0; i < count && i < capacity; i++)
+	{
+		pWaves[i] = collected[i];
+	}
+	return count;
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// A wave in one of the wave banks a sound bank references
+	struct WaveReference
+	{
+		// Index into the sound bank's wave bank name table
+		uint16 waveBank;
+		// Entry index in that wave bank
+		uint16 wave;
+	};
+
+	struct SoundBankSound
+	{
+		// Position of the sound definition in the file, what cues and
+		// variations refer to it by
+		uint32 offset;
+		uint8 flags;
+		uint8 priority;
+		uint16 category;
+		uint8 volume;
+		uint8 trackCount;
+		// Pitch in cents
+		int16 pitch;
+		// Range in SoundBankFile's wave reference table
+		uint32 firstWave;
+		uint32 waveCount;
+		// False if a track holds an event the parser does not know, the
+		// waves listed may then be incomplete
+		bool isComplete;
+	};
+
+	struct SoundBankCue
+	{
+		uint8 flags;
+		// Most instances playing at once, 0xFF for no limit
+		uint8 instanceLimit;
+		// What happens when the limit is hit: fail, queue, replace oldest,
+		// replace quietest or replace lowest priority
+		uint8 maxInstanceBehavior;
+		uint16 fadeInMilliseconds;
+		uint16 fadeOutMilliseconds;
+		// Range in SoundBankFile's cue sound table
+		uint32 firstSound;
+		uint32 soundCount;
+		// Range in SoundBankFile's wave reference table, every wave the
+		// cue can play through its sounds or variations, without duplicates
+		uint32 firstWave;
+		uint32 waveCount;
+		bool isComplete;
+	};
+
+	// Index of an XACT3 sound bank (.xsb) built from the file contents
+	// alone, without an engine: cue names, sound definitions, instance
+	// limits and the cue to sound to wave dependencies. Cue indices match
+	// the ones XACT assigns. Everything is copied out of the data passed to
+	// Parse, which may be released afterwards.
+	//
+	// Plain C++ without CLR or XACT dependencies, see NativeFileMapping.h.
+	class SoundBankFile
+	{
+		uint16 contentVersion;
+		uint16 formatVersion;
+		char name[65];
+
+		BankArray<char> waveBankNames;
+		BankArray<SoundBankSound> sounds;
+		BankArray<SoundBankCue> cues;
+		// Offsets into cueNameData, empty if the bank has no cue names
+		BankArray<uint32> cueNames;
+		BankArray<char> cueNameData;
+
+		BankArray<uint32> cueSounds;
+		BankArray<WaveReference> waves;
+
+		SoundBankFile(const SoundBankFile&);
+		SoundBankFile& operator=(const SoundBankFile&);
+
+		void Clear();
+		BankParseResult ParseSounds(const BankReader& reader, size_t offset, uint32 count);
+		bool ParseTrack(const BankReader& reader, size_t offset, BankArray<WaveReference>& trackWaves);
+		BankParseResult ParseCue(const BankReader& reader, uint32 code, bool isVariation, SoundBankCue& cue);
+		uint32 FindSound(uint32 offset) const;
+		void AddCueWaves(SoundBankCue& cue, BankArray<WaveReference>& cueWaves);
+
+	public:
+		static const uint16 FormatVersion = 43;
+		static const uint32 InvalidIndex = 0xFFFFFFFF;
+		static const uint32 WaveBankNameLength = 64;
+
+		SoundBankFile();
+		~SoundBankFile();
+
+		BankParseResult Parse(const void* pData, size_t size);
+
+		uint16 GetContentVersion() const { return contentVersion; }
+		uint16 GetFormatVersion() const { return formatVersion; }
+		const char* GetName() const { return name; }
+
+		uint32 GetWaveBankCount() const { return waveBankNames.GetCount() / (WaveBankNameLength + 1); }
+		const char* GetWaveBankName(uint32 index) const { return waveBankNames.GetData() + index * (WaveBankNameLength + 1); }
+
+		uint32 GetSoundCount() const { return sounds.GetCount(); }
+		const SoundBankSound& GetSound(uint32 index) const { return sounds[index]; }
+
+		uint32 GetCueCount() const { return cues.GetCount(); }
+		const SoundBankCue& GetCue(uint32 index) const { return cues[index]; }
+		// Null if the bank was built without cue names
+		const char* GetCueName(uint32 index) const;
+		// Returns InvalidIndex for unknown names or banks without names
+		uint32 FindCue(const char* name) const;
+
+		// Entries of the cue sound table, indices into the sound table
+		const uint32* GetCueSounds() const { return cueSounds.GetData(); }
+		// Entries of the wave reference table
+		const WaveReference* GetWaves() const { return waves.GetData(); }
+
+		// Collects the waves the given cues can play, without duplicates,
+		// sorted by wave bank and wave. Returns the number of waves, which
+		// may exceed capacity; only the first capacity are written.
+		uint32 CollectWaves(const uint32* pCueIndices, uint32 cueCount, WaveReference* pWaves, uint32 capacity) const;
+	};
+
+}}}
@@ -0,0 +1,481 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeSpatialIndex.h
+
+#include <float.h>
+#include <math.h>
+
+#include "NativeSpatialIndex.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Cell coordinates take 21 bits each of the key, so the key of an
+	// occupied cell never has the top bit set
+	const int32 MaxCellCoordinate = (1 << 20) - 1;
+	const int32 CellCoordinateBias = 1 << 20;
+	const uint64 EmptyKey = ~static_cast<uint64>(0);
+
+	const uint32 InitialCellCapacity = 64;
+	const uint32 InitialPointCapacity = 64;
+
+	int32 ToCellCoordinate(float value, float cellSize)
+	{
+		float cell = floorf(value / cellSize);
+		// Written so NaN ends up in a cell as well
+		if (!(cell >= static_cast<float>(-MaxCellCoordinate)))
+		{
+			return -MaxCellCoordinate;
+		}
+		if (!(cell <= static_cast<float>(MaxCellCoordinate)))
+		{
+			return MaxCellCoordinate;
+		}
+		return static_cast<int32>(cell);
+	}
+
+	uint64 MakeCellKey(int32 x, int32 y, int32 z)
+	{
+		return (static_cast<uint64>(x + CellCoordinateBias) << 42) |
+			(static_cast<uint64>(y + CellCoordinateBias) << 21) |
+			static_cast<uint64>(z + CellCoordinateBias);
+	}
+
+	// Every bit of the key moves the low bits the table is indexed with,
+	// neighbouring cells thus spread over the table
+	uint32 HashCellKey(uint64 key)
+	{
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDULL;
+		key ^= key >> 33;
+		key *= 0xC4CEB9FE1A85EC53ULL;
+		key ^= key >> 33;
+		return static_cast<uint32>(key);
+	}
+
+	// Restores the max-heap below index after its value got smaller
+	void SiftDown(uint32 index, uint32 count, int32* pIds, float* pValues)
+	{
+		int32 id = pIds[index];
+		float value = pValues[index];
+		for (;;)
+		{
+			uint32 child = index * 2 + 1;
+			if (child >= count)
+			{
+				break;
+			}
+			if (child + 1 < count && pValues[child + 1] > pValues[child])
+			{
+				child++;
+			}
+			if (pValues[child] <= value)
+			{
+				break;
+			}
+			pIds[index] = pIds[child];
+			pValues[index] = pValues[child];
+			index = child;
+		}
+		pIds[index] = id;
+		pValues[index] = value;
+	}
+}
+
+const float SpatialIndex::Unbounded = FLT_MAX;
+
+SpatialIndex::SpatialIndex(float cellSize)
+	: cellSize(cellSize)
+	, pointCount(0)
+	, pCells(NULL)
+	, cellCapacity(0)
+	, cellCount(0)
+	, maxRadius(0)
+	, maxRadiusDirty(false)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+	delete[] pCells;
+}
+
+uint64 SpatialIndex::GetCellKey(float x, float y, float z) const
+{
+	return MakeCellKey(ToCellCoordinate(x, cellSize), ToCellCoordinate(y, cellSize), ToCellCoordinate(z, cellSize));
+}
+
+uint32 SpatialIndex::FindCell(uint64 key) const
+{
+	uint32 mask = cellCapacity - 1;
+	uint32 index = HashCellKey(key) & mask;
+	while (pCells[index].key != key && pCells[index].key != EmptyKey)
+	{
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+void SpatialIndex::GrowCells()
+{
+	Cell* pOldCells = pCells;
+	uint32 oldCapacity = cellCapacity;
+
+	cellCapacity = cellCapacity > 0 ? cellCapacity * 2 : InitialCellCapacity;
+	pCells = new Cell[cellCapacity];
+	for (uint32 i = 0; i < cellCapacity; i++)
+	{
+		pCells[i].key = EmptyKey;
+	}
+
+	for (uint32 i = 0; i < oldCapacity; i++)
+	{
+		if (pOldCells[i].key != EmptyKey)
+		{
+			pCells[FindCell(pOldCells[i].key)] = pOldCells[i];
+		}
+	}
+	delete[] pOldCells;
+}
+
+void SpatialIndex::RemoveCell(uint32 index)
+{
+	// Moves the cells of the probe sequence after the hole back, so
+	// lookups never stop early at it
+	uint32 mask = cellCapacity - 1;
+	uint32 hole = index;
+	uint32 i = index;
+	for (;;)
+	{
+		i = (i + 1) & mask;
+		if (pCells[i].key == EmptyKey)
+		{
+			break;
+		}
+		uint32 home = HashCellKey(pCells[i].key) & mask;
+		if (((i - home) & mask) >= ((i - hole) & mask))
+		{
+			pCells[hole] = pCells[i];
+			hole = i;
+		}
+	}
+	pCells[hole].key = EmptyKey;
+	cellCount--;
+}
+
+void SpatialIndex::Link(int32 id)
+{
+	Point& point = points[id];
+
+	if ((cellCount + 1) * 2 > cellCapacity)
+	{
+		GrowCells();
+	}
+	uint32 index = FindCell(point.cellKey);
+	Cell& cell = pCells[index];
+	if (cell.key == EmptyKey)
+	{
+		cell.key = point.cellKey;
+		cell.first = -1;
+		cell.pointCount = 0;
+		cellCount++;
+	}
+
+	point.previous = -1;
+	point.next = cell.first;
+	if (cell.first >= 0)
+	{
+		points[cell.first].previous = id;
+	}
+	cell.first = id;
+	cell.pointCount++;
+}
+
+void SpatialIndex::Unlink(int32 id)
+{
+	Point& point = points[id];
+
+	uint32 index = FindCell(point.cellKey);
+	Cell& cell = pCells[index];
+	if (point.previous >= 0)
+	{
+		points[point.previous].next = point.next;
+	}
+	else
+	{
+		cell.first = point.next;
+	}
+	if (point.next >= 0)
+	{
+		points[point.next].previous = point.previous;
+	}
+
+	if (--cell.pointCount == 0)
+	{
+		RemoveCell(index);
+	}
+}
+
+void SpatialIndex::SetCellSize(float newCellSize)
+{
+	cellSize = newCellSize;
+	for (uint32 i = 0; i < cellCapacity; i++)
+	{
+		pCells[i].key = EmptyKey;
+	}
+	cellCount = 0;
+
+	for (uint32 id = 0; id < points.GetCount(); id++)
+	{
+		Point& point = points[id];
+		if (point.inUse == true)
+		{
+			point.cellKey = GetCellKey(point.x, point.y, point.z);
+			Link(static_cast<int32>(id));
+		}
+	}
+}
+
+bool SpatialIndex::Contains(int32 id) const
+{
+	return id >= 0 && static_cast<uint32>(id) < points.GetCount() && points[id].inUse == true;
+}
+
+void SpatialIndex::Insert(int32 id, float x, float y, float z, float radius)
+{
+	if (Contains(id) == true)
+	{
+		Move(id, x, y, z);
+		SetRadius(id, radius);
+		return;
+	}
+
+	uint32 oldCount = points.GetCount();
+	if (static_cast<uint32>(id) >= oldCount)
+	{
+		uint32 newCount = static_cast<uint32>(id) + 1;
+		// Reserve only grows to what it is asked for
+		uint32 capacity = InitialPointCapacity;
+		while (capacity < newCount)
+		{
+			capacity *= 2;
+		}
+		points.Reserve(capacity);
+		points.Resize(newCount);
+		for (uint32 i = oldCount; i < newCount; i++)
+		{
+			points[i].inUse = false;
+		}
+	}
+
+	Point& point = points[id];
+	point.x = x;
+	point.y = y;
+	point.z = z;
+	point.radius = radius;
+	point.cellKey = GetCellKey(x, y, z);
+	point.inUse = true;
+	Link(id);
+	pointCount++;
+
+	if (radius > maxRadius)
+	{
+		maxRadius = radius;
+	}
+}
+
+void SpatialIndex::Remove(int32 id)
+{
+	if (Contains(id) == false)
+	{
+		return;
+	}
+
+	Unlink(id);
+	points[id].inUse = false;
+	pointCount--;
+
+	if (points[id].radius >= maxRadius)
+	{
+		maxRadiusDirty = true;
+	}
+}
+
+void SpatialIndex::Move(int32 id, float x, float y, float z)
+{
+	Point& point = points[id];
+	uint64 key = GetCellKey(x, y, z);
+	if (key != point.cellKey)
+	{
+		Unlink(id);
+		point.cellKey = key;
+		Link(id);
+	}
+	point.x = x;
+	point.y = y;
+	point.z = z;
+}
+
+void SpatialIndex::SetRadius(int32 id, float radius)
+{
+	Point& point = points[id];
+	if (radius > maxRadius)
+	{
+		maxRadius = radius;
+	}
+	else if (point.radius >= maxRadius && radius < point.radius)
+	{
+		maxRadiusDirty = true;
+	}
+	point.radius = radius;
+}
+
+void SpatialIndex::UpdateMaxRadius()
+{
+	maxRadius = 0;
+	for (uint32 id = 0; id < points.GetCount(); id++)
+	{
+		const Point& point = points[id];
+		if (point.inUse == true && point.radius > maxRadius)
+		{
+			maxRadius = point.radius;
+		}
+	}
+	maxRadiusDirty = false;
+}
+
+uint32 SpatialIndex::Consider(int32 id, float relativeDistance, uint32 count, uint32 maxCount,
+	int32* pIds, float* pRelativeDistances)
+{
+	if (count < maxCount)
+	{
+		// Sift up
+		uint32 index = count;
+		while (index > 0)
+		{
+			uint32 parent = (index - 1) / 2;
+			if (pRelativeDistances[parent] >= relativeDistance)
+			{
+				break;
+			}
+			pIds[index] = pIds[parent];
+			pRelativeDistances[index] = pRelativeDistances[parent];
+			index = parent;
+		}
+		pIds[index] = id;
+		pRelativeDistances[index] = relativeDistance;
+		return count + 1;
+	}
+
+	if (relativeDistance < pRelativeDistances[0])
+	{
+		pIds[0] = id;
+		pRelativeDistances[0] = relativeDistance;
+		SiftDown(0, count, pIds, pRelativeDistances);
+	}
+	return count;
+}
+
+uint32 SpatialIndex::ConsiderPoint(int32 id, float x, float y, float z, float maxDistance,
+	uint32 count, uint32 maxCount, int32* pIds, float* pRelativeDistances) const
+{
+	const Point& point = points[id];
+	float dx = point.x - x;
+	float dy = point.y - y;
+	float dz = point.z - z;
+	float distanceSquared = dx * dx + dy * dy + dz * dz;
+	float limit = point.radius < maxDistance ? point.radius : maxDistance;
+	if (distanceSquared > limit * limit)
+	{
+		return count;
+	}
+
+	float relativeDistance = point.radius > 0 ? sqrtf(distanceSquared) / point.radius : 0;
+	return Consider(id, relativeDistance, count, maxCount, pIds, pRelativeDistances);
+}
+
+uint32 SpatialIndex::Query(float x, float y, float z, float maxDistance, uint32 maxCount,
+	int32* pIds, float* pRelativeDistances)
+{
+	if (maxCount == 0 || pointCount == 0)
+	{
+		return 0;
+	}
+	if (maxRadiusDirty == true)
+	{
+		UpdateMaxRadius();
+	}
+
+	float range = maxRadius < maxDistance ? maxRadius : maxDistance;
+	if (!(range >= 0))
+	{
+		return 0;
+	}
+
+	int32 minX = ToCellCoordinate(x - range, cellSize);
+	int32 minY = ToCellCoordinate(y - range, cellSize);
+	int32 minZ = ToCellCoordinate(z - range, cellSize);
+	int32 maxX = ToCellCoordinate(x + range, cellSize);
+	int32 maxY = ToCellCoordinate(y + range, cellSize);
+	int32 maxZ = ToCellCoordinate(z + range, cellSize);
+
+	uint32 count = 0;
+
+	// Visit the cells in range, or every point in id order once there are
+	// fewer of those than cells to look up
+	double rangeCellCount = static_cast<double>(maxX - minX + 1) *
+		static_cast<double>(maxY - minY + 1) * static_cast<double>(maxZ - minZ + 1);
+	if (rangeCellCount > static_cast<double>(points.GetCount()))
+	{
+		for (uint32 id = 0; id < points.GetCount(); id++)
+		{
+			if (points[id].inUse == true)
+			{
+				count = ConsiderPoint(static_cast<int32>(id), x, y, z, maxDistance, count, maxCount,
+					pIds, pRelativeDistances);
+			}
+		}
+	}
+	else
+	{
+		for (int32 cellX = minX; cellX <= maxX; cellX++)
+		{
+			for (int32 cellY = minY; cellY <= maxY; cellY++)
+			{
+				for (int32 cellZ = minZ; cellZ <= maxZ; cellZ++)
+				{
+					const Cell& cell = pCells[FindCell(MakeCellKey(cellX, cellY, cellZ))];
+					if (cell.key == EmptyKey)
+					{
+						continue;
+					}
+					for (int32 id = cell.first; id >= 0; id = points[id].next)
+					{
+						count = ConsiderPoint(id, x, y, z, maxDistance, count, maxCount,
+							pIds, pRelativeDistances);
+					}
+				}
+			}
+		}
+	}
+
+	// Sort the heap, closest first
+	for (uint32 end = count; end > 1; end--)
+	{
+		int32 id = pIds[end - 1];
+		float relativeDistance = pRelativeDistances[end - 1];
+		pIds[end - 1] = pIds[0];
+		pRelativeDistances[end - 1] = pRelativeDistances[0];
+		pIds[0] = id;
+		pRelativeDistances[0] = relativeDistance;
+		SiftDown(0, end - 1, pIds, pRelativeDistances);
+	}
+	return count;
+}
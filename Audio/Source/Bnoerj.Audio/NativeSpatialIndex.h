@@ -0,0 +1,110 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Points with an audible radius, bucketed into a uniform grid of cubic
+	// cells so the points audible at a position are found without looking
+	// at all of them. Only occupied cells are kept, in a hash table keyed
+	// by the cell coordinates, each with a list of its points. Moving a
+	// point within its cell only stores the position.
+	//
+	// Points are identified by small non-negative ids, such as the slots
+	// of the EmitterStore; the point array grows to the largest id.
+	//
+	// Plain C++ without CLR, XACT or windows.h dependencies, so it builds
+	// on any platform, see SpatialIndexBenchmark.
+	class SpatialIndex
+	{
+		struct Point
+		{
+			float x;
+			float y;
+			float z;
+			float radius;
+			uint64 cellKey;
+			// Neighbours in the list of the cell, -1 at the ends
+			int32 previous;
+			int32 next;
+			bool inUse;
+		};
+
+		struct Cell
+		{
+			uint64 key;
+			int32 first;
+			uint32 pointCount;
+		};
+
+		float cellSize;
+		BankArray<Point> points;
+		uint32 pointCount;
+		// Open addressing with linear probing, a power of two in size and
+		// at most half full
+		Cell* pCells;
+		uint32 cellCapacity;
+		uint32 cellCount;
+		// Largest radius of all points, recalculated by the next query
+		// once the largest one shrinks or leaves
+		float maxRadius;
+		bool maxRadiusDirty;
+
+		uint64 GetCellKey(float x, float y, float z) const;
+		// Index of the cell with the key, or of the empty entry it goes to
+		uint32 FindCell(uint64 key) const;
+		void Link(int32 id);
+		void Unlink(int32 id);
+		void RemoveCell(uint32 index);
+		void GrowCells();
+		void UpdateMaxRadius();
+		// Keeps the maxCount closest candidates as a max-heap on the
+		// relative distance, returns the new heap size
+		static uint32 Consider(int32 id, float relativeDistance, uint32 count, uint32 maxCount,
+			int32* pIds, float* pRelativeDistances);
+		// Considers the point if it is in range of the position
+		uint32 ConsiderPoint(int32 id, float x, float y, float z, float maxDistance,
+			uint32 count, uint32 maxCount, int32* pIds, float* pRelativeDistances) const;
+
+		SpatialIndex(const SpatialIndex&);
+		SpatialIndex& operator=(const SpatialIndex&);
+
+	public:
+		// No radius limit, the point is audible at any distance
+		static const float Unbounded;
+
+		explicit SpatialIndex(float cellSize);
+		~SpatialIndex();
+
+		float GetCellSize() const { return cellSize; }
+		// Rebuilds the grid with the new cell size, which is best close to
+		// the typical audible radius
+		void SetCellSize(float newCellSize);
+
+		uint32 GetCount() const { return pointCount; }
+		bool Contains(int32 id) const;
+
+		void Insert(int32 id, float x, float y, float z, float radius);
+		void Remove(int32 id);
+		void Move(int32 id, float x, float y, float z);
+		float GetRadius(int32 id) const { return points[id].radius; }
+		void SetRadius(int32 id, float radius);
+
+		// Finds the points within their radius and within maxDistance of
+		// the position and writes the ids of up to maxCount of them to
+		// pIds, ordered by their distance relative to their radius, written
+		// to pRelativeDistances: 0 at the point, 1 at the edge of its
+		// radius. With equal radii that is the closest first, otherwise it
+		// approximates the loudest first. Returns the number of ids written.
+		uint32 Query(float x, float y, float z, float maxDistance, uint32 maxCount,
+			int32* pIds, float* pRelativeDistances);
+	};
+
+}}}
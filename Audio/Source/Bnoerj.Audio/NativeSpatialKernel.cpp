@@ -0,0 +1,484 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeSpatialKernel.h
+
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define SPATIAL_KERNEL_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "NativeSpatialKernel.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const float Pi = 3.14159265f;
+	const float HalfPi = 1.57079633f;
+	const float TwoPi = 6.28318531f;
+
+	// X3DAUDIO_SPEED_OF_SOUND
+	const float DefaultSpeedOfSound = 343.5f;
+	// Upper end of the DopplerPitchScalar cue variable
+	const float MaxDopplerFactor = 4.0f;
+	// Keeps the doppler factor finite for emitters at the speed of sound
+	const float MinDopplerDenominator = 1e-6f;
+
+	// Azimuths of the speaker bits in channel mask order, as in the
+	// xact3d3.h emitter layouts. The LFE has none.
+	const int SpeakerBitCount = 11;
+	const float SpeakerAzimuths[SpeakerBitCount] =
+	{
+		-Pi / 6,		// Front left
+		Pi / 6,			// Front right
+		0.0f,			// Front center
+		0.0f,			// Low frequency
+		-Pi * 5 / 6,	// Back left
+		Pi * 5 / 6,		// Back right
+		-Pi / 12,		// Front left of center
+		Pi / 12,		// Front right of center
+		Pi,				// Back center
+		-Pi / 2,		// Side left
+		Pi / 2,			// Side right
+	};
+
+	// Masks XACT uses for final mix formats without one, by channel count
+	const unsigned int DefaultChannelMasks[SpatialKernel::MaxChannelCount + 1] =
+	{
+		0,
+		SpatialKernel::SpeakerFrontCenter,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight | SpatialKernel::SpeakerLowFrequency,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight |
+			SpatialKernel::SpeakerBackLeft | SpatialKernel::SpeakerBackRight,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight | SpatialKernel::SpeakerLowFrequency |
+			SpatialKernel::SpeakerBackLeft | SpatialKernel::SpeakerBackRight,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight | SpatialKernel::SpeakerFrontCenter |
+			SpatialKernel::SpeakerLowFrequency | SpatialKernel::SpeakerBackLeft | SpatialKernel::SpeakerBackRight,
+		0,
+		SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight | SpatialKernel::SpeakerFrontCenter |
+			SpatialKernel::SpeakerLowFrequency | SpatialKernel::SpeakerBackLeft | SpatialKernel::SpeakerBackRight |
+			SpatialKernel::SpeakerFrontLeftOfCenter | SpatialKernel::SpeakerFrontRightOfCenter,
+	};
+
+	float Dot(const float* a, const float* b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	// Right hand side of the listener, the space is left handed
+	void Right(const float* front, const float* top, float* right)
+	{
+		right[0] = top[1] * front[2] - top[2] * front[1];
+		right[1] = top[2] * front[0] - top[0] * front[2];
+		right[2] = top[0] * front[1] - top[1] * front[0];
+	}
+
+#if defined(SPATIAL_KERNEL_SSE)
+	__m128 Select(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	__m128 Abs(__m128 x)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+	}
+
+	// Loads up to four entries from i on, the missing lanes are 0
+	__m128 Load(const float* p, int i, int count)
+	{
+		if (count == 4)
+		{
+			return _mm_loadu_ps(p + i);
+		}
+		float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		memcpy(lanes, p + i, count * sizeof(float));
+		return _mm_loadu_ps(lanes);
+	}
+
+	void Store(float* p, int i, int count, __m128 value)
+	{
+		if (count == 4)
+		{
+			_mm_storeu_ps(p + i, value);
+			return;
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, value);
+		memcpy(p + i, lanes, count * sizeof(float));
+	}
+
+	// atan2(y, x) in [-pi, pi], within 1e-5 of the C runtime
+	__m128 Atan2(__m128 y, __m128 x)
+	{
+		__m128 ax = Abs(x);
+		__m128 ay = Abs(y);
+		__m128 largest = _mm_max_ps(ax, ay);
+		__m128 ratio = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(largest, _mm_set1_ps(1e-30f)));
+
+		__m128 r2 = _mm_mul_ps(ratio, ratio);
+		__m128 r = _mm_set1_ps(-0.01172120f);
+		r = _mm_add_ps(_mm_mul_ps(r, r2), _mm_set1_ps(0.05265332f));
+		r = _mm_add_ps(_mm_mul_ps(r, r2), _mm_set1_ps(-0.11643287f));
+		r = _mm_add_ps(_mm_mul_ps(r, r2), _mm_set1_ps(0.19354346f));
+		r = _mm_add_ps(_mm_mul_ps(r, r2), _mm_set1_ps(-0.33262347f));
+		r = _mm_add_ps(_mm_mul_ps(r, r2), _mm_set1_ps(0.99997726f));
+		r = _mm_mul_ps(r, ratio);
+
+		r = Select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(HalfPi), r), r);
+		r = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(Pi), r), r);
+		return Select(_mm_cmplt_ps(y, _mm_setzero_ps()), _mm_sub_ps(_mm_setzero_ps(), r), r);
+	}
+
+	// acos(x) for x in [-1, 1], Abramowitz and Stegun 4.4.46
+	__m128 Acos(__m128 x)
+	{
+		__m128 ax = _mm_min_ps(Abs(x), _mm_set1_ps(1.0f));
+		__m128 r = _mm_set1_ps(-0.0012624911f);
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(0.0066700901f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(-0.0170881256f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(0.0308918810f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(-0.0501743046f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(0.0889789874f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(-0.2145988016f));
+		r = _mm_add_ps(_mm_mul_ps(r, ax), _mm_set1_ps(1.5707963050f));
+		r = _mm_mul_ps(r, _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), ax)));
+		return Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(Pi), r), r);
+	}
+
+	// Constant power gains cos(t * pi / 2) and sin(t * pi / 2) for t in
+	// [0, 1], Taylor series, within 1e-5
+	void PanGains(__m128 t, __m128& from, __m128& to)
+	{
+		__m128 a = _mm_mul_ps(t, _mm_set1_ps(HalfPi));
+		__m128 a2 = _mm_mul_ps(a, a);
+
+		__m128 s = _mm_set1_ps(1.0f / 362880.0f);
+		s = _mm_add_ps(_mm_mul_ps(s, a2), _mm_set1_ps(-1.0f / 5040.0f));
+		s = _mm_add_ps(_mm_mul_ps(s, a2), _mm_set1_ps(1.0f / 120.0f));
+		s = _mm_add_ps(_mm_mul_ps(s, a2), _mm_set1_ps(-1.0f / 6.0f));
+		s = _mm_add_ps(_mm_mul_ps(s, a2), _mm_set1_ps(1.0f));
+		to = _mm_mul_ps(s, a);
+
+		__m128 c = _mm_set1_ps(-1.0f / 3628800.0f);
+		c = _mm_add_ps(_mm_mul_ps(c, a2), _mm_set1_ps(1.0f / 40320.0f));
+		c = _mm_add_ps(_mm_mul_ps(c, a2), _mm_set1_ps(-1.0f / 720.0f));
+		c = _mm_add_ps(_mm_mul_ps(c, a2), _mm_set1_ps(1.0f / 24.0f));
+		c = _mm_add_ps(_mm_mul_ps(c, a2), _mm_set1_ps(-0.5f));
+		from = _mm_add_ps(_mm_mul_ps(c, a2), _mm_set1_ps(1.0f));
+	}
+#endif
+}
+
+SpatialKernel::SpatialKernel()
+	: channelCount(0)
+	, lfeChannel(-1)
+	, speakerCount(0)
+	, speedOfSound(DefaultSpeedOfSound)
+{
+}
+
+bool SpatialKernel::SetSpeakers(unsigned int channelMask, int channelCount)
+{
+	this->channelCount = 0;
+	lfeChannel = -1;
+	speakerCount = 0;
+
+	if (channelCount < 1 || channelCount > MaxChannelCount)
+	{
+		return false;
+	}
+	if (channelMask == 0)
+	{
+		channelMask = DefaultChannelMasks[channelCount];
+	}
+
+	int channel = 0;
+	for (int bit = 0; bit < SpeakerBitCount; bit++)
+	{
+		if ((channelMask & (1u << bit)) == 0)
+		{
+			continue;
+		}
+		if (channel == channelCount)
+		{
+			speakerCount = 0;
+			return false;
+		}
+
+		if ((1u << bit) == SpeakerLowFrequency)
+		{
+			lfeChannel = channel;
+		}
+		else
+		{
+			// Insertion sort by azimuth
+			float azimuth = SpeakerAzimuths[bit];
+			int i = speakerCount++;
+			for (; i > 0 && speakerAzimuths[i - 1] > azimuth; i--)
+			{
+				speakerAzimuths[i] = speakerAzimuths[i - 1];
+				speakerChannels[i] = speakerChannels[i - 1];
+			}
+			speakerAzimuths[i] = azimuth;
+			speakerChannels[i] = channel;
+		}
+		channel++;
+	}
+	if (channel != channelCount || speakerCount == 0)
+	{
+		speakerCount = 0;
+		return false;
+	}
+
+	for (int s = 0; s < speakerCount; s++)
+	{
+		float end = s + 1 < speakerCount ? speakerAzimuths[s + 1] : speakerAzimuths[0] + TwoPi;
+		segmentScales[s] = 1.0f / (end - speakerAzimuths[s]);
+	}
+	this->channelCount = channelCount;
+	return true;
+}
+
+void SpatialKernel::SetSpeedOfSound(float speedOfSound)
+{
+	this->speedOfSound = speedOfSound > 0 ? speedOfSound : DefaultSpeedOfSound;
+}
+
+void SpatialKernel::CalculateReference(const Listener& listener, const Emitters& emitters, int first, int end, const Results& results) const
+{
+	float right[3];
+	Right(listener.front, listener.top, right);
+
+	for (int i = first; i < end; i++)
+	{
+		float toListener[3];
+		float front[3];
+		float velocity[3];
+		for (int k = 0; k < 3; k++)
+		{
+			toListener[k] = listener.position[k] - emitters.pPosition[k][i];
+			front[k] = emitters.pFront[k][i];
+			velocity[k] = emitters.pVelocity[k][i];
+		}
+
+		float distance = sqrtf(Dot(toListener, toListener));
+		float angle = 0.0f;
+		float doppler = 1.0f;
+		if (distance > 0)
+		{
+			float direction[3] = { toListener[0] / distance, toListener[1] / distance, toListener[2] / distance };
+
+			float cosine = Dot(front, direction);
+			cosine = cosine < -1.0f ? -1.0f : cosine > 1.0f ? 1.0f : cosine;
+			angle = acosf(cosine);
+
+			float scaler = emitters.pDopplerScaler[i];
+			if (scaler > 0)
+			{
+				// Velocities along the emitter to listener direction, at most
+				// the scaled speed of sound
+				float scaledSpeedOfSound = speedOfSound / scaler;
+				float emitterSpeed = Dot(velocity, direction);
+				float listenerSpeed = Dot(listener.velocity, direction);
+				emitterSpeed = emitterSpeed < scaledSpeedOfSound ? emitterSpeed : scaledSpeedOfSound;
+				listenerSpeed = listenerSpeed < scaledSpeedOfSound ? listenerSpeed : scaledSpeedOfSound;
+				float denominator = speedOfSound - scaler * emitterSpeed;
+				denominator = denominator > MinDopplerDenominator ? denominator : MinDopplerDenominator;
+				doppler = (speedOfSound - scaler * listenerSpeed) / denominator;
+				doppler = doppler < MaxDopplerFactor ? doppler : MaxDopplerFactor;
+			}
+		}
+
+		results.pDistance[i] = distance;
+		results.pAngle[i] = angle;
+		results.pDoppler[i] = doppler;
+
+		float* pCoefficients = results.pCoefficients + i * channelCount;
+		for (int d = 0; d < channelCount; d++)
+		{
+			pCoefficients[d] = 0.0f;
+		}
+		if (lfeChannel >= 0)
+		{
+			pCoefficients[lfeChannel] = 1.0f;
+		}
+		if (speakerCount == 1)
+		{
+			pCoefficients[speakerChannels[0]] = 1.0f;
+			continue;
+		}
+
+		// Azimuth of the emitter in the listener's horizontal plane, straight
+		// ahead when it is at or above the listener
+		float x = -Dot(toListener, right);
+		float z = -Dot(toListener, listener.front);
+		float azimuth = x != 0 || z != 0 ? atan2f(x, z) : 0.0f;
+		if (azimuth < speakerAzimuths[0])
+		{
+			azimuth += TwoPi;
+		}
+
+		int s = speakerCount - 1;
+		while (s > 0 && azimuth < speakerAzimuths[s])
+		{
+			s--;
+		}
+		float t = (azimuth - speakerAzimuths[s]) * segmentScales[s];
+		t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+		pCoefficients[speakerChannels[s]] += cosf(t * HalfPi);
+		pCoefficients[speakerChannels[(s + 1) % speakerCount]] += sinf(t * HalfPi);
+	}
+}
+
+#if defined(SPATIAL_KERNEL_SSE)
+void SpatialKernel::Calculate(const Listener& listener, const Emitters& emitters, int first, int end, const Results& results) const
+{
+	float right[3];
+	Right(listener.front, listener.top, right);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 speed = _mm_set1_ps(speedOfSound);
+
+	for (int i = first; i < end; i += 4)
+	{
+		int count = end - i < 4 ? end - i : 4;
+
+		__m128 toListener[3];
+		__m128 front[3];
+		__m128 velocity[3];
+		for (int k = 0; k < 3; k++)
+		{
+			toListener[k] = _mm_sub_ps(_mm_set1_ps(listener.position[k]), Load(emitters.pPosition[k], i, count));
+			front[k] = Load(emitters.pFront[k], i, count);
+			velocity[k] = Load(emitters.pVelocity[k], i, count);
+		}
+
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(toListener[0], toListener[0]),
+			_mm_mul_ps(toListener[1], toListener[1])),
+			_mm_mul_ps(toListener[2], toListener[2])));
+		__m128 hasDistance = _mm_cmpgt_ps(distance, zero);
+		// 0 for emitters at the listener, their direction stays 0
+		__m128 inverseDistance = _mm_and_ps(hasDistance, _mm_div_ps(one, Select(hasDistance, distance, one)));
+		__m128 direction[3];
+		for (int k = 0; k < 3; k++)
+		{
+			direction[k] = _mm_mul_ps(toListener[k], inverseDistance);
+		}
+
+		__m128 cosine = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(front[0], direction[0]),
+			_mm_mul_ps(front[1], direction[1])),
+			_mm_mul_ps(front[2], direction[2]));
+		__m128 angle = _mm_and_ps(hasDistance, Acos(cosine));
+
+		__m128 scaler = Load(emitters.pDopplerScaler, i, count);
+		__m128 hasDoppler = _mm_and_ps(hasDistance, _mm_cmpgt_ps(scaler, zero));
+		__m128 scaledSpeed = _mm_div_ps(speed, Select(hasDoppler, scaler, one));
+		__m128 emitterSpeed = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(velocity[0], direction[0]),
+			_mm_mul_ps(velocity[1], direction[1])),
+			_mm_mul_ps(velocity[2], direction[2]));
+		__m128 listenerSpeed = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(listener.velocity[0]), direction[0]),
+			_mm_mul_ps(_mm_set1_ps(listener.velocity[1]), direction[1])),
+			_mm_mul_ps(_mm_set1_ps(listener.velocity[2]), direction[2]));
+		emitterSpeed = _mm_min_ps(emitterSpeed, scaledSpeed);
+		listenerSpeed = _mm_min_ps(listenerSpeed, scaledSpeed);
+		__m128 denominator = _mm_max_ps(_mm_sub_ps(speed, _mm_mul_ps(scaler, emitterSpeed)), _mm_set1_ps(MinDopplerDenominator));
+		__m128 doppler = _mm_div_ps(_mm_sub_ps(speed, _mm_mul_ps(scaler, listenerSpeed)), denominator);
+		doppler = Select(hasDoppler, _mm_min_ps(doppler, _mm_set1_ps(MaxDopplerFactor)), one);
+
+		Store(results.pDistance, i, count, distance);
+		Store(results.pAngle, i, count, angle);
+		Store(results.pDoppler, i, count, doppler);
+
+		__m128 coefficients[MaxChannelCount];
+		for (int d = 0; d < channelCount; d++)
+		{
+			coefficients[d] = zero;
+		}
+		if (lfeChannel >= 0)
+		{
+			coefficients[lfeChannel] = one;
+		}
+
+		if (speakerCount == 1)
+		{
+			coefficients[speakerChannels[0]] = one;
+		}
+		else
+		{
+			__m128 x = _mm_sub_ps(zero, _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(toListener[0], _mm_set1_ps(right[0])),
+				_mm_mul_ps(toListener[1], _mm_set1_ps(right[1]))),
+				_mm_mul_ps(toListener[2], _mm_set1_ps(right[2]))));
+			__m128 z = _mm_sub_ps(zero, _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(toListener[0], _mm_set1_ps(listener.front[0])),
+				_mm_mul_ps(toListener[1], _mm_set1_ps(listener.front[1]))),
+				_mm_mul_ps(toListener[2], _mm_set1_ps(listener.front[2]))));
+			__m128 azimuth = Atan2(x, z);
+			azimuth = Select(_mm_cmplt_ps(azimuth, _mm_set1_ps(speakerAzimuths[0])),
+				_mm_add_ps(azimuth, _mm_set1_ps(TwoPi)), azimuth);
+
+			// Every lane is in exactly one segment
+			__m128 masks[MaxChannelCount];
+			__m128 t = zero;
+			for (int s = 0; s < speakerCount; s++)
+			{
+				__m128 start = _mm_set1_ps(speakerAzimuths[s]);
+				masks[s] = _mm_cmpge_ps(azimuth, start);
+				if (s + 1 < speakerCount)
+				{
+					masks[s] = _mm_and_ps(masks[s], _mm_cmplt_ps(azimuth, _mm_set1_ps(speakerAzimuths[s + 1])));
+				}
+				t = _mm_or_ps(t, _mm_and_ps(masks[s], _mm_mul_ps(_mm_sub_ps(azimuth, start), _mm_set1_ps(segmentScales[s]))));
+			}
+			t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+			__m128 from;
+			__m128 to;
+			PanGains(t, from, to);
+			for (int s = 0; s < speakerCount; s++)
+			{
+				int fromChannel = speakerChannels[s];
+				int toChannel = speakerChannels[(s + 1) % speakerCount];
+				coefficients[fromChannel] = _mm_add_ps(coefficients[fromChannel], _mm_and_ps(masks[s], from));
+				coefficients[toChannel] = _mm_add_ps(coefficients[toChannel], _mm_and_ps(masks[s], to));
+			}
+		}
+
+		// Transpose to one row of coefficients per emitter
+		float lanes[MaxChannelCount][4];
+		for (int d = 0; d < channelCount; d++)
+		{
+			_mm_storeu_ps(lanes[d], coefficients[d]);
+		}
+		for (int lane = 0; lane < count; lane++)
+		{
+			float* pCoefficients = results.pCoefficients + (i + lane) * channelCount;
+			for (int d = 0; d < channelCount; d++)
+			{
+				pCoefficients[d] = lanes[d][lane];
+			}
+		}
+	}
+}
+#else
+void SpatialKernel::Calculate(const Listener& listener, const Emitters& emitters, int first, int end, const Results& results) const
+{
+	CalculateReference(listener, emitters, first, end, results);
+}
+#endif
@@ -0,0 +1,110 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// The 3D settings XACT3DCalculate gives XACT3DApply, calculated for
+	// four mono emitters at a time with SSE: the emitter to listener
+	// distance, the angle between the emitter front and the listener, the
+	// doppler factor and the output matrix.
+	//
+	// Vectors are in the left handed X3DAudio space AudioListener and
+	// AudioEmitter fill in. Azimuths are clockwise from the front, in
+	// radians. The output speakers are placed at the azimuths of the
+	// xact3d3.h channel layouts. The emitter is panned between the two
+	// speakers around its azimuth in the listener's horizontal plane with
+	// constant power, the LFE channel gets 1. Distance curves are left to
+	// the caller, as are cones, which the kernel does not model.
+	//
+	// Builds without windows.h and without /clr. Calculate falls back to
+	// CalculateReference where SSE is not available.
+	class SpatialKernel
+	{
+	public:
+		static const int MaxChannelCount = 8;
+
+		// Speaker bits of a WAVEFORMATEXTENSIBLE channel mask
+		enum Speaker
+		{
+			SpeakerFrontLeft = 0x1,
+			SpeakerFrontRight = 0x2,
+			SpeakerFrontCenter = 0x4,
+			SpeakerLowFrequency = 0x8,
+			SpeakerBackLeft = 0x10,
+			SpeakerBackRight = 0x20,
+			SpeakerFrontLeftOfCenter = 0x40,
+			SpeakerFrontRightOfCenter = 0x80,
+			SpeakerBackCenter = 0x100,
+			SpeakerSideLeft = 0x200,
+			SpeakerSideRight = 0x400,
+		};
+
+		struct Listener
+		{
+			float position[3];
+			float front[3];
+			float top[3];
+			float velocity[3];
+		};
+
+		// Structure of arrays, one entry per emitter
+		struct Emitters
+		{
+			const float* pPosition[3];
+			const float* pFront[3];
+			const float* pVelocity[3];
+			const float* pDopplerScaler;
+		};
+
+		// pCoefficients holds GetChannelCount() coefficients per emitter
+		struct Results
+		{
+			float* pDistance;
+			float* pAngle;
+			float* pDoppler;
+			float* pCoefficients;
+		};
+
+	private:
+		int channelCount;
+		// Output channel of the LFE speaker, -1 for none
+		int lfeChannel;
+		// The other speakers by ascending azimuth, in (-pi, pi]. Segment s
+		// pans from speaker s to speaker s + 1, the last one wraps around
+		// through the back.
+		int speakerCount;
+		int speakerChannels[MaxChannelCount];
+		float speakerAzimuths[MaxChannelCount];
+		float segmentScales[MaxChannelCount];
+		float speedOfSound;
+
+	public:
+		SpatialKernel();
+
+		// Places the speakers of the output format. Returns false for masks
+		// with more than MaxChannelCount channels or without a speaker but
+		// the LFE, then nothing is calculated.
+		bool SetSpeakers(unsigned int channelMask, int channelCount);
+		int GetChannelCount() const { return channelCount; }
+		// -1 for outputs without one
+		int GetLfeChannel() const { return lfeChannel; }
+		bool IsReady() const { return speakerCount > 0; }
+
+		// The speed of sound the doppler factor uses, XACT3DInitialize takes
+		// it from the SpeedOfSound global variable
+		void SetSpeedOfSound(float speedOfSound);
+
+		// Calculates the entries in [first, end) for one listener
+		void Calculate(const Listener& listener, const Emitters& emitters, int first, int end, const Results& results) const;
+		// Same as Calculate, one emitter at a time with the C runtime math
+		// functions. Results agree with Calculate to within about 1e-4.
+		void CalculateReference(const Listener& listener, const Emitters& emitters, int first, int end, const Results& results) const;
+	};
+
+}}}
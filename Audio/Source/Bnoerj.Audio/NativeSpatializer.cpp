@@ -0,0 +1,252 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeSpatializer.h
+
+#include <windows.h>
+#pragma warning(push)
+#pragma warning(disable: 4793) // xact3wb.h(130): '__asm': causes native code generation for function 'void XACTWaveBank::SwapBytes(DWORD &)'
+#include <xact3.h>
+#pragma warning(pop)
+#include <xact3d3.h>
+
+#include "NativeSpatializer.h"
+
+using namespace Bnoerj::Audio::Native;
+
+// Entries of a typical scene, grown to the largest batch seen
+static const LONG InitialCapacity = 64;
+
+// X3DAudio evaluates distance curves at the distance over the curve
+// distance scaler, beyond the last point the curve stays flat
+static float EvaluateCurve(const X3DAUDIO_DISTANCE_CURVE* pCurve, float distance, float scaler)
+{
+	const X3DAUDIO_DISTANCE_CURVE_POINT* pPoints = pCurve->pPoints;
+	float x = scaler > 0 ? distance / scaler : 0.0f;
+	if (x <= pPoints[0].Distance)
+	{
+		return pPoints[0].DSPSetting;
+	}
+	for (UINT32 i = 1; i < pCurve->PointCount; i++)
+	{
+		if (x < pPoints[i].Distance)
+		{
+			float t = (x - pPoints[i - 1].Distance) / (pPoints[i].Distance - pPoints[i - 1].Distance);
+			return pPoints[i - 1].DSPSetting + t * (pPoints[i].DSPSetting - pPoints[i - 1].DSPSetting);
+		}
+	}
+	return pPoints[pCurve->PointCount - 1].DSPSetting;
+}
+
+Spatializer::Spatializer(DspArena* pArena)
+	: pArena(pArena)
+	, pEntries(new Entry[InitialCapacity])
+	, pFields(new float[InitialCapacity * FieldCount])
+	, pCoefficients(new float[InitialCapacity * MaxDestinationChannelCount])
+	, capacity(InitialCapacity)
+	, count(0)
+{
+	ZeroMemory(pEntries, InitialCapacity * sizeof(Entry));
+}
+
+Spatializer::~Spatializer()
+{
+	for (LONG i = 0; i < capacity; i++)
+	{
+		pArena->Free(pEntries[i].pDsp);
+	}
+	delete[] pEntries;
+	delete[] pFields;
+	delete[] pCoefficients;
+}
+
+void Spatializer::SetSpeakers(DWORD channelMask, UINT channelCount)
+{
+	kernel.SetSpeakers(channelMask, static_cast<int>(channelCount));
+}
+
+void Spatializer::SetSpeedOfSound(float speedOfSound)
+{
+	kernel.SetSpeedOfSound(speedOfSound);
+}
+
+void Spatializer::Reset(LONG newCount)
+{
+	if (newCount > capacity)
+	{
+		// The entries move with their settings
+		Entry* pNewEntries = new Entry[newCount];
+		ZeroMemory(pNewEntries, newCount * sizeof(Entry));
+		CopyMemory(pNewEntries, pEntries, capacity * sizeof(Entry));
+		delete[] pEntries;
+		delete[] pFields;
+		delete[] pCoefficients;
+		pEntries = pNewEntries;
+		pFields = new float[newCount * FieldCount];
+		pCoefficients = new float[newCount * MaxDestinationChannelCount];
+		capacity = newCount;
+	}
+	count = newCount;
+}
+
+void Spatializer::Set(LONG index, IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, const X3DAUDIO_EMITTER& emitter)
+{
+	Entry& entry = pEntries[index];
+	entry.pCue = pCue;
+	entry.pListener = pListener;
+	entry.emitter = emitter;
+	entry.hr = E_PENDING;
+
+	X3DAUDIO_EMITTER* pEmitter = &entry.emitter;
+	if (pEmitter->pChannelAzimuths != NULL)
+	{
+		// Entries without settings are not calculated
+		UINT azimuthCount = pEmitter->ChannelCount < DspArena::MaxChannelCount
+			? pEmitter->ChannelCount
+			: DspArena::MaxChannelCount;
+		CopyMemory(entry.channelAzimuths, pEmitter->pChannelAzimuths, azimuthCount * sizeof(FLOAT32));
+		pEmitter->pChannelAzimuths = entry.channelAzimuths;
+	}
+
+	if (entry.pDsp == NULL || entry.pDsp->SrcChannelCount != pEmitter->ChannelCount)
+	{
+		pArena->Free(entry.pDsp);
+		entry.pDsp = pArena->Allocate(pEmitter->ChannelCount);
+		if (entry.pDsp == NULL)
+		{
+			entry.hr = E_INVALIDARG;
+		}
+	}
+	entry.useKernel = kernel.IsReady() == true && pEmitter->ChannelCount == 1 &&
+		pEmitter->pCone == NULL && pEmitter->InnerRadius == 0 && pListener->pCone == NULL;
+
+	GetField(FieldPositionX)[index] = pEmitter->Position.x;
+	GetField(FieldPositionY)[index] = pEmitter->Position.y;
+	GetField(FieldPositionZ)[index] = pEmitter->Position.z;
+	GetField(FieldFrontX)[index] = pEmitter->OrientFront.x;
+	GetField(FieldFrontY)[index] = pEmitter->OrientFront.y;
+	GetField(FieldFrontZ)[index] = pEmitter->OrientFront.z;
+	GetField(FieldVelocityX)[index] = pEmitter->Velocity.x;
+	GetField(FieldVelocityY)[index] = pEmitter->Velocity.y;
+	GetField(FieldVelocityZ)[index] = pEmitter->Velocity.z;
+	GetField(FieldDopplerScaler)[index] = pEmitter->DopplerScaler;
+}
+
+void Spatializer::CalculateKernel(const X3DAUDIO_LISTENER* pListener, LONG first, LONG end)
+{
+	SpatialKernel::Listener listener;
+	listener.position[0] = pListener->Position.x;
+	listener.position[1] = pListener->Position.y;
+	listener.position[2] = pListener->Position.z;
+	listener.front[0] = pListener->OrientFront.x;
+	listener.front[1] = pListener->OrientFront.y;
+	listener.front[2] = pListener->OrientFront.z;
+	listener.top[0] = pListener->OrientTop.x;
+	listener.top[1] = pListener->OrientTop.y;
+	listener.top[2] = pListener->OrientTop.z;
+	listener.velocity[0] = pListener->Velocity.x;
+	listener.velocity[1] = pListener->Velocity.y;
+	listener.velocity[2] = pListener->Velocity.z;
+
+	SpatialKernel::Emitters emitters;
+	emitters.pPosition[0] = GetField(FieldPositionX);
+	emitters.pPosition[1] = GetField(FieldPositionY);
+	emitters.pPosition[2] = GetField(FieldPositionZ);
+	emitters.pFront[0] = GetField(FieldFrontX);
+	emitters.pFront[1] = GetField(FieldFrontY);
+	emitters.pFront[2] = GetField(FieldFrontZ);
+	emitters.pVelocity[0] = GetField(FieldVelocityX);
+	emitters.pVelocity[1] = GetField(FieldVelocityY);
+	emitters.pVelocity[2] = GetField(FieldVelocityZ);
+	emitters.pDopplerScaler = GetField(FieldDopplerScaler);
+
+	// Coefficients of entry i start at i * channelCount, kernel.Calculate
+	// writes them from first on
+	SpatialKernel::Results results;
+	results.pDistance = GetField(FieldDistance);
+	results.pAngle = GetField(FieldAngle);
+	results.pDoppler = GetField(FieldDoppler);
+	results.pCoefficients = pCoefficients;
+
+	kernel.Calculate(listener, emitters, first, end, results);
+}
+
+void Spatializer::Calculate(const BYTE* p3DAudioData, UINT destinationChannelCount, LONG first, LONG end)
+{
+	// The kernel takes one listener at a time, batches mostly share one
+	bool useKernel = kernel.IsReady() == true && static_cast<UINT>(kernel.GetChannelCount()) == destinationChannelCount;
+	if (useKernel == true)
+	{
+		LONG runStart = first;
+		for (LONG i = first + 1; i <= end; i++)
+		{
+			if (i == end || pEntries[i].pListener != pEntries[runStart].pListener)
+			{
+				CalculateKernel(pEntries[runStart].pListener, runStart, i);
+				runStart = i;
+			}
+		}
+	}
+
+	UINT channelCount = destinationChannelCount;
+	for (LONG i = first; i < end; i++)
+	{
+		Entry& entry = pEntries[i];
+		if (entry.pDsp == NULL)
+		{
+			continue;
+		}
+
+		// The entry owns its settings, so entries can be calculated in any
+		// order and on any thread
+		X3DAUDIO_DSP_SETTINGS& dsp = *entry.pDsp;
+		if (useKernel == false || entry.useKernel == false)
+		{
+			entry.hr = ::XACT3DCalculate(p3DAudioData, entry.pListener, &entry.emitter, &dsp);
+			continue;
+		}
+
+		dsp.EmitterToListenerDistance = GetField(FieldDistance)[i];
+		dsp.EmitterToListenerAngle = GetField(FieldAngle)[i];
+		dsp.DopplerFactor = GetField(FieldDoppler)[i];
+
+		// XACT3DCalculate uses flat curves for emitters without one
+		const X3DAUDIO_EMITTER* pEmitter = &entry.emitter;
+		float volume = pEmitter->pVolumeCurve != NULL
+			? EvaluateCurve(pEmitter->pVolumeCurve, dsp.EmitterToListenerDistance, pEmitter->CurveDistanceScaler)
+			: 1.0f;
+		float lfe = pEmitter->pLFECurve != NULL
+			? EvaluateCurve(pEmitter->pLFECurve, dsp.EmitterToListenerDistance, pEmitter->CurveDistanceScaler)
+			: 1.0f;
+		const float* pSource = pCoefficients + i * channelCount;
+		for (UINT d = 0; d < channelCount; d++)
+		{
+			float scale = static_cast<int>(d) == kernel.GetLfeChannel() ? lfe : volume;
+			dsp.pMatrixCoefficients[d] = pSource[d] * scale;
+		}
+		entry.hr = S_OK;
+	}
+}
+
+LONG Spatializer::Apply()
+{
+	LONG failedCount = 0;
+	for (LONG i = 0; i < count; i++)
+	{
+		Entry& entry = pEntries[i];
+		if (SUCCEEDED(entry.hr))
+		{
+			entry.hr = ::XACT3DApply(entry.pDsp, entry.pCue);
+		}
+		if (FAILED(entry.hr))
+		{
+			failedCount++;
+		}
+	}
+	return failedCount;
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeDspArena.h"
+#include "NativeSpatialKernel.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// The cue, listener and emitter triples of a batched Apply3D, each with
+	// its own DSP settings from the engine's DspArena, sized for the
+	// emitter's channels. An entry keeps its settings for the next batch
+	// while the channel count stays the same. Calculate needs no engine
+	// lock and can run on disjoint ranges in parallel, Apply then hands all
+	// settings to XACT in one locked section, see Engine::Apply3DBatch.
+	//
+	// Set copies the emitter, with its channel azimuths, the listener has
+	// to stay until the batch is applied. Mono emitters without a cone or
+	// inner radius, heard by a listener without a cone, go through the
+	// SpatialKernel four at a time. Their positions, fronts, velocities
+	// and doppler scalers are copied to arrays by Set. The others use
+	// XACT3DCalculate.
+	//
+	// Filled and used under Engine::pSpatializerLock. Compiled without
+	// /clr, the calculation runs on thread pool threads and has no use for
+	// managed code.
+	class Spatializer
+	{
+		static const UINT MaxDestinationChannelCount = SpatialKernel::MaxChannelCount;
+
+		struct Entry
+		{
+			IXACT3Cue* pCue;
+			const X3DAUDIO_LISTENER* pListener;
+			X3DAUDIO_EMITTER emitter;
+			FLOAT32 channelAzimuths[DspArena::MaxChannelCount];
+			// NULL for emitters with more channels than the arena serves
+			X3DAUDIO_DSP_SETTINGS* pDsp;
+			bool useKernel;
+			HRESULT hr;
+		};
+
+		// Kernel input and output arrays, capacity entries each
+		enum Field
+		{
+			FieldPositionX,
+			FieldPositionY,
+			FieldPositionZ,
+			FieldFrontX,
+			FieldFrontY,
+			FieldFrontZ,
+			FieldVelocityX,
+			FieldVelocityY,
+			FieldVelocityZ,
+			FieldDopplerScaler,
+			FieldDistance,
+			FieldAngle,
+			FieldDoppler,
+			FieldCount,
+		};
+
+		SpatialKernel kernel;
+		DspArena* pArena;
+
+		Entry* pEntries;
+		float* pFields;
+		// MaxDestinationChannelCount per entry
+		float* pCoefficients;
+		LONG capacity;
+		LONG count;
+
+		float* GetField(Field field) const { return pFields + field * capacity; }
+		void CalculateKernel(const X3DAUDIO_LISTENER* pListener, LONG first, LONG end);
+
+		Spatializer(const Spatializer&);
+		Spatializer& operator=(const Spatializer&);
+
+	public:
+		// The arena must outlive the spatializer
+		explicit Spatializer(DspArena* pArena);
+		~Spatializer();
+
+		// Output speakers and speed of sound for the kernel, see
+		// SpatialKernel. Without speakers every entry uses XACT3DCalculate.
+		void SetSpeakers(DWORD channelMask, UINT channelCount);
+		void SetSpeedOfSound(float speedOfSound);
+
+		// Drops the entries and makes room for count new ones
+		void Reset(LONG count);
+		// Keeps the first count entries set since Reset
+		void Truncate(LONG newCount) { count = newCount < count ? newCount : count; }
+		LONG GetCount() const { return count; }
+		void Set(LONG index, IXACT3Cue* pCue, const X3DAUDIO_LISTENER* pListener, const X3DAUDIO_EMITTER& emitter);
+
+		// Calculates the DSP settings of the entries in [first, end)
+		void Calculate(const BYTE* p3DAudioData, UINT destinationChannelCount, LONG first, LONG end);
+		// Applies the calculated settings, Engine::syncRoot must be held.
+		// Returns the number of cues that failed.
+		LONG Apply();
+
+		// The result of Calculate and Apply, E_PENDING for entries queued as
+		// commands instead
+		HRESULT GetResult(LONG index) const { return pEntries[index].hr; }
+
+		// For deferred commands
+		IXACT3Cue* GetCue(LONG index) const { return pEntries[index].pCue; }
+		const X3DAUDIO_LISTENER* GetListener(LONG index) const { return pEntries[index].pListener; }
+		const X3DAUDIO_EMITTER* GetEmitter(LONG index) const { return &pEntries[index].emitter; }
+	};
+
+}}}
@@ -0,0 +1,347 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeStreamReader.h
+
+#include <windows.h>
+#include <process.h>
+#include <string.h>
+
+#include "NativeLock.h"
+#include "NativeStreamReader.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Completion codes left in OVERLAPPED::Internal, as the system does
+	const ULONG_PTR StatusSuccess = 0;
+	const ULONG_PTR StatusPending = 0x00000103;
+	const ULONG_PTR StatusEndOfFile = 0xC0000011;
+	const ULONG_PTR StatusIoDeviceError = 0xC0000185;
+
+	struct ReaderState
+	{
+		StreamScheduler scheduler;
+		HANDLE files[StreamScheduler::MaxStreams];
+		HANDLE hWorkEvent;
+		HANDLE hThread;
+		volatile bool stop;
+	};
+
+	// Guards the reference count, pState and everything in it
+	CriticalSection readerLock;
+	LONG referenceCount = 0;
+	ReaderState* pState = NULL;
+	LARGE_INTEGER frequency;
+
+	int64 GetMicroseconds()
+	{
+		LARGE_INTEGER counter;
+		::QueryPerformanceCounter(&counter);
+		return (counter.QuadPart / frequency.QuadPart) * 1000000 +
+			(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+	}
+
+	uint32 FindFile(HANDLE hFile)
+	{
+		if (pState != NULL)
+		{
+			for (uint32 i = 0; i < StreamScheduler::MaxStreams; i++)
+			{
+				if (pState->files[i] == hFile)
+				{
+					return i;
+				}
+			}
+		}
+		return StreamScheduler::InvalidStream;
+	}
+
+	void SetCompleted(LPOVERLAPPED pOverlapped, DWORD bytesTransferred, ULONG_PTR status)
+	{
+		// Readers check Internal first, the count must be visible by then
+		pOverlapped->InternalHigh = bytesTransferred;
+		::MemoryBarrier();
+		pOverlapped->Internal = status;
+		if (pOverlapped->hEvent != NULL)
+		{
+			::SetEvent(pOverlapped->hEvent);
+		}
+	}
+
+	// Called with readerLock held
+	void DeliverCompletions(ReaderState* pState)
+	{
+		StreamCompletion completion;
+		while (pState->scheduler.PopCompleted(completion) == true)
+		{
+			ULONG_PTR status = StatusIoDeviceError;
+			if (completion.succeeded == true)
+			{
+				status = completion.bytesTransferred > 0 ? StatusSuccess : StatusEndOfFile;
+			}
+			SetCompleted(static_cast<LPOVERLAPPED>(completion.pContext), completion.bytesTransferred, status);
+		}
+	}
+
+	// Uses its own state, a new one may be running while it stops
+	unsigned __stdcall WorkerProc(void* pContext)
+	{
+		ReaderState* pState = static_cast<ReaderState*>(pContext);
+		OVERLAPPED overlapped = { 0 };
+		overlapped.hEvent = ::CreateEventW(NULL, TRUE, FALSE, NULL);
+
+		for (;;)
+		{
+			StreamRead read;
+			HANDLE hFile = NULL;
+			bool hasRead;
+			{
+				ScopedLock lock(&readerLock);
+				if (pState->stop == true)
+				{
+					break;
+				}
+				hasRead = pState->scheduler.BeginRead(GetMicroseconds(), read);
+				if (hasRead == true)
+				{
+					hFile = pState->files[read.stream];
+				}
+				DeliverCompletions(pState);
+			}
+
+			if (hasRead == false)
+			{
+				::WaitForSingleObject(pState->hWorkEvent, INFINITE);
+				continue;
+			}
+
+			overlapped.Offset = static_cast<DWORD>(read.offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(read.offset >> 32);
+			DWORD bytesRead = 0;
+			BOOL succeeded = ::ReadFile(hFile, read.pBuffer, read.length, NULL, &overlapped);
+			if (succeeded != FALSE || ::GetLastError() == ERROR_IO_PENDING)
+			{
+				succeeded = ::GetOverlappedResult(hFile, &overlapped, &bytesRead, TRUE);
+			}
+			if (succeeded == FALSE && ::GetLastError() == ERROR_HANDLE_EOF)
+			{
+				succeeded = TRUE;
+				bytesRead = 0;
+			}
+
+			ScopedLock lock(&readerLock);
+			pState->scheduler.EndRead(read, bytesRead, succeeded != FALSE, GetMicroseconds());
+			DeliverCompletions(pState);
+		}
+
+		::CloseHandle(overlapped.hEvent);
+		return 0;
+	}
+}
+
+bool StreamReader::Acquire()
+{
+	ScopedLock lock(&readerLock);
+
+	if (referenceCount++ > 0)
+	{
+		return true;
+	}
+
+	::QueryPerformanceFrequency(&frequency);
+
+	pState = new ReaderState();
+	memset(pState->files, 0, sizeof(pState->files));
+	pState->stop = false;
+	pState->hWorkEvent = ::CreateEventW(NULL, FALSE, FALSE, NULL);
+	pState->hThread = reinterpret_cast<HANDLE>(::_beginthreadex(NULL, 0, WorkerProc, pState, 0, NULL));
+	if (pState->hWorkEvent == NULL || pState->hThread == NULL)
+	{
+		if (pState->hWorkEvent != NULL)
+		{
+			::CloseHandle(pState->hWorkEvent);
+		}
+		delete pState;
+		pState = NULL;
+		referenceCount--;
+		return false;
+	}
+	::SetThreadPriority(pState->hThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return true;
+}
+
+void StreamReader::Release()
+{
+	ReaderState* pStopping;
+	{
+		ScopedLock lock(&readerLock);
+		if (referenceCount == 0 || --referenceCount > 0)
+		{
+			return;
+		}
+		pStopping = pState;
+		pStopping->stop = true;
+		::SetEvent(pStopping->hWorkEvent);
+		pState = NULL;
+	}
+
+	// The worker takes readerLock until it sees stop
+	::WaitForSingleObject(pStopping->hThread, INFINITE);
+
+	ScopedLock lock(&readerLock);
+	for (uint32 i = 0; i < StreamScheduler::MaxStreams; i++)
+	{
+		if (pStopping->files[i] != NULL)
+		{
+			pStopping->scheduler.RemoveStream(i);
+		}
+	}
+	DeliverCompletions(pStopping);
+	::CloseHandle(pStopping->hThread);
+	::CloseHandle(pStopping->hWorkEvent);
+	delete pStopping;
+}
+
+bool StreamReader::AddFile(HANDLE hFile, uint64 fileSize, uint32 blockSize, uint32 prefetchDepth)
+{
+	ScopedLock lock(&readerLock);
+
+	if (pState == NULL)
+	{
+		return false;
+	}
+
+	uint32 stream = pState->scheduler.AddStream(fileSize, blockSize, prefetchDepth);
+	if (stream == StreamScheduler::InvalidStream)
+	{
+		return false;
+	}
+	pState->files[stream] = hFile;
+	return true;
+}
+
+void StreamReader::RemoveFile(HANDLE hFile)
+{
+	for (;;)
+	{
+		{
+			ScopedLock lock(&readerLock);
+			uint32 stream = FindFile(hFile);
+			if (stream == StreamScheduler::InvalidStream)
+			{
+				return;
+			}
+			if (pState->scheduler.IsReading(stream) == false)
+			{
+				pState->scheduler.RemoveStream(stream);
+				pState->files[stream] = NULL;
+				DeliverCompletions(pState);
+				return;
+			}
+		}
+		::Sleep(1);
+	}
+}
+
+void StreamReader::GetStatistics(StreamStatistics& statistics)
+{
+	ScopedLock lock(&readerLock);
+
+	if (pState != NULL)
+	{
+		statistics = pState->scheduler.GetTotalStatistics();
+	}
+	else
+	{
+		memset(&statistics, 0, sizeof(statistics));
+	}
+}
+
+BOOL WINAPI StreamReader::ReadFile(HANDLE hFile, LPVOID pBuffer, DWORD bytesToRead, LPDWORD pBytesRead,
+	LPOVERLAPPED pOverlapped)
+{
+	if (pOverlapped != NULL)
+	{
+		ScopedLock lock(&readerLock);
+
+		uint32 stream = FindFile(hFile);
+		if (stream != StreamScheduler::InvalidStream)
+		{
+			uint64 offset = (static_cast<uint64>(pOverlapped->OffsetHigh) << 32) | pOverlapped->Offset;
+			pOverlapped->Internal = StatusPending;
+			pOverlapped->InternalHigh = 0;
+			if (pOverlapped->hEvent != NULL)
+			{
+				::ResetEvent(pOverlapped->hEvent);
+			}
+
+			uint32 bytesTransferred;
+			StreamSubmitResult result = pState->scheduler.Submit(
+				stream, offset, bytesToRead, pBuffer, pOverlapped, GetMicroseconds(), bytesTransferred);
+			if (result == StreamSubmitCompleted)
+			{
+				SetCompleted(pOverlapped, bytesTransferred, bytesTransferred > 0 ? StatusSuccess : StatusEndOfFile);
+				if (pBytesRead != NULL)
+				{
+					*pBytesRead = bytesTransferred;
+				}
+				if (bytesTransferred == 0)
+				{
+					::SetLastError(ERROR_HANDLE_EOF);
+					return FALSE;
+				}
+				return TRUE;
+			}
+			if (result == StreamSubmitQueued)
+			{
+				::SetEvent(pState->hWorkEvent);
+				::SetLastError(ERROR_IO_PENDING);
+				return FALSE;
+			}
+			// Too many requests pending, read directly
+		}
+	}
+	return ::ReadFile(hFile, pBuffer, bytesToRead, pBytesRead, pOverlapped);
+}
+
+BOOL WINAPI StreamReader::GetOverlappedResult(HANDLE hFile, LPOVERLAPPED pOverlapped, LPDWORD pBytesTransferred,
+	BOOL wait)
+{
+	// The system waits on the file handle without an event, which is
+	// never signaled for reads served here
+	bool isServed = false;
+	if (pOverlapped->hEvent == NULL)
+	{
+		ScopedLock lock(&readerLock);
+		isServed = FindFile(hFile) != StreamScheduler::InvalidStream;
+	}
+	if (isServed == false)
+	{
+		return ::GetOverlappedResult(hFile, pOverlapped, pBytesTransferred, wait);
+	}
+
+	while (pOverlapped->Internal == StatusPending)
+	{
+		if (wait == FALSE)
+		{
+			::SetLastError(ERROR_IO_INCOMPLETE);
+			return FALSE;
+		}
+		::Sleep(1);
+	}
+	::MemoryBarrier();
+	*pBytesTransferred = static_cast<DWORD>(pOverlapped->InternalHigh);
+	if (pOverlapped->Internal == StatusSuccess)
+	{
+		return TRUE;
+	}
+	::SetLastError(pOverlapped->Internal == StatusEndOfFile ? ERROR_HANDLE_EOF : ERROR_IO_DEVICE);
+	return FALSE;
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeStreamScheduler.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	// Serves the reads XACT makes for streaming wave banks through one
+	// StreamScheduler and a worker thread shared by all engines in the
+	// process. ReadFile and GetOverlappedResult are installed as the XACT
+	// file I/O callbacks, reads of files not added with AddFile, or that
+	// the scheduler cannot queue, go to the system directly.
+	//
+	// Compiled without /clr, XACT calls in from its own threads.
+	class StreamReader
+	{
+		StreamReader();
+
+	public:
+		static const uint32 DefaultPrefetchDepth = 2;
+		static const uint32 MaxPrefetchDepth = 8;
+
+		// Every engine holds a reference while it exists, the worker
+		// runs while there is at least one
+		static bool Acquire();
+		static void Release();
+
+		// Returns false if the file is read directly, e.g. without a
+		// running reader or with MaxStreams files added
+		static bool AddFile(HANDLE hFile, uint64 fileSize, uint32 blockSize, uint32 prefetchDepth);
+		// Waits for a read of the file still out, fails its pending requests
+		static void RemoveFile(HANDLE hFile);
+
+		// Summed over all files, zero without a running reader
+		static void GetStatistics(StreamStatistics& statistics);
+
+		static BOOL WINAPI ReadFile(HANDLE hFile, LPVOID pBuffer, DWORD bytesToRead, LPDWORD pBytesRead,
+			LPOVERLAPPED pOverlapped);
+		static BOOL WINAPI GetOverlappedResult(HANDLE hFile, LPOVERLAPPED pOverlapped, LPDWORD pBytesTransferred,
+			BOOL wait);
+	};
+
+}}}
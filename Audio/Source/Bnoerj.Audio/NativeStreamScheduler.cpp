@@ -0,0 +1,574 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeStreamScheduler.h
+
+#include <string.h>
+
+#include "NativeStreamScheduler.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const int64 MicrosecondsPerSecond = 1000000;
+	// Requests closer together are treated as this far apart when
+	// estimating the rate, XACT submits a burst when a wave starts
+	const int64 MinRequestInterval = 1000;
+
+	// Time it takes to consume length bytes at the given rate
+	int64 GetDuration(uint64 length, uint32 bytesPerSecond)
+	{
+		if (bytesPerSecond == 0)
+		{
+			bytesPerSecond = StreamScheduler::DefaultBytesPerSecond;
+		}
+		return static_cast<int64>(length * MicrosecondsPerSecond / bytesPerSecond);
+	}
+
+	void AddLatency(StreamStatistics& statistics, int64 latency, bool missedDeadline)
+	{
+		statistics.totalLatencyMicroseconds += latency;
+		if (latency > statistics.maxLatencyMicroseconds)
+		{
+			statistics.maxLatencyMicroseconds = latency;
+		}
+		if (missedDeadline == true)
+		{
+			statistics.deadlineMisses++;
+		}
+	}
+}
+
+StreamScheduler::StreamScheduler()
+	: completionHead(0)
+{
+	memset(streams, 0, sizeof(streams));
+	memset(&totalStatistics, 0, sizeof(totalStatistics));
+}
+
+StreamScheduler::~StreamScheduler()
+{
+	for (uint32 i = 0; i < MaxStreams; i++)
+	{
+		FreeWindows(streams[i]);
+	}
+}
+
+uint32 StreamScheduler::AddStream(uint64 fileSize, uint32 blockSize, uint32 prefetchDepth)
+{
+	for (uint32 i = 0; i < MaxStreams; i++)
+	{
+		Stream& stream = streams[i];
+		if (stream.isUsed == false)
+		{
+			memset(&stream, 0, sizeof(stream));
+			stream.isUsed = true;
+			stream.fileSize = fileSize;
+			stream.blockSize = blockSize > 0 ? blockSize : 1;
+			stream.prefetchDepth = prefetchDepth;
+			return i;
+		}
+	}
+	return InvalidStream;
+}
+
+void StreamScheduler::RemoveStream(uint32 streamIndex)
+{
+	if (streamIndex >= MaxStreams || streams[streamIndex].isUsed == false)
+	{
+		return;
+	}
+
+	Stream& stream = streams[streamIndex];
+	while (stream.requestCount > 0)
+	{
+		Complete(stream, stream.requestCount - 1, 0, false, stream.requests[stream.requestCount - 1].submitTime);
+	}
+	FreeWindows(stream);
+	stream.isUsed = false;
+}
+
+bool StreamScheduler::IsReading(uint32 streamIndex) const
+{
+	if (streamIndex >= MaxStreams)
+	{
+		return false;
+	}
+	for (uint32 i = 0; i < MaxWindows; i++)
+	{
+		if (streams[streamIndex].windows[i].isReading == true)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void StreamScheduler::FreeWindows(Stream& stream)
+{
+	for (uint32 i = 0; i < MaxWindows; i++)
+	{
+		delete[] stream.windows[i].pData;
+		memset(&stream.windows[i], 0, sizeof(Window));
+	}
+}
+
+StreamSubmitResult StreamScheduler::Submit(uint32 streamIndex, uint64 offset, uint32 length, void* pBuffer, void* pContext,
+	int64 now, uint32& bytesTransferred)
+{
+	bytesTransferred = 0;
+	if (streamIndex >= MaxStreams || streams[streamIndex].isUsed == false)
+	{
+		return StreamSubmitFailed;
+	}
+
+	Stream& stream = streams[streamIndex];
+	stream.statistics.requests++;
+	totalStatistics.requests++;
+
+	// Reads at or past the end succeed with no data, like ReadFile
+	if (offset >= stream.fileSize)
+	{
+		return StreamSubmitCompleted;
+	}
+
+	// Served from a window read ahead
+	for (uint32 i = 0; i < MaxWindows; i++)
+	{
+		Window& window = stream.windows[i];
+		uint64 windowEnd = window.offset + window.length;
+		if (window.isUsed == false || window.length == 0 || offset < window.offset || offset >= windowEnd)
+		{
+			continue;
+		}
+
+		uint64 end = offset + length < windowEnd ? offset + length : windowEnd;
+		if (end - offset < length && windowEnd < stream.fileSize)
+		{
+			continue;
+		}
+
+		bytesTransferred = static_cast<uint32>(end - offset);
+		memcpy(pBuffer, window.pData + (offset - window.offset), bytesTransferred);
+		if (end > window.consumedOffset)
+		{
+			window.consumedOffset = end;
+		}
+		UpdateRate(window, length, now);
+		stream.statistics.prefetchHits++;
+		totalStatistics.prefetchHits++;
+		return StreamSubmitCompleted;
+	}
+
+	if (stream.requestCount == MaxRequests)
+	{
+		return StreamSubmitFailed;
+	}
+
+	Request& request = stream.requests[stream.requestCount++];
+	request.offset = offset;
+	request.length = length;
+	request.pBuffer = pBuffer;
+	request.pContext = pContext;
+	request.submitTime = now;
+	request.window = FindWindow(stream, offset);
+	if (request.window == NoWindow)
+	{
+		request.window = ClaimWindow(stream, offset, now);
+	}
+
+	// The consumer has about one more request worth of data left
+	uint32 bytesPerSecond = 0;
+	if (request.window != NoWindow)
+	{
+		Window& window = stream.windows[request.window];
+		UpdateRate(window, length, now);
+		bytesPerSecond = window.bytesPerSecond;
+	}
+	request.deadline = now + GetDuration(length, bytesPerSecond);
+	return StreamSubmitQueued;
+}
+
+uint32 StreamScheduler::FindWindow(Stream& stream, uint64 offset) const
+{
+	// A window continues a sequential run if the offset is within what
+	// it holds or would hold after its next read, which first drops what
+	// has been consumed, or where a request pending on it ends
+	for (uint32 i = 0; i < MaxWindows; i++)
+	{
+		const Window& window = stream.windows[i];
+		if (window.isUsed == false || offset < window.offset)
+		{
+			continue;
+		}
+
+		uint32 reach = static_cast<uint32>(stream.blockSize * (stream.prefetchDepth + 1));
+		if (window.capacity > reach)
+		{
+			reach = window.capacity;
+		}
+		uint64 start = window.consumedOffset > window.offset ? window.consumedOffset : window.offset;
+		uint64 end = window.offset + window.length;
+		if (start > end)
+		{
+			start = end;
+		}
+		if (offset < start + reach)
+		{
+			return i;
+		}
+
+		for (uint32 j = 0; j < stream.requestCount; j++)
+		{
+			const Request& request = stream.requests[j];
+			if (request.window == i && request.offset + request.length == offset)
+			{
+				return i;
+			}
+		}
+	}
+	return NoWindow;
+}
+
+uint32 StreamScheduler::ClaimWindow(Stream& stream, uint64 offset, int64 now)
+{
+	// An unused window, else the least recently used one without a read
+	// out or requests pending
+	uint32 best = NoWindow;
+	for (uint32 i = 0; i < MaxWindows; i++)
+	{
+		const Window& window = stream.windows[i];
+		if (window.isReading == true)
+		{
+			continue;
+		}
+
+		bool hasRequests = false;
+		for (uint32 j = 0; j < stream.requestCount && hasRequests == false; j++)
+		{
+			hasRequests = stream.requests[j].window == i;
+		}
+		if (hasRequests == true)
+		{
+			continue;
+		}
+
+		if (window.isUsed == false)
+		{
+			best = i;
+			break;
+		}
+		if (best == NoWindow || window.lastSubmitTime < stream.windows[best].lastSubmitTime)
+		{
+			best = i;
+		}
+	}
+
+	if (best != NoWindow)
+	{
+		Window& window = stream.windows[best];
+		window.isUsed = true;
+		window.offset = offset;
+		window.length = 0;
+		window.consumedOffset = offset;
+		window.lastSubmitTime = now;
+		window.bytesPerSecond = 0;
+	}
+	return best;
+}
+
+void StreamScheduler::UpdateRate(Window& window, uint32 length, int64 now)
+{
+	int64 interval = now - window.lastSubmitTime;
+	if (interval < MinRequestInterval)
+	{
+		interval = MinRequestInterval;
+	}
+	uint32 rate = static_cast<uint32>(static_cast<int64>(length) * MicrosecondsPerSecond / interval);
+	window.bytesPerSecond = window.bytesPerSecond == 0 ? rate : (window.bytesPerSecond / 8) * 7 + rate / 8;
+	window.lastSubmitTime = now;
+}
+
+bool StreamScheduler::GetWindowDeadline(Stream& stream, uint32 windowIndex, int64& deadline) const
+{
+	const Window& window = stream.windows[windowIndex];
+	if (window.isReading == true)
+	{
+		return false;
+	}
+
+	bool hasWork = false;
+	for (uint32 i = 0; i < stream.requestCount; i++)
+	{
+		const Request& request = stream.requests[i];
+		if (request.window == windowIndex && (hasWork == false || request.deadline < deadline))
+		{
+			deadline = request.deadline;
+			hasWork = true;
+		}
+	}
+	if (hasWork == true || stream.prefetchDepth == 0 || window.isUsed == false || window.length == 0)
+	{
+		return hasWork;
+	}
+
+	// Read ahead once there is room for a block, due when the data ahead
+	// of the consumer runs out
+	uint64 end = window.offset + window.length;
+	uint64 consumed = window.consumedOffset > window.offset ? window.consumedOffset : window.offset;
+	uint64 ahead = consumed < end ? end - consumed : 0;
+	uint64 room = window.capacity > ahead ? window.capacity - ahead : 0;
+	if (end >= stream.fileSize || room < stream.blockSize)
+	{
+		return false;
+	}
+	deadline = window.lastSubmitTime + GetDuration(ahead, window.bytesPerSecond);
+	return true;
+}
+
+bool StreamScheduler::BeginRead(int64 now, StreamRead& read)
+{
+	for (;;)
+	{
+		uint32 bestStream = InvalidStream;
+		uint32 bestWindow = NoWindow;
+		int64 bestDeadline = 0;
+		for (uint32 i = 0; i < MaxStreams; i++)
+		{
+			Stream& stream = streams[i];
+			if (stream.isUsed == false)
+			{
+				continue;
+			}
+
+			// Requests that found all windows busy when submitted
+			for (uint32 j = 0; j < stream.requestCount; j++)
+			{
+				Request& request = stream.requests[j];
+				if (request.window == NoWindow)
+				{
+					request.window = FindWindow(stream, request.offset);
+					if (request.window == NoWindow)
+					{
+						request.window = ClaimWindow(stream, request.offset, now);
+					}
+				}
+			}
+
+			for (uint32 j = 0; j < MaxWindows; j++)
+			{
+				int64 deadline;
+				if (GetWindowDeadline(stream, j, deadline) == true &&
+					(bestStream == InvalidStream || deadline < bestDeadline))
+				{
+					bestStream = i;
+					bestWindow = j;
+					bestDeadline = deadline;
+				}
+			}
+		}
+		if (bestStream == InvalidStream)
+		{
+			return false;
+		}
+
+		Stream& stream = streams[bestStream];
+		Window& window = stream.windows[bestWindow];
+
+		// The first request of the window in file order, if any. The rate
+		// estimate may give a later request an earlier deadline.
+		const Request* pRequest = NULL;
+		for (uint32 i = 0; i < stream.requestCount; i++)
+		{
+			const Request& request = stream.requests[i];
+			if (request.window == bestWindow && (pRequest == NULL || request.offset < pRequest->offset))
+			{
+				pRequest = &request;
+			}
+		}
+
+		uint64 windowEnd = window.offset + window.length;
+		if (pRequest != NULL && (window.length == 0 || pRequest->offset < window.offset || pRequest->offset > windowEnd))
+		{
+			// Not a continuation of the data held, start over at the request
+			window.offset = pRequest->offset;
+			window.length = 0;
+			window.consumedOffset = pRequest->offset;
+		}
+		else
+		{
+			// Drop what has been consumed and is not wanted by a request
+			uint64 keepFrom = window.consumedOffset > window.offset ? window.consumedOffset : window.offset;
+			for (uint32 i = 0; i < stream.requestCount; i++)
+			{
+				const Request& request = stream.requests[i];
+				if (request.window == bestWindow && request.offset >= window.offset && request.offset < keepFrom)
+				{
+					keepFrom = request.offset;
+				}
+			}
+			if (keepFrom > windowEnd)
+			{
+				keepFrom = windowEnd;
+			}
+			uint32 drop = static_cast<uint32>(keepFrom - window.offset);
+			if (drop > 0)
+			{
+				memmove(window.pData, window.pData + drop, window.length - drop);
+				window.offset = keepFrom;
+				window.length -= drop;
+			}
+		}
+
+		// Room for the requests and prefetchDepth blocks, requests larger
+		// than a block or further ahead grow the window
+		uint64 needed = static_cast<uint64>(stream.blockSize) * (stream.prefetchDepth + 1);
+		for (uint32 i = 0; i < stream.requestCount; i++)
+		{
+			const Request& request = stream.requests[i];
+			if (request.window == bestWindow && request.offset >= window.offset &&
+				request.offset + request.length - window.offset > needed)
+			{
+				needed = request.offset + request.length - window.offset;
+			}
+		}
+		if (needed > window.capacity)
+		{
+			uint8* pData = new uint8[static_cast<size_t>(needed)];
+			if (window.length > 0)
+			{
+				memcpy(pData, window.pData, window.length);
+			}
+			delete[] window.pData;
+			window.pData = pData;
+			window.capacity = static_cast<uint32>(needed);
+		}
+
+		read.stream = bestStream;
+		read.window = bestWindow;
+		read.offset = window.offset + window.length;
+		read.length = window.capacity - window.length;
+		if (read.offset + read.length > stream.fileSize)
+		{
+			read.length = read.offset < stream.fileSize ? static_cast<uint32>(stream.fileSize - read.offset) : 0;
+		}
+		if (read.length == 0)
+		{
+			// Requests past an end that moved after a short read
+			ServeRequests(stream, bestWindow, now);
+			continue;
+		}
+		read.pBuffer = window.pData + window.length;
+		window.isReading = true;
+		return true;
+	}
+}
+
+void StreamScheduler::EndRead(const StreamRead& read, uint32 bytesRead, bool succeeded, int64 now)
+{
+	Stream& stream = streams[read.stream];
+	Window& window = stream.windows[read.window];
+	window.isReading = false;
+
+	stream.statistics.reads++;
+	totalStatistics.reads++;
+
+	if (succeeded == false)
+	{
+		for (uint32 i = 0; i < stream.requestCount;)
+		{
+			if (stream.requests[i].window == read.window)
+			{
+				Complete(stream, i, 0, false, now);
+			}
+			else
+			{
+				i++;
+			}
+		}
+		window.length = 0;
+		return;
+	}
+
+	stream.statistics.bytesRead += bytesRead;
+	totalStatistics.bytesRead += bytesRead;
+	window.length += bytesRead;
+	if (bytesRead < read.length)
+	{
+		// The file is shorter than it was
+		stream.fileSize = window.offset + window.length;
+	}
+
+	ServeRequests(stream, read.window, now);
+}
+
+void StreamScheduler::ServeRequests(Stream& stream, uint32 windowIndex, int64 now)
+{
+	Window& window = stream.windows[windowIndex];
+	uint64 windowEnd = window.offset + window.length;
+	for (uint32 i = 0; i < stream.requestCount;)
+	{
+		Request& request = stream.requests[i];
+		if (request.window != windowIndex || request.offset < window.offset || request.offset > windowEnd)
+		{
+			i++;
+			continue;
+		}
+
+		// Whole requests only, except where the file ends
+		uint64 end = request.offset + request.length < windowEnd ? request.offset + request.length : windowEnd;
+		if (end - request.offset < request.length && windowEnd < stream.fileSize)
+		{
+			i++;
+			continue;
+		}
+
+		uint32 length = static_cast<uint32>(end - request.offset);
+		memcpy(request.pBuffer, window.pData + (request.offset - window.offset), length);
+		if (end > window.consumedOffset)
+		{
+			window.consumedOffset = end;
+		}
+		Complete(stream, i, length, true, now);
+	}
+}
+
+void StreamScheduler::Complete(Stream& stream, uint32 requestIndex, uint32 bytesTransferred, bool succeeded, int64 now)
+{
+	Request& request = stream.requests[requestIndex];
+
+	StreamCompletion completion;
+	completion.pContext = request.pContext;
+	completion.bytesTransferred = bytesTransferred;
+	completion.succeeded = succeeded;
+	completions.Add(completion);
+
+	int64 latency = now - request.submitTime;
+	bool missedDeadline = now > request.deadline;
+	AddLatency(stream.statistics, latency, missedDeadline);
+	AddLatency(totalStatistics, latency, missedDeadline);
+
+	stream.requests[requestIndex] = stream.requests[--stream.requestCount];
+}
+
+bool StreamScheduler::PopCompleted(StreamCompletion& completion)
+{
+	if (completionHead == completions.GetCount())
+	{
+		return false;
+	}
+
+	completion = completions[completionHead++];
+	if (completionHead == completions.GetCount())
+	{
+		completions.Resize(0);
+		completionHead = 0;
+	}
+	return true;
+}
@@ -0,0 +1,175 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	enum StreamSubmitResult
+	{
+		// The data was copied from a read ahead window
+		StreamSubmitCompleted,
+		// Completes once a read covering it has ended, see PopCompleted
+		StreamSubmitQueued,
+		// Unknown stream or too many requests pending on it
+		StreamSubmitFailed,
+	};
+
+	// A disk read handed out by BeginRead. The caller reads length bytes
+	// at offset of the stream's file into pBuffer and calls EndRead.
+	struct StreamRead
+	{
+		uint32 stream;
+		uint32 window;
+		uint64 offset;
+		uint32 length;
+		void* pBuffer;
+	};
+
+	struct StreamCompletion
+	{
+		// As passed to Submit
+		void* pContext;
+		uint32 bytesTransferred;
+		bool succeeded;
+	};
+
+	struct StreamStatistics
+	{
+		// Reads asked for through Submit
+		uint64 requests;
+		// Requests served from a read ahead window without waiting
+		uint64 prefetchHits;
+		// Disk reads, each may serve several requests
+		uint64 reads;
+		uint64 bytesRead;
+		// Requests completed after their deadline
+		uint64 deadlineMisses;
+		// Time from Submit to completion
+		int64 totalLatencyMicroseconds;
+		int64 maxLatencyMicroseconds;
+	};
+
+	// Orders the disk reads of any number of streams, such as XACT
+	// streaming wave banks sharing one disk.
+	//
+	// Every stream keeps a few read ahead windows, one per sequential run
+	// of requests, e.g. one per wave playing from a streaming bank. A disk
+	// read fills a window for all requests pending on it and up to
+	// prefetchDepth blocks beyond, so sequential requests are coalesced
+	// into one read and later ones are served by a copy. Each window
+	// estimates how fast its data is consumed from the requests it sees.
+	// BeginRead hands out the read for the window closest to running dry:
+	// the earliest deadline among pending requests, or for windows with
+	// nothing pending, the time their read ahead data will be used up.
+	//
+	// The scheduler does no I/O and keeps no time itself. Callers pass the
+	// current time in microseconds and serialize all calls, see
+	// NativeStreamReader.h for the one driving XACT.
+	//
+	// Plain C++ without CLR or XACT dependencies, see NativeFileMapping.h.
+	class StreamScheduler
+	{
+	public:
+		static const uint32 MaxStreams = 32;
+		static const uint32 MaxWindows = 4;
+		static const uint32 MaxRequests = 64;
+		static const uint32 InvalidStream = 0xFFFFFFFF;
+		// Consumption rate assumed before a window has seen two requests,
+		// 16 bit stereo PCM at 44.1 kHz
+		static const uint32 DefaultBytesPerSecond = 176400;
+
+	private:
+		static const uint32 NoWindow = 0xFFFFFFFF;
+
+		struct Request
+		{
+			uint64 offset;
+			uint32 length;
+			uint32 window;
+			void* pBuffer;
+			void* pContext;
+			int64 submitTime;
+			int64 deadline;
+		};
+
+		struct Window
+		{
+			bool isUsed;
+			uint8* pData;
+			uint32 capacity;
+			// File range held in pData
+			uint64 offset;
+			uint32 length;
+			// End of the last request served, data before it may be dropped
+			uint64 consumedOffset;
+			bool isReading;
+			int64 lastSubmitTime;
+			uint32 bytesPerSecond;
+		};
+
+		struct Stream
+		{
+			bool isUsed;
+			uint64 fileSize;
+			uint32 blockSize;
+			uint32 prefetchDepth;
+			Window windows[MaxWindows];
+			Request requests[MaxRequests];
+			uint32 requestCount;
+			StreamStatistics statistics;
+		};
+
+		Stream streams[MaxStreams];
+		BankArray<StreamCompletion> completions;
+		uint32 completionHead;
+		StreamStatistics totalStatistics;
+
+		StreamScheduler(const StreamScheduler&);
+		StreamScheduler& operator=(const StreamScheduler&);
+
+		uint32 FindWindow(Stream& stream, uint64 offset) const;
+		uint32 ClaimWindow(Stream& stream, uint64 offset, int64 now);
+		bool GetWindowDeadline(Stream& stream, uint32 window, int64& deadline) const;
+		void UpdateRate(Window& window, uint32 length, int64 now);
+		void Complete(Stream& stream, uint32 request, uint32 bytesTransferred, bool succeeded, int64 now);
+		void ServeRequests(Stream& stream, uint32 window, int64 now);
+		void FreeWindows(Stream& stream);
+
+	public:
+		StreamScheduler();
+		~StreamScheduler();
+
+		// blockSize is the usual request size, prefetchDepth the number
+		// of blocks read ahead of the last request. Returns InvalidStream
+		// if all streams are in use.
+		uint32 AddStream(uint64 fileSize, uint32 blockSize, uint32 prefetchDepth);
+		// Fails requests still pending on the stream. Must not be called
+		// while a read of the stream is out, see IsReading.
+		void RemoveStream(uint32 stream);
+		bool IsReading(uint32 stream) const;
+
+		// bytesTransferred is set if the request completed right away
+		StreamSubmitResult Submit(uint32 stream, uint64 offset, uint32 length, void* pBuffer, void* pContext,
+			int64 now, uint32& bytesTransferred);
+
+		// Picks the most urgent read, returns false if there is nothing to
+		// read or every window with work has a read out. Requests past the
+		// end of a file may complete here, not only in EndRead.
+		bool BeginRead(int64 now, StreamRead& read);
+		void EndRead(const StreamRead& read, uint32 bytesRead, bool succeeded, int64 now);
+
+		bool PopCompleted(StreamCompletion& completion);
+
+		const StreamStatistics& GetStatistics(uint32 stream) const { return streams[stream].statistics; }
+		// Summed over all streams, including removed ones
+		const StreamStatistics& GetTotalStatistics() const { return totalStatistics; }
+	};
+
+}}}
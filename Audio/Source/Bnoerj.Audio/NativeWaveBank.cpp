@@ -1,113 +1,185 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "NativeEngine.h"
-#include "NativeWaveBank.h"
-#include "NativeHelpers.h"
-#include "ErrorToException.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio::Native;
-using namespace Bnoerj::Native::Helpers;
-
-WaveBank::WaveBank(IXACT3Engine* pEngine, String^ filename)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	array<Byte>^ aData = File::ReadAllBytes(filename);
-	void* pData = NULL;
-	if (aData != nullptr && aData->Length > 0)
-	{
-		pin_ptr<Byte> ptrData = &aData[0];
-		pData = new BYTE[aData->Length];
-		memcpy_s(pData, aData->Length, ptrData, aData->Length);
-	}
-
-	IXACT3WaveBank* pWaveBank;
-	HRESULT hr = pEngine->CreateInMemoryWaveBank(pData, aData->Length, 0, 0, &pWaveBank);
-	if (FAILED(hr))
-	{
-		delete[] pData;
-		ErrorToException::Throw(hr);
-	}
-
-	this->pEngine = pEngine;
-	this->pObject = pWaveBank;
-	this->pData = pData;
-	hStreamingWaveBankFile = INVALID_HANDLE_VALUE;
-}
-
-WaveBank::WaveBank(IXACT3Engine* pEngine, String^ filename, DWORD offset, short packetSize)
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	hStreamingWaveBankFile = ::CreateFileW(
-		Bnoerj::Native::Helpers::StringConverter::ToNativeStringUni(filename),
-		GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
-		FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, NULL);
-	if (hStreamingWaveBankFile == INVALID_HANDLE_VALUE)
-	{
-		ErrorToException::Throw(E_FAIL);
-	}
-
-	XACT_WAVEBANK_STREAMING_PARAMETERS params = { 0 };
-	params.file = hStreamingWaveBankFile;
-	params.offset = offset;
-	params.packetSize = packetSize;
-
-	IXACT3WaveBank* pWaveBank;
-	HRESULT hr = pEngine->CreateStreamingWaveBank(&params, &pWaveBank);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-
-	this->pEngine = pEngine;
-	this->pObject = pWaveBank;
-	this->pData = NULL;
-}
-
-void WaveBank::Release()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3WaveBank* pWaveBank = static_cast<IXACT3WaveBank*>(pObject);
-	if (pWaveBank != NULL)
-	{
-		pWaveBank->Destroy();
-	}
-	pObject = NULL;
-
-	if (this->pData != NULL)
-	{
-		BYTE* pData = static_cast<BYTE*>(this->pData);
-		delete[] pData;
-	}
-	pData = NULL;
-
-	if (hStreamingWaveBankFile != INVALID_HANDLE_VALUE)
-	{
-		::CloseHandle(hStreamingWaveBankFile);
-		hStreamingWaveBankFile = INVALID_HANDLE_VALUE;
-	}
-}
-
-DWORD WaveBank::GetStatus()
-{
-	msclr::lock lock(Engine::syncRoot);
-
-	IXACT3WaveBank* pWaveBank = static_cast<IXACT3WaveBank*>(pObject);
-	DWORD state;
-	HRESULT hr = pWaveBank->GetState(&state);
-	if (FAILED(hr))
-	{
-		ErrorToException::Throw(hr);
-	}
-	return state;
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "NativeEngine.h"
+#include "NativeWaveBank.h"
+#include "NativeWaveBankFile.h"
+#include "NativeHelpers.h"
+#include "NativeStreamReader.h"
+#include "ErrorToException.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio::Native;
+using namespace Bnoerj::Native::Helpers;
+
+WaveBank::WaveBank(Engine^ engine, String^ filename)
+{
+	// XACT reads wave data straight from the read only view
+	Create(engine, Engine::MapFile(filename, FileMapping::AccessReadOnly));
+	source = gcnew FileBankSource(filename, FileMapping::AccessReadOnly);
+}
+
+WaveBank::WaveBank(Engine^ engine, FileMapping* pMapping, BankSource^ source)
+{
+	Create(engine, pMapping);
+	this->source = source;
+}
+
+void WaveBank::Create(Engine^ engine, FileMapping* pMapping)
+{
+	if (name == nullptr)
+	{
+		WaveBankFile waveBankFile;
+		if (waveBankFile.Parse(pMapping->GetData(), pMapping->GetSize()) == BankParseOk)
+		{
+			name = gcnew String(waveBankFile.GetName());
+		}
+	}
+
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3Engine* pEngine = engine->pEngine;
+
+	IXACT3WaveBank* pWaveBank;
+	HRESULT hr = pEngine->CreateInMemoryWaveBank(pMapping->GetData(), static_cast<DWORD>(pMapping->GetSize()), 0, 0, &pWaveBank);
+	if (FAILED(hr))
+	{
+		delete pMapping;
+		ErrorToException::Throw(hr);
+	}
+
+	this->engine = engine;
+	this->pEngine = pEngine;
+	this->pObject = pWaveBank;
+	this->pMapping = pMapping;
+	hStreamingWaveBankFile = INVALID_HANDLE_VALUE;
+}
+
+WaveBank::WaveBank(Engine^ engine, String^ filename, DWORD offset, short packetSize, DWORD prefetchDepth)
+{
+	// Buffered, the read ahead windows of the StreamReader are not sector
+	// aligned and reads from them need not be either
+	Bnoerj::Native::Helpers::NativeStringUni nativeFilename(filename);
+	HANDLE hFile = ::CreateFileW(
+		nativeFilename,
+		GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		ErrorToException::Throw(E_FAIL);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(hFile, &fileSize) == FALSE)
+	{
+		fileSize.QuadPart = 0;
+	}
+	CreateStreaming(engine, hFile, offset, fileSize.QuadPart, packetSize, prefetchDepth);
+}
+
+WaveBank::WaveBank(Engine^ engine, HANDLE hPackFile, DWORD offset, ULONGLONG size, short packetSize, DWORD prefetchDepth)
+{
+	// A handle of its own, so the bank outlives the pack and the
+	// StreamReader tells the banks of one pack apart
+	HANDLE hFile;
+	HANDLE hProcess = ::GetCurrentProcess();
+	if (::DuplicateHandle(hProcess, hPackFile, hProcess, &hFile, 0, FALSE, DUPLICATE_SAME_ACCESS) == FALSE)
+	{
+		ErrorToException::Throw(HRESULT_FROM_WIN32(::GetLastError()));
+	}
+	CreateStreaming(engine, hFile, offset, offset + size, packetSize, prefetchDepth);
+}
+
+void WaveBank::CreateStreaming(Engine^ engine, HANDLE hFile, DWORD offset, ULONGLONG endOffset, short packetSize,
+	DWORD prefetchDepth)
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3Engine* pEngine = engine->pEngine;
+	hStreamingWaveBankFile = hFile;
+
+	// XACT reads one packet of packetSize DVD sectors at a time
+	if (endOffset > offset)
+	{
+		StreamReader::AddFile(hStreamingWaveBankFile, endOffset, packetSize * 2048, prefetchDepth);
+	}
+
+	XACT_WAVEBANK_STREAMING_PARAMETERS params = { 0 };
+	params.file = hStreamingWaveBankFile;
+	params.offset = offset;
+	params.packetSize = packetSize;
+
+	IXACT3WaveBank* pWaveBank;
+	HRESULT hr = pEngine->CreateStreamingWaveBank(&params, &pWaveBank);
+	if (FAILED(hr))
+	{
+		StreamReader::RemoveFile(hStreamingWaveBankFile);
+		::CloseHandle(hStreamingWaveBankFile);
+		hStreamingWaveBankFile = INVALID_HANDLE_VALUE;
+		ErrorToException::Throw(hr);
+	}
+
+	this->engine = engine;
+	this->pEngine = pEngine;
+	this->pObject = pWaveBank;
+	this->pData = NULL;
+}
+
+void WaveBank::Release()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3WaveBank* pWaveBank = static_cast<IXACT3WaveBank*>(pObject);
+	if (pWaveBank != NULL)
+	{
+		pWaveBank->Destroy();
+	}
+	pObject = NULL;
+
+	delete pMapping;
+	pMapping = NULL;
+
+	if (hStreamingWaveBankFile != INVALID_HANDLE_VALUE)
+	{
+		// After Destroy, XACT has no reads of the bank left
+		StreamReader::RemoveFile(hStreamingWaveBankFile);
+		::CloseHandle(hStreamingWaveBankFile);
+		hStreamingWaveBankFile = INVALID_HANDLE_VALUE;
+	}
+}
+
+void WaveBank::Reload(FileMapping* pMapping)
+{
+	Create(engine, pMapping);
+}
+
+bool WaveBank::IsInUse()
+{
+	return (GetStatus() & XACT_WAVEBANKSTATE_INUSE) != 0;
+}
+
+DWORD WaveBank::GetStatus()
+{
+	ScopedLock lock(Engine::syncRoot);
+
+	IXACT3WaveBank* pWaveBank = static_cast<IXACT3WaveBank*>(pObject);
+	if (pWaveBank == NULL)
+	{
+		// Unloaded by the memory budget
+		return 0;
+	}
+
+	DWORD state;
+	HRESULT hr = pWaveBank->GetState(&state);
+	if (FAILED(hr))
+	{
+		ErrorToException::Throw(hr);
+	}
+	return state;
+}
@@ -1,30 +1,50 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-using namespace System::Runtime::InteropServices;
-
-#include "NativeAudioObject.h"
-
-namespace Bnoerj { namespace Audio { namespace Native {
-
-	ref class WaveBank : public AudioObject
-	{
-		HANDLE hStreamingWaveBankFile;
-
-	public:
-		WaveBank(IXACT3Engine* pEngine, String^ filename);
-		WaveBank(IXACT3Engine* pEngine, String^ filename, DWORD offset, short packetSize);
-
-		virtual void Release() override;
-
-		DWORD GetStatus();
-	};
-
-}}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+using namespace System::Runtime::InteropServices;
+
+#include "NativeBank.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	ref class WaveBank : public Bank
+	{
+		HANDLE hStreamingWaveBankFile;
+
+		void Create(Engine^ engine, FileMapping* pMapping);
+		// Takes ownership of the file handle, also if creating the bank
+		// fails. Reads stop at endOffset.
+		void CreateStreaming(Engine^ engine, HANDLE hFile, DWORD offset, ULONGLONG endOffset, short packetSize,
+			DWORD prefetchDepth);
+
+	internal:
+		// Name from the bank header, sound banks refer to the bank by it.
+		// Null for streaming banks and headers that could not be read.
+		String^ name;
+
+	public:
+		WaveBank(Engine^ engine, String^ filename);
+		// Takes ownership of the mapping, also if creating the bank fails.
+		// source may be null, the bank is then never unloaded.
+		WaveBank(Engine^ engine, FileMapping* pMapping, BankSource^ source);
+		// Reads are scheduled by the StreamReader, prefetchDepth is the
+		// number of packets read ahead of XACT
+		WaveBank(Engine^ engine, String^ filename, DWORD offset, short packetSize, DWORD prefetchDepth);
+		// A streaming wave bank of size bytes at offset of a bank pack
+		WaveBank(Engine^ engine, HANDLE hPackFile, DWORD offset, ULONGLONG size, short packetSize, DWORD prefetchDepth);
+
+		virtual void Release() override;
+		virtual bool IsInUse() override;
+		virtual void Reload(FileMapping* pMapping) override;
+
+		DWORD GetStatus();
+	};
+
+}}}
@@ -0,0 +1,318 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Compiled without /clr and without the precompiled header, see
+// NativeWaveBankFile.h
+
+#include <string.h>
+
+#include "NativeWaveBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Layout of the header, the bank data and the entries, see xact3wb.h
+	const size_t HeaderSize = 12 + WaveBankSegmentCount * 8;
+	const size_t BankDataSize = 96;
+	const size_t BankNameLength = 64;
+	const size_t EntrySize = 24;
+	const size_t CompactEntrySize = 4;
+
+	const uint32 AdpcmBlockAlignOffset = 22;
+
+	const uint32 WmaBlockAlign[] =
+	{
+		929, 1487, 1280, 2230, 8917, 8192, 4459, 5945, 2304, 1536, 1485, 1008, 2731, 4096, 6827, 5462, 1280,
+	};
+	const uint32 WmaAvgBytesPerSec[] =
+	{
+		12000, 24000, 4000, 6000, 8000, 20000, 2500,
+	};
+
+	uint32 GetAdpcmSamplesPerBlock(const WaveBankFormat& format)
+	{
+		if (format.channels == 0 || format.blockAlign < 7u * format.channels)
+		{
+			return 0;
+		}
+		return (format.blockAlign - 7 * format.channels) * 8 / (4 * format.channels) + 2;
+	}
+
+	// Samples in a wave of the given length, zero if the format does not
+	// tell without decoding
+	uint32 GetSampleCount(const WaveBankFormat& format, uint32 length)
+	{
+		if (format.blockAlign == 0)
+		{
+			return 0;
+		}
+		switch (format.formatTag)
+		{
+		case WaveBankFormatPcm:
+			return length / format.blockAlign;
+		case WaveBankFormatAdpcm:
+			return length / format.blockAlign * GetAdpcmSamplesPerBlock(format);
+		default:
+			return 0;
+		}
+	}
+}
+
+WaveBankFile::WaveBankFile()
+	: pEntries(NULL)
+	, pNames(NULL)
+{
+	Clear();
+}
+
+WaveBankFile::~WaveBankFile()
+{
+	Clear();
+}
+
+void WaveBankFile::Clear()
+{
+	delete[] pEntries;
+	pEntries = NULL;
+	delete[] pNames;
+	pNames = NULL;
+
+	contentVersion = 0;
+	headerVersion = 0;
+	flags = 0;
+	alignment = 0;
+	buildTime = 0;
+	name[0] = '\0';
+	memset(segments, 0, sizeof(segments));
+	entryCount = 0;
+	nameSize = 0;
+}
+
+void WaveBankFile::UnpackFormat(uint32 miniFormat, WaveBankFormat& format)
+{
+	// wFormatTag:2, nChannels:3, nSamplesPerSec:18, wBlockAlign:8,
+	// wBitsPerSample:1, from the lowest bit up
+	uint32 blockAlign = (miniFormat >> 23) & 0xFF;
+	uint32 bitsPerSample = (miniFormat >> 31) & 0x1;
+
+	format.formatTag = static_cast<WaveBankFormatTag>(miniFormat & 0x3);
+	format.channels = static_cast<uint16>((miniFormat >> 2) & 0x7);
+	format.samplesPerSec = (miniFormat >> 5) & 0x3FFFF;
+
+	switch (format.formatTag)
+	{
+	case WaveBankFormatPcm:
+		format.bitsPerSample = bitsPerSample != 0 ? 16 : 8;
+		format.blockAlign = blockAlign;
+		format.avgBytesPerSec = format.samplesPerSec * blockAlign;
+		break;
+	case WaveBankFormatXma:
+		format.bitsPerSample = 16;
+		format.blockAlign = format.channels * 2;
+		format.avgBytesPerSec = format.samplesPerSec * format.blockAlign;
+		break;
+	case WaveBankFormatAdpcm:
+		{
+			format.bitsPerSample = 4;
+			format.blockAlign = (blockAlign + AdpcmBlockAlignOffset) * format.channels;
+			uint32 samplesPerBlock = GetAdpcmSamplesPerBlock(format);
+			format.avgBytesPerSec = samplesPerBlock != 0 ? format.blockAlign * format.samplesPerSec / samplesPerBlock : 0;
+		}
+		break;
+	case WaveBankFormatWma:
+		{
+			// The block align field holds two table indices
+			uint32 blockAlignIndex = blockAlign & 0x1F;
+			uint32 bytesPerSecIndex = blockAlign >> 5;
+			format.bitsPerSample = 16;
+			format.blockAlign = blockAlignIndex < sizeof(WmaBlockAlign) / sizeof(WmaBlockAlign[0])
+				? WmaBlockAlign[blockAlignIndex] : 0;
+			format.avgBytesPerSec = bytesPerSecIndex < sizeof(WmaAvgBytesPerSec) / sizeof(WmaAvgBytesPerSec[0])
+				? WmaAvgBytesPerSec[bytesPerSecIndex] : 0;
+		}
+		break;
+	}
+}
+
+BankParseResult WaveBankFile::Parse(const void* pData, size_t size)
+{
+	Clear();
+
+	BankReader reader(pData, size);
+	if (reader.ReadSignature("WBND") == false)
+	{
+		return BankParseInvalidSignature;
+	}
+	if (reader.Contains(0, HeaderSize) == false)
+	{
+		return BankParseTruncated;
+	}
+
+	contentVersion = reader.ReadUInt32(4);
+	headerVersion = reader.ReadUInt32(8);
+	if (headerVersion != HeaderVersion)
+	{
+		return BankParseUnsupportedVersion;
+	}
+
+	for (int i = 0; i < WaveBankSegmentCount; i++)
+	{
+		segments[i].offset = reader.ReadUInt32(12 + i * 8);
+		segments[i].length = reader.ReadUInt32(16 + i * 8);
+		if (segments[i].length > 0 && reader.Contains(segments[i].offset, segments[i].length) == false)
+		{
+			// Streaming banks may leave the wave data out of the file
+			// being parsed, e.g. when only the header was read
+			if (i != WaveBankSegmentEntryWaveData)
+			{
+				return BankParseTruncated;
+			}
+		}
+	}
+
+	//
+	// Bank data
+	//
+
+	const BankRegion& bankData = segments[WaveBankSegmentBankData];
+	if (bankData.length < BankDataSize)
+	{
+		return BankParseTruncated;
+	}
+
+	size_t offset = bankData.offset;
+	flags = reader.ReadUInt32(offset);
+	uint32 count = reader.ReadUInt32(offset + 4);
+	memcpy(name, reader.GetData() + offset + 8, BankNameLength);
+	name[BankNameLength] = '\0';
+	uint32 metaDataSize = reader.ReadUInt32(offset + 72);
+	uint32 entryNameSize = reader.ReadUInt32(offset + 76);
+	alignment = reader.ReadUInt32(offset + 80);
+	uint32 compactFormat = reader.ReadUInt32(offset + 84);
+	buildTime = reader.ReadUInt64(offset + 88);
+
+	//
+	// Entries
+	//
+
+	const BankRegion& metaData = segments[WaveBankSegmentEntryMetaData];
+	bool isCompact = (flags & BankFlagCompact) != 0;
+	if (isCompact == true ? metaDataSize < CompactEntrySize : metaDataSize < 8)
+	{
+		return BankParseInvalidData;
+	}
+	if (count > metaData.length / metaDataSize)
+	{
+		return BankParseTruncated;
+	}
+
+	const BankRegion& waveData = segments[WaveBankSegmentEntryWaveData];
+	pEntries = new WaveBankEntry[count];
+	memset(pEntries, 0, count * sizeof(WaveBankEntry));
+	entryCount = count;
+
+	for (uint32 i = 0; i < count; i++)
+	{
+		WaveBankEntry& entry = pEntries[i];
+		offset = metaData.offset + i * metaDataSize;
+
+		if (isCompact == true)
+		{
+			// dwOffset:21 in units of the alignment, dwLengthDeviation:11
+			uint32 value = reader.ReadUInt32(offset);
+			uint32 start = (value & 0x1FFFFF) * alignment;
+			uint32 deviation = value >> 21;
+			uint32 end = waveData.length;
+			if (i + 1 < count)
+			{
+				end = (reader.ReadUInt32(offset + metaDataSize) & 0x1FFFFF) * alignment;
+			}
+			if (end < start + deviation)
+			{
+				return BankParseInvalidData;
+			}
+
+			UnpackFormat(compactFormat, entry.format);
+			entry.playOffset = waveData.offset + start;
+			entry.playLength = end - start - deviation;
+			entry.duration = GetSampleCount(entry.format, entry.playLength);
+			continue;
+		}
+
+		// Banks from older tools may store only the leading fields
+		uint32 flagsAndDuration = reader.ReadUInt32(offset);
+		entry.flags = flagsAndDuration & 0xF;
+		entry.duration = flagsAndDuration >> 4;
+		UnpackFormat(reader.ReadUInt32(offset + 4), entry.format);
+		if (metaDataSize >= 12)
+		{
+			entry.playOffset = waveData.offset + reader.ReadUInt32(offset + 8);
+		}
+		if (metaDataSize >= 16)
+		{
+			entry.playLength = reader.ReadUInt32(offset + 12);
+		}
+		if (metaDataSize >= 20)
+		{
+			entry.loopStart = reader.ReadUInt32(offset + 16);
+		}
+		if (metaDataSize >= EntrySize)
+		{
+			entry.loopLength = reader.ReadUInt32(offset + 20);
+		}
+	}
+
+	//
+	// Entry names
+	//
+
+	const BankRegion& names = segments[WaveBankSegmentEntryNames];
+	if ((flags & BankFlagEntryNames) != 0 && entryNameSize > 0 && count > 0)
+	{
+		if (count > names.length / entryNameSize)
+		{
+			return BankParseTruncated;
+		}
+
+		// Names fill the whole element if they are as long as it is
+		nameSize = entryNameSize + 1;
+		pNames = new char[count * nameSize];
+		for (uint32 i = 0; i < count; i++)
+		{
+			memcpy(pNames + i * nameSize, reader.GetData() + names.offset + i * entryNameSize, entryNameSize);
+			pNames[i * nameSize + entryNameSize] = '\0';
+		}
+	}
+
+	return BankParseOk;
+}
+
+const char* WaveBankFile::GetEntryName(uint32 index) const
+{
+	if (pNames == NULL || index >= entryCount)
+	{
+		return NULL;
+	}
+	return pNames + index * nameSize;
+}
+
+uint32 WaveBankFile::FindEntry(const char* name) const
+{
+	if (pNames == NULL)
+	{
+		return InvalidIndex;
+	}
+	for (uint32 i = 0; i < entryCount; i++)
+	{
+		if (strcmp(pNames + i * nameSize, name) == 0)
+		{
+			return i;
+		}
+	}
+	return InvalidIndex;
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include "NativeBankReader.h"
+
+namespace Bnoerj { namespace Audio { namespace Native {
+
+	enum WaveBankFormatTag
+	{
+		WaveBankFormatPcm = 0,
+		WaveBankFormatXma = 1,
+		WaveBankFormatAdpcm = 2,
+		WaveBankFormatWma = 3,
+	};
+
+	enum WaveBankSegment
+	{
+		WaveBankSegmentBankData,
+		WaveBankSegmentEntryMetaData,
+		WaveBankSegmentSeekTables,
+		WaveBankSegmentEntryNames,
+		WaveBankSegmentEntryWaveData,
+		WaveBankSegmentCount,
+	};
+
+	struct BankRegion
+	{
+		uint32 offset;
+		uint32 length;
+	};
+
+	// A wave format unpacked from the 32 bit mini format XACT stores
+	struct WaveBankFormat
+	{
+		WaveBankFormatTag formatTag;
+		uint16 channels;
+		uint16 bitsPerSample;
+		uint32 samplesPerSec;
+		uint32 blockAlign;
+		uint32 avgBytesPerSec;
+	};
+
+	struct WaveBankEntry
+	{
+		// WaveBankFile::EntryFlag* values
+		uint32 flags;
+		// Length in samples
+		uint32 duration;
+		WaveBankFormat format;
+		// Wave data position relative to the start of the file
+		uint32 playOffset;
+		uint32 playLength;
+		// Loop region in samples
+		uint32 loopStart;
+		uint32 loopLength;
+	};
+
+	// Index of an XACT3 wave bank (.xwb) built from the file contents alone,
+	// without an engine. Everything is copied out of the data passed to
+	// Parse, which may be released afterwards.
+	//
+	// Plain C++ without CLR or XACT dependencies, see NativeFileMapping.h.
+	class WaveBankFile
+	{
+		uint32 contentVersion;
+		uint32 headerVersion;
+		uint32 flags;
+		uint32 alignment;
+		uint64 buildTime;
+		char name[65];
+		BankRegion segments[WaveBankSegmentCount];
+
+		uint32 entryCount;
+		WaveBankEntry* pEntries;
+		// entryCount zero terminated names of nameSize bytes each, null if
+		// the bank was built without entry names
+		char* pNames;
+		uint32 nameSize;
+
+		WaveBankFile(const WaveBankFile&);
+		WaveBankFile& operator=(const WaveBankFile&);
+
+		void Clear();
+
+	public:
+		static const uint32 HeaderVersion = 44;
+		static const uint32 InvalidIndex = 0xFFFFFFFF;
+
+		// Bank flags
+		static const uint32 BankFlagStreaming = 0x00000001;
+		static const uint32 BankFlagEntryNames = 0x00010000;
+		static const uint32 BankFlagCompact = 0x00020000;
+		static const uint32 BankFlagSyncDisabled = 0x00040000;
+		static const uint32 BankFlagSeekTables = 0x00080000;
+
+		// Entry flags
+		static const uint32 EntryFlagReadAhead = 0x1;
+		static const uint32 EntryFlagLoopCache = 0x2;
+		static const uint32 EntryFlagRemoveLoopTail = 0x4;
+		static const uint32 EntryFlagIgnoreLoop = 0x8;
+
+		WaveBankFile();
+		~WaveBankFile();
+
+		BankParseResult Parse(const void* pData, size_t size);
+
+		uint32 GetContentVersion() const { return contentVersion; }
+		uint32 GetHeaderVersion() const { return headerVersion; }
+		uint32 GetFlags() const { return flags; }
+		bool IsStreaming() const { return (flags & BankFlagStreaming) != 0; }
+		uint32 GetAlignment() const { return alignment; }
+		// FILETIME of the build, as a single 64 bit value
+		uint64 GetBuildTime() const { return buildTime; }
+		const char* GetName() const { return name; }
+		BankRegion GetSegment(WaveBankSegment segment) const { return segments[segment]; }
+
+		uint32 GetEntryCount() const { return entryCount; }
+		const WaveBankEntry& GetEntry(uint32 index) const { return pEntries[index]; }
+		// Null if the bank was built without entry names
+		const char* GetEntryName(uint32 index) const;
+		// Returns InvalidIndex for unknown names or banks without names
+		uint32 FindEntry(const char* name) const;
+
+		static void UnpackFormat(uint32 miniFormat, WaveBankFormat& format);
+	};
+
+}}}
@@ -1,84 +1,253 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "StringResources.h"
-
-#include "AudioStopOptions.h"
-#include "AudioCategory.h"
-#include "RendererDetail.h"
-#include "AudioEngine.h"
-#include "AudioListener.h"
-#include "AudioEmitter.h"
-#include "AudioObject.h"
-#include "Cue.h"
-#include "SoundBank.h"
-
-#include "NativeEngine.h"
-#include "NativeCue.h"
-#include "NativeSoundBank.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio;
-
-
-SoundBank::SoundBank(AudioEngine^ engine, String^ filename)
-{
-	if (engine == nullptr)
-	{
-		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
-	}
-	if (String::IsNullOrEmpty(filename) == true)
-	{
-		throw gcnew ArgumentNullException("filename", StringResources::NullNotAllowed);
-	}
-
-	this->nativeObject = gcnew Native::SoundBank(engine->pEngine, filename);
-	engine->AddAudioInstance(this->nativeObject->pObject, this);
-
-	this->engine = engine;
-}
-
-bool SoundBank::IsInUse::get()
-{
-	DWORD status = static_cast<Native::SoundBank^>(nativeObject)->GetStatus();
-	return (status & XACT_SOUNDBANKSTATE_INUSE) != 0;
-}
-
-Cue^ SoundBank::GetCue(String^ name)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-	Native::Cue^ nativeCue = static_cast<Native::SoundBank^>(nativeObject)->GetCue(name);
-	return gcnew Cue(engine, static_cast<Native::AudioObject^>(nativeCue), name);
-}
-
-void SoundBank::PlayCue(String^ name)
-{
-	if (String::IsNullOrEmpty(name) == true)
-	{
-		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-	}
-
-	static_cast<Native::SoundBank^>(nativeObject)->PlayCue(name);
-}
-
-void SoundBank::PlayCue(String^ name, AudioListener^ listener, AudioEmitter^ emitter)
-{
-	if (String::IsNullOrEmpty(name) == true)
-    {
-        throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
-    }
-
-	Native::Cue^ nativeCue = static_cast<Native::SoundBank^>(nativeObject)->GetCue(name);
-    Cue^ cue = gcnew Cue(engine, static_cast<Native::AudioObject^>(nativeCue), name);
-    cue->Apply3D(listener, emitter);
-    cue->Play();
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "BankBudget.h"
+#include "AudioListener.h"
+#include "AudioEmitter.h"
+#include "AudioObject.h"
+#include "Cue.h"
+#include "CueHandle.h"
+#include "SoundBank.h"
+#include "BankPack.h"
+
+#include "NativeEngine.h"
+#include "NativeCue.h"
+#include "NativeSoundBank.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio;
+
+
+SoundBank::SoundBank(AudioEngine^ engine, String^ filename)
+{
+	if (engine == nullptr)
+	{
+		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(filename) == true)
+	{
+		throw gcnew ArgumentNullException("filename", StringResources::NullNotAllowed);
+	}
+
+	this->nativeObject = gcnew Native::SoundBank(engine->engine, filename);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+SoundBank::SoundBank(AudioEngine^ engine, BankPack^ pack, String^ name)
+{
+	if (engine == nullptr)
+	{
+		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
+	}
+	if (pack == nullptr)
+	{
+		throw gcnew ArgumentNullException("pack", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+
+	Native::BankPackEntry entry = pack->GetEntry(name);
+	if (entry.type != Native::BankPackEntrySoundBank)
+	{
+		throw gcnew ArgumentException(String::Format(StringResources::PackEntryTypeMismatch, name), "name");
+	}
+
+	// XACT writes to sound bank data, see Native::SoundBank
+	Native::BankSource^ source = pack->CreateSource(name, Native::FileMapping::AccessCopyOnWrite);
+	this->nativeObject = gcnew Native::SoundBank(engine->engine, source->Map(), source);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+SoundBank::SoundBank(AudioEngine^ engine, Native::FileMapping* pMapping, Native::BankSource^ source)
+{
+	this->nativeObject = gcnew Native::SoundBank(engine->engine, pMapping, source);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+bool SoundBank::IsLoaded::get()
+{
+	return static_cast<Native::SoundBank^>(nativeObject)->IsLoaded();
+}
+
+bool SoundBank::IsInUse::get()
+{
+	DWORD status = static_cast<Native::SoundBank^>(nativeObject)->GetStatus();
+	return (status & XACT_SOUNDBANKSTATE_INUSE) != 0;
+}
+
+CueHandle SoundBank::GetCueHandle(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	return CueHandle(soundBank->GetCueIndex(name), soundBank);
+}
+
+XACTINDEX SoundBank::GetCueIndex(CueHandle cue)
+{
+	if (cue.IsValid == false)
+	{
+		throw gcnew ArgumentException(StringResources::InvalidCueHandle, "cue");
+	}
+	if (cue.Owner != nativeObject)
+	{
+		throw gcnew ArgumentException(StringResources::CueHandleMismatch, "cue");
+	}
+	return cue.Index;
+}
+
+XACTINDEX SoundBank::GetCueIndex(int index)
+{
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	if (index < 0 || index >= static_cast<int>(soundBank->GetCueCount()))
+	{
+		throw gcnew ArgumentOutOfRangeException("index", StringResources::InvalidCue);
+	}
+	return static_cast<XACTINDEX>(index);
+}
+
+Cue^ SoundBank::PrepareCue(XACTINDEX index)
+{
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	Native::Cue^ nativeCue = soundBank->GetCue(index);
+	return gcnew Cue(engine, static_cast<Native::AudioObject^>(nativeCue), soundBank->GetCueName(index));
+}
+
+Cue^ SoundBank::GetCue(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	Native::Cue^ nativeCue = soundBank->GetCue(name);
+	return gcnew Cue(engine, static_cast<Native::AudioObject^>(nativeCue), name);
+}
+
+Cue^ SoundBank::GetCue(CueHandle cue)
+{
+	return PrepareCue(GetCueIndex(cue));
+}
+
+Cue^ SoundBank::GetCue(int index)
+{
+	return PrepareCue(GetCueIndex(index));
+}
+
+void SoundBank::PlayCue(String^ name)
+{
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	soundBank->PlayCue(name);
+}
+
+void SoundBank::PlayCue(String^ name, AudioListener^ listener, AudioEmitter^ emitter)
+{
+	if (String::IsNullOrEmpty(name) == true)
+    {
+        throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+    }
+
+	// Loaded before the name is looked up, see Native::SoundBank::GetCueIndex
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	PlayCue3D(soundBank->GetCueIndex(name), listener, emitter);
+}
+
+void SoundBank::PlayCue(CueHandle cue)
+{
+	XACTINDEX index = GetCueIndex(cue);
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	soundBank->PlayCue(index);
+}
+
+void SoundBank::PlayCue(CueHandle cue, AudioListener^ listener, AudioEmitter^ emitter)
+{
+	PlayCue3D(GetCueIndex(cue), listener, emitter);
+}
+
+void SoundBank::PlayCue(int index)
+{
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	XACTINDEX cueIndex = GetCueIndex(index);
+	engine->budget->Use(soundBank);
+	soundBank->PlayCue(cueIndex);
+}
+
+void SoundBank::PlayCue(int index, AudioListener^ listener, AudioEmitter^ emitter)
+{
+	PlayCue3D(GetCueIndex(index), listener, emitter);
+}
+
+void SoundBank::PlayCue3D(XACTINDEX index, AudioListener^ listener, AudioEmitter^ emitter)
+{
+	if (listener == nullptr)
+	{
+		throw gcnew ArgumentNullException("listener", StringResources::NullNotAllowed);
+	}
+	if (emitter == nullptr)
+	{
+		throw gcnew ArgumentNullException("emitter", StringResources::NullNotAllowed);
+	}
+
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	X3DAUDIO_EMITTER emitterData;
+	FLOAT32 channelAzimuths[AudioEmitter::MaxChannelCount];
+	emitter->GetEmitter(&emitterData, channelAzimuths);
+	soundBank->PlayCue3D(index, listener->listenerData, &emitterData);
+}
+
+int SoundBank::GetCuePoolSize(CueHandle cue)
+{
+	XACTINDEX index = GetCueIndex(cue);
+	return static_cast<Native::SoundBank^>(nativeObject)->GetCuePoolSize(index);
+}
+
+void SoundBank::SetCuePoolSize(CueHandle cue, int size)
+{
+	XACTINDEX index = GetCueIndex(cue);
+	if (size < 0)
+	{
+		throw gcnew ArgumentOutOfRangeException("size", StringResources::InvalidCuePoolSize);
+	}
+
+	Native::SoundBank^ soundBank = static_cast<Native::SoundBank^>(nativeObject);
+	engine->budget->Use(soundBank);
+	soundBank->SetCuePoolSize(index, size);
+}
@@ -1,26 +1,67 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class SoundBank : public AudioObject
-	{
-	public:
-		SoundBank(AudioEngine^ engine, String^ filename);
-
-		property bool IsInUse { bool get(); }
-
-		Cue^ GetCue(String^ name);
-		void PlayCue(String^ name);
-		void PlayCue(String^ name, AudioListener^ listener, AudioEmitter^ emitter);
-	};
-
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	value struct CueHandle;
+
+	public ref class SoundBank : public AudioObject
+	{
+	public:
+		SoundBank(AudioEngine^ engine, String^ filename);
+		// The sound bank of that name in the pack
+		SoundBank(AudioEngine^ engine, BankPack^ pack, String^ name);
+
+		// False while unloaded to stay within AudioEngine::MemoryBudget.
+		// The bank is loaded again when a cue of it is asked for.
+		property bool IsLoaded { bool get(); }
+		property bool IsInUse { bool get(); }
+
+		// Resolves a cue name once for the GetCue and PlayCue overloads
+		// taking a handle. Returns an invalid handle for unknown names.
+		CueHandle GetCueHandle(String^ name);
+
+		Cue^ GetCue(String^ name);
+		Cue^ GetCue(CueHandle cue);
+		void PlayCue(String^ name);
+		void PlayCue(CueHandle cue);
+		// Fire and forget, the cue is taken from the cue pool of its
+		// definition, or prepared if the pool is empty. No Cue is created.
+		void PlayCue(String^ name, AudioListener^ listener, AudioEmitter^ emitter);
+		void PlayCue(CueHandle cue, AudioListener^ listener, AudioEmitter^ emitter);
+
+		// Number of cues kept prepared for the 3D PlayCue overloads. 0 by
+		// default, the pool is off and every such PlayCue prepares its cue
+		// until a size is set. Pools are filled in AudioEngine::Update.
+		// Prepared cues keep the bank in use, it is then not unloaded to
+		// stay within AudioEngine::MemoryBudget.
+		int GetCuePoolSize(CueHandle cue);
+		void SetCuePoolSize(CueHandle cue, int size);
+
+		// Take the cue indices Xidgen generates from the sound bank
+		Cue^ GetCue(int index);
+		void PlayCue(int index);
+		void PlayCue(int index, AudioListener^ listener, AudioEmitter^ emitter);
+
+	internal:
+		// Creates a sound bank from a file already mapped by a
+		// BankLoadOperation, takes ownership of the mapping. The source maps
+		// the file again after the bank was unloaded.
+		SoundBank(AudioEngine^ engine, Native::FileMapping* pMapping, Native::BankSource^ source);
+
+	private:
+		XACTINDEX GetCueIndex(CueHandle cue);
+		XACTINDEX GetCueIndex(int index);
+		Cue^ PrepareCue(XACTINDEX index);
+		void PlayCue3D(XACTINDEX index, AudioListener^ listener, AudioEmitter^ emitter);
+	};
+
+}}
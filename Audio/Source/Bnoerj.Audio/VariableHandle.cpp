@@ -0,0 +1,60 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+#include "VariableHandle.h"
+
+using namespace Bnoerj::Audio;
+
+VariableHandle::VariableHandle(XACTVARIABLEINDEX index, bool isGlobal)
+	: value(index != XACTVARIABLEINDEX_INVALID ? index + 1 : 0)
+	, isGlobal(isGlobal)
+{}
+
+XACTVARIABLEINDEX VariableHandle::Index::get()
+{
+	return value != 0 ? value - 1 : XACTVARIABLEINDEX_INVALID;
+}
+
+bool VariableHandle::IsValid::get()
+{
+	return value != 0;
+}
+
+bool VariableHandle::IsGlobal::get()
+{
+	return isGlobal;
+}
+
+bool VariableHandle::Equals(VariableHandle other)
+{
+	return value == other.value && isGlobal == other.isGlobal;
+}
+
+bool VariableHandle::Equals(Object^ other)
+{
+	if (dynamic_cast<VariableHandle^>(other) != nullptr)
+	{
+		return Equals(safe_cast<VariableHandle>(other));
+	}
+	return false;
+}
+
+int VariableHandle::GetHashCode()
+{
+	return isGlobal == true ? -value : value;
+}
+
+bool VariableHandle::operator ==(VariableHandle a, VariableHandle b)
+{
+	return a.value == b.value && a.isGlobal == b.isGlobal;
+}
+
+bool VariableHandle::operator !=(VariableHandle a, VariableHandle b)
+{
+	return !(a == b);
+}
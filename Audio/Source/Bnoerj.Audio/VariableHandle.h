@@ -0,0 +1,40 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	// A global or cue variable resolved by name once. Get and set calls
+	// taking a handle skip the name lookup.
+	public value struct VariableHandle : IEquatable<VariableHandle>
+	{
+	private:
+		// Variable index plus one, zero for a default or unresolved handle
+		UInt16 value;
+		bool isGlobal;
+
+	internal:
+		VariableHandle(XACTVARIABLEINDEX index, bool isGlobal);
+
+		property XACTVARIABLEINDEX Index { XACTVARIABLEINDEX get(); }
+
+	public:
+		// False if the name did not resolve to a variable
+		property bool IsValid { bool get(); }
+		property bool IsGlobal { bool get(); }
+
+		virtual bool Equals(VariableHandle other);
+		virtual bool Equals(Object^ other) override;
+		virtual int GetHashCode() override;
+
+		static bool operator ==(VariableHandle a, VariableHandle b);
+		static bool operator !=(VariableHandle a, VariableHandle b);
+	};
+}}
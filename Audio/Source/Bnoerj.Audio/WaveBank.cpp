@@ -1,68 +1,152 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#include "stdafx.h"
-
-#include "StringResources.h"
-
-#include "AudioStopOptions.h"
-#include "AudioCategory.h"
-#include "RendererDetail.h"
-#include "AudioEngine.h"
-#include "AudioObject.h"
-#include "WaveBank.h"
-
-#include "NativeWaveBank.h"
-
-using namespace System::IO;
-using namespace Bnoerj::Audio;
-
-WaveBank::WaveBank(AudioEngine^ engine, String^ nonStreamingWaveBankFilename)
-{
-	if (engine == nullptr)
-	{
-		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
-	}
-	if (String::IsNullOrEmpty(nonStreamingWaveBankFilename) == true)
-	{
-		throw gcnew ArgumentNullException("nonStreamingWaveBankFilename", StringResources::NullNotAllowed);
-	}
-
-	nativeObject = gcnew Native::WaveBank(engine->pEngine, nonStreamingWaveBankFilename);
-	engine->AddAudioInstance(nativeObject->pObject, this);
-
-	this->engine = engine;
-}
-
-WaveBank::WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize)
-{
-	if (engine == nullptr)
-	{
-		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
-	}
-	if (String::IsNullOrEmpty(streamingWaveBankFilename) == true)
-	{
-		throw gcnew ArgumentNullException("streamingWaveBankFilename", StringResources::NullNotAllowed);
-	}
-
-	nativeObject = gcnew Native::WaveBank(engine->pEngine, streamingWaveBankFilename, offset, (short)packetSize);
-	engine->AddAudioInstance(nativeObject->pObject, this);
-
-	this->engine = engine;
-}
-
-bool WaveBank::IsPrepared::get()
-{
-	DWORD status = static_cast<Native::WaveBank^>(nativeObject)->GetStatus();
-	return (status & XACT_WAVEBANKSTATE_PREPARED) != 0;
-}
-
-bool WaveBank::IsInUse::get()
-{
-	DWORD status = static_cast<Native::WaveBank^>(nativeObject)->GetStatus();
-	return (status & XACT_WAVEBANKSTATE_INUSE) != 0;
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include "stdafx.h"
+
+#include "StringResources.h"
+
+#include "AudioStopOptions.h"
+#include "AudioCategory.h"
+#include "RendererDetail.h"
+#include "AudioEngine.h"
+#include "BankBudget.h"
+#include "AudioObject.h"
+#include "WaveBank.h"
+#include "BankPack.h"
+
+#include "NativeWaveBank.h"
+#include "NativeStreamReader.h"
+
+using namespace System::IO;
+using namespace Bnoerj::Audio;
+
+WaveBank::WaveBank(AudioEngine^ engine, String^ nonStreamingWaveBankFilename)
+{
+	if (engine == nullptr)
+	{
+		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(nonStreamingWaveBankFilename) == true)
+	{
+		throw gcnew ArgumentNullException("nonStreamingWaveBankFilename", StringResources::NullNotAllowed);
+	}
+
+	nativeObject = gcnew Native::WaveBank(engine->engine, nonStreamingWaveBankFilename);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+WaveBank::WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize)
+{
+	Create(engine, streamingWaveBankFilename, offset, packetSize, Native::StreamReader::DefaultPrefetchDepth);
+}
+
+WaveBank::WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize, int prefetchDepth)
+{
+	Create(engine, streamingWaveBankFilename, offset, packetSize, prefetchDepth);
+}
+
+void WaveBank::Create(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize, int prefetchDepth)
+{
+	if (engine == nullptr)
+	{
+		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(streamingWaveBankFilename) == true)
+	{
+		throw gcnew ArgumentNullException("streamingWaveBankFilename", StringResources::NullNotAllowed);
+	}
+	if (prefetchDepth < 0 || prefetchDepth > static_cast<int>(Native::StreamReader::MaxPrefetchDepth))
+	{
+		throw gcnew ArgumentOutOfRangeException("prefetchDepth", StringResources::InvalidPrefetchDepth);
+	}
+
+	nativeObject = gcnew Native::WaveBank(engine->engine, streamingWaveBankFilename, offset, (short)packetSize, prefetchDepth);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+WaveBank::WaveBank(AudioEngine^ engine, BankPack^ pack, String^ name)
+{
+	Create(engine, pack, name, Native::StreamReader::DefaultPrefetchDepth);
+}
+
+WaveBank::WaveBank(AudioEngine^ engine, BankPack^ pack, String^ name, int prefetchDepth)
+{
+	Create(engine, pack, name, prefetchDepth);
+}
+
+void WaveBank::Create(AudioEngine^ engine, BankPack^ pack, String^ name, int prefetchDepth)
+{
+	if (engine == nullptr)
+	{
+		throw gcnew ArgumentNullException("engine", StringResources::NullNotAllowed);
+	}
+	if (pack == nullptr)
+	{
+		throw gcnew ArgumentNullException("pack", StringResources::NullNotAllowed);
+	}
+	if (String::IsNullOrEmpty(name) == true)
+	{
+		throw gcnew ArgumentNullException("name", StringResources::NullNotAllowed);
+	}
+	if (prefetchDepth < 0 || prefetchDepth > static_cast<int>(Native::StreamReader::MaxPrefetchDepth))
+	{
+		throw gcnew ArgumentOutOfRangeException("prefetchDepth", StringResources::InvalidPrefetchDepth);
+	}
+
+	Native::BankPackEntry entry = pack->GetEntry(name);
+	if (entry.type == Native::BankPackEntryWaveBank)
+	{
+		// XACT reads wave data straight from the read only view
+		Native::BankSource^ source = pack->CreateSource(name, Native::FileMapping::AccessReadOnly);
+		nativeObject = gcnew Native::WaveBank(engine->engine, source->Map(), source);
+	}
+	else if (entry.type == Native::BankPackEntryStreamingWaveBank && entry.offset <= 0xFFFFFFFF)
+	{
+		nativeObject = gcnew Native::WaveBank(engine->engine, pack->GetFileHandle(),
+			static_cast<DWORD>(entry.offset), entry.size, static_cast<short>(entry.packetSize), prefetchDepth);
+	}
+	else
+	{
+		throw gcnew ArgumentException(String::Format(StringResources::PackEntryTypeMismatch, name), "name");
+	}
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+WaveBank::WaveBank(AudioEngine^ engine, Native::FileMapping* pMapping, Native::BankSource^ source)
+{
+	nativeObject = gcnew Native::WaveBank(engine->engine, pMapping, source);
+	engine->AddAudioInstance(this);
+	engine->budget->Add(this);
+
+	this->engine = engine;
+}
+
+bool WaveBank::IsLoaded::get()
+{
+	return static_cast<Native::WaveBank^>(nativeObject)->IsLoaded();
+}
+
+bool WaveBank::IsPrepared::get()
+{
+	DWORD status = static_cast<Native::WaveBank^>(nativeObject)->GetStatus();
+	return (status & XACT_WAVEBANKSTATE_PREPARED) != 0;
+}
+
+bool WaveBank::IsInUse::get()
+{
+	DWORD status = static_cast<Native::WaveBank^>(nativeObject)->GetStatus();
+	return (status & XACT_WAVEBANKSTATE_INUSE) != 0;
+}
@@ -1,25 +1,45 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-#pragma once
-
-using namespace System;
-
-namespace Bnoerj { namespace Audio {
-
-	public ref class WaveBank : public AudioObject
-	{
-		System::IO::FileStream^ stream;
-
-	public:
-		WaveBank(AudioEngine^ engine, String^ nonStreamingWaveBankFilename);
-		WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize);
-
-		property bool IsPrepared { bool get(); }
-		property bool IsInUse { bool get(); }
-	};
-}}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+using namespace System;
+
+namespace Bnoerj { namespace Audio {
+
+	public ref class WaveBank : public AudioObject
+	{
+		System::IO::FileStream^ stream;
+
+		void Create(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize, int prefetchDepth);
+		void Create(AudioEngine^ engine, BankPack^ pack, String^ name, int prefetchDepth);
+
+	public:
+		WaveBank(AudioEngine^ engine, String^ nonStreamingWaveBankFilename);
+		WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize);
+		// prefetchDepth is the number of packets read ahead of playback,
+		// 0 to 8. The other overload reads ahead 2 packets.
+		WaveBank(AudioEngine^ engine, String^ streamingWaveBankFilename, int offset, int packetSize, int prefetchDepth);
+		// The wave bank of that name in the pack, in-memory or streaming
+		// as it was built. Streaming banks take the packet size stored in
+		// the pack, prefetchDepth applies to them only.
+		WaveBank(AudioEngine^ engine, BankPack^ pack, String^ name);
+		WaveBank(AudioEngine^ engine, BankPack^ pack, String^ name, int prefetchDepth);
+
+		// False while unloaded to stay within AudioEngine::MemoryBudget.
+		// The bank is loaded again with a sound bank playing from it.
+		property bool IsLoaded { bool get(); }
+		property bool IsPrepared { bool get(); }
+		property bool IsInUse { bool get(); }
+
+	internal:
+		// Creates an in-memory wave bank from a file already mapped by a
+		// BankLoadOperation, takes ownership of the mapping. The source maps
+		// the file again after the bank was unloaded.
+		WaveBank(AudioEngine^ engine, Native::FileMapping* pMapping, Native::BankSource^ source);
+	};
+}}
@@ -0,0 +1,571 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the command queue of Bnoerj.Audio, see NativeRingBuffer.h and
+// Engine::Submit, against the global lock every call took before it. A
+// number of producer threads submit commands to a stub engine, a frame
+// of them at a time with a sleep of one period in between, while a
+// service thread holds the lock for a while on that period, as the
+// service thread does for IXACT3Engine::DoWork:
+//
+//   Lock   every producer takes the lock and executes its command, as the
+//          calls on a Cue did with deferred commands off
+//   Queue  producers push their commands into a RingBuffer, which the
+//          service thread flushes under the lock before its work. A
+//          producer finding the queue full flushes it, releases the
+//          lock and queues its command again, as Engine::Submit does.
+//
+// The stub executes a command by touching the state of its cue. Every
+// command carries its producer and a sequence number, so both modes check
+// that all commands ran once, in the order each producer submitted them.
+//
+// Plain C++ on top of NativeRingBuffer.h. On Windows it uses the Win32
+// threads and critical section the engine uses, elsewhere pthreads and
+// GCC atomics, for example with
+//   g++ -O2 -I../Bnoerj.Audio CommandQueueBenchmark.cpp -lpthread
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+// The Win32 subset NativeRingBuffer.h uses
+typedef int LONG;
+typedef unsigned char BYTE;
+
+inline LONG InterlockedCompareExchange(volatile LONG* pDestination, LONG exchange, LONG comparand)
+{
+	return __sync_val_compare_and_swap(pDestination, comparand, exchange);
+}
+
+inline LONG InterlockedExchange(volatile LONG* pTarget, LONG value)
+{
+	// __sync_lock_test_and_set is only an acquire barrier, the value
+	// written before must be visible first
+	__sync_synchronize();
+	return __sync_lock_test_and_set(pTarget, value);
+}
+
+inline LONG InterlockedIncrement(volatile LONG* pAddend)
+{
+	return __sync_add_and_fetch(pAddend, 1);
+}
+#endif
+
+#include "NativeRingBuffer.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// As Bnoerj::Audio::Native::CommandQueueCapacity
+	const LONG QueueCapacity = 4096;
+	// Cues the commands are spread over
+	const unsigned int CueCount = 256;
+
+	// About the size of Native::Command, which carries a copy of the 3D
+	// listener and emitter
+	struct StubCommand
+	{
+		unsigned int producer;
+		unsigned int sequence;
+		unsigned int cue;
+		float value;
+		BYTE payload[240];
+	};
+
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int threadCount;
+		unsigned int commandCount;
+		unsigned int frameCommandCount;
+		unsigned int work;
+		unsigned int periodMicroseconds;
+		unsigned int workMicroseconds;
+	};
+
+#if defined(_WIN32)
+	class Lock
+	{
+		CRITICAL_SECTION criticalSection;
+
+	public:
+		Lock() { ::InitializeCriticalSectionAndSpinCount(&criticalSection, 4000); }
+		~Lock() { ::DeleteCriticalSection(&criticalSection); }
+		void Enter() { ::EnterCriticalSection(&criticalSection); }
+		void Leave() { ::LeaveCriticalSection(&criticalSection); }
+	};
+
+	typedef HANDLE Thread;
+	typedef DWORD ThreadResult;
+#define THREADPROC WINAPI
+
+	Thread StartThread(ThreadResult (THREADPROC* pProc)(void*), void* pContext)
+	{
+		return ::CreateThread(NULL, 0, reinterpret_cast<LPTHREAD_START_ROUTINE>(pProc), pContext, 0, NULL);
+	}
+
+	void JoinThread(Thread thread)
+	{
+		::WaitForSingleObject(thread, INFINITE);
+		::CloseHandle(thread);
+	}
+
+	void SleepMicroseconds(unsigned int microseconds)
+	{
+		::Sleep(microseconds / 1000);
+	}
+
+	void YieldThread()
+	{
+		::SwitchToThread();
+	}
+
+	double GetSeconds()
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&counter);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+#else
+	class Lock
+	{
+		pthread_mutex_t mutex;
+
+	public:
+		Lock() { pthread_mutex_init(&mutex, NULL); }
+		~Lock() { pthread_mutex_destroy(&mutex); }
+		void Enter() { pthread_mutex_lock(&mutex); }
+		void Leave() { pthread_mutex_unlock(&mutex); }
+	};
+
+	typedef pthread_t Thread;
+	typedef void* ThreadResult;
+#define THREADPROC
+
+	Thread StartThread(ThreadResult (*pProc)(void*), void* pContext)
+	{
+		pthread_t thread;
+		pthread_create(&thread, NULL, pProc, pContext);
+		return thread;
+	}
+
+	void JoinThread(Thread thread)
+	{
+		pthread_join(thread, NULL);
+	}
+
+	void SleepMicroseconds(unsigned int microseconds)
+	{
+		if (microseconds > 0)
+		{
+			usleep(microseconds);
+		}
+		else
+		{
+			sched_yield();
+		}
+	}
+
+	void YieldThread()
+	{
+		sched_yield();
+	}
+
+	double GetSeconds()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+#endif
+
+	// Executes commands, always under its lock
+	class StubEngine
+	{
+		std::vector<unsigned int> nextSequences;
+		unsigned int work;
+		float cueStates[CueCount];
+
+	public:
+		Lock lock;
+		RingBuffer<StubCommand> commands;
+		unsigned long long executed;
+		unsigned long long outOfOrder;
+		volatile LONG overflows;
+		volatile bool isDone;
+
+		StubEngine(unsigned int producerCount, unsigned int work)
+			: nextSequences(producerCount)
+			, work(work)
+			, commands(QueueCapacity)
+			, executed(0)
+			, outOfOrder(0)
+			, overflows(0)
+			, isDone(false)
+		{
+			memset(cueStates, 0, sizeof(cueStates));
+		}
+
+		float GetCueState(unsigned int cue) const
+		{
+			return cueStates[cue];
+		}
+
+		void Execute(const StubCommand& command)
+		{
+			if (command.sequence != nextSequences[command.producer])
+			{
+				outOfOrder++;
+			}
+			nextSequences[command.producer] = command.sequence + 1;
+
+			// Stands in for the XACT call
+			float state = cueStates[command.cue];
+			for (unsigned int i = 0; i < work; i++)
+			{
+				state = state * 0.5f + command.value;
+			}
+			cueStates[command.cue] = state;
+			executed++;
+		}
+
+		// As Engine::FlushCommands, the caller holds the lock
+		void Flush()
+		{
+			StubCommand command;
+			while (commands.Pop(command) == true)
+			{
+				Execute(command);
+			}
+		}
+
+		// As Engine::Submit
+		void Submit(const StubCommand& command)
+		{
+			if (commands.Push(command) == false)
+			{
+				::InterlockedIncrement(&overflows);
+				for (;;)
+				{
+					lock.Enter();
+					Flush();
+					lock.Leave();
+					if (commands.Push(command) == true)
+					{
+						break;
+					}
+					YieldThread();
+				}
+			}
+		}
+	};
+
+	struct Producer
+	{
+		StubEngine* pEngine;
+		unsigned int id;
+		unsigned int commandCount;
+		unsigned int frameCommandCount;
+		unsigned int periodMicroseconds;
+		bool useQueue;
+		double seconds;
+		double worstSeconds;
+	};
+
+	ThreadResult THREADPROC ProducerProc(void* pContext)
+	{
+		Producer* pProducer = static_cast<Producer*>(pContext);
+		StubEngine* pEngine = pProducer->pEngine;
+
+		StubCommand command;
+		memset(&command, 0, sizeof(command));
+		command.producer = pProducer->id;
+
+		double seconds = 0;
+		double worstSeconds = 0;
+		double last = GetSeconds();
+		for (unsigned int i = 0; i < pProducer->commandCount; i++)
+		{
+			command.sequence = i;
+			command.cue = (i * 7 + pProducer->id) % CueCount;
+			command.value = static_cast<float>(i & 0xFF);
+			if (pProducer->useQueue == true)
+			{
+				pEngine->Submit(command);
+			}
+			else
+			{
+				pEngine->lock.Enter();
+				pEngine->Execute(command);
+				pEngine->lock.Leave();
+			}
+
+			double now = GetSeconds();
+			seconds += now - last;
+			if (now - last > worstSeconds)
+			{
+				worstSeconds = now - last;
+			}
+			last = now;
+
+			// The rest of the frame, not counted
+			if (pProducer->frameCommandCount > 0 && (i + 1) % pProducer->frameCommandCount == 0)
+			{
+				SleepMicroseconds(pProducer->periodMicroseconds);
+				last = GetSeconds();
+			}
+		}
+		pProducer->seconds = seconds;
+		pProducer->worstSeconds = worstSeconds;
+		return 0;
+	}
+
+	struct Service
+	{
+		StubEngine* pEngine;
+		unsigned int periodMicroseconds;
+		unsigned int workMicroseconds;
+	};
+
+	// As the service thread, flushes and does its work on a fixed period
+	ThreadResult THREADPROC ServiceProc(void* pContext)
+	{
+		Service* pService = static_cast<Service*>(pContext);
+		StubEngine* pEngine = pService->pEngine;
+
+		for (;;)
+		{
+			bool isDone = pEngine->isDone;
+
+			pEngine->lock.Enter();
+			pEngine->Flush();
+			// Stands in for DoWork, which keeps the lock busy
+			double end = GetSeconds() + pService->workMicroseconds * 1e-6;
+			while (isDone == false && GetSeconds() < end)
+			{
+			}
+			pEngine->lock.Leave();
+
+			if (isDone == true)
+			{
+				break;
+			}
+			SleepMicroseconds(pService->periodMicroseconds);
+		}
+		return 0;
+	}
+
+	// Runs one mode with the number of producers, returns false if commands
+	// were lost or reordered
+	bool Run(const Parameters& parameters, unsigned int producerCount, bool useQueue)
+	{
+		StubEngine engine(producerCount, parameters.work);
+		std::vector<Producer> producers(producerCount);
+		std::vector<Thread> threads(producerCount);
+
+		Service service = { &engine, parameters.periodMicroseconds, parameters.workMicroseconds };
+		Thread serviceThread = StartThread(ServiceProc, &service);
+
+		double start = GetSeconds();
+		for (unsigned int i = 0; i < producerCount; i++)
+		{
+			Producer& producer = producers[i];
+			producer.pEngine = &engine;
+			producer.id = i;
+			producer.commandCount = parameters.commandCount;
+			producer.frameCommandCount = parameters.frameCommandCount;
+			producer.periodMicroseconds = parameters.periodMicroseconds;
+			producer.useQueue = useQueue;
+			producer.seconds = 0;
+			threads[i] = StartThread(ProducerProc, &producer);
+		}
+
+		double producerSeconds = 0;
+		double worstSeconds = 0;
+		for (unsigned int i = 0; i < producerCount; i++)
+		{
+			JoinThread(threads[i]);
+			producerSeconds += producers[i].seconds;
+			if (producers[i].worstSeconds > worstSeconds)
+			{
+				worstSeconds = producers[i].worstSeconds;
+			}
+		}
+		double submitSeconds = GetSeconds() - start;
+
+		engine.isDone = true;
+		JoinThread(serviceThread);
+		double totalSeconds = GetSeconds() - start;
+
+		unsigned long long commandCount = static_cast<unsigned long long>(parameters.commandCount) * producerCount;
+		printf("%-5s %7u %9.3f us %9.1f us %9.1f ms %9.1f ms %9ld\n",
+			useQueue == true ? "Queue" : "Lock", producerCount,
+			commandCount > 0 ? producerSeconds * 1e6 / commandCount : 0, worstSeconds * 1e6,
+			submitSeconds * 1000, totalSeconds * 1000, static_cast<long>(engine.overflows));
+
+		// Keep the stub work from being optimized away
+		float checksum = 0;
+		for (unsigned int i = 0; i < CueCount; i++)
+		{
+			checksum += engine.GetCueState(i);
+		}
+		if (checksum < 0)
+		{
+			printf("%g\n", checksum);
+		}
+
+		if (engine.executed != commandCount || engine.outOfOrder != 0)
+		{
+			fprintf(stderr, "error: %llu of %llu commands executed, %llu out of order\n",
+				engine.executed, commandCount, engine.outOfOrder);
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.threadCount = 4;
+		parameters.commandCount = 1000000;
+		parameters.frameCommandCount = 1000;
+		parameters.work = 16;
+		parameters.periodMicroseconds = 1000;
+		parameters.workMicroseconds = 200;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == false)
+			{
+				fprintf(stderr, "error: unexpected argument %s\n", arg);
+				return false;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'T': pValue = &parameters.threadCount; break;
+			case 'C': pValue = &parameters.commandCount; break;
+			case 'F': pValue = &parameters.frameCommandCount; break;
+			case 'W': pValue = &parameters.work; break;
+			case 'P': pValue = &parameters.periodMicroseconds; break;
+			case 'D': pValue = &parameters.workMicroseconds; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		if (parameters.threadCount == 0 || parameters.threadCount > 64)
+		{
+			fprintf(stderr, "error: the thread count must be between 1 and 64\n");
+			return false;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Command Queue Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: COMMANDQUEUEBENCHMARK [options]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /T:<count>      Producer threads at most, default is 4. Runs with 1, 2,\n");
+		printf("                   4 and so on up to it.\n");
+		printf("   /C:<count>      Commands per producer, default is 1000000.\n");
+		printf("   /F:<count>      Commands a producer submits per frame before it\n");
+		printf("                   sleeps for a period, default is 1000. 0 submits\n");
+		printf("                   all of them at once.\n");
+		printf("   /W:<count>      Work per executed command, default is 16.\n");
+		printf("   /P:<us>         Period of the service thread, default is 1000.\n");
+		printf("   /D:<us>         Time the service thread holds the lock per period,\n");
+		printf("                   default is 200.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	printf("%u commands per producer, %u per frame, work %u, service thread holds the lock %u of every %u us\n\n",
+		parameters.commandCount, parameters.frameCommandCount, parameters.work, parameters.workMicroseconds,
+		parameters.periodMicroseconds);
+	printf("Mode  Threads      average        worst     submit      total  overflows\n");
+
+	bool succeeded = true;
+	for (unsigned int producerCount = 1; ; producerCount *= 2)
+	{
+		if (producerCount > parameters.threadCount)
+		{
+			producerCount = parameters.threadCount;
+		}
+		succeeded &= Run(parameters, producerCount, false);
+		succeeded &= Run(parameters, producerCount, true);
+		if (producerCount == parameters.threadCount)
+		{
+			break;
+		}
+	}
+
+	printf("\nAverage and worst are the times a producer spends to submit a command,\n");
+	printf("submit until all producers are done and total until all commands ran.\n");
+	printf("Average and worst leave out the time producers sleep between frames.\n");
+	return succeeded == true ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "NativeTests.h"
+#include "NativeBankPackFile.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	struct PackInput
+	{
+		std::string name;
+		BankPackEntryType type;
+		std::vector<uint8> data;
+
+		PackInput(const char* name, BankPackEntryType type, size_t size)
+			: name(name)
+			, type(type)
+			, data(size)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				data[i] = static_cast<uint8>(i * 13 + type * 5 + size);
+			}
+		}
+	};
+
+	void WriteUInt32(std::vector<uint8>& buffer, size_t offset, uint32 value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			buffer[offset + i] = static_cast<uint8>(value >> (i * 8));
+		}
+	}
+
+	void WriteUInt64(std::vector<uint8>& buffer, size_t offset, uint64 value)
+	{
+		WriteUInt32(buffer, offset, static_cast<uint32>(value));
+		WriteUInt32(buffer, offset + 4, static_cast<uint32>(value >> 32));
+	}
+
+	size_t GetEntryOffset(uint32 index)
+	{
+		return BankPackFile::HeaderSize + index * BankPackFile::EntrySize;
+	}
+
+	// A pack laid out the way Xpack writes it
+	std::vector<uint8> WritePack(const std::vector<PackInput>& inputs, uint32 alignment, uint32 packetSize)
+	{
+		size_t tableSize = GetEntryOffset(static_cast<uint32>(inputs.size()));
+		std::vector<uint8> pack(tableSize, 0);
+		memcpy(&pack[0], "XPAK", 4);
+		WriteUInt32(pack, 4, BankPackFile::Version);
+		WriteUInt32(pack, 8, alignment);
+		WriteUInt32(pack, 12, static_cast<uint32>(inputs.size()));
+
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const PackInput& input = inputs[i];
+			size_t offset = (pack.size() + alignment - 1) / alignment * alignment;
+
+			size_t entryOffset = GetEntryOffset(static_cast<uint32>(i));
+			memcpy(&pack[entryOffset], input.name.c_str(), input.name.size());
+			WriteUInt32(pack, entryOffset + 64, input.type);
+			WriteUInt32(pack, entryOffset + 68, input.type == BankPackEntryStreamingWaveBank ? packetSize : 0);
+			WriteUInt64(pack, entryOffset + 72, offset);
+			WriteUInt64(pack, entryOffset + 80, input.data.size());
+
+			pack.resize(offset, 0);
+			pack.insert(pack.end(), input.data.begin(), input.data.end());
+		}
+		return pack;
+	}
+
+	std::vector<PackInput> GetScene()
+	{
+		std::vector<PackInput> inputs;
+		inputs.push_back(PackInput("Sample.xgs", BankPackEntrySettings, 1234));
+		inputs.push_back(PackInput("Sample.xwb", BankPackEntryWaveBank, 5000));
+		inputs.push_back(PackInput("Empty.xwb", BankPackEntryWaveBank, 0));
+		inputs.push_back(PackInput("Sample.xsb", BankPackEntrySoundBank, 777));
+		inputs.push_back(PackInput("Music.xwb", BankPackEntryStreamingWaveBank, 3 * BankPackFile::SectorSize));
+		return inputs;
+	}
+
+	BankParseResult Parse(BankPackFile& file, const std::vector<uint8>& pack)
+	{
+		return file.Parse(&pack[0], pack.size(), pack.size());
+	}
+}
+
+TEST(BankPackFile, RoundTripsXpackLayout)
+{
+	std::vector<PackInput> inputs = GetScene();
+	const uint32 alignments[] = { BankPackFile::DefaultAlignment, 4 * BankPackFile::SectorSize };
+	for (int k = 0; k < 2; k++)
+	{
+		std::vector<uint8> pack = WritePack(inputs, alignments[k], 16);
+
+		BankPackFile file;
+		REQUIRE(Parse(file, pack) == BankParseOk);
+		CHECK(file.GetAlignment() == alignments[k]);
+		REQUIRE(file.GetEntryCount() == inputs.size());
+
+		for (uint32 i = 0; i < file.GetEntryCount(); i++)
+		{
+			const BankPackEntry& entry = file.GetEntry(i);
+			const PackInput& input = inputs[i];
+			CHECK(input.name == entry.name);
+			CHECK(entry.type == input.type);
+			CHECK(entry.packetSize == (input.type == BankPackEntryStreamingWaveBank ? 16u : 0u));
+			CHECK(entry.size == input.data.size());
+
+			// Sector aligned past the table, so streaming wave banks can be
+			// read without buffering
+			CHECK(entry.offset >= GetEntryOffset(file.GetEntryCount()));
+			CHECK(entry.offset % alignments[k] == 0);
+			CHECK(entry.offset % BankPackFile::SectorSize == 0);
+			REQUIRE(entry.offset + entry.size <= pack.size());
+			CHECK(input.data.empty() == true ||
+				memcmp(&pack[static_cast<size_t>(entry.offset)], &input.data[0], input.data.size()) == 0);
+		}
+
+		CHECK(file.FindEntry("sample.XSB") == 3);
+		CHECK(file.FindEntry("Music.xwb") == 4);
+		CHECK(file.FindEntry("Sample") == BankPackFile::InvalidIndex);
+		CHECK(file.FindEntry("Sample.xsb2") == BankPackFile::InvalidIndex);
+	}
+}
+
+TEST(BankPackFile, TableSizeFromHeader)
+{
+	std::vector<uint8> pack = WritePack(GetScene(), BankPackFile::DefaultAlignment, 16);
+
+	uint32 tableSize = 0;
+	CHECK(BankPackFile::GetTableSize(&pack[0], BankPackFile::HeaderSize, tableSize) == BankParseOk);
+	CHECK(tableSize == GetEntryOffset(5));
+	CHECK(BankPackFile::GetTableSize(&pack[0], BankPackFile::HeaderSize - 1, tableSize) == BankParseTruncated);
+
+	// Only the header is needed, the table itself is checked by Parse
+	BankPackFile file;
+	CHECK(file.Parse(&pack[0], tableSize - 1, pack.size()) == BankParseTruncated);
+	CHECK(file.Parse(&pack[0], tableSize, tableSize - 1) == BankParseTruncated);
+	CHECK(file.Parse(&pack[0], tableSize, pack.size()) == BankParseOk);
+	CHECK(file.GetEntryCount() == 5);
+
+	std::vector<uint8> other(pack);
+	memcpy(&other[0], "XWBK", 4);
+	CHECK(BankPackFile::GetTableSize(&other[0], other.size(), tableSize) == BankParseInvalidSignature);
+	other = pack;
+	WriteUInt32(other, 4, BankPackFile::Version + 1);
+	CHECK(Parse(file, other) == BankParseUnsupportedVersion);
+	other = pack;
+	WriteUInt32(other, 12, 0xFFFFFFFF);
+	CHECK(BankPackFile::GetTableSize(&other[0], other.size(), tableSize) == BankParseInvalidData);
+}
+
+TEST(BankPackFile, RejectsUnalignedEntries)
+{
+	std::vector<uint8> pack = WritePack(GetScene(), BankPackFile::DefaultAlignment, 16);
+	BankPackFile file;
+
+	// Not a power of two multiple of the sector size
+	const uint32 alignments[] = { 0, 512, BankPackFile::SectorSize / 2, 3 * BankPackFile::SectorSize };
+	for (int i = 0; i < 4; i++)
+	{
+		std::vector<uint8> other(pack);
+		WriteUInt32(other, 8, alignments[i]);
+		CHECK(Parse(file, other) == BankParseInvalidData);
+		CHECK(file.GetEntryCount() == 0);
+	}
+
+	std::vector<uint8> other(pack);
+	WriteUInt64(other, GetEntryOffset(1) + 72, BankPackFile::SectorSize * 2 + 512);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+
+	// Inside the table
+	other = pack;
+	WriteUInt64(other, GetEntryOffset(0) + 72, 0);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	CHECK(file.GetEntryCount() == 0);
+}
+
+TEST(BankPackFile, RejectsEntriesPastEnd)
+{
+	std::vector<uint8> pack = WritePack(GetScene(), BankPackFile::DefaultAlignment, 16);
+	BankPackFile file;
+	REQUIRE(Parse(file, pack) == BankParseOk);
+	uint64 lastEnd = file.GetEntry(4).offset + file.GetEntry(4).size;
+	REQUIRE(lastEnd == pack.size());
+
+	// The last entry cut short
+	CHECK(file.Parse(&pack[0], pack.size(), pack.size() - 1) == BankParseTruncated);
+	CHECK(file.GetEntryCount() == 0);
+
+	// Starting past the end, aligned
+	std::vector<uint8> other(pack);
+	WriteUInt64(other, GetEntryOffset(3) + 72, (pack.size() / BankPackFile::SectorSize + 1) * BankPackFile::SectorSize);
+	CHECK(Parse(file, other) == BankParseTruncated);
+
+	// A size that wraps around when added to the offset
+	other = pack;
+	WriteUInt64(other, GetEntryOffset(1) + 80, 0xFFFFFFFFFFFFF000ULL);
+	CHECK(Parse(file, other) == BankParseTruncated);
+	CHECK(file.GetEntryCount() == 0);
+}
+
+TEST(BankPackFile, RejectsOverlappingEntries)
+{
+	std::vector<uint8> pack = WritePack(GetScene(), BankPackFile::DefaultAlignment, 16);
+	BankPackFile file;
+	REQUIRE(Parse(file, pack) == BankParseOk);
+	uint64 waveBankOffset = file.GetEntry(1).offset;
+	uint64 soundBankOffset = file.GetEntry(3).offset;
+
+	// The sound bank at the start of the wave bank before it
+	std::vector<uint8> other(pack);
+	WriteUInt64(other, GetEntryOffset(3) + 72, waveBankOffset);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	CHECK(file.GetEntryCount() == 0);
+
+	// The wave bank reaching into the sound bank after it
+	other = pack;
+	WriteUInt64(other, GetEntryOffset(1) + 80, soundBankOffset - waveBankOffset + 1);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+
+	// Ending right where the next one starts is fine, and an empty entry
+	// overlaps nothing
+	other = pack;
+	WriteUInt64(other, GetEntryOffset(1) + 80, soundBankOffset - waveBankOffset);
+	WriteUInt64(other, GetEntryOffset(2) + 72, soundBankOffset);
+	CHECK(Parse(file, other) == BankParseOk);
+}
+
+TEST(BankPackFile, RejectsInvalidEntries)
+{
+	std::vector<uint8> pack = WritePack(GetScene(), BankPackFile::DefaultAlignment, 16);
+	BankPackFile file;
+
+	// An empty name and one without its terminating zero
+	std::vector<uint8> other(pack);
+	other[GetEntryOffset(2)] = 0;
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	other = pack;
+	memset(&other[GetEntryOffset(2)], 'a', BankPackFile::MaxNameLength + 1);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+
+	other = pack;
+	WriteUInt32(other, GetEntryOffset(0) + 64, BankPackEntryTypeCount);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+
+	// Packet sizes belong to streaming wave banks, and fit a short
+	other = pack;
+	WriteUInt32(other, GetEntryOffset(1) + 68, 16);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	other = pack;
+	WriteUInt32(other, GetEntryOffset(4) + 68, 0);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	other = pack;
+	WriteUInt32(other, GetEntryOffset(4) + 68, 0x8000);
+	CHECK(Parse(file, other) == BankParseInvalidData);
+	CHECK(file.GetEntryCount() == 0);
+}
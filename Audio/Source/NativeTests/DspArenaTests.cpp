@@ -0,0 +1,124 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// DspArena hands out X3DAUDIO_DSP_SETTINGS, so it builds with the DirectX
+// SDK only
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <xact3.h>
+#include <xact3d3.h>
+
+#include <vector>
+
+#include "NativeTests.h"
+#include "NativeDspArena.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	// 5.1, as the final mix of most engines
+	const UINT DestinationChannelCount = 6;
+
+	// Fills the buffers of the settings with values telling which
+	// settings they belong to
+	void Fill(X3DAUDIO_DSP_SETTINGS* pSettings, float tag)
+	{
+		for (UINT i = 0; i < pSettings->SrcChannelCount * pSettings->DstChannelCount; i++)
+		{
+			pSettings->pMatrixCoefficients[i] = tag;
+		}
+		for (UINT i = 0; i < pSettings->SrcChannelCount; i++)
+		{
+			pSettings->pDelayTimes[i] = -tag;
+		}
+	}
+
+	bool IsFilled(const X3DAUDIO_DSP_SETTINGS* pSettings, float tag)
+	{
+		for (UINT i = 0; i < pSettings->SrcChannelCount * pSettings->DstChannelCount; i++)
+		{
+			if (pSettings->pMatrixCoefficients[i] != tag)
+			{
+				return false;
+			}
+		}
+		for (UINT i = 0; i < pSettings->SrcChannelCount; i++)
+		{
+			if (pSettings->pDelayTimes[i] != -tag)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(DspArena, SizesSettingsPerChannelCount)
+{
+	DspArena arena(DestinationChannelCount);
+	CHECK(arena.GetDestinationChannelCount() == DestinationChannelCount);
+	CHECK(arena.Allocate(0) == NULL);
+	CHECK(arena.Allocate(DspArena::MaxChannelCount + 1) == NULL);
+
+	// More than a slab of each count, every one with buffers of its own
+	std::vector<X3DAUDIO_DSP_SETTINGS*> settings;
+	for (UINT round = 0; round < 20; round++)
+	{
+		for (UINT channelCount = 1; channelCount <= DspArena::MaxChannelCount; channelCount++)
+		{
+			X3DAUDIO_DSP_SETTINGS* pSettings = arena.Allocate(channelCount);
+			REQUIRE(pSettings != NULL);
+			CHECK(pSettings->SrcChannelCount == channelCount);
+			CHECK(pSettings->DstChannelCount == DestinationChannelCount);
+			REQUIRE(pSettings->pMatrixCoefficients != NULL && pSettings->pDelayTimes != NULL);
+
+			// Zeroed for XACT3DCalculate, which leaves the delay times alone
+			CHECK(IsFilled(pSettings, 0.0f) == true);
+			Fill(pSettings, static_cast<float>(settings.size() + 1));
+			settings.push_back(pSettings);
+		}
+	}
+
+	// No two settings share a buffer
+	for (size_t i = 0; i < settings.size(); i++)
+	{
+		CHECK(IsFilled(settings[i], static_cast<float>(i + 1)) == true);
+		arena.Free(settings[i]);
+	}
+	arena.Free(NULL);
+}
+
+TEST(DspArena, ReusesFreedSettings)
+{
+	DspArena arena(DestinationChannelCount);
+
+	X3DAUDIO_DSP_SETTINGS* pMono = arena.Allocate(1);
+	X3DAUDIO_DSP_SETTINGS* pStereo = arena.Allocate(2);
+	REQUIRE(pMono != NULL && pStereo != NULL);
+	Fill(pStereo, 5.0f);
+
+	// Freed settings go back to the list of their channel count and are
+	// the next ones handed out for it, with their buffers as they were
+	arena.Free(pStereo);
+	X3DAUDIO_DSP_SETTINGS* pOther = arena.Allocate(1);
+	CHECK(pOther != pStereo);
+	CHECK(pOther->SrcChannelCount == 1);
+	X3DAUDIO_DSP_SETTINGS* pAgain = arena.Allocate(2);
+	CHECK(pAgain == pStereo);
+	CHECK(pAgain->SrcChannelCount == 2);
+	CHECK(IsFilled(pAgain, 5.0f) == true);
+
+	arena.Free(pMono);
+	arena.Free(pOther);
+	arena.Free(pAgain);
+}
+
+#endif
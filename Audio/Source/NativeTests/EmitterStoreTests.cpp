@@ -0,0 +1,135 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// EmitterStore keeps X3DAUDIO_EMITTER fields, so it builds with the
+// DirectX SDK only
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <xact3.h>
+#include <xact3d3.h>
+
+#include "NativeTests.h"
+#include "NativeEmitterStore.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	void SetVector(EmitterStore& store, LONG slot, EmitterStore::Field first, float x, float y, float z)
+	{
+		float xyz[3] = { x, y, z };
+		store.SetVector(slot, first, xyz);
+	}
+}
+
+TEST(EmitterStore, GenerationsFollowChanges)
+{
+	EmitterStore store;
+	LONG slot = store.Add();
+	LONG other = store.Add();
+	LONGLONG generation = store.GetGeneration(slot);
+	LONGLONG otherGeneration = store.GetGeneration(other);
+
+	// Setting what is there already is no change
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0, 0, 0);
+	SetVector(store, slot, EmitterStore::FieldFrontX, 0, 0, -1);
+	SetVector(store, slot, EmitterStore::FieldVelocityX, 0, 0, 0);
+	store.Set(EmitterStore::FieldDopplerScaler, slot, 1);
+	store.SetChannelCount(slot, 1);
+	CHECK(store.GetGeneration(slot) == generation);
+
+	SetVector(store, slot, EmitterStore::FieldPositionX, 1, 2, 3);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	float xyz[3];
+	store.GetVector(slot, EmitterStore::FieldPositionX, xyz);
+	CHECK(xyz[0] == 1 && xyz[1] == 2 && xyz[2] == 3);
+	CHECK(store.Get(EmitterStore::FieldPositionZ, slot) == -3);
+
+	// Any change of the velocity, doppler scaler, channel radius, channel
+	// count or azimuths
+	SetVector(store, slot, EmitterStore::FieldVelocityX, 0, 0, 0.001f);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	store.Set(EmitterStore::FieldDopplerScaler, slot, 2);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	store.Set(EmitterStore::FieldChannelRadius, slot, 2);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	store.SetChannelCount(slot, 2);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	FLOAT32 azimuths[2] = { 0, 3.14159265f };
+	CHECK(store.SetChannelAzimuths(slot, azimuths, 2) == true);
+	CHECK(store.GetGeneration(slot) == ++generation);
+
+	// Other slots keep theirs
+	CHECK(store.GetGeneration(other) == otherGeneration);
+}
+
+TEST(EmitterStore, MovesWithinEpsilonKeepGeneration)
+{
+	EmitterStore store;
+	LONG slot = store.Add();
+	store.Set(EmitterStore::FieldPositionEpsilon, slot, 0.5f);
+	store.Set(EmitterStore::FieldOrientationEpsilon, slot, 0.1f);
+	LONGLONG generation = store.GetGeneration(slot);
+
+	// Distances count from where the last generation was taken, so small
+	// steps add up
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.3f, 0, 0);
+	CHECK(store.GetGeneration(slot) == generation);
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.3f, 0.3f, 0);
+	CHECK(store.GetGeneration(slot) == generation);
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.4f, 0.4f, 0);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.4f, 0.4f, 0.45f);
+	CHECK(store.GetGeneration(slot) == generation);
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.4f, 0.4f, -0.6f);
+	CHECK(store.GetGeneration(slot) == ++generation);
+
+	// The position is stored either way, only the generation waits
+	float xyz[3];
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.5f, 0.4f, -0.6f);
+	store.GetVector(slot, EmitterStore::FieldPositionX, xyz);
+	CHECK(xyz[0] == 0.5f && xyz[1] == 0.4f && xyz[2] == -0.6f);
+	CHECK(store.GetGeneration(slot) == generation);
+
+	// Front and top with the orientation epsilon
+	SetVector(store, slot, EmitterStore::FieldFrontX, 0.05f, 0, -1);
+	CHECK(store.GetGeneration(slot) == generation);
+	SetVector(store, slot, EmitterStore::FieldFrontX, 0.15f, 0, -1);
+	CHECK(store.GetGeneration(slot) == ++generation);
+	SetVector(store, slot, EmitterStore::FieldTopX, 0, 1, 0.2f);
+	CHECK(store.GetGeneration(slot) == ++generation);
+
+	// Epsilons are not part of the 3D settings
+	store.Set(EmitterStore::FieldPositionEpsilon, slot, 0);
+	CHECK(store.GetGeneration(slot) == generation);
+	SetVector(store, slot, EmitterStore::FieldPositionX, 0.5f, 0.4f, -0.61f);
+	CHECK(store.GetGeneration(slot) == ++generation);
+}
+
+TEST(EmitterStore, SetVectorsBumpsMovedSlots)
+{
+	EmitterStore store;
+	LONG slots[3];
+	LONGLONG generations[3];
+	for (int i = 0; i < 3; i++)
+	{
+		slots[i] = store.Add();
+		generations[i] = store.GetGeneration(slots[i]);
+	}
+
+	// The middle one stays where it is
+	float positions[9] = { 1, 0, 0, 0, 0, 0, 0, 0, 5 };
+	store.SetVectors(EmitterStore::FieldPositionX, slots, positions, 3);
+	CHECK(store.GetGeneration(slots[0]) == generations[0] + 1);
+	CHECK(store.GetGeneration(slots[1]) == generations[1]);
+	CHECK(store.GetGeneration(slots[2]) == generations[2] + 1);
+}
+
+#endif
@@ -0,0 +1,310 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include "NativeTests.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	// Larger than a page and the allocation granularity, so regions start
+	// inside views
+	const size_t FileSize = 3 * 65536 + 123;
+
+	void FillPattern(std::vector<unsigned char>& data, unsigned char seed)
+	{
+		data.resize(FileSize);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			data[i] = static_cast<unsigned char>(i * 31 + seed + (i >> 8));
+		}
+	}
+
+	// Overwrites one byte in place, as a tool rebuilding a bank of the
+	// same size might, and sets the write time back to what it was
+	bool PatchFile(const TempFile& file, size_t offset, unsigned char value)
+	{
+#if defined(_WIN32)
+		FILETIME writeTime;
+		HANDLE hFile = ::CreateFileA(file.GetPath().c_str(), GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+			FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+		if (hFile == INVALID_HANDLE_VALUE || ::GetFileTime(hFile, NULL, NULL, &writeTime) == FALSE)
+		{
+			::CloseHandle(hFile);
+			return false;
+		}
+#else
+		struct stat status;
+		if (::stat(file.GetPath().c_str(), &status) == -1)
+		{
+			return false;
+		}
+#endif
+
+		FILE* pFile = fopen(file.GetPath().c_str(), "r+b");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+		bool succeeded = fseek(pFile, static_cast<long>(offset), SEEK_SET) == 0 && fputc(value, pFile) == value;
+		succeeded = fclose(pFile) == 0 && succeeded;
+
+#if defined(_WIN32)
+		succeeded = ::SetFileTime(hFile, NULL, NULL, &writeTime) != FALSE && succeeded;
+		::CloseHandle(hFile);
+#else
+		struct timespec times[2] = { status.st_atim, status.st_mtim };
+		succeeded = ::utimensat(AT_FDCWD, file.GetPath().c_str(), times, 0) == 0 && succeeded;
+#endif
+		return succeeded;
+	}
+}
+
+TEST(FileMapping, OpenMapsWholeFile)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 1);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	FileMapping mapping;
+	REQUIRE(mapping.Open(file.GetNativePath(), FileMapping::AccessReadOnly) == 0);
+	CHECK(mapping.IsOpen() == true);
+	REQUIRE(mapping.GetSize() == data.size());
+	CHECK(memcmp(mapping.GetData(), &data[0], data.size()) == 0);
+
+	mapping.Close();
+	CHECK(mapping.IsOpen() == false);
+	CHECK(mapping.GetData() == NULL);
+	CHECK(mapping.GetSize() == 0);
+}
+
+TEST(FileMapping, EmptyFileMapsToNullView)
+{
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(NULL, 0) == true);
+
+	FileMapping mapping;
+	CHECK(mapping.Open(file.GetNativePath(), FileMapping::AccessReadOnly) == 0);
+	CHECK(mapping.GetData() == NULL);
+	CHECK(mapping.GetSize() == 0);
+}
+
+TEST(FileMapping, MissingFileFails)
+{
+	TempFile file("FileMapping.missing.tmp");
+
+	FileMapping mapping;
+	CHECK(mapping.Open(file.GetNativePath(), FileMapping::AccessReadOnly) != 0);
+	CHECK(mapping.IsOpen() == false);
+
+	MappableFile mappable;
+	CHECK(mappable.Open(file.GetNativePath()) != 0);
+	CHECK(mappable.IsOpen() == false);
+}
+
+TEST(FileMapping, CopyOnWriteLeavesFileUnchanged)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 2);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	FileMapping writable;
+	REQUIRE(writable.Open(file.GetNativePath(), FileMapping::AccessCopyOnWrite) == 0);
+	unsigned char* pBytes = static_cast<unsigned char*>(writable.GetData());
+	pBytes[0] ^= 0xFF;
+	pBytes[FileSize - 1] ^= 0xFF;
+
+	std::vector<unsigned char> contents;
+	REQUIRE(ReadFile(file.GetPath(), contents) == true);
+	CHECK(contents == data);
+
+	FileMapping readOnly;
+	REQUIRE(readOnly.Open(file.GetNativePath(), FileMapping::AccessReadOnly) == 0);
+	CHECK(memcmp(readOnly.GetData(), &data[0], data.size()) == 0);
+	CHECK(pBytes[0] != data[0]);
+}
+
+TEST(FileMapping, MapsRegionsAtAnyOffset)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 3);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappableFile mappable;
+	REQUIRE(mappable.Open(file.GetNativePath()) == 0);
+	CHECK(mappable.GetSize() == data.size());
+
+	const size_t offsets[] = { 0, 1, 4095, 4096, 65536 + 7, FileSize - 10 };
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+	{
+		FileMapping mapping;
+		size_t size = FileSize - offsets[i] < 5000 ? FileSize - offsets[i] : 5000;
+		REQUIRE(mappable.Map(offsets[i], size, FileMapping::AccessReadOnly, mapping) == 0);
+		REQUIRE(mapping.GetSize() == size);
+		CHECK(memcmp(mapping.GetData(), &data[offsets[i]], size) == 0);
+	}
+
+	// Mappings stay valid once the file is closed
+	FileMapping mapping;
+	REQUIRE(mappable.Map(100, 200, FileMapping::AccessReadOnly, mapping) == 0);
+	mappable.Close();
+	CHECK(memcmp(mapping.GetData(), &data[100], 200) == 0);
+}
+
+TEST(FileMapping, MapOutsideFileFails)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 4);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappableFile mappable;
+	REQUIRE(mappable.Open(file.GetNativePath()) == 0);
+
+	FileMapping mapping;
+	CHECK(mappable.Map(FileSize + 1, 0, FileMapping::AccessReadOnly, mapping) != 0);
+	CHECK(mappable.Map(FileSize - 10, 11, FileMapping::AccessReadOnly, mapping) != 0);
+	CHECK(mappable.Map(1, static_cast<size_t>(-1), FileMapping::AccessReadOnly, mapping) != 0);
+	CHECK(mapping.IsOpen() == false);
+
+	// An empty region at the end is fine, and maps to nothing
+	CHECK(mappable.Map(FileSize, 0, FileMapping::AccessReadOnly, mapping) == 0);
+	CHECK(mapping.GetData() == NULL);
+}
+
+TEST(FileMapping, CacheSharesViewsOfOneFile)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 5);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappingCacheStatistics before;
+	MappingCache::GetStatistics(before);
+
+	FileMapping first;
+	FileMapping second;
+	REQUIRE(MappingCache::Open(file.GetNativePath(), first) == 0);
+	REQUIRE(MappingCache::Open(file.GetNativePath(), second) == 0);
+	CHECK(first.GetData() == second.GetData());
+	CHECK(first.GetSize() == data.size());
+	CHECK(memcmp(second.GetData(), &data[0], data.size()) == 0);
+
+	MappingCacheStatistics statistics;
+	MappingCache::GetStatistics(statistics);
+	CHECK(statistics.misses == before.misses + 1);
+	CHECK(statistics.hits == before.hits + 1);
+	CHECK(statistics.viewCount == before.viewCount + 1);
+	CHECK(statistics.viewBytes == before.viewBytes + data.size());
+
+	// The view goes with the last mapping of it
+	first.Close();
+	CHECK(memcmp(second.GetData(), &data[0], data.size()) == 0);
+	second.Close();
+	MappingCache::GetStatistics(statistics);
+	CHECK(statistics.viewCount == before.viewCount);
+	CHECK(statistics.viewBytes == before.viewBytes);
+}
+
+TEST(FileMapping, CacheKeepsChangedFilesApart)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 7);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappingCacheStatistics before;
+	MappingCache::GetStatistics(before);
+
+	FileMapping first;
+	REQUIRE(MappingCache::Open(file.GetNativePath(), first) == 0);
+
+	// Same size, same write time and the same first pages
+	data[FileSize - 1] ^= 0xFF;
+	REQUIRE(PatchFile(file, FileSize - 1, data[FileSize - 1]) == true);
+
+	FileMapping second;
+	REQUIRE(MappingCache::Open(file.GetNativePath(), second) == 0);
+	CHECK(memcmp(second.GetData(), &data[0], data.size()) == 0);
+
+	MappingCacheStatistics statistics;
+	MappingCache::GetStatistics(statistics);
+#if defined(_WIN32)
+	// The identity has no change time here and is unchanged, the view of
+	// the file shows the patched byte
+	CHECK(first.GetData() == second.GetData());
+	CHECK(statistics.hits == before.hits + 1);
+#else
+	// The change time moved
+	CHECK(first.GetData() != second.GetData());
+	CHECK(statistics.misses == before.misses + 2);
+	CHECK(statistics.hits == before.hits);
+	CHECK(statistics.viewCount == before.viewCount + 2);
+#endif
+}
+
+TEST(FileMapping, CacheSharesTouchedFiles)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 8);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappingCacheStatistics before;
+	MappingCache::GetStatistics(before);
+
+	FileMapping first;
+	REQUIRE(MappingCache::Open(file.GetNativePath(), first) == 0);
+
+	// Written back unchanged, the region hashes the same
+	REQUIRE(PatchFile(file, FileSize - 1, data[FileSize - 1]) == true);
+
+	FileMapping second;
+	REQUIRE(MappingCache::Open(file.GetNativePath(), second) == 0);
+	CHECK(first.GetData() == second.GetData());
+	CHECK(memcmp(second.GetData(), &data[0], data.size()) == 0);
+
+	MappingCacheStatistics statistics;
+	MappingCache::GetStatistics(statistics);
+	CHECK(statistics.misses == before.misses + 1);
+	CHECK(statistics.hits == before.hits + 1);
+	CHECK(statistics.viewCount == before.viewCount + 1);
+}
+
+TEST(FileMapping, CacheKeepsRegionsApart)
+{
+	std::vector<unsigned char> data;
+	FillPattern(data, 6);
+	TempFile file("FileMapping.tmp");
+	REQUIRE(file.Write(&data[0], data.size()) == true);
+
+	MappableFile mappable;
+	REQUIRE(mappable.Open(file.GetNativePath()) == 0);
+
+	FileMapping first;
+	FileMapping second;
+	REQUIRE(MappingCache::Map(mappable, 0, 1000, first) == 0);
+	REQUIRE(MappingCache::Map(mappable, 1000, 1000, second) == 0);
+	CHECK(first.GetData() != second.GetData());
+	CHECK(memcmp(first.GetData(), &data[0], 1000) == 0);
+	CHECK(memcmp(second.GetData(), &data[1000], 1000) == 0);
+}
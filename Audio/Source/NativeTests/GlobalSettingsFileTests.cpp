@@ -0,0 +1,464 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <objbase.h>
+#include <xact3.h>
+#endif
+
+#include "NativeTests.h"
+#include "NativeGlobalSettingsFile.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	// Writes global settings in the layout GlobalSettingsFile reads: the
+	// header, the categories, the variables, the RPC curves, the category
+	// names and the variable names, in that order
+	class GlobalSettingsBuilder
+	{
+		std::vector<uint8> data;
+
+		void Put8(size_t offset, uint32 value)
+		{
+			data[offset] = static_cast<uint8>(value);
+		}
+
+		void Put16(size_t offset, uint32 value)
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				int shift = bigEndian == true ? (1 - i) * 8 : i * 8;
+				data[offset + i] = static_cast<uint8>(value >> shift);
+			}
+		}
+
+		void Put32(size_t offset, uint32 value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int shift = bigEndian == true ? (3 - i) * 8 : i * 8;
+				data[offset + i] = static_cast<uint8>(value >> shift);
+			}
+		}
+
+		void PutFloat(size_t offset, float value)
+		{
+			uint32 bits;
+			memcpy(&bits, &value, sizeof(bits));
+			Put32(offset, bits);
+		}
+
+		// Appends size zero bytes, returns their offset
+		size_t Append(size_t size)
+		{
+			size_t offset = data.size();
+			data.resize(offset + size, 0);
+			return offset;
+		}
+
+		void AppendName(const char* name)
+		{
+			size_t offset = Append(strlen(name) + 1);
+			memcpy(&data[offset], name, strlen(name));
+		}
+
+	public:
+		struct Category
+		{
+			const char* name;
+			uint8 instanceLimit;
+			uint8 maxInstanceBehavior;
+			uint16 fadeIn;
+			uint16 fadeOut;
+			// 0xFFFF for the root, as in the file
+			uint16 parent;
+			uint8 volume;
+		};
+
+		struct Variable
+		{
+			const char* name;
+			uint8 flags;
+			float initialValue;
+			float minValue;
+			float maxValue;
+		};
+
+		struct Rpc
+		{
+			uint16 variable;
+			uint16 parameter;
+			std::vector<SettingsRpcPoint> points;
+		};
+
+		bool bigEndian;
+		std::vector<Category> categories;
+		std::vector<Variable> variables;
+		std::vector<Rpc> rpcs;
+
+		GlobalSettingsBuilder()
+			: bigEndian(false)
+		{}
+
+		void AddCategory(const char* name, uint16 parent, uint8 instanceLimit, uint8 volume)
+		{
+			Category category = { name, instanceLimit, 0, 0, 0, parent, volume };
+			categories.push_back(category);
+		}
+
+		void AddVariable(const char* name, uint8 flags, float initialValue, float minValue, float maxValue)
+		{
+			Variable variable = { name, flags, initialValue, minValue, maxValue };
+			variables.push_back(variable);
+		}
+
+		Rpc& AddRpc(uint16 variable, uint16 parameter)
+		{
+			Rpc rpc;
+			rpc.variable = variable;
+			rpc.parameter = parameter;
+			rpcs.push_back(rpc);
+			return rpcs.back();
+		}
+
+		static void AddPoint(Rpc& rpc, float x, float y, uint8 type)
+		{
+			SettingsRpcPoint point = { x, y, type };
+			rpc.points.push_back(point);
+		}
+
+		std::vector<uint8> Build()
+		{
+			data.clear();
+			Append(77);
+			memcpy(&data[0], bigEndian == true ? "FSGX" : "XGSF", 4);
+			Put16(4, 46);
+			Put16(6, GlobalSettingsFile::FormatVersion);
+			Put16(19, static_cast<uint32>(categories.size()));
+			Put16(21, static_cast<uint32>(variables.size()));
+			Put16(27, static_cast<uint32>(rpcs.size()));
+
+			Put32(33, static_cast<uint32>(data.size()));
+			for (size_t i = 0; i < categories.size(); i++)
+			{
+				const Category& category = categories[i];
+				size_t offset = Append(10);
+				Put8(offset, category.instanceLimit);
+				Put16(offset + 1, category.fadeIn);
+				Put16(offset + 3, category.fadeOut);
+				Put8(offset + 5, category.maxInstanceBehavior << 3);
+				Put16(offset + 6, category.parent);
+				Put8(offset + 8, category.volume);
+				Put8(offset + 9, 1);
+			}
+
+			Put32(37, static_cast<uint32>(data.size()));
+			for (size_t i = 0; i < variables.size(); i++)
+			{
+				const Variable& variable = variables[i];
+				size_t offset = Append(13);
+				Put8(offset, variable.flags);
+				PutFloat(offset + 1, variable.initialValue);
+				PutFloat(offset + 5, variable.minValue);
+				PutFloat(offset + 9, variable.maxValue);
+			}
+
+			Put32(65, static_cast<uint32>(data.size()));
+			for (size_t i = 0; i < rpcs.size(); i++)
+			{
+				const Rpc& rpc = rpcs[i];
+				size_t offset = Append(5);
+				Put16(offset, rpc.variable);
+				Put8(offset + 2, static_cast<uint32>(rpc.points.size()));
+				Put16(offset + 3, rpc.parameter);
+				for (size_t j = 0; j < rpc.points.size(); j++)
+				{
+					size_t point = Append(9);
+					PutFloat(point, rpc.points[j].x);
+					PutFloat(point + 4, rpc.points[j].y);
+					Put8(point + 8, rpc.points[j].type);
+				}
+			}
+
+			Put32(57, static_cast<uint32>(data.size()));
+			for (size_t i = 0; i < categories.size(); i++)
+			{
+				AppendName(categories[i].name);
+			}
+			Put32(61, static_cast<uint32>(data.size()));
+			for (size_t i = 0; i < variables.size(); i++)
+			{
+				AppendName(variables[i].name);
+			}
+			return data;
+		}
+	};
+
+	// A category tree of three, global and per-cue variables, and two
+	// curves
+	void AddStandardSettings(GlobalSettingsBuilder& builder)
+	{
+		builder.AddCategory("Global", 0xFFFF, 0xFF, 180);
+		builder.AddCategory("Default", 0, 0xFF, 180);
+		builder.AddCategory("Music", 0, 2, 90);
+		GlobalSettingsBuilder::Category& music = builder.categories.back();
+		music.maxInstanceBehavior = 3;
+		music.fadeIn = 100;
+		music.fadeOut = 300;
+
+		builder.AddVariable("SpeedOfSound", GlobalSettingsFile::VariableFlagPublic | GlobalSettingsFile::VariableFlagReserved,
+			343.5f, 0, 1000000);
+		builder.AddVariable("Distance", GlobalSettingsFile::VariableFlagPublic | GlobalSettingsFile::VariableFlagCue,
+			0, 0, 1000000);
+		builder.AddVariable("Intensity", GlobalSettingsFile::VariableFlagPublic, 0.25f, -1, 1);
+
+		GlobalSettingsBuilder::Rpc& volume = builder.AddRpc(2, 0);
+		GlobalSettingsBuilder::AddPoint(volume, 0, -9600, 0);
+		GlobalSettingsBuilder::AddPoint(volume, 0.5f, -600, 1);
+		GlobalSettingsBuilder::AddPoint(volume, 1, 0, 3);
+
+		GlobalSettingsBuilder::Rpc& pitch = builder.AddRpc(1, 1);
+		GlobalSettingsBuilder::AddPoint(pitch, 0, 1200, 0);
+		GlobalSettingsBuilder::AddPoint(pitch, 1000, -1200, 0);
+	}
+
+	void CheckStandardSettings(const GlobalSettingsFile& file)
+	{
+		CHECK(file.GetContentVersion() == 46);
+		CHECK(file.GetFormatVersion() == GlobalSettingsFile::FormatVersion);
+
+		REQUIRE(file.GetCategoryCount() == 3);
+		const char* categoryNames[] = { "Global", "Default", "Music" };
+		for (uint32 i = 0; i < 3; i++)
+		{
+			CHECK(strcmp(file.GetCategoryName(i), categoryNames[i]) == 0);
+			CHECK(file.FindCategory(categoryNames[i]) == i);
+		}
+		CHECK(file.FindCategory("Missing") == GlobalSettingsFile::InvalidIndex);
+		CHECK(file.GetCategory(0).parentCategory == GlobalSettingsFile::InvalidIndex);
+		CHECK(file.GetCategory(1).parentCategory == 0);
+
+		const SettingsCategory& music = file.GetCategory(2);
+		CHECK(music.parentCategory == 0);
+		CHECK(music.instanceLimit == 2);
+		CHECK(music.maxInstanceBehavior == 3);
+		CHECK(music.fadeInMilliseconds == 100);
+		CHECK(music.fadeOutMilliseconds == 300);
+		CHECK(music.volume == 90);
+
+		REQUIRE(file.GetVariableCount() == 3);
+		CHECK(file.FindVariable("SpeedOfSound") == 0);
+		CHECK(file.FindVariable("Distance") == 1);
+		CHECK(file.FindVariable("Intensity") == 2);
+		CHECK(file.FindVariable("Missing") == GlobalSettingsFile::InvalidIndex);
+		CHECK(file.IsGlobalVariable(0) == true);
+		CHECK(file.IsGlobalVariable(1) == false);
+		CHECK(file.IsGlobalVariable(2) == true);
+		CHECK(file.GetVariable(0).initialValue == 343.5f);
+		CHECK(file.GetVariable(0).maxValue == 1000000);
+		CHECK(file.GetVariable(2).initialValue == 0.25f);
+		CHECK(file.GetVariable(2).minValue == -1);
+
+		REQUIRE(file.GetRpcCount() == 2);
+		const SettingsRpc& volume = file.GetRpc(0);
+		CHECK(volume.variable == 2);
+		CHECK(volume.parameter == 0);
+		REQUIRE(volume.pointCount == 3);
+		const SettingsRpcPoint* pPoints = file.GetRpcPoints() + volume.firstPoint;
+		CHECK(pPoints[1].x == 0.5f && pPoints[1].y == -600 && pPoints[1].type == 1);
+		CHECK(pPoints[2].x == 1 && pPoints[2].y == 0 && pPoints[2].type == 3);
+
+		// Sound banks refer to the curves by offset
+		const SettingsRpc& pitch = file.GetRpc(1);
+		CHECK(pitch.variable == 1);
+		CHECK(pitch.pointCount == 2);
+		CHECK(pitch.offset == volume.offset + 5 + 3 * 9);
+		CHECK(file.FindRpc(volume.offset) == 0);
+		CHECK(file.FindRpc(pitch.offset) == 1);
+		CHECK(file.FindRpc(pitch.offset + 1) == GlobalSettingsFile::InvalidIndex);
+	}
+}
+
+TEST(GlobalSettingsFile, ParsesStandardSettings)
+{
+	GlobalSettingsBuilder builder;
+	AddStandardSettings(builder);
+	std::vector<uint8> data = builder.Build();
+
+	GlobalSettingsFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CheckStandardSettings(file);
+}
+
+TEST(GlobalSettingsFile, ParsesByteSwappedSettings)
+{
+	GlobalSettingsBuilder builder;
+	builder.bigEndian = true;
+	AddStandardSettings(builder);
+	std::vector<uint8> data = builder.Build();
+
+	GlobalSettingsFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CheckStandardSettings(file);
+}
+
+TEST(GlobalSettingsFile, RejectsOtherFiles)
+{
+	GlobalSettingsBuilder builder;
+	AddStandardSettings(builder);
+	std::vector<uint8> data = builder.Build();
+	GlobalSettingsFile file;
+
+	std::vector<uint8> wrongSignature = data;
+	memcpy(&wrongSignature[0], "SDBK", 4);
+	CHECK(file.Parse(&wrongSignature[0], wrongSignature.size()) == BankParseInvalidSignature);
+
+	std::vector<uint8> wrongVersion = data;
+	wrongVersion[6] = 43;
+	CHECK(file.Parse(&wrongVersion[0], wrongVersion.size()) == BankParseUnsupportedVersion);
+
+	CHECK(file.Parse(&data[0], 3) == BankParseInvalidSignature);
+	CHECK(file.GetCategoryCount() == 0);
+}
+
+TEST(GlobalSettingsFile, RejectsBrokenSettings)
+{
+	GlobalSettingsBuilder builder;
+	AddStandardSettings(builder);
+	std::vector<uint8> data = builder.Build();
+
+	// The names come last and end with their terminator, every byte counts
+	for (size_t size = 4; size < data.size(); size++)
+	{
+		std::vector<uint8> truncated(data.begin(), data.begin() + size);
+		GlobalSettingsFile file;
+		CHECK(file.Parse(&truncated[0], truncated.size()) == BankParseTruncated);
+	}
+
+	GlobalSettingsBuilder wrongParent;
+	AddStandardSettings(wrongParent);
+	wrongParent.categories[1].parent = 3;
+	data = wrongParent.Build();
+	GlobalSettingsFile file;
+	CHECK(file.Parse(&data[0], data.size()) == BankParseInvalidData);
+
+	GlobalSettingsBuilder wrongVariable;
+	AddStandardSettings(wrongVariable);
+	wrongVariable.rpcs[1].variable = 3;
+	data = wrongVariable.Build();
+	CHECK(file.Parse(&data[0], data.size()) == BankParseInvalidData);
+}
+
+namespace
+{
+	// The variables of Sample.xap, and whether they are global
+	struct SampleVariable
+	{
+		const char* name;
+		bool isGlobal;
+		bool isReadOnly;
+		float initialValue;
+		float maxValue;
+	};
+
+	const SampleVariable SampleVariables[] =
+	{
+		{ "OrientationAngle", false, false, 0, 180 },
+		{ "DopplerPitchScalar", false, false, 1, 4 },
+		{ "SpeedOfSound", true, false, 343.5f, 1000000 },
+		{ "ReleaseTime", false, true, 0, 15000 },
+		{ "AttackTime", false, true, 0, 15000 },
+		{ "NumCueInstances", false, true, 0, 1024 },
+		{ "Distance", false, false, 0, 1000000 },
+	};
+
+	const uint32 SampleVariableCount = sizeof(SampleVariables) / sizeof(SampleVariables[0]);
+}
+
+TEST(GlobalSettingsFile, ParsesSampleSettings)
+{
+	if (GetContentDirectory().empty() == true)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> data;
+	REQUIRE(ReadFile(GetContentDirectory() + "/Sample.xgs", data) == true);
+	GlobalSettingsFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+
+	REQUIRE(file.GetCategoryCount() == 3);
+	uint32 global = file.FindCategory("Global");
+	REQUIRE(global != GlobalSettingsFile::InvalidIndex);
+	CHECK(file.GetCategory(global).parentCategory == GlobalSettingsFile::InvalidIndex);
+	const char* children[] = { "Default", "Music" };
+	for (int i = 0; i < 2; i++)
+	{
+		uint32 category = file.FindCategory(children[i]);
+		REQUIRE(category != GlobalSettingsFile::InvalidIndex);
+		CHECK(file.GetCategory(category).parentCategory == global);
+		CHECK(file.GetCategory(category).instanceLimit == 0xFF);
+	}
+
+	REQUIRE(file.GetVariableCount() == SampleVariableCount);
+	for (uint32 i = 0; i < SampleVariableCount; i++)
+	{
+		const SampleVariable& expected = SampleVariables[i];
+		uint32 index = file.FindVariable(expected.name);
+		REQUIRE(index != GlobalSettingsFile::InvalidIndex);
+		const SettingsVariable& variable = file.GetVariable(index);
+		CHECK(file.IsGlobalVariable(index) == expected.isGlobal);
+		CHECK(((variable.flags & GlobalSettingsFile::VariableFlagReadOnly) != 0) == expected.isReadOnly);
+		CHECK(variable.initialValue == expected.initialValue);
+		CHECK(variable.maxValue == expected.maxValue);
+	}
+}
+
+#if defined(_WIN32)
+
+TEST(GlobalSettingsFile, MatchesXactIndices)
+{
+	XactEngine engine;
+	if (engine.pEngine == NULL)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> data;
+	REQUIRE(ReadFile(GetContentDirectory() + "/Sample.xgs", data) == true);
+	GlobalSettingsFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+
+	// What Engine::VerifySettingsTables relies on
+	for (uint32 i = 0; i < file.GetCategoryCount(); i++)
+	{
+		CHECK(engine.pEngine->GetCategory(file.GetCategoryName(i)) == i);
+	}
+	for (uint32 i = 0; i < file.GetVariableCount(); i++)
+	{
+		XACTVARIABLEINDEX index = engine.pEngine->GetGlobalVariableIndex(file.GetVariableName(i));
+		if (file.IsGlobalVariable(i) == false)
+		{
+			CHECK(index == XACTVARIABLEINDEX_INVALID);
+			continue;
+		}
+		CHECK(index == i);
+
+		XACTVARIABLEVALUE value = 0;
+		CHECK(SUCCEEDED(engine.pEngine->GetGlobalVariable(static_cast<XACTVARIABLEINDEX>(i), &value)));
+		CHECK(value == file.GetVariable(i).initialValue);
+	}
+}
+
+#endif
@@ -0,0 +1,264 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Unit tests of the plain C++ parts of Bnoerj.Audio, one file per part.
+// They build and run on any platform, for example with
+//   g++ -O2 -I../Bnoerj.Audio *.cpp ../Bnoerj.Audio/NativeFileMapping.cpp ../Bnoerj.Audio/NativeWaveBankFile.cpp ../Bnoerj.Audio/NativeSoundBankFile.cpp ../Bnoerj.Audio/NativeGlobalSettingsFile.cpp ../Bnoerj.Audio/NativeSpatialKernel.cpp ../Bnoerj.Audio/NativeStreamScheduler.cpp ../Bnoerj.Audio/NativeBankPackFile.cpp ../Bnoerj.Audio/NativeSpatialIndex.cpp -lpthread
+// Tests of built XACT files skip themselves unless /C names a directory
+// with the files Sample.xap builds.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <objbase.h>
+#include <xact3.h>
+#endif
+
+#include "NativeTests.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	struct Test
+	{
+		const char* group;
+		const char* name;
+		NativeTests::TestMethod method;
+	};
+
+	// A function, so registrations of other files find it constructed
+	std::vector<Test>& GetTests()
+	{
+		static std::vector<Test> tests;
+		return tests;
+	}
+
+	std::string contentDirectory;
+	const Test* pRunningTest = NULL;
+	unsigned int failedChecks = 0;
+
+	struct Parameters
+	{
+		bool skipLogo;
+		const char* filter;
+	};
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.filter = NULL;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == false)
+			{
+				fprintf(stderr, "error: unexpected argument %s\n", arg);
+				return false;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (option == 'C' && arg[1] == ':' && arg[2] != '\0')
+			{
+				contentDirectory = arg + 2;
+			}
+			else if (option == 'T' && arg[1] == ':' && arg[2] != '\0')
+			{
+				parameters.filter = arg + 2;
+			}
+			else
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Native Tests\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: NATIVETESTS [options]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /C:<directory>  Directory with the files Sample.xap builds, for the\n");
+		printf("                   tests of built XACT files.\n");
+		printf("   /T:<group>      Only run the tests of the group.\n");
+	}
+}
+
+namespace NativeTests {
+
+	TestRegistration::TestRegistration(const char* group, const char* name, TestMethod method)
+	{
+		Test test = { group, name, method };
+		GetTests().push_back(test);
+	}
+
+	bool Check(bool condition, const char* file, int line, const char* expression)
+	{
+		if (condition == false)
+		{
+			failedChecks++;
+			fprintf(stderr, "%s(%d): %s.%s failed: %s\n", file, line,
+				pRunningTest->group, pRunningTest->name, expression);
+		}
+		return condition;
+	}
+
+	const std::string& GetContentDirectory()
+	{
+		return contentDirectory;
+	}
+
+	bool ReadFile(const std::string& path, std::vector<unsigned char>& data)
+	{
+		data.clear();
+		FILE* pFile = fopen(path.c_str(), "rb");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+
+		unsigned char buffer[65536];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		{
+			data.insert(data.end(), buffer, buffer + read);
+		}
+		bool succeeded = ferror(pFile) == 0;
+		fclose(pFile);
+		return succeeded;
+	}
+
+	TempFile::TempFile(const char* name)
+		: path(name)
+	{
+		// The names are plain ASCII
+		for (size_t i = 0; i <= path.size(); i++)
+		{
+			nativePath.push_back(static_cast<FilePathChar>(path.c_str()[i]));
+		}
+	}
+
+	TempFile::~TempFile()
+	{
+		remove(path.c_str());
+	}
+
+	bool TempFile::Write(const void* pData, size_t size)
+	{
+		FILE* pFile = fopen(path.c_str(), "wb");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+		bool succeeded = size == 0 || fwrite(pData, 1, size, pFile) == size;
+		return fclose(pFile) == 0 && succeeded;
+	}
+
+#if defined(_WIN32)
+	XactEngine::XactEngine()
+		: isComInitialized(false)
+		, pEngine(NULL)
+	{
+		if (contentDirectory.empty() == true ||
+			ReadFile(contentDirectory + "/Sample.xgs", globalSettings) == false)
+		{
+			return;
+		}
+
+		isComInitialized = SUCCEEDED(::CoInitializeEx(NULL, COINIT_MULTITHREADED));
+		if (FAILED(::XACT3CreateEngine(0, &pEngine)))
+		{
+			pEngine = NULL;
+			return;
+		}
+
+		// XACT keeps the settings, which must outlive the engine
+		XACT_RUNTIME_PARAMETERS parameters = { 0 };
+		parameters.lookAheadTime = XACT_ENGINE_LOOKAHEAD_DEFAULT;
+		parameters.pGlobalSettingsBuffer = &globalSettings[0];
+		parameters.globalSettingsBufferSize = static_cast<DWORD>(globalSettings.size());
+		if (FAILED(pEngine->Initialize(&parameters)))
+		{
+			pEngine->Release();
+			pEngine = NULL;
+		}
+	}
+
+	XactEngine::~XactEngine()
+	{
+		if (pEngine != NULL)
+		{
+			pEngine->ShutDown();
+			pEngine->Release();
+		}
+		if (isComInitialized == true)
+		{
+			::CoUninitialize();
+		}
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	unsigned int testCount = 0;
+	unsigned int failedTests = 0;
+	const std::vector<Test>& tests = GetTests();
+	for (size_t i = 0; i < tests.size(); i++)
+	{
+		const Test& test = tests[i];
+		if (parameters.filter != NULL && strcmp(parameters.filter, test.group) != 0)
+		{
+			continue;
+		}
+
+		pRunningTest = &test;
+		unsigned int failedBefore = failedChecks;
+		test.method();
+		testCount++;
+		if (failedChecks != failedBefore)
+		{
+			failedTests++;
+		}
+	}
+	pRunningTest = NULL;
+
+	printf("%u tests, %u failed\n", testCount, failedTests);
+	return failedTests > 0 ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "NativeFileMapping.h"
+
+#if defined(_WIN32)
+struct IXACT3Engine;
+#endif
+
+namespace NativeTests {
+
+	typedef void (*TestMethod)();
+
+	// Adds a test to the ones main runs, see TEST
+	class TestRegistration
+	{
+	public:
+		TestRegistration(const char* group, const char* name, TestMethod method);
+	};
+
+	// Records a failed check of the running test, returns condition
+	bool Check(bool condition, const char* file, int line, const char* expression);
+
+	// Directory given with /C, empty if none. Tests of built XACT files
+	// read them from it, e.g. the Content directory of a Sample build.
+	const std::string& GetContentDirectory();
+
+	// Reads a whole file, false if it cannot be read
+	bool ReadFile(const std::string& path, std::vector<unsigned char>& data);
+
+	// A file in the working directory with the given contents, deleted
+	// again by the destructor
+	class TempFile
+	{
+		std::string path;
+		std::vector<Bnoerj::Audio::Native::FilePathChar> nativePath;
+
+		TempFile(const TempFile&);
+		TempFile& operator=(const TempFile&);
+
+	public:
+		explicit TempFile(const char* name);
+		~TempFile();
+
+		// Replaces the contents, false if the file cannot be written
+		bool Write(const void* pData, size_t size);
+
+		const std::string& GetPath() const { return path; }
+		const Bnoerj::Audio::Native::FilePathChar* GetNativePath() const { return &nativePath[0]; }
+	};
+
+#if defined(_WIN32)
+	// An XACT engine initialized with the Sample.xgs of the /C directory.
+	// pEngine is null without /C or if no engine can be created, tests
+	// comparing with XACT are then left out like the ones without /C.
+	class XactEngine
+	{
+		std::vector<unsigned char> globalSettings;
+		bool isComInitialized;
+
+		XactEngine(const XactEngine&);
+		XactEngine& operator=(const XactEngine&);
+
+	public:
+		IXACT3Engine* pEngine;
+
+		XactEngine();
+		~XactEngine();
+	};
+#endif
+}
+
+// Defines a test of the group, run by main in the order of definition
+#define TEST(group, name) \
+	static void group##_##name(); \
+	static NativeTests::TestRegistration group##_##name##Registration(#group, #name, group##_##name); \
+	static void group##_##name()
+
+// Fail the running test but keep running it
+#define CHECK(condition) \
+	NativeTests::Check((condition) ? true : false, __FILE__, __LINE__, #condition)
+
+// Fail the running test and leave it
+#define REQUIRE(condition) \
+	if (NativeTests::Check((condition) ? true : false, __FILE__, __LINE__, #condition) == false) return
@@ -0,0 +1,240 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+
+// The Win32 subset NativeRingBuffer.h uses, as in CommandQueueBenchmark
+typedef int LONG;
+typedef unsigned char BYTE;
+
+inline LONG InterlockedCompareExchange(volatile LONG* pDestination, LONG exchange, LONG comparand)
+{
+	return __sync_val_compare_and_swap(pDestination, comparand, exchange);
+}
+
+inline LONG InterlockedExchange(volatile LONG* pTarget, LONG value)
+{
+	__sync_synchronize();
+	return __sync_lock_test_and_set(pTarget, value);
+}
+#endif
+
+#include "NativeTests.h"
+#include "NativeRingBuffer.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	const unsigned int ProducerCount = 4;
+	const unsigned int ValuesPerProducer = 50000;
+
+	struct Value
+	{
+		unsigned int producer;
+		unsigned int sequence;
+	};
+
+	struct Producer
+	{
+		RingBuffer<Value>* pQueue;
+		unsigned int index;
+	};
+
+#if defined(_WIN32)
+	typedef HANDLE Thread;
+	typedef DWORD ThreadResult;
+#define THREADPROC WINAPI
+
+	Thread StartThread(ThreadResult (THREADPROC* pProc)(void*), void* pContext)
+	{
+		return ::CreateThread(NULL, 0, reinterpret_cast<LPTHREAD_START_ROUTINE>(pProc), pContext, 0, NULL);
+	}
+
+	void JoinThread(Thread thread)
+	{
+		::WaitForSingleObject(thread, INFINITE);
+		::CloseHandle(thread);
+	}
+
+	void YieldThread()
+	{
+		::SwitchToThread();
+	}
+#else
+	typedef pthread_t Thread;
+	typedef void* ThreadResult;
+#define THREADPROC
+
+	Thread StartThread(ThreadResult (*pProc)(void*), void* pContext)
+	{
+		pthread_t thread;
+		pthread_create(&thread, NULL, pProc, pContext);
+		return thread;
+	}
+
+	void JoinThread(Thread thread)
+	{
+		pthread_join(thread, NULL);
+	}
+
+	void YieldThread()
+	{
+		sched_yield();
+	}
+#endif
+
+	ThreadResult THREADPROC ProducerProc(void* pContext)
+	{
+		Producer& producer = *static_cast<Producer*>(pContext);
+		for (unsigned int i = 0; i < ValuesPerProducer; i++)
+		{
+			Value value = { producer.index, i };
+			while (producer.pQueue->Push(value) == false)
+			{
+				YieldThread();
+			}
+		}
+		return 0;
+	}
+}
+
+TEST(RingBuffer, EmptyAndFull)
+{
+	RingBuffer<int> queue(8);
+	CHECK(queue.GetCapacity() == 8);
+	CHECK(queue.GetCount() == 0);
+
+	int value = -1;
+	CHECK(queue.Pop(value) == false);
+	CHECK(value == -1);
+
+	for (int i = 0; i < 8; i++)
+	{
+		CHECK(queue.Push(i) == true);
+	}
+	CHECK(queue.GetCount() == 8);
+	CHECK(queue.Push(8) == false);
+	CHECK(queue.GetCount() == 8);
+
+	// A popped cell takes the next push
+	REQUIRE(queue.Pop(value) == true);
+	CHECK(value == 0);
+	CHECK(queue.Push(8) == true);
+	CHECK(queue.Push(9) == false);
+
+	for (int i = 1; i <= 8; i++)
+	{
+		REQUIRE(queue.Pop(value) == true);
+		CHECK(value == i);
+	}
+	CHECK(queue.Pop(value) == false);
+	CHECK(queue.GetCount() == 0);
+}
+
+TEST(RingBuffer, WrapsAround)
+{
+	// Batches that do not divide the capacity, so every cell is written
+	// at every position of a batch
+	RingBuffer<int> queue(4);
+	int next = 0;
+	int expected = 0;
+	for (int round = 0; round < 1000; round++)
+	{
+		int batch = 1 + round % 4;
+		for (int i = 0; i < batch; i++)
+		{
+			CHECK(queue.Push(next++) == true);
+		}
+		CHECK(queue.GetCount() == batch);
+		if (batch == 4)
+		{
+			CHECK(queue.Push(next) == false);
+		}
+
+		int value;
+		while (queue.Pop(value) == true)
+		{
+			CHECK(value == expected);
+			expected++;
+		}
+		CHECK(queue.GetCount() == 0);
+	}
+	CHECK(expected == next);
+}
+
+TEST(RingBuffer, KeepsOrderOfEachProducer)
+{
+	// Small enough to be full now and then
+	RingBuffer<Value> queue(64);
+	Producer producers[ProducerCount];
+	Thread threads[ProducerCount];
+	for (unsigned int i = 0; i < ProducerCount; i++)
+	{
+		producers[i].pQueue = &queue;
+		producers[i].index = i;
+		threads[i] = StartThread(ProducerProc, &producers[i]);
+	}
+
+	// Values of one producer come out in the order it pushed them,
+	// interleaved in any way with the others
+	std::vector<unsigned int> nextSequence(ProducerCount, 0);
+	unsigned int received = 0;
+	bool isOrdered = true;
+	while (received < ProducerCount * ValuesPerProducer)
+	{
+		Value value;
+		if (queue.Pop(value) == false)
+		{
+			YieldThread();
+			continue;
+		}
+
+		if (value.producer >= ProducerCount || value.sequence != nextSequence[value.producer])
+		{
+			isOrdered = false;
+			break;
+		}
+		nextSequence[value.producer]++;
+		received++;
+	}
+	CHECK(isOrdered == true);
+
+	// Drains what is left if the order broke, so the producers can end
+	while (isOrdered == false && received < ProducerCount * ValuesPerProducer)
+	{
+		Value value;
+		if (queue.Pop(value) == true)
+		{
+			received++;
+		}
+		else
+		{
+			YieldThread();
+		}
+	}
+	for (unsigned int i = 0; i < ProducerCount; i++)
+	{
+		JoinThread(threads[i]);
+	}
+
+	Value value;
+	CHECK(queue.Pop(value) == false);
+	CHECK(queue.GetCount() == 0);
+	for (unsigned int i = 0; i < ProducerCount; i++)
+	{
+		CHECK(nextSequence[i] == ValuesPerProducer || isOrdered == false);
+	}
+}
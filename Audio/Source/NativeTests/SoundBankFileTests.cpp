@@ -0,0 +1,751 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <objbase.h>
+#include <xact3.h>
+#endif
+
+#include "NativeTests.h"
+#include "NativeSoundBankFile.h"
+#include "NativeWaveBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	WaveReference Wave(uint16 waveBank, uint16 wave)
+	{
+		WaveReference reference = { waveBank, wave };
+		return reference;
+	}
+
+	bool operator==(const WaveReference& a, const WaveReference& b)
+	{
+		return a.waveBank == b.waveBank && a.wave == b.wave;
+	}
+
+	// Writes sound banks in the layout SoundBankFile reads: the header, the
+	// wave bank names, the sounds, their track events, the cue variation
+	// tables, the simple and complex cues, the cue name index and the cue
+	// names, in that order
+	class SoundBankBuilder
+	{
+		std::vector<uint8> data;
+
+		void Put8(size_t offset, uint32 value)
+		{
+			data[offset] = static_cast<uint8>(value);
+		}
+
+		void Put16(size_t offset, uint32 value)
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				int shift = bigEndian == true ? (1 - i) * 8 : i * 8;
+				data[offset + i] = static_cast<uint8>(value >> shift);
+			}
+		}
+
+		void Put32(size_t offset, uint32 value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int shift = bigEndian == true ? (3 - i) * 8 : i * 8;
+				data[offset + i] = static_cast<uint8>(value >> shift);
+			}
+		}
+
+		// Appends size zero bytes, returns their offset
+		size_t Append(size_t size)
+		{
+			size_t offset = data.size();
+			data.resize(offset + size, 0);
+			return offset;
+		}
+
+		void PutWave(size_t offset, const WaveReference& wave)
+		{
+			Put16(offset, wave.wave);
+			Put8(offset + 2, wave.waveBank);
+		}
+
+	public:
+		// Track events, see the EventType of NativeSoundBankFile.cpp
+		enum EventType
+		{
+			PlayWave = 1,
+			PlayWaveTrackVariation = 3,
+			Volume = 8,
+			Unknown = 31,
+		};
+
+		struct Event
+		{
+			EventType type;
+			std::vector<WaveReference> waves;
+		};
+
+		struct Sound
+		{
+			uint8 priority;
+			uint16 category;
+			int16 pitch;
+			// Simple sounds play this wave, complex ones their tracks
+			WaveReference wave;
+			std::vector<std::vector<Event> > tracks;
+			bool hasRpcs;
+			bool hasDsp;
+		};
+
+		struct Cue
+		{
+			const char* name;
+			bool isComplex;
+			uint8 instanceLimit;
+			uint16 fadeIn;
+			uint16 fadeOut;
+			uint8 maxInstanceBehavior;
+			// The cue plays this sound unless it has variations
+			uint32 sound;
+			// Variation table format: 0 waves, 1 sounds
+			uint32 variationFormat;
+			std::vector<uint32> variationSounds;
+			std::vector<WaveReference> variationWaves;
+		};
+
+		bool bigEndian;
+		bool names;
+		std::vector<const char*> waveBanks;
+		std::vector<Sound> sounds;
+		std::vector<Cue> cues;
+
+		// Filled by Build
+		size_t cueNamesOffset;
+
+		SoundBankBuilder()
+			: bigEndian(false)
+			, names(true)
+			, cueNamesOffset(0)
+		{}
+
+		Sound& AddSimpleSound(uint16 category, const WaveReference& wave)
+		{
+			Sound sound;
+			sound.priority = 0;
+			sound.category = category;
+			sound.pitch = 0;
+			sound.wave = wave;
+			sound.hasRpcs = false;
+			sound.hasDsp = false;
+			sounds.push_back(sound);
+			return sounds.back();
+		}
+
+		Sound& AddComplexSound(uint16 category)
+		{
+			Sound& sound = AddSimpleSound(category, Wave(0, 0));
+			sound.tracks.resize(1);
+			return sound;
+		}
+
+		static void AddEvent(std::vector<Event>& track, EventType type, const WaveReference* pWaves, size_t waveCount)
+		{
+			Event event;
+			event.type = type;
+			event.waves.assign(pWaves, pWaves + waveCount);
+			track.push_back(event);
+		}
+
+		Cue& AddCue(const char* name, bool isComplex, uint32 sound)
+		{
+			Cue cue;
+			cue.name = name;
+			cue.isComplex = isComplex;
+			cue.instanceLimit = 0xFF;
+			cue.fadeIn = 0;
+			cue.fadeOut = 0;
+			cue.maxInstanceBehavior = 0;
+			cue.sound = sound;
+			cue.variationFormat = 0;
+			cues.push_back(cue);
+			return cues.back();
+		}
+
+		std::vector<uint8> Build()
+		{
+			data.clear();
+			Append(138);
+			memcpy(&data[0], bigEndian == true ? "KBDS" : "SDBK", 4);
+			Put16(4, 46);
+			Put16(6, SoundBankFile::FormatVersion);
+			strcpy(reinterpret_cast<char*>(&data[74]), "TestSounds");
+
+			// Simple cues come first in the file and in the numbering
+			std::vector<const Cue*> ordered;
+			for (size_t i = 0; i < cues.size(); i++)
+			{
+				if (cues[i].isComplex == false)
+				{
+					ordered.push_back(&cues[i]);
+				}
+			}
+			uint32 simpleCueCount = static_cast<uint32>(ordered.size());
+			for (size_t i = 0; i < cues.size(); i++)
+			{
+				if (cues[i].isComplex == true)
+				{
+					ordered.push_back(&cues[i]);
+				}
+			}
+
+			Put8(27, static_cast<uint32>(waveBanks.size()));
+			Put32(58, static_cast<uint32>(Append(waveBanks.size() * 64)));
+			for (size_t i = 0; i < waveBanks.size(); i++)
+			{
+				strncpy(reinterpret_cast<char*>(&data[data.size() - (waveBanks.size() - i) * 64]), waveBanks[i], 64);
+			}
+
+			// Sounds, with the offsets of their track tables to patch
+			Put16(28, static_cast<uint32>(sounds.size()));
+			Put32(70, static_cast<uint32>(data.size()));
+			std::vector<size_t> soundOffsets;
+			std::vector<size_t> trackOffsets;
+			for (size_t i = 0; i < sounds.size(); i++)
+			{
+				const Sound& sound = sounds[i];
+				bool isComplex = sound.tracks.empty() == false;
+				size_t offset = Append(9);
+				soundOffsets.push_back(offset);
+				Put8(offset, (isComplex == true ? 0x01 : 0) | (sound.hasRpcs == true ? 0x02 : 0) | (sound.hasDsp == true ? 0x10 : 0));
+				Put16(offset + 1, sound.category);
+				Put8(offset + 3, 0x5A);
+				Put16(offset + 4, static_cast<uint16>(sound.pitch));
+				Put8(offset + 6, sound.priority);
+
+				if (isComplex == true)
+				{
+					Put8(Append(1), static_cast<uint32>(sound.tracks.size()));
+				}
+				else
+				{
+					PutWave(Append(3), sound.wave);
+				}
+				if (sound.hasRpcs == true)
+				{
+					Put16(Append(6), 6);
+				}
+				if (sound.hasDsp == true)
+				{
+					Put16(Append(4), 4);
+				}
+				trackOffsets.push_back(data.size());
+				if (isComplex == true)
+				{
+					Append(sound.tracks.size() * 9);
+				}
+				Put16(offset + 7, static_cast<uint32>(data.size() - offset));
+			}
+
+			// Track events
+			for (size_t i = 0; i < sounds.size(); i++)
+			{
+				const Sound& sound = sounds[i];
+				for (size_t track = 0; track < sound.tracks.size(); track++)
+				{
+					const std::vector<Event>& events = sound.tracks[track];
+					size_t offset = Append(5);
+					Put32(trackOffsets[i] + track * 9 + 1, static_cast<uint32>(offset));
+					Put8(offset, static_cast<uint32>(events.size()));
+					for (size_t j = 0; j < events.size(); j++)
+					{
+						const Event& event = events[j];
+						// Timestamp above the type
+						Put32(Append(7), event.type | (static_cast<uint32>(j) * 100 << 5));
+						switch (event.type)
+						{
+						case PlayWave:
+							PutWave(Append(9) + 1, event.waves[0]);
+							break;
+						case PlayWaveTrackVariation:
+							{
+								Append(6);
+								size_t header = Append(8);
+								Put16(header, static_cast<uint32>(event.waves.size()));
+								for (size_t k = 0; k < event.waves.size(); k++)
+								{
+									PutWave(Append(5), event.waves[k]);
+								}
+							}
+							break;
+						case Volume:
+							// A ramp
+							Append(15);
+							break;
+						case Unknown:
+							Append(3);
+							break;
+						}
+					}
+				}
+			}
+
+			// Variation tables
+			std::vector<size_t> cueCodes;
+			for (size_t i = 0; i < ordered.size(); i++)
+			{
+				const Cue& cue = *ordered[i];
+				bool isVariation = cue.variationSounds.empty() == false || cue.variationWaves.empty() == false;
+				if (isVariation == false)
+				{
+					cueCodes.push_back(soundOffsets[cue.sound]);
+					continue;
+				}
+
+				size_t offset = Append(8);
+				cueCodes.push_back(offset);
+				Put16(offset + 2, cue.variationFormat);
+				if (cue.variationFormat == 0)
+				{
+					Put16(offset, static_cast<uint32>(cue.variationWaves.size()));
+					for (size_t j = 0; j < cue.variationWaves.size(); j++)
+					{
+						PutWave(Append(5), cue.variationWaves[j]);
+					}
+				}
+				else
+				{
+					Put16(offset, static_cast<uint32>(cue.variationSounds.size()));
+					for (size_t j = 0; j < cue.variationSounds.size(); j++)
+					{
+						Put32(Append(6), static_cast<uint32>(soundOffsets[cue.variationSounds[j]]));
+					}
+				}
+			}
+
+			// Cues
+			Put16(19, simpleCueCount);
+			Put16(21, static_cast<uint32>(ordered.size()) - simpleCueCount);
+			Put16(25, static_cast<uint32>(ordered.size()));
+			Put32(34, static_cast<uint32>(data.size()));
+			for (uint32 i = 0; i < simpleCueCount; i++)
+			{
+				size_t offset = Append(5);
+				Put32(offset + 1, static_cast<uint32>(cueCodes[i]));
+			}
+			Put32(38, static_cast<uint32>(data.size()));
+			for (size_t i = simpleCueCount; i < ordered.size(); i++)
+			{
+				const Cue& cue = *ordered[i];
+				bool isVariation = cue.variationSounds.empty() == false || cue.variationWaves.empty() == false;
+				size_t offset = Append(15);
+				Put8(offset, isVariation == true ? 0 : 0x04);
+				Put32(offset + 1, static_cast<uint32>(cueCodes[i]));
+				Put8(offset + 9, cue.instanceLimit);
+				Put16(offset + 10, cue.fadeIn);
+				Put16(offset + 12, cue.fadeOut);
+				Put8(offset + 14, cue.maxInstanceBehavior << 3);
+			}
+
+			// Cue names
+			if (names == false)
+			{
+				Put32(66, 0xFFFFFFFF);
+				cueNamesOffset = data.size();
+				return data;
+			}
+			size_t index = Append(ordered.size() * 6);
+			Put32(66, static_cast<uint32>(index));
+			cueNamesOffset = data.size();
+			for (size_t i = 0; i < ordered.size(); i++)
+			{
+				const char* name = ordered[i]->name;
+				size_t offset = Append(strlen(name) + 1);
+				memcpy(&data[offset], name, strlen(name));
+				Put32(index + i * 6, static_cast<uint32>(offset));
+				Put16(index + i * 6 + 4, 0xFFFF);
+			}
+			return data;
+		}
+	};
+
+	// Two wave banks, a simple sound, a complex one with RPC and DSP
+	// tables, two tracks and a track variation, and the cues playing them:
+	// a simple cue, a complex one with a single sound, and variations of
+	// sounds and of waves
+	void AddStandardContent(SoundBankBuilder& builder)
+	{
+		builder.waveBanks.push_back("Effects");
+		builder.waveBanks.push_back("a name that is exactly sixty-four characters long, no terminator");
+
+		builder.AddSimpleSound(1, Wave(0, 2)).priority = 3;
+
+		SoundBankBuilder::Sound& complex = builder.AddComplexSound(2);
+		complex.pitch = -1200;
+		complex.hasRpcs = true;
+		complex.hasDsp = true;
+		complex.tracks.resize(2);
+		const WaveReference first[] = { Wave(1, 5) };
+		const WaveReference second[] = { Wave(1, 4) };
+		const WaveReference variation[] = { Wave(1, 3), Wave(1, 1), Wave(0, 2) };
+		SoundBankBuilder::AddEvent(complex.tracks[0], SoundBankBuilder::PlayWave, first, 1);
+		SoundBankBuilder::AddEvent(complex.tracks[0], SoundBankBuilder::Volume, NULL, 0);
+		SoundBankBuilder::AddEvent(complex.tracks[0], SoundBankBuilder::PlayWave, second, 1);
+		SoundBankBuilder::AddEvent(complex.tracks[1], SoundBankBuilder::PlayWaveTrackVariation, variation, 3);
+
+		SoundBankBuilder::Cue& single = builder.AddCue("single", true, 1);
+		single.instanceLimit = 3;
+		single.fadeIn = 100;
+		single.fadeOut = 200;
+		single.maxInstanceBehavior = 2;
+
+		SoundBankBuilder::Cue& sounds = builder.AddCue("sounds", true, 0);
+		sounds.variationFormat = 1;
+		sounds.variationSounds.push_back(0);
+		sounds.variationSounds.push_back(1);
+
+		SoundBankBuilder::Cue& waves = builder.AddCue("waves", true, 0);
+		waves.variationWaves.push_back(Wave(0, 7));
+		waves.variationWaves.push_back(Wave(0, 7));
+		waves.variationWaves.push_back(Wave(1, 0));
+
+		// Added last but numbered first, as a simple cue
+		builder.AddCue("simple", false, 0);
+	}
+
+	bool HasWaves(const SoundBankFile& file, uint32 firstWave, uint32 waveCount,
+		const WaveReference* pExpected, uint32 expectedCount)
+	{
+		if (waveCount != expectedCount)
+		{
+			return false;
+		}
+		for (uint32 i = 0; i < waveCount; i++)
+		{
+			if ((file.GetWaves()[firstWave + i] == pExpected[i]) == false)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void CheckStandardContent(const SoundBankFile& file)
+	{
+		CHECK(file.GetContentVersion() == 46);
+		CHECK(file.GetFormatVersion() == SoundBankFile::FormatVersion);
+		CHECK(strcmp(file.GetName(), "TestSounds") == 0);
+		REQUIRE(file.GetWaveBankCount() == 2);
+		CHECK(strcmp(file.GetWaveBankName(0), "Effects") == 0);
+		CHECK(strcmp(file.GetWaveBankName(1), "a name that is exactly sixty-four characters long, no terminator") == 0);
+
+		REQUIRE(file.GetSoundCount() == 2);
+		const SoundBankSound& simple = file.GetSound(0);
+		CHECK(simple.category == 1);
+		CHECK(simple.priority == 3);
+		CHECK(simple.trackCount == 1);
+		CHECK(simple.isComplete == true);
+		const WaveReference simpleWaves[] = { Wave(0, 2) };
+		CHECK(HasWaves(file, simple.firstWave, simple.waveCount, simpleWaves, 1));
+
+		// Sorted by wave bank and wave, without duplicates
+		const SoundBankSound& complex = file.GetSound(1);
+		CHECK(complex.category == 2);
+		CHECK(complex.pitch == -1200);
+		CHECK(complex.trackCount == 2);
+		CHECK(complex.isComplete == true);
+		const WaveReference complexWaves[] = { Wave(0, 2), Wave(1, 1), Wave(1, 3), Wave(1, 4), Wave(1, 5) };
+		CHECK(HasWaves(file, complex.firstWave, complex.waveCount, complexWaves, 5));
+
+		REQUIRE(file.GetCueCount() == 4);
+		const char* names[] = { "simple", "single", "sounds", "waves" };
+		for (uint32 i = 0; i < 4; i++)
+		{
+			CHECK(strcmp(file.GetCueName(i), names[i]) == 0);
+			CHECK(file.FindCue(names[i]) == i);
+		}
+		CHECK(file.GetCueName(4) == NULL);
+		CHECK(file.FindCue("missing") == SoundBankFile::InvalidIndex);
+
+		const SoundBankCue& simpleCue = file.GetCue(0);
+		CHECK(simpleCue.instanceLimit == 0xFF);
+		REQUIRE(simpleCue.soundCount == 1);
+		CHECK(file.GetCueSounds()[simpleCue.firstSound] == 0);
+		CHECK(HasWaves(file, simpleCue.firstWave, simpleCue.waveCount, simpleWaves, 1));
+
+		const SoundBankCue& singleCue = file.GetCue(1);
+		CHECK(singleCue.instanceLimit == 3);
+		CHECK(singleCue.fadeInMilliseconds == 100);
+		CHECK(singleCue.fadeOutMilliseconds == 200);
+		CHECK(singleCue.maxInstanceBehavior == 2);
+		REQUIRE(singleCue.soundCount == 1);
+		CHECK(file.GetCueSounds()[singleCue.firstSound] == 1);
+		CHECK(HasWaves(file, singleCue.firstWave, singleCue.waveCount, complexWaves, 5));
+
+		const SoundBankCue& soundsCue = file.GetCue(2);
+		REQUIRE(soundsCue.soundCount == 2);
+		CHECK(file.GetCueSounds()[soundsCue.firstSound] == 0);
+		CHECK(file.GetCueSounds()[soundsCue.firstSound + 1] == 1);
+		CHECK(HasWaves(file, soundsCue.firstWave, soundsCue.waveCount, complexWaves, 5));
+		CHECK(soundsCue.isComplete == true);
+
+		const SoundBankCue& wavesCue = file.GetCue(3);
+		CHECK(wavesCue.soundCount == 0);
+		const WaveReference variationWaves[] = { Wave(0, 7), Wave(1, 0) };
+		CHECK(HasWaves(file, wavesCue.firstWave, wavesCue.waveCount, variationWaves, 2));
+	}
+}
+
+TEST(SoundBankFile, ParsesStandardBank)
+{
+	SoundBankBuilder builder;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CheckStandardContent(file);
+}
+
+TEST(SoundBankFile, ParsesByteSwappedBank)
+{
+	SoundBankBuilder builder;
+	builder.bigEndian = true;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CheckStandardContent(file);
+}
+
+TEST(SoundBankFile, ParsesBankWithoutCueNames)
+{
+	SoundBankBuilder builder;
+	builder.names = false;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CHECK(file.GetCueCount() == 4);
+	CHECK(file.GetCueName(0) == NULL);
+	CHECK(file.FindCue("simple") == SoundBankFile::InvalidIndex);
+}
+
+TEST(SoundBankFile, CollectsWavesOfCues)
+{
+	SoundBankBuilder builder;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+
+	// Unknown cue indices are skipped
+	const uint32 cueIndices[] = { 3, 0, 17, 0 };
+	WaveReference waves[4];
+	REQUIRE(file.CollectWaves(cueIndices, 4, waves, 4) == 3);
+	CHECK(waves[0] == Wave(0, 2));
+	CHECK(waves[1] == Wave(0, 7));
+	CHECK(waves[2] == Wave(1, 0));
+
+	// Counts all, writes up to the capacity
+	const uint32 allCues[] = { 0, 1, 2, 3 };
+	memset(waves, 0xFF, sizeof(waves));
+	CHECK(file.CollectWaves(allCues, 4, waves, 2) == 7);
+	CHECK(waves[1] == Wave(0, 7));
+	CHECK(waves[2] == Wave(0xFFFF, 0xFFFF));
+}
+
+TEST(SoundBankFile, MarksUnknownEventsIncomplete)
+{
+	SoundBankBuilder builder;
+	builder.waveBanks.push_back("Effects");
+	SoundBankBuilder::Sound& sound = builder.AddComplexSound(0);
+	const WaveReference before[] = { Wave(0, 4) };
+	const WaveReference after[] = { Wave(0, 9) };
+	SoundBankBuilder::AddEvent(sound.tracks[0], SoundBankBuilder::PlayWave, before, 1);
+	SoundBankBuilder::AddEvent(sound.tracks[0], SoundBankBuilder::Unknown, NULL, 0);
+	SoundBankBuilder::AddEvent(sound.tracks[0], SoundBankBuilder::PlayWave, after, 1);
+	builder.AddCue("cue", false, 0);
+	std::vector<uint8> data = builder.Build();
+
+	// The waves before the unknown event are still listed
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CHECK(file.GetSound(0).isComplete == false);
+	CHECK(file.GetCue(0).isComplete == false);
+	CHECK(HasWaves(file, file.GetCue(0).firstWave, file.GetCue(0).waveCount, before, 1));
+}
+
+TEST(SoundBankFile, RejectsOtherFiles)
+{
+	SoundBankBuilder builder;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+	SoundBankFile file;
+
+	std::vector<uint8> wrongSignature = data;
+	memcpy(&wrongSignature[0], "WBND", 4);
+	CHECK(file.Parse(&wrongSignature[0], wrongSignature.size()) == BankParseInvalidSignature);
+
+	std::vector<uint8> wrongVersion = data;
+	wrongVersion[6] = 42;
+	CHECK(file.Parse(&wrongVersion[0], wrongVersion.size()) == BankParseUnsupportedVersion);
+
+	CHECK(file.Parse(&data[0], 3) == BankParseInvalidSignature);
+	CHECK(file.GetCueCount() == 0);
+}
+
+TEST(SoundBankFile, RejectsTruncatedBanks)
+{
+	SoundBankBuilder builder;
+	AddStandardContent(builder);
+	std::vector<uint8> data = builder.Build();
+
+	// Every table must lie inside the data. The last name may be cut
+	// short, names end with the data.
+	for (size_t size = 4; size < data.size(); size++)
+	{
+		std::vector<uint8> truncated(data.begin(), data.begin() + size);
+		SoundBankFile file;
+		BankParseResult result = file.Parse(&truncated[0], truncated.size());
+		if (size < builder.cueNamesOffset + strlen("simple") + 1)
+		{
+			CHECK(result == BankParseTruncated);
+		}
+	}
+
+	// A cue playing something that is not a sound
+	std::vector<uint8> wrongSound = data;
+	uint32 simpleCues = wrongSound[34] | (wrongSound[35] << 8) | (wrongSound[36] << 16) | (wrongSound[37] << 24);
+	wrongSound[simpleCues + 1]++;
+	SoundBankFile file;
+	CHECK(file.Parse(&wrongSound[0], wrongSound.size()) == BankParseInvalidData);
+}
+
+namespace
+{
+	// The cues of Sample.xap and the wave each plays, by the wave bank
+	// index and the entry index XACT assigned in the project
+	struct SampleCue
+	{
+		const char* name;
+		uint16 waveBank;
+		uint16 wave;
+		uint16 channels;
+	};
+
+	const char* const SampleWaveBanks[] = { "InMemoryWaveBank", "StreamingWaveBank" };
+
+	const SampleCue SampleCues[] =
+	{
+		{ "song3", 1, 3, 2 },
+		{ "rev", 1, 0, 1 },
+		{ "song1", 1, 1, 1 },
+		{ "song2", 1, 2, 1 },
+		{ "zap", 0, 0, 2 },
+	};
+
+	const uint32 SampleCueCount = sizeof(SampleCues) / sizeof(SampleCues[0]);
+}
+
+TEST(SoundBankFile, ParsesSampleBank)
+{
+	if (GetContentDirectory().empty() == true)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> data;
+	REQUIRE(ReadFile(GetContentDirectory() + "/Sounds.xsb", data) == true);
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+
+	REQUIRE(file.GetWaveBankCount() == 2);
+	CHECK(strcmp(file.GetWaveBankName(0), SampleWaveBanks[0]) == 0);
+	CHECK(strcmp(file.GetWaveBankName(1), SampleWaveBanks[1]) == 0);
+
+	// The waves referenced must be the ones of the wave banks built along
+	WaveBankFile waveBanks[2];
+	std::vector<unsigned char> waveBankData[2];
+	for (int i = 0; i < 2; i++)
+	{
+		REQUIRE(ReadFile(GetContentDirectory() + "/" + SampleWaveBanks[i] + ".xwb", waveBankData[i]) == true);
+		REQUIRE(waveBanks[i].Parse(&waveBankData[i][0], waveBankData[i].size()) == BankParseOk);
+	}
+
+	REQUIRE(file.GetCueCount() == SampleCueCount);
+	for (uint32 i = 0; i < SampleCueCount; i++)
+	{
+		const SampleCue& expected = SampleCues[i];
+		uint32 index = file.FindCue(expected.name);
+		REQUIRE(index != SoundBankFile::InvalidIndex);
+		CHECK(strcmp(file.GetCueName(index), expected.name) == 0);
+
+		const SoundBankCue& cue = file.GetCue(index);
+		CHECK(cue.isComplete == true);
+		CHECK(cue.soundCount == 1);
+		REQUIRE(cue.waveCount == 1);
+		const WaveReference& wave = file.GetWaves()[cue.firstWave];
+		CHECK(wave == Wave(expected.waveBank, expected.wave));
+
+		REQUIRE(wave.waveBank < 2 && wave.wave < waveBanks[wave.waveBank].GetEntryCount());
+		const WaveBankFile& waveBank = waveBanks[wave.waveBank];
+		CHECK(waveBank.GetEntry(wave.wave).format.channels == expected.channels);
+		if (waveBank.GetEntryName(wave.wave) != NULL)
+		{
+			CHECK(strcmp(waveBank.GetEntryName(wave.wave), expected.name) == 0);
+		}
+	}
+}
+
+#if defined(_WIN32)
+
+TEST(SoundBankFile, MatchesXactCueIndices)
+{
+	XactEngine engine;
+	if (engine.pEngine == NULL)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> data;
+	REQUIRE(ReadFile(GetContentDirectory() + "/Sounds.xsb", data) == true);
+	SoundBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+
+	// XACT writes to the data, which must outlive the bank
+	std::vector<unsigned char> xactData = data;
+	IXACT3SoundBank* pSoundBank;
+	REQUIRE(SUCCEEDED(engine.pEngine->CreateSoundBank(&xactData[0], static_cast<DWORD>(xactData.size()), 0, 0, &pSoundBank)));
+
+	XACTINDEX cueCount = 0;
+	pSoundBank->GetNumCues(&cueCount);
+	CHECK(cueCount == file.GetCueCount());
+	for (XACTINDEX i = 0; i < cueCount && i < file.GetCueCount(); i++)
+	{
+		XACT_CUE_PROPERTIES properties;
+		if (CHECK(SUCCEEDED(pSoundBank->GetCueProperties(i, &properties))) == false)
+		{
+			continue;
+		}
+		CHECK(strcmp(properties.friendlyName, file.GetCueName(i)) == 0);
+		CHECK(pSoundBank->GetCueIndex(file.GetCueName(i)) == i);
+		CHECK(properties.maxInstances == file.GetCue(i).instanceLimit);
+	}
+
+	pSoundBank->Destroy();
+}
+
+#endif
@@ -0,0 +1,266 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "NativeTests.h"
+#include "NativeSpatialIndex.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	// Points this close to the edge of their range may be found or not,
+	// depending on how the compiler rounds
+	const float EdgeTolerance = 1e-4f;
+
+	// Same numbers on every platform
+	class Random
+	{
+		unsigned int state;
+
+	public:
+		explicit Random(unsigned int seed)
+			: state(seed)
+		{}
+
+		unsigned int Next(unsigned int count)
+		{
+			state = state * 1664525 + 1013904223;
+			return (state >> 8) % count;
+		}
+
+		float Next(float minValue, float maxValue)
+		{
+			state = state * 1664525 + 1013904223;
+			return minValue + static_cast<float>(state >> 8) / 16777216.0f * (maxValue - minValue);
+		}
+	};
+
+	struct Point
+	{
+		bool inUse;
+		float x;
+		float y;
+		float z;
+		float radius;
+	};
+
+	// The points of an index kept in a plain array, queried by looking at
+	// every one of them
+	class LinearScan
+	{
+	public:
+		std::vector<Point> points;
+
+		explicit LinearScan(size_t size)
+			: points(size)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				points[i].inUse = false;
+			}
+		}
+
+		// Distance of the point relative to its radius, and its distance
+		// relative to the range it is audible in, above 1 if it is not
+		void Measure(int32 id, float x, float y, float z, float maxDistance,
+			float& relativeDistance, float& relativeRange) const
+		{
+			const Point& point = points[id];
+			float dx = point.x - x;
+			float dy = point.y - y;
+			float dz = point.z - z;
+			float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+			float limit = point.radius < maxDistance ? point.radius : maxDistance;
+			relativeDistance = point.radius > 0 ? distance / point.radius : 0;
+			relativeRange = limit > 0 ? distance / limit : (distance > 0 ? 2.0f : 0.0f);
+		}
+	};
+
+	// Checks a query of the index against the linear scan
+	void CheckQuery(SpatialIndex& index, const LinearScan& scan, float x, float y, float z, float maxDistance,
+		uint32 maxCount)
+	{
+		std::vector<int32> ids(maxCount + 1);
+		std::vector<float> relativeDistances(maxCount + 1);
+		uint32 count = index.Query(x, y, z, maxDistance, maxCount, &ids[0], &relativeDistances[0]);
+		CHECK(count <= maxCount);
+
+		// Found points are audible and in order
+		std::vector<bool> isFound(scan.points.size(), false);
+		for (uint32 i = 0; i < count; i++)
+		{
+			int32 id = ids[i];
+			REQUIRE(id >= 0 && static_cast<size_t>(id) < scan.points.size());
+			CHECK(scan.points[id].inUse == true);
+			CHECK(isFound[id] == false);
+			isFound[id] = true;
+
+			float relativeDistance;
+			float relativeRange;
+			scan.Measure(id, x, y, z, maxDistance, relativeDistance, relativeRange);
+			CHECK(relativeRange <= 1 + EdgeTolerance);
+			CHECK(fabsf(relativeDistances[i] - relativeDistance) <= EdgeTolerance);
+			CHECK(i == 0 || relativeDistances[i - 1] <= relativeDistances[i]);
+		}
+
+		// Points left out are not audible, or further than the ones found
+		// once maxCount is reached
+		uint32 audibleCount = 0;
+		for (size_t id = 0; id < scan.points.size(); id++)
+		{
+			if (scan.points[id].inUse == false)
+			{
+				continue;
+			}
+
+			float relativeDistance;
+			float relativeRange;
+			scan.Measure(static_cast<int32>(id), x, y, z, maxDistance, relativeDistance, relativeRange);
+			if (relativeRange > 1 - EdgeTolerance || isFound[id] == true)
+			{
+				continue;
+			}
+			audibleCount++;
+			CHECK(count == 0 || relativeDistance >= relativeDistances[count - 1] - EdgeTolerance);
+		}
+		CHECK(audibleCount == 0 || count == maxCount);
+	}
+
+	// Random inserts, moves, removes and radius changes, checked with
+	// queries from random positions after every few of them
+	void RunRandomOperations(unsigned int seed, float worldSize, float cellSize, float minRadius, float maxRadius)
+	{
+		const int32 MaxId = 300;
+		Random random(seed);
+		SpatialIndex index(cellSize);
+		LinearScan scan(MaxId);
+
+		for (int step = 0; step < 3000; step++)
+		{
+			int32 id = static_cast<int32>(random.Next(MaxId));
+			Point& point = scan.points[id];
+			unsigned int operation = random.Next(10);
+			if (operation < 4 && point.inUse == false)
+			{
+				point.inUse = true;
+				point.x = random.Next(-worldSize, worldSize);
+				point.y = random.Next(-worldSize, worldSize);
+				point.z = random.Next(-worldSize, worldSize);
+				// Now and then one audible everywhere
+				point.radius = random.Next(20) == 0 ? SpatialIndex::Unbounded : random.Next(minRadius, maxRadius);
+				index.Insert(id, point.x, point.y, point.z, point.radius);
+			}
+			else if (operation < 6 && point.inUse == true)
+			{
+				point.inUse = false;
+				index.Remove(id);
+			}
+			else if (operation < 8 && point.inUse == true)
+			{
+				// Mostly small steps, within the cell or to the next one
+				float step = random.Next(3) == 0 ? worldSize : cellSize;
+				point.x += random.Next(-step, step);
+				point.y += random.Next(-step, step);
+				point.z += random.Next(-step, step);
+				index.Move(id, point.x, point.y, point.z);
+			}
+			else if (operation == 8 && point.inUse == true)
+			{
+				point.radius = random.Next(minRadius, maxRadius);
+				index.SetRadius(id, point.radius);
+			}
+			else if (operation == 9 && random.Next(50) == 0)
+			{
+				cellSize = random.Next(0.25f, 4.0f) * cellSize;
+				index.SetCellSize(cellSize);
+			}
+
+			if (step % 10 == 0)
+			{
+				uint32 count = 0;
+				for (int32 i = 0; i < MaxId; i++)
+				{
+					count += scan.points[i].inUse == true ? 1 : 0;
+				}
+				CHECK(index.GetCount() == count);
+
+				float x = random.Next(-worldSize, worldSize);
+				float y = random.Next(-worldSize, worldSize);
+				float z = random.Next(-worldSize, worldSize);
+				float maxDistance = random.Next(2) == 0 ? SpatialIndex::Unbounded : random.Next(0, worldSize);
+				CheckQuery(index, scan, x, y, z, maxDistance, MaxId);
+				CheckQuery(index, scan, x, y, z, maxDistance, 1 + random.Next(8));
+			}
+		}
+	}
+}
+
+TEST(SpatialIndex, MatchesLinearScan)
+{
+	// Small radii in large cells, the queries look up a few cells
+	RunRandomOperations(1, 100.0f, 20.0f, 1.0f, 30.0f);
+}
+
+TEST(SpatialIndex, MatchesLinearScanWithLargeRadii)
+{
+	// Radii spanning many small cells, the queries fall back to looking
+	// at every point
+	RunRandomOperations(2, 50.0f, 0.5f, 10.0f, 80.0f);
+}
+
+TEST(SpatialIndex, FindsPointsAfterCellsRemoved)
+{
+	// One point per cell in a small area, so the probe sequences of the
+	// hash table run into each other, then most cells removed again
+	const int32 Side = 12;
+	SpatialIndex index(1.0f);
+	LinearScan scan(Side * Side * Side);
+	for (int32 id = 0; id < Side * Side * Side; id++)
+	{
+		Point& point = scan.points[id];
+		point.inUse = true;
+		point.x = static_cast<float>(id % Side) + 0.5f;
+		point.y = static_cast<float>(id / Side % Side) + 0.5f;
+		point.z = static_cast<float>(id / (Side * Side)) + 0.5f;
+		point.radius = 0.25f;
+		index.Insert(id, point.x, point.y, point.z, point.radius);
+	}
+
+	Random random(3);
+	for (int32 id = 0; id < Side * Side * Side; id++)
+	{
+		if (random.Next(4) != 0)
+		{
+			scan.points[id].inUse = false;
+			index.Remove(id);
+		}
+	}
+
+	// Every point left is found in its own cell, and only there
+	for (int32 id = 0; id < Side * Side * Side; id++)
+	{
+		const Point& point = scan.points[id];
+		int32 found = -1;
+		float relativeDistance;
+		uint32 count = index.Query(point.x, point.y, point.z, SpatialIndex::Unbounded, 1, &found, &relativeDistance);
+		if (point.inUse == true)
+		{
+			CHECK(count == 1 && found == id);
+		}
+		else
+		{
+			CHECK(count == 0);
+		}
+	}
+	CheckQuery(index, scan, Side * 0.5f, Side * 0.5f, Side * 0.5f, SpatialIndex::Unbounded, Side * Side * Side);
+}
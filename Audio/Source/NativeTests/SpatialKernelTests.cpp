@@ -0,0 +1,478 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <math.h>
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <x3daudio.h>
+#endif
+
+#include "NativeTests.h"
+#include "NativeSpatialKernel.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	const float Pi = 3.14159265f;
+	// The accuracy SpatialKernel documents for Calculate
+	const float Tolerance = 1e-4f;
+
+	// Cosine and sine of pi / 4 and pi / 10, the constant power gains of
+	// an emitter halfway and a fifth into a segment
+	const float Half = 0.70710678f;
+	const float FifthFrom = 0.95105652f;
+	const float FifthTo = 0.30901699f;
+
+	const unsigned int Stereo = SpatialKernel::SpeakerFrontLeft | SpatialKernel::SpeakerFrontRight;
+	const unsigned int Surround = Stereo | SpatialKernel::SpeakerFrontCenter | SpatialKernel::SpeakerLowFrequency |
+		SpatialKernel::SpeakerBackLeft | SpatialKernel::SpeakerBackRight;
+
+	bool IsNear(float value, float expected, float tolerance = Tolerance)
+	{
+		return fabsf(value - expected) <= tolerance;
+	}
+
+	// Same numbers on every platform
+	class Random
+	{
+		unsigned int state;
+
+	public:
+		explicit Random(unsigned int seed)
+			: state(seed)
+		{}
+
+		float Next(float minValue, float maxValue)
+		{
+			state = state * 1664525 + 1013904223;
+			return minValue + static_cast<float>(state >> 8) / 16777216.0f * (maxValue - minValue);
+		}
+	};
+
+	// Emitters in the arrays SpatialKernel takes and room for its results,
+	// for a listener at the origin facing +z with +y up, so +x is right
+	class Scene
+	{
+		std::vector<float> fields[10];
+		std::vector<float> results[4];
+
+	public:
+		SpatialKernel::Listener listener;
+		SpatialKernel::Emitters emitters;
+		SpatialKernel::Results out;
+
+		Scene(int count, int channelCount)
+		{
+			for (int k = 0; k < 10; k++)
+			{
+				fields[k].resize(count);
+			}
+			for (int i = 0; i < count; i++)
+			{
+				fields[5][i] = 1.0f;
+				fields[9][i] = 1.0f;
+			}
+			results[0].resize(count);
+			results[1].resize(count);
+			results[2].resize(count);
+			results[3].resize(count * channelCount);
+
+			for (int k = 0; k < 3; k++)
+			{
+				listener.position[k] = 0.0f;
+				listener.front[k] = k == 2 ? 1.0f : 0.0f;
+				listener.top[k] = k == 1 ? 1.0f : 0.0f;
+				listener.velocity[k] = 0.0f;
+				emitters.pPosition[k] = &fields[k][0];
+				emitters.pFront[k] = &fields[3 + k][0];
+				emitters.pVelocity[k] = &fields[6 + k][0];
+			}
+			emitters.pDopplerScaler = &fields[9][0];
+			out.pDistance = &results[0][0];
+			out.pAngle = &results[1][0];
+			out.pDoppler = &results[2][0];
+			out.pCoefficients = &results[3][0];
+		}
+
+		// Emitters face +z and stand still unless changed
+		void SetPosition(int i, float x, float y, float z)
+		{
+			fields[0][i] = x;
+			fields[1][i] = y;
+			fields[2][i] = z;
+		}
+
+		void SetFront(int i, float x, float y, float z)
+		{
+			fields[3][i] = x;
+			fields[4][i] = y;
+			fields[5][i] = z;
+		}
+
+		void SetVelocity(int i, float x, float y, float z)
+		{
+			fields[6][i] = x;
+			fields[7][i] = y;
+			fields[8][i] = z;
+		}
+
+		void SetDopplerScaler(int i, float scaler)
+		{
+			fields[9][i] = scaler;
+		}
+	};
+
+	// Checks the coefficients of emitter i against expected, with both
+	// Calculate and CalculateReference
+	void CheckCoefficients(const SpatialKernel& kernel, Scene& scene, int i, const float* expected)
+	{
+		int channelCount = kernel.GetChannelCount();
+		for (int pass = 0; pass < 2; pass++)
+		{
+			if (pass == 0)
+			{
+				kernel.CalculateReference(scene.listener, scene.emitters, i, i + 1, scene.out);
+			}
+			else
+			{
+				kernel.Calculate(scene.listener, scene.emitters, i, i + 1, scene.out);
+			}
+			for (int d = 0; d < channelCount; d++)
+			{
+				CHECK(IsNear(scene.out.pCoefficients[i * channelCount + d], expected[d]));
+			}
+		}
+	}
+}
+
+TEST(SpatialKernel, SetSpeakersPlacesChannels)
+{
+	SpatialKernel kernel;
+	CHECK(kernel.IsReady() == false);
+
+	CHECK(kernel.SetSpeakers(0, 6) == true);
+	CHECK(kernel.GetChannelCount() == 6);
+	CHECK(kernel.GetLfeChannel() == 3);
+	CHECK(kernel.IsReady() == true);
+
+	CHECK(kernel.SetSpeakers(Stereo, 2) == true);
+	CHECK(kernel.GetLfeChannel() == -1);
+
+	// More speakers than channels, fewer, or only the LFE
+	CHECK(kernel.SetSpeakers(Surround, 2) == false);
+	CHECK(kernel.IsReady() == false);
+	CHECK(kernel.SetSpeakers(Stereo, 3) == false);
+	CHECK(kernel.SetSpeakers(SpatialKernel::SpeakerLowFrequency, 1) == false);
+	CHECK(kernel.SetSpeakers(0, 7) == false);
+	CHECK(kernel.SetSpeakers(0, SpatialKernel::MaxChannelCount + 1) == false);
+	CHECK(kernel.GetChannelCount() == 0);
+}
+
+TEST(SpatialKernel, DistanceAndAngle)
+{
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(Stereo, 2) == true);
+
+	Scene scene(4, 2);
+	// In front facing the listener, to the right facing right, behind
+	// facing away and at the listener
+	scene.SetPosition(0, 0.0f, 0.0f, 10.0f);
+	scene.SetFront(0, 0.0f, 0.0f, -1.0f);
+	scene.SetPosition(1, 3.0f, 4.0f, 0.0f);
+	scene.SetFront(1, 1.0f, 0.0f, 0.0f);
+	scene.SetPosition(2, 0.0f, 0.0f, -2.0f);
+	scene.SetFront(2, 0.0f, 0.0f, -1.0f);
+
+	const float distances[4] = { 10.0f, 5.0f, 2.0f, 0.0f };
+	const float angles[4] = { 0.0f, 2.21429744f, Pi, 0.0f };
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 0)
+		{
+			kernel.CalculateReference(scene.listener, scene.emitters, 0, 4, scene.out);
+		}
+		else
+		{
+			kernel.Calculate(scene.listener, scene.emitters, 0, 4, scene.out);
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			CHECK(IsNear(scene.out.pDistance[i], distances[i]));
+			CHECK(IsNear(scene.out.pAngle[i], angles[i]));
+			CHECK(IsNear(scene.out.pDoppler[i], 1.0f));
+		}
+	}
+}
+
+TEST(SpatialKernel, Doppler)
+{
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(Stereo, 2) == true);
+	kernel.SetSpeedOfSound(343.5f);
+
+	Scene scene(5, 2);
+	for (int i = 0; i < 5; i++)
+	{
+		scene.SetPosition(i, 0.0f, 0.0f, 10.0f);
+	}
+	// Approaching at a tenth of the speed of sound, (c) / (c - v)
+	scene.SetVelocity(0, 0.0f, 0.0f, -34.35f);
+	// Receding at a tenth, scaled by 2
+	scene.SetVelocity(1, 0.0f, 0.0f, 34.35f);
+	scene.SetDopplerScaler(1, 2.0f);
+	// Approaching at the speed of sound, clamped to MaxDopplerFactor
+	scene.SetVelocity(2, 0.0f, 0.0f, -343.5f);
+	// Doppler off
+	scene.SetVelocity(3, 0.0f, 0.0f, -34.35f);
+	scene.SetDopplerScaler(3, 0.0f);
+	// Moving sideways only
+	scene.SetVelocity(4, 50.0f, 0.0f, 0.0f);
+
+	const float expected[5] = { 1.11111111f, 0.83333333f, 4.0f, 1.0f, 1.0f };
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 0)
+		{
+			kernel.CalculateReference(scene.listener, scene.emitters, 0, 5, scene.out);
+		}
+		else
+		{
+			kernel.Calculate(scene.listener, scene.emitters, 0, 5, scene.out);
+		}
+		for (int i = 0; i < 5; i++)
+		{
+			CHECK(IsNear(scene.out.pDoppler[i], expected[i]));
+		}
+	}
+
+	// The listener receding from a still emitter, (c - v) / c
+	scene.listener.velocity[2] = -34.35f;
+	scene.SetVelocity(0, 0.0f, 0.0f, 0.0f);
+	kernel.CalculateReference(scene.listener, scene.emitters, 0, 1, scene.out);
+	CHECK(IsNear(scene.out.pDoppler[0], 0.9f));
+	kernel.Calculate(scene.listener, scene.emitters, 0, 1, scene.out);
+	CHECK(IsNear(scene.out.pDoppler[0], 0.9f));
+}
+
+TEST(SpatialKernel, PansStereo)
+{
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(Stereo, 2) == true);
+
+	Scene scene(4, 2);
+	// Front, right, left and the listener's own position
+	scene.SetPosition(0, 0.0f, 0.0f, 10.0f);
+	scene.SetPosition(1, 10.0f, 0.0f, 0.0f);
+	scene.SetPosition(2, -10.0f, 0.0f, 0.0f);
+
+	// The speakers are at -30 and 30 degrees, the segment through the back
+	// spans 300, so 90 degrees is a fifth into it
+	const float front[2] = { Half, Half };
+	const float right[2] = { FifthTo, FifthFrom };
+	const float left[2] = { FifthFrom, FifthTo };
+	CheckCoefficients(kernel, scene, 0, front);
+	CheckCoefficients(kernel, scene, 1, right);
+	CheckCoefficients(kernel, scene, 2, left);
+	CheckCoefficients(kernel, scene, 3, front);
+}
+
+TEST(SpatialKernel, PansSurround)
+{
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(Surround, 6) == true);
+
+	Scene scene(5, 6);
+	// Front, right, behind, left and above
+	scene.SetPosition(0, 0.0f, 0.0f, 10.0f);
+	scene.SetPosition(1, 10.0f, 0.0f, 0.0f);
+	scene.SetPosition(2, 0.0f, 0.0f, -10.0f);
+	scene.SetPosition(3, -10.0f, 0.0f, 0.0f);
+	scene.SetPosition(4, 0.0f, 10.0f, 0.0f);
+
+	// FL, FR, C, LFE, BL, BR at -30, 30, 0, -, -150 and 150 degrees
+	const float front[6] = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f };
+	const float right[6] = { 0.0f, Half, 0.0f, 1.0f, 0.0f, Half };
+	const float behind[6] = { 0.0f, 0.0f, 0.0f, 1.0f, Half, Half };
+	const float left[6] = { Half, 0.0f, 0.0f, 1.0f, Half, 0.0f };
+	CheckCoefficients(kernel, scene, 0, front);
+	CheckCoefficients(kernel, scene, 1, right);
+	CheckCoefficients(kernel, scene, 2, behind);
+	CheckCoefficients(kernel, scene, 3, left);
+	CheckCoefficients(kernel, scene, 4, front);
+}
+
+TEST(SpatialKernel, PansMonoToCenter)
+{
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(0, 1) == true);
+
+	Scene scene(2, 1);
+	scene.SetPosition(0, 10.0f, 0.0f, 0.0f);
+	scene.SetPosition(1, 0.0f, 0.0f, -10.0f);
+
+	const float center[1] = { 1.0f };
+	CheckCoefficients(kernel, scene, 0, center);
+	CheckCoefficients(kernel, scene, 1, center);
+}
+
+TEST(SpatialKernel, CalculateMatchesReference)
+{
+	const int EmitterCount = 203;
+	Random random(7);
+
+	for (int channelCount = 1; channelCount <= SpatialKernel::MaxChannelCount; channelCount++)
+	{
+		SpatialKernel kernel;
+		if (kernel.SetSpeakers(0, channelCount) == false)
+		{
+			continue;
+		}
+
+		Scene scene(EmitterCount, channelCount);
+		scene.listener.position[0] = 3.0f;
+		scene.listener.velocity[0] = 5.0f;
+		// Facing down the x axis, tilted a little
+		const float front[3] = { 0.8f, 0.0f, 0.6f };
+		const float top[3] = { 0.0f, 1.0f, 0.0f };
+		for (int k = 0; k < 3; k++)
+		{
+			scene.listener.front[k] = front[k];
+			scene.listener.top[k] = top[k];
+		}
+
+		for (int i = 0; i < EmitterCount; i++)
+		{
+			scene.SetPosition(i, random.Next(-100, 100), random.Next(-100, 100), random.Next(-100, 100));
+			float x = random.Next(-1, 1);
+			float y = random.Next(-1, 1);
+			float z = random.Next(-1, 1);
+			float length = sqrtf(x * x + y * y + z * z);
+			if (length > 0)
+			{
+				scene.SetFront(i, x / length, y / length, z / length);
+			}
+			scene.SetVelocity(i, random.Next(-50, 50), random.Next(-50, 50), random.Next(-50, 50));
+			scene.SetDopplerScaler(i, random.Next(0, 2));
+		}
+		// One at the listener
+		scene.SetPosition(5, 3.0f, 0.0f, 0.0f);
+
+		std::vector<float> distances(EmitterCount);
+		std::vector<float> angles(EmitterCount);
+		std::vector<float> dopplers(EmitterCount);
+		std::vector<float> coefficients(EmitterCount * channelCount);
+		kernel.CalculateReference(scene.listener, scene.emitters, 0, EmitterCount, scene.out);
+		for (int i = 0; i < EmitterCount; i++)
+		{
+			distances[i] = scene.out.pDistance[i];
+			angles[i] = scene.out.pAngle[i];
+			dopplers[i] = scene.out.pDoppler[i];
+		}
+		for (int i = 0; i < EmitterCount * channelCount; i++)
+		{
+			coefficients[i] = scene.out.pCoefficients[i];
+		}
+
+		// Ranges not starting or ending on a multiple of four as well
+		const int ranges[][2] = { { 0, EmitterCount }, { 1, 2 }, { 3, 10 }, { 10, 13 }, { 17, 23 } };
+		for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+		{
+			int first = ranges[r][0];
+			int end = ranges[r][1];
+			kernel.Calculate(scene.listener, scene.emitters, first, end, scene.out);
+			for (int i = first; i < end; i++)
+			{
+				CHECK(IsNear(scene.out.pDistance[i], distances[i], distances[i] * Tolerance));
+				CHECK(IsNear(scene.out.pAngle[i], angles[i]));
+				CHECK(IsNear(scene.out.pDoppler[i], dopplers[i]));
+				for (int d = 0; d < channelCount; d++)
+				{
+					CHECK(IsNear(scene.out.pCoefficients[i * channelCount + d], coefficients[i * channelCount + d]));
+				}
+			}
+		}
+	}
+}
+
+#if defined(_WIN32)
+
+// Compares with X3DAudioCalculate for mono emitters without cones and with
+// flat distance curves, the part of it SpatialKernel replaces
+TEST(SpatialKernel, MatchesX3DAudio)
+{
+	const int EmitterCount = 64;
+	const int ChannelCount = 6;
+	const float SpeedOfSound = 343.5f;
+
+	SpatialKernel kernel;
+	REQUIRE(kernel.SetSpeakers(Surround, ChannelCount) == true);
+	kernel.SetSpeedOfSound(SpeedOfSound);
+
+	X3DAUDIO_HANDLE handle;
+	X3DAudioInitialize(Surround, SpeedOfSound, handle);
+
+	X3DAUDIO_DISTANCE_CURVE_POINT flatPoints[2] = { { 0.0f, 1.0f }, { 1.0f, 1.0f } };
+	X3DAUDIO_DISTANCE_CURVE flatCurve = { flatPoints, 2 };
+
+	Scene scene(EmitterCount, ChannelCount);
+	scene.listener.velocity[2] = 3.0f;
+	X3DAUDIO_LISTENER listener = {};
+	listener.OrientFront.z = 1.0f;
+	listener.OrientTop.y = 1.0f;
+	listener.Velocity.z = 3.0f;
+
+	Random random(11);
+	for (int i = 0; i < EmitterCount; i++)
+	{
+		scene.SetPosition(i, random.Next(-50, 50), random.Next(-5, 5), random.Next(-50, 50));
+		scene.SetVelocity(i, random.Next(-20, 20), 0.0f, random.Next(-20, 20));
+	}
+	kernel.CalculateReference(scene.listener, scene.emitters, 0, EmitterCount, scene.out);
+
+	for (int i = 0; i < EmitterCount; i++)
+	{
+		FLOAT32 azimuth = 0.0f;
+		X3DAUDIO_EMITTER emitter = {};
+		emitter.OrientFront.z = 1.0f;
+		emitter.OrientTop.y = 1.0f;
+		emitter.Position.x = scene.emitters.pPosition[0][i];
+		emitter.Position.y = scene.emitters.pPosition[1][i];
+		emitter.Position.z = scene.emitters.pPosition[2][i];
+		emitter.Velocity.x = scene.emitters.pVelocity[0][i];
+		emitter.Velocity.z = scene.emitters.pVelocity[2][i];
+		emitter.ChannelCount = 1;
+		emitter.pChannelAzimuths = &azimuth;
+		emitter.pVolumeCurve = &flatCurve;
+		emitter.pLFECurve = &flatCurve;
+		emitter.CurveDistanceScaler = 1.0f;
+		emitter.DopplerScaler = 1.0f;
+
+		FLOAT32 matrix[ChannelCount];
+		X3DAUDIO_DSP_SETTINGS settings = {};
+		settings.pMatrixCoefficients = matrix;
+		settings.SrcChannelCount = 1;
+		settings.DstChannelCount = ChannelCount;
+		X3DAudioCalculate(handle, &listener, &emitter,
+			X3DAUDIO_CALCULATE_MATRIX | X3DAUDIO_CALCULATE_DOPPLER | X3DAUDIO_CALCULATE_EMITTER_ANGLE, &settings);
+
+		CHECK(IsNear(scene.out.pDistance[i], settings.EmitterToListenerDistance, settings.EmitterToListenerDistance * 1e-3f));
+		CHECK(IsNear(scene.out.pAngle[i], settings.EmitterToListenerAngle, 1e-3f));
+		CHECK(IsNear(scene.out.pDoppler[i], settings.DopplerFactor, 1e-3f));
+		for (int d = 0; d < ChannelCount; d++)
+		{
+			CHECK(IsNear(scene.out.pCoefficients[i * ChannelCount + d], matrix[d], 0.02f));
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,332 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <string.h>
+
+#include <vector>
+
+#include "NativeTests.h"
+#include "NativeStreamScheduler.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	const uint32 BlockSize = 100;
+
+	// File contents the scheduler reads from, different at every offset
+	// within a few hundred bytes
+	class Disk
+	{
+		std::vector<uint8> data;
+
+	public:
+		explicit Disk(size_t size)
+			: data(size)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				data[i] = static_cast<uint8>(i * 7 + (i >> 8) + 3);
+			}
+		}
+
+		// Ends the read with up to maxBytes of it, as ReadFile would
+		void Read(StreamScheduler& scheduler, const StreamRead& read, int64 now, uint32 maxBytes = 0xFFFFFFFF)
+		{
+			uint32 length = read.length < maxBytes ? read.length : maxBytes;
+			memcpy(read.pBuffer, &data[static_cast<size_t>(read.offset)], length);
+			scheduler.EndRead(read, length, true, now);
+		}
+
+		// Whether buffer holds length bytes of the file from offset
+		bool Matches(const std::vector<uint8>& buffer, uint64 offset, uint32 length) const
+		{
+			return buffer.size() >= length &&
+				memcmp(&buffer[0], &data[static_cast<size_t>(offset)], length) == 0;
+		}
+	};
+
+	// A request buffer, its address is the context of the request
+	struct Request
+	{
+		std::vector<uint8> buffer;
+		StreamCompletion completion;
+		bool isCompleted;
+
+		Request()
+			: buffer(4 * BlockSize)
+			, isCompleted(false)
+		{}
+
+		StreamSubmitResult Submit(StreamScheduler& scheduler, uint32 stream, uint64 offset, uint32 length,
+			int64 now, uint32& bytesTransferred)
+		{
+			return scheduler.Submit(stream, offset, length, &buffer[0], this, now, bytesTransferred);
+		}
+	};
+
+	// Hands every completion to the request it belongs to
+	int PopAll(StreamScheduler& scheduler)
+	{
+		int count = 0;
+		StreamCompletion completion;
+		while (scheduler.PopCompleted(completion) == true)
+		{
+			Request* pRequest = static_cast<Request*>(completion.pContext);
+			pRequest->completion = completion;
+			pRequest->isCompleted = true;
+			count++;
+		}
+		return count;
+	}
+}
+
+TEST(StreamScheduler, ReadsEarliestDeadlineFirst)
+{
+	Disk disk(10000);
+	StreamScheduler scheduler;
+	uint32 first = scheduler.AddStream(10000, BlockSize, 0);
+	uint32 second = scheduler.AddStream(10000, BlockSize, 0);
+	REQUIRE(first != StreamScheduler::InvalidStream && second != StreamScheduler::InvalidStream);
+
+	// The stream added last asked first, so its data runs out first
+	Request late;
+	Request early;
+	uint32 bytesTransferred;
+	CHECK(early.Submit(scheduler, second, 5000, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	CHECK(late.Submit(scheduler, first, 0, BlockSize, 500, bytesTransferred) == StreamSubmitQueued);
+
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(600, read) == true);
+	CHECK(read.stream == second);
+	CHECK(read.offset == 5000);
+
+	// One read per window at a time
+	StreamRead other;
+	REQUIRE(scheduler.BeginRead(600, other) == true);
+	CHECK(other.stream == first);
+	CHECK(other.offset == 0);
+	StreamRead none;
+	CHECK(scheduler.BeginRead(600, none) == false);
+
+	disk.Read(scheduler, other, 700);
+	disk.Read(scheduler, read, 800);
+	CHECK(PopAll(scheduler) == 2);
+	CHECK(early.isCompleted == true && early.completion.succeeded == true);
+	CHECK(late.isCompleted == true && late.completion.succeeded == true);
+	CHECK(disk.Matches(early.buffer, 5000, BlockSize) == true);
+	CHECK(disk.Matches(late.buffer, 0, BlockSize) == true);
+	CHECK(scheduler.BeginRead(900, read) == false);
+}
+
+TEST(StreamScheduler, CoalescesSequentialRequests)
+{
+	Disk disk(10000);
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(10000, BlockSize, 2);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	Request requests[3];
+	uint32 bytesTransferred;
+	for (int i = 0; i < 3; i++)
+	{
+		CHECK(requests[i].Submit(scheduler, stream, i * BlockSize, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	}
+
+	// One read for all three, the prefetch depth covers the rest
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(0, read) == true);
+	CHECK(read.offset == 0);
+	CHECK(read.length == 3 * BlockSize);
+	disk.Read(scheduler, read, 100);
+
+	CHECK(PopAll(scheduler) == 3);
+	for (int i = 0; i < 3; i++)
+	{
+		CHECK(requests[i].isCompleted == true);
+		CHECK(requests[i].completion.succeeded == true);
+		CHECK(requests[i].completion.bytesTransferred == BlockSize);
+		CHECK(disk.Matches(requests[i].buffer, i * BlockSize, BlockSize) == true);
+	}
+
+	const StreamStatistics& statistics = scheduler.GetStatistics(stream);
+	CHECK(statistics.requests == 3);
+	CHECK(statistics.reads == 1);
+	CHECK(statistics.bytesRead == 3 * BlockSize);
+	CHECK(statistics.prefetchHits == 0);
+}
+
+TEST(StreamScheduler, ServesPrefetchedData)
+{
+	Disk disk(10000);
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(10000, BlockSize, 3);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	Request first;
+	uint32 bytesTransferred;
+	CHECK(first.Submit(scheduler, stream, 0, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(0, read) == true);
+	CHECK(read.length == 4 * BlockSize);
+	disk.Read(scheduler, read, 100);
+	CHECK(PopAll(scheduler) == 1);
+
+	// The blocks read ahead complete without waiting
+	for (uint32 i = 1; i < 4; i++)
+	{
+		Request next;
+		bytesTransferred = 0;
+		CHECK(next.Submit(scheduler, stream, i * BlockSize, BlockSize, i * 10000, bytesTransferred) == StreamSubmitCompleted);
+		CHECK(bytesTransferred == BlockSize);
+		CHECK(disk.Matches(next.buffer, i * BlockSize, BlockSize) == true);
+	}
+	CHECK(PopAll(scheduler) == 0);
+
+	// Past the window, read ahead once the consumed data is dropped
+	Request past;
+	CHECK(past.Submit(scheduler, stream, 4 * BlockSize, BlockSize, 40000, bytesTransferred) == StreamSubmitQueued);
+	REQUIRE(scheduler.BeginRead(40000, read) == true);
+	CHECK(read.offset == 4 * BlockSize);
+	disk.Read(scheduler, read, 40100);
+	CHECK(PopAll(scheduler) == 1);
+	CHECK(disk.Matches(past.buffer, 4 * BlockSize, BlockSize) == true);
+
+	const StreamStatistics& statistics = scheduler.GetStatistics(stream);
+	CHECK(statistics.prefetchHits == 3);
+	CHECK(statistics.reads == 2);
+	CHECK(scheduler.GetTotalStatistics().prefetchHits == 3);
+}
+
+TEST(StreamScheduler, EndsAtEndOfFile)
+{
+	Disk disk(250);
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(250, BlockSize, 1);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	// At or past the end succeeds with no data
+	Request past;
+	uint32 bytesTransferred = 1;
+	CHECK(past.Submit(scheduler, stream, 250, BlockSize, 0, bytesTransferred) == StreamSubmitCompleted);
+	CHECK(bytesTransferred == 0);
+
+	// The read stops at the end, the request gets what there is
+	Request last;
+	CHECK(last.Submit(scheduler, stream, 200, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(0, read) == true);
+	CHECK(read.offset == 200);
+	CHECK(read.length == 50);
+	disk.Read(scheduler, read, 100);
+
+	CHECK(PopAll(scheduler) == 1);
+	CHECK(last.completion.succeeded == true);
+	CHECK(last.completion.bytesTransferred == 50);
+	CHECK(disk.Matches(last.buffer, 200, 50) == true);
+	CHECK(scheduler.BeginRead(200, read) == false);
+}
+
+TEST(StreamScheduler, ShortReadMovesEndOfFile)
+{
+	Disk disk(1000);
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(1000, BlockSize, 0);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	Request requests[2];
+	uint32 bytesTransferred;
+	CHECK(requests[0].Submit(scheduler, stream, 0, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	CHECK(requests[1].Submit(scheduler, stream, BlockSize, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+
+	// The file got shorter than the stream was added with
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(0, read) == true);
+	CHECK(read.length == 2 * BlockSize);
+	disk.Read(scheduler, read, 100, 60);
+
+	CHECK(PopAll(scheduler) == 1);
+	CHECK(requests[0].completion.succeeded == true);
+	CHECK(requests[0].completion.bytesTransferred == 60);
+	CHECK(disk.Matches(requests[0].buffer, 0, 60) == true);
+
+	// Past the new end, completed by BeginRead without a read
+	CHECK(scheduler.BeginRead(200, read) == false);
+	CHECK(PopAll(scheduler) == 1);
+	CHECK(requests[1].completion.succeeded == true);
+	CHECK(requests[1].completion.bytesTransferred == 0);
+
+	Request later;
+	CHECK(later.Submit(scheduler, stream, 60, BlockSize, 300, bytesTransferred) == StreamSubmitCompleted);
+	CHECK(bytesTransferred == 0);
+}
+
+TEST(StreamScheduler, FailedReadFailsItsRequests)
+{
+	Disk disk(10000);
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(10000, BlockSize, 0);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	// Two runs far apart, in windows of their own
+	Request failing[2];
+	Request other;
+	uint32 bytesTransferred;
+	CHECK(failing[0].Submit(scheduler, stream, 0, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	CHECK(failing[1].Submit(scheduler, stream, BlockSize, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	CHECK(other.Submit(scheduler, stream, 5000, BlockSize, 500, bytesTransferred) == StreamSubmitQueued);
+
+	StreamRead read;
+	REQUIRE(scheduler.BeginRead(0, read) == true);
+	CHECK(read.offset == 0);
+	CHECK(scheduler.IsReading(stream) == true);
+	scheduler.EndRead(read, 0, false, 100);
+
+	CHECK(PopAll(scheduler) == 2);
+	for (int i = 0; i < 2; i++)
+	{
+		CHECK(failing[i].isCompleted == true);
+		CHECK(failing[i].completion.succeeded == false);
+		CHECK(failing[i].completion.bytesTransferred == 0);
+	}
+	CHECK(other.isCompleted == false);
+
+	// Nothing is kept of the failed read, the next request reads again
+	Request retry;
+	CHECK(retry.Submit(scheduler, stream, 0, BlockSize, 200, bytesTransferred) == StreamSubmitQueued);
+	int reads = 0;
+	while (scheduler.BeginRead(300, read) == true)
+	{
+		disk.Read(scheduler, read, 400);
+		reads++;
+	}
+	CHECK(reads == 2);
+	CHECK(PopAll(scheduler) == 2);
+	CHECK(retry.completion.succeeded == true);
+	CHECK(disk.Matches(retry.buffer, 0, BlockSize) == true);
+	CHECK(other.completion.succeeded == true);
+	CHECK(disk.Matches(other.buffer, 5000, BlockSize) == true);
+}
+
+TEST(StreamScheduler, RemoveStreamFailsPendingRequests)
+{
+	StreamScheduler scheduler;
+	uint32 stream = scheduler.AddStream(10000, BlockSize, 1);
+	REQUIRE(stream != StreamScheduler::InvalidStream);
+
+	Request pending;
+	uint32 bytesTransferred;
+	CHECK(pending.Submit(scheduler, stream, 0, BlockSize, 0, bytesTransferred) == StreamSubmitQueued);
+	scheduler.RemoveStream(stream);
+
+	CHECK(PopAll(scheduler) == 1);
+	CHECK(pending.completion.succeeded == false);
+	StreamRead read;
+	CHECK(scheduler.BeginRead(100, read) == false);
+	CHECK(pending.Submit(scheduler, stream, 0, BlockSize, 200, bytesTransferred) == StreamSubmitFailed);
+}
@@ -0,0 +1,429 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#include <string.h>
+
+#include "NativeTests.h"
+#include "NativeWaveBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+using namespace NativeTests;
+
+namespace
+{
+	uint32 PackFormat(uint32 formatTag, uint32 channels, uint32 samplesPerSec, uint32 blockAlign, uint32 bitsPerSample)
+	{
+		return formatTag | (channels << 2) | (samplesPerSec << 5) | (blockAlign << 23) | (bitsPerSample << 31);
+	}
+
+	// Writes wave banks in the layout of xact3wb.h: the header, the bank
+	// data, the entry metadata, the entry names and the wave data, in that
+	// order, without seek tables
+	class WaveBankBuilder
+	{
+		std::vector<uint8> data;
+
+		void Put32(size_t offset, uint32 value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int shift = bigEndian == true ? (3 - i) * 8 : i * 8;
+				data[offset + i] = static_cast<uint8>(value >> shift);
+			}
+		}
+
+		void Put64(size_t offset, uint64 value)
+		{
+			Put32(offset + (bigEndian == true ? 4 : 0), static_cast<uint32>(value));
+			Put32(offset + (bigEndian == true ? 0 : 4), static_cast<uint32>(value >> 32));
+		}
+
+		static uint32 Align(uint32 value, uint32 alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+	public:
+		struct Entry
+		{
+			uint32 flags;
+			uint32 duration;
+			uint32 format;
+			uint32 length;
+			uint32 loopStart;
+			uint32 loopLength;
+			const char* name;
+		};
+
+		bool bigEndian;
+		bool compact;
+		bool names;
+		uint32 alignment;
+		uint32 compactFormat;
+		std::vector<Entry> entries;
+
+		WaveBankBuilder()
+			: bigEndian(false)
+			, compact(false)
+			, names(true)
+			, alignment(2048)
+			, compactFormat(0)
+		{}
+
+		void Add(uint32 flags, uint32 duration, uint32 format, uint32 length, uint32 loopStart, uint32 loopLength, const char* name)
+		{
+			Entry entry = { flags, duration, format, length, loopStart, loopLength, name };
+			entries.push_back(entry);
+		}
+
+		std::vector<uint8> Build()
+		{
+			const uint32 HeaderSize = 52;
+			const uint32 BankDataSize = 96;
+			const uint32 NameSize = 64;
+			uint32 count = static_cast<uint32>(entries.size());
+			uint32 metaDataSize = compact == true ? 4 : 24;
+
+			uint32 metaDataOffset = HeaderSize + BankDataSize;
+			uint32 namesOffset = metaDataOffset + count * metaDataSize;
+			uint32 namesLength = names == true ? count * NameSize : 0;
+			uint32 waveDataOffset = Align(namesOffset + namesLength, alignment);
+
+			std::vector<uint32> offsets;
+			uint32 waveDataLength = 0;
+			for (uint32 i = 0; i < count; i++)
+			{
+				offsets.push_back(waveDataLength);
+				waveDataLength = Align(waveDataLength + entries[i].length, alignment);
+			}
+
+			data.assign(waveDataOffset + waveDataLength, 0);
+			memcpy(&data[0], bigEndian == true ? "DNBW" : "WBND", 4);
+			Put32(4, 46);
+			Put32(8, WaveBankFile::HeaderVersion);
+			uint32 segments[WaveBankSegmentCount][2] =
+			{
+				{ HeaderSize, BankDataSize },
+				{ metaDataOffset, count * metaDataSize },
+				{ namesOffset, 0 },
+				{ namesOffset, namesLength },
+				{ waveDataOffset, waveDataLength },
+			};
+			for (int i = 0; i < WaveBankSegmentCount; i++)
+			{
+				Put32(12 + i * 8, segments[i][0]);
+				Put32(16 + i * 8, segments[i][1]);
+			}
+
+			uint32 flags = (names == true ? WaveBankFile::BankFlagEntryNames : 0) |
+				(compact == true ? WaveBankFile::BankFlagCompact : 0);
+			Put32(HeaderSize, flags);
+			Put32(HeaderSize + 4, count);
+			strcpy(reinterpret_cast<char*>(&data[HeaderSize + 8]), "TestBank");
+			Put32(HeaderSize + 72, metaDataSize);
+			Put32(HeaderSize + 76, names == true ? NameSize : 0);
+			Put32(HeaderSize + 80, alignment);
+			Put32(HeaderSize + 84, compactFormat);
+			Put64(HeaderSize + 88, 0x0123456789ABCDEFULL);
+
+			for (uint32 i = 0; i < count; i++)
+			{
+				const Entry& entry = entries[i];
+				size_t offset = metaDataOffset + i * metaDataSize;
+				if (compact == true)
+				{
+					uint32 deviation = Align(entry.length, alignment) - entry.length;
+					Put32(offset, (offsets[i] / alignment) | (deviation << 21));
+				}
+				else
+				{
+					Put32(offset, entry.flags | (entry.duration << 4));
+					Put32(offset + 4, entry.format);
+					Put32(offset + 8, offsets[i]);
+					Put32(offset + 12, entry.length);
+					Put32(offset + 16, entry.loopStart);
+					Put32(offset + 20, entry.loopLength);
+				}
+				if (names == true)
+				{
+					strncpy(reinterpret_cast<char*>(&data[namesOffset + i * NameSize]), entry.name, NameSize);
+				}
+				for (uint32 j = 0; j < entry.length; j++)
+				{
+					data[waveDataOffset + offsets[i] + j] = static_cast<uint8>(i + 1);
+				}
+			}
+			return data;
+		}
+	};
+
+	void AddStandardEntries(WaveBankBuilder& builder)
+	{
+		builder.Add(WaveBankFile::EntryFlagReadAhead, 1000, PackFormat(WaveBankFormatPcm, 2, 44100, 4, 1), 4000, 100, 500, "stereo");
+		builder.Add(0, 512, PackFormat(WaveBankFormatAdpcm, 1, 22050, 14, 0), 288, 0, 0, "adpcm");
+		builder.Add(WaveBankFile::EntryFlagIgnoreLoop, 44100, PackFormat(WaveBankFormatWma, 2, 48000, 1 | (2 << 5), 0), 5000, 0, 0,
+			"a name that is exactly sixty-four characters long, no terminator");
+	}
+
+	void CheckStandardEntries(const WaveBankFile& file)
+	{
+		REQUIRE(file.GetEntryCount() == 3);
+		uint32 waveData = file.GetSegment(WaveBankSegmentEntryWaveData).offset;
+
+		const WaveBankEntry& stereo = file.GetEntry(0);
+		CHECK(stereo.flags == WaveBankFile::EntryFlagReadAhead);
+		CHECK(stereo.duration == 1000);
+		CHECK(stereo.format.formatTag == WaveBankFormatPcm);
+		CHECK(stereo.format.channels == 2);
+		CHECK(stereo.format.samplesPerSec == 44100);
+		CHECK(stereo.format.bitsPerSample == 16);
+		CHECK(stereo.format.blockAlign == 4);
+		CHECK(stereo.format.avgBytesPerSec == 176400);
+		CHECK(stereo.playOffset == waveData);
+		CHECK(stereo.playLength == 4000);
+		CHECK(stereo.loopStart == 100);
+		CHECK(stereo.loopLength == 500);
+
+		const WaveBankEntry& adpcm = file.GetEntry(1);
+		CHECK(adpcm.format.formatTag == WaveBankFormatAdpcm);
+		CHECK(adpcm.format.channels == 1);
+		// Stored with the offset of 22 the format removes
+		CHECK(adpcm.format.blockAlign == 36);
+		CHECK(adpcm.format.bitsPerSample == 4);
+		CHECK(adpcm.playOffset == waveData + 4096);
+		CHECK(adpcm.playLength == 288);
+
+		const WaveBankEntry& wma = file.GetEntry(2);
+		CHECK(wma.flags == WaveBankFile::EntryFlagIgnoreLoop);
+		CHECK(wma.format.formatTag == WaveBankFormatWma);
+		CHECK(wma.format.blockAlign == 1487);
+		CHECK(wma.format.avgBytesPerSec == 4000);
+		CHECK(wma.playOffset == waveData + 6144);
+
+		CHECK(strcmp(file.GetEntryName(0), "stereo") == 0);
+		CHECK(strcmp(file.GetEntryName(2), "a name that is exactly sixty-four characters long, no terminator") == 0);
+		CHECK(file.GetEntryName(3) == NULL);
+		CHECK(file.FindEntry("adpcm") == 1);
+		CHECK(file.FindEntry("missing") == WaveBankFile::InvalidIndex);
+	}
+
+	// Expected contents of the banks Sample.xap builds, from its wav files
+	struct SampleWave
+	{
+		const char* name;
+		uint16 channels;
+		uint32 samples;
+	};
+
+	const SampleWave InMemoryWaves[] =
+	{
+		{ "zap", 2, 224768 / 4 },
+	};
+
+	const SampleWave StreamingWaves[] =
+	{
+		{ "rev", 1, 514174 / 2 },
+		{ "song1", 1, 1713906 / 2 },
+		{ "song2", 1, 783768 / 2 },
+		{ "song3", 2, 1557848 / 4 },
+	};
+
+	void CheckSampleBank(const char* fileName, const SampleWave* pWaves, uint32 waveCount,
+		WaveBankFormatTag formatTag, bool isStreaming)
+	{
+		std::vector<unsigned char> data;
+		REQUIRE(ReadFile(GetContentDirectory() + "/" + fileName, data) == true);
+
+		WaveBankFile file;
+		REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+		CHECK(file.IsStreaming() == isStreaming);
+		REQUIRE(file.GetEntryCount() == waveCount);
+
+		BankRegion waveData = file.GetSegment(WaveBankSegmentEntryWaveData);
+		for (uint32 i = 0; i < waveCount; i++)
+		{
+			const WaveBankEntry& entry = file.GetEntry(i);
+			CHECK(entry.format.formatTag == formatTag);
+			CHECK(entry.format.channels == pWaves[i].channels);
+			CHECK(entry.format.samplesPerSec == 44100);
+			if (formatTag == WaveBankFormatPcm)
+			{
+				CHECK(entry.duration == pWaves[i].samples);
+			}
+			else
+			{
+				// Compressed waves may be padded to whole blocks
+				CHECK(entry.duration + 512 > pWaves[i].samples && entry.duration < pWaves[i].samples + 512);
+			}
+			CHECK(entry.playOffset >= waveData.offset);
+			CHECK(entry.playOffset + entry.playLength <= waveData.offset + waveData.length);
+			if (file.GetEntryName(i) != NULL)
+			{
+				CHECK(strcmp(file.GetEntryName(i), pWaves[i].name) == 0);
+			}
+		}
+	}
+}
+
+TEST(WaveBankFile, ParsesStandardBank)
+{
+	WaveBankBuilder builder;
+	AddStandardEntries(builder);
+	std::vector<uint8> data = builder.Build();
+
+	WaveBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CHECK(file.GetContentVersion() == 46);
+	CHECK(file.GetHeaderVersion() == WaveBankFile::HeaderVersion);
+	CHECK(file.IsStreaming() == false);
+	CHECK(file.GetAlignment() == 2048);
+	CHECK(file.GetBuildTime() == 0x0123456789ABCDEFULL);
+	CHECK(strcmp(file.GetName(), "TestBank") == 0);
+	CheckStandardEntries(file);
+}
+
+TEST(WaveBankFile, ParsesByteSwappedBank)
+{
+	WaveBankBuilder builder;
+	builder.bigEndian = true;
+	AddStandardEntries(builder);
+	std::vector<uint8> data = builder.Build();
+
+	WaveBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	CHECK(file.GetBuildTime() == 0x0123456789ABCDEFULL);
+	CheckStandardEntries(file);
+}
+
+TEST(WaveBankFile, ParsesCompactBank)
+{
+	WaveBankBuilder builder;
+	builder.compact = true;
+	builder.names = false;
+	builder.alignment = 512;
+	builder.compactFormat = PackFormat(WaveBankFormatPcm, 1, 22050, 2, 1);
+	builder.Add(0, 0, 0, 1000, 0, 0, "");
+	builder.Add(0, 0, 0, 512, 0, 0, "");
+	builder.Add(0, 0, 0, 3, 0, 0, "");
+	std::vector<uint8> data = builder.Build();
+
+	WaveBankFile file;
+	REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+	REQUIRE(file.GetEntryCount() == 3);
+	uint32 waveData = file.GetSegment(WaveBankSegmentEntryWaveData).offset;
+
+	const uint32 offsets[] = { 0, 1024, 1536 };
+	const uint32 lengths[] = { 1000, 512, 3 };
+	for (uint32 i = 0; i < 3; i++)
+	{
+		const WaveBankEntry& entry = file.GetEntry(i);
+		CHECK(entry.format.channels == 1);
+		CHECK(entry.format.samplesPerSec == 22050);
+		CHECK(entry.playOffset == waveData + offsets[i]);
+		CHECK(entry.playLength == lengths[i]);
+		// Derived from the length, as compact entries do not store it
+		CHECK(entry.duration == lengths[i] / 2);
+		CHECK(data[entry.playOffset] == i + 1);
+	}
+
+	CHECK(file.GetEntryName(0) == NULL);
+	CHECK(file.FindEntry("") == WaveBankFile::InvalidIndex);
+}
+
+TEST(WaveBankFile, RejectsOtherFiles)
+{
+	WaveBankBuilder builder;
+	AddStandardEntries(builder);
+	std::vector<uint8> data = builder.Build();
+	WaveBankFile file;
+
+	std::vector<uint8> wrongSignature = data;
+	memcpy(&wrongSignature[0], "SDBK", 4);
+	CHECK(file.Parse(&wrongSignature[0], wrongSignature.size()) == BankParseInvalidSignature);
+
+	std::vector<uint8> wrongVersion = data;
+	wrongVersion[8] = 43;
+	CHECK(file.Parse(&wrongVersion[0], wrongVersion.size()) == BankParseUnsupportedVersion);
+
+	CHECK(file.Parse(&data[0], 3) == BankParseInvalidSignature);
+	CHECK(file.GetEntryCount() == 0);
+}
+
+TEST(WaveBankFile, RejectsTruncatedBanks)
+{
+	WaveBankBuilder builder;
+	AddStandardEntries(builder);
+	std::vector<uint8> data = builder.Build();
+	uint32 tablesEnd = 0;
+	{
+		WaveBankFile file;
+		REQUIRE(file.Parse(&data[0], data.size()) == BankParseOk);
+		BankRegion names = file.GetSegment(WaveBankSegmentEntryNames);
+		tablesEnd = names.offset + names.length;
+	}
+
+	// Every table must lie inside the data. Only the wave data may be left
+	// out, as with the header of a streaming bank.
+	for (size_t size = 4; size < data.size(); size++)
+	{
+		std::vector<uint8> truncated(data.begin(), data.begin() + size);
+		WaveBankFile file;
+		BankParseResult result = file.Parse(&truncated[0], truncated.size());
+		if (size < tablesEnd)
+		{
+			CHECK(result == BankParseTruncated);
+		}
+		else
+		{
+			CHECK(result == BankParseOk);
+		}
+	}
+
+	// Counts past the tables
+	std::vector<uint8> tooManyEntries = data;
+	tooManyEntries[52 + 4] = 4;
+	WaveBankFile file;
+	CHECK(file.Parse(&tooManyEntries[0], tooManyEntries.size()) == BankParseTruncated);
+}
+
+TEST(WaveBankFile, UnpacksFormats)
+{
+	WaveBankFormat format;
+
+	WaveBankFile::UnpackFormat(PackFormat(WaveBankFormatPcm, 1, 8000, 1, 0), format);
+	CHECK(format.bitsPerSample == 8);
+	CHECK(format.avgBytesPerSec == 8000);
+
+	WaveBankFile::UnpackFormat(PackFormat(WaveBankFormatXma, 6, 48000, 0, 0), format);
+	CHECK(format.formatTag == WaveBankFormatXma);
+	CHECK(format.channels == 6);
+	CHECK(format.blockAlign == 12);
+
+	// 70 + 22 bytes per channel and block, (184 - 7 * 2) * 8 / (4 * 2) + 2
+	// samples per block
+	WaveBankFile::UnpackFormat(PackFormat(WaveBankFormatAdpcm, 2, 44100, 70, 0), format);
+	CHECK(format.blockAlign == 184);
+	CHECK(format.avgBytesPerSec == 184 * 44100 / 172);
+
+	// Indices past the tables
+	WaveBankFile::UnpackFormat(PackFormat(WaveBankFormatWma, 2, 44100, 31 | (7 << 5), 0), format);
+	CHECK(format.blockAlign == 0);
+	CHECK(format.avgBytesPerSec == 0);
+}
+
+TEST(WaveBankFile, ParsesSampleBanks)
+{
+	if (GetContentDirectory().empty() == true)
+	{
+		return;
+	}
+
+	// Sample.xap keeps the in-memory bank PCM and compresses the streaming
+	// bank with ADPCM
+	CheckSampleBank("InMemoryWaveBank.xwb", InMemoryWaves, 1, WaveBankFormatPcm, false);
+	CheckSampleBank("StreamingWaveBank.xwb", StreamingWaves, 4, WaveBankFormatAdpcm, true);
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using System.Diagnostics;
+using Bnoerj.Audio;
+using Microsoft.Xna.Framework;
+
+namespace Sample
+{
+	/// <summary>
+	/// Creates and disposes cues at a fixed rate and reports the time spent
+	/// per cue and the garbage collections since the start.
+	/// </summary>
+	class CueChurnBenchmark
+	{
+		const int CuesPerSecond = 10000;
+
+		SoundBank soundBank;
+		string cueName;
+		Stopwatch stopwatch = new Stopwatch();
+		double pendingCues;
+		long cueCount;
+		int startCollections;
+		bool isRunning;
+
+		public CueChurnBenchmark(SoundBank soundBank, string cueName)
+		{
+			this.soundBank = soundBank;
+			this.cueName = cueName;
+		}
+
+		public bool IsRunning
+		{
+			get { return isRunning; }
+		}
+
+		public void Start()
+		{
+			pendingCues = 0;
+			cueCount = 0;
+			startCollections = GC.CollectionCount(0);
+			stopwatch.Reset();
+			isRunning = true;
+		}
+
+		public void Stop()
+		{
+			isRunning = false;
+		}
+
+		public void Update(GameTime gameTime)
+		{
+			if (isRunning == false)
+			{
+				return;
+			}
+
+			pendingCues += gameTime.ElapsedRealTime.TotalSeconds * CuesPerSecond;
+
+			stopwatch.Start();
+			while (pendingCues >= 1)
+			{
+				Cue cue = soundBank.GetCue(cueName);
+				cue.Dispose();
+				pendingCues -= 1;
+				cueCount++;
+			}
+			stopwatch.Stop();
+		}
+
+		public override string ToString()
+		{
+			double microseconds = cueCount > 0 ? stopwatch.Elapsed.TotalMilliseconds * 1000 / cueCount : 0;
+			return String.Format("{0} cues, {1:F2} us per cue, {2} gen 0 collections",
+				cueCount, microseconds, GC.CollectionCount(0) - startCollections);
+		}
+	}
+}
+#endif
@@ -1,121 +1,156 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-using System;
-using System.Collections.Generic;
-using Microsoft.Xna.Framework;
-#if XBOX
-using Microsoft.Xna.Framework.Audio;
-#else
-using Bnoerj.Audio;
-#endif
-using Microsoft.Xna.Framework.Content;
-using Microsoft.Xna.Framework.Graphics;
-using Microsoft.Xna.Framework.Input;
-
-namespace Sample
-{
-	/// <summary>
-	/// This is the main type for your game
-	/// </summary>
-	public class Game1 : Microsoft.Xna.Framework.Game
-	{
-		GraphicsDeviceManager graphics;
-		SpriteBatch spriteBatch;
-
-		AudioEngine engine;
-		WaveBank inMemoryWaveBank;
-		WaveBank streamingWaveBank;
-		SoundBank soundBank;
-		Cue cue;
-
-		public Game1()
-		{
-			graphics = new GraphicsDeviceManager(this);
-			Content.RootDirectory = "Content";
-		}
-
-		/// <summary>
-		/// Allows the game to perform any initialization it needs to before starting to run.
-		/// This is where it can query for any required services and load any non-graphic
-		/// related content.  Calling base.Initialize will enumerate through any components
-		/// and initialize them as well.
-		/// </summary>
-		protected override void Initialize()
-		{
-			// TODO: Add your initialization logic here
-
-			base.Initialize();
-		}
-
-		/// <summary>
-		/// LoadContent will be called once per game and is the place to load
-		/// all of your content.
-		/// </summary>
-		protected override void LoadContent()
-		{
-			// Create a new SpriteBatch, which can be used to draw textures.
-			spriteBatch = new SpriteBatch(GraphicsDevice);
-
-			engine = new AudioEngine("Content/Sample.xgs");
-			inMemoryWaveBank = new WaveBank(engine, "Content/InMemoryWaveBank.xwb");
-			streamingWaveBank = new WaveBank(engine, "Content/StreamingWaveBank.xwb", 0, 64);
-			soundBank = new SoundBank(engine, "Content/Sounds.xsb");
-		}
-
-		/// <summary>
-		/// UnloadContent will be called once per game and is the place to unload
-		/// all content.
-		/// </summary>
-		protected override void UnloadContent()
-		{
-			// TODO: Unload any non ContentManager content here
-		}
-
-		/// <summary>
-		/// Allows the game to run logic such as updating the world,
-		/// checking for collisions, gathering input, and playing audio.
-		/// </summary>
-		/// <param name="gameTime">Provides a snapshot of timing values.</param>
-		protected override void Update(GameTime gameTime)
-		{
-			// Allows the game to exit
-			if (Keyboard.GetState().IsKeyDown(Keys.Escape) == true ||
-				GamePad.GetState(PlayerIndex.One).Buttons.Back == ButtonState.Pressed)
-			{
-				this.Exit();
-			}
-
-			if (streamingWaveBank.IsPrepared == true && cue == null)
-			{
-				cue = soundBank.GetCue("song1");
-			}
-
-			if (cue != null && cue.IsPlaying == false && cue.IsStopped == false)
-			{
-				cue.Play();
-			}
-
-			engine.Update();
-
-			base.Update(gameTime);
-		}
-
-		/// <summary>
-		/// This is called when the game should draw itself.
-		/// </summary>
-		/// <param name="gameTime">Provides a snapshot of timing values.</param>
-		protected override void Draw(GameTime gameTime)
-		{
-			graphics.GraphicsDevice.Clear(Color.CornflowerBlue);
-
-			// TODO: Add your drawing code here
-
-			base.Draw(gameTime);
-		}
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+using System;
+using System.Collections.Generic;
+using Microsoft.Xna.Framework;
+#if XBOX
+using Microsoft.Xna.Framework.Audio;
+#else
+using Bnoerj.Audio;
+#endif
+using Microsoft.Xna.Framework.Content;
+using Microsoft.Xna.Framework.Graphics;
+using Microsoft.Xna.Framework.Input;
+
+namespace Sample
+{
+	/// <summary>
+	/// This is the main type for your game
+	/// </summary>
+	public class Game1 : Microsoft.Xna.Framework.Game
+	{
+		GraphicsDeviceManager graphics;
+		SpriteBatch spriteBatch;
+
+		AudioEngine engine;
+		WaveBank inMemoryWaveBank;
+		WaveBank streamingWaveBank;
+		SoundBank soundBank;
+		Cue cue;
+#if !XBOX
+		CueChurnBenchmark cueChurn;
+		PlayCueBenchmark playCue;
+		KeyboardState lastKeyboardState;
+#endif
+
+		public Game1()
+		{
+			graphics = new GraphicsDeviceManager(this);
+			Content.RootDirectory = "Content";
+		}
+
+		/// <summary>
+		/// Allows the game to perform any initialization it needs to before starting to run.
+		/// This is where it can query for any required services and load any non-graphic
+		/// related content.  Calling base.Initialize will enumerate through any components
+		/// and initialize them as well.
+		/// </summary>
+		protected override void Initialize()
+		{
+			// TODO: Add your initialization logic here
+
+			base.Initialize();
+		}
+
+		/// <summary>
+		/// LoadContent will be called once per game and is the place to load
+		/// all of your content.
+		/// </summary>
+		protected override void LoadContent()
+		{
+			// Create a new SpriteBatch, which can be used to draw textures.
+			spriteBatch = new SpriteBatch(GraphicsDevice);
+
+			engine = new AudioEngine("Content/Sample.xgs");
+			inMemoryWaveBank = new WaveBank(engine, "Content/InMemoryWaveBank.xwb");
+			streamingWaveBank = new WaveBank(engine, "Content/StreamingWaveBank.xwb", 0, 64);
+			soundBank = new SoundBank(engine, "Content/Sounds.xsb");
+#if !XBOX
+			cueChurn = new CueChurnBenchmark(soundBank, "zap");
+			playCue = new PlayCueBenchmark(engine, soundBank, "zap");
+#endif
+		}
+
+		/// <summary>
+		/// UnloadContent will be called once per game and is the place to unload
+		/// all content.
+		/// </summary>
+		protected override void UnloadContent()
+		{
+			// TODO: Unload any non ContentManager content here
+		}
+
+		/// <summary>
+		/// Allows the game to run logic such as updating the world,
+		/// checking for collisions, gathering input, and playing audio.
+		/// </summary>
+		/// <param name="gameTime">Provides a snapshot of timing values.</param>
+		protected override void Update(GameTime gameTime)
+		{
+			// Allows the game to exit
+			if (Keyboard.GetState().IsKeyDown(Keys.Escape) == true ||
+				GamePad.GetState(PlayerIndex.One).Buttons.Back == ButtonState.Pressed)
+			{
+				this.Exit();
+			}
+
+			if (streamingWaveBank.IsPrepared == true && cue == null)
+			{
+				cue = soundBank.GetCue("song1");
+			}
+
+			if (cue != null && cue.IsPlaying == false && cue.IsStopped == false)
+			{
+				cue.Play();
+			}
+
+#if !XBOX
+			// B starts and stops the cue churn benchmark
+			KeyboardState keyboardState = Keyboard.GetState();
+			if (keyboardState.IsKeyDown(Keys.B) == true && lastKeyboardState.IsKeyDown(Keys.B) == false)
+			{
+				if (cueChurn.IsRunning == true)
+				{
+					cueChurn.Stop();
+				}
+				else
+				{
+					cueChurn.Start();
+				}
+			}
+
+			// P plays a cue by name and by handle and shows the plays per second
+			if (keyboardState.IsKeyDown(Keys.P) == true && lastKeyboardState.IsKeyDown(Keys.P) == false)
+			{
+				playCue.Run();
+			}
+			lastKeyboardState = keyboardState;
+
+			cueChurn.Update(gameTime);
+			Window.Title = cueChurn.ToString() + "  " + playCue.ToString();
+#endif
+
+			engine.Update();
+
+			base.Update(gameTime);
+		}
+
+		/// <summary>
+		/// This is called when the game should draw itself.
+		/// </summary>
+		/// <param name="gameTime">Provides a snapshot of timing values.</param>
+		protected override void Draw(GameTime gameTime)
+		{
+			graphics.GraphicsDevice.Clear(Color.CornflowerBlue);
+
+			// TODO: Add your drawing code here
+
+			base.Draw(gameTime);
+		}
+	}
+}
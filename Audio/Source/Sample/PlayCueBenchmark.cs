@@ -0,0 +1,82 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using System.Diagnostics;
+using Bnoerj.Audio;
+
+namespace Sample
+{
+	/// <summary>
+	/// Plays a cue a number of times by name and the same number of times by
+	/// CueHandle and reports the plays per second of both paths.
+	/// </summary>
+	class PlayCueBenchmark
+	{
+		const int PlayCount = 10000;
+		// Plays between engine updates, so XACT retires finished cues
+		const int PlaysPerUpdate = 100;
+
+		AudioEngine engine;
+		SoundBank soundBank;
+		string cueName;
+		double namePlaysPerSecond;
+		double handlePlaysPerSecond;
+
+		public PlayCueBenchmark(AudioEngine engine, SoundBank soundBank, string cueName)
+		{
+			this.engine = engine;
+			this.soundBank = soundBank;
+			this.cueName = cueName;
+		}
+
+		public void Run()
+		{
+			CueHandle handle = soundBank.GetCueHandle(cueName);
+
+			// Warm up both paths, the name table and the JIT
+			soundBank.PlayCue(cueName);
+			soundBank.PlayCue(handle);
+			engine.Update();
+
+			namePlaysPerSecond = Measure(delegate { soundBank.PlayCue(cueName); });
+			handlePlaysPerSecond = Measure(delegate { soundBank.PlayCue(handle); });
+		}
+
+		delegate void PlayMethod();
+
+		double Measure(PlayMethod play)
+		{
+			Stopwatch stopwatch = new Stopwatch();
+			for (int i = 0; i < PlayCount; i += PlaysPerUpdate)
+			{
+				stopwatch.Start();
+				for (int j = 0; j < PlaysPerUpdate; j++)
+				{
+					play();
+				}
+				stopwatch.Stop();
+
+				// Not timed, the same for both paths
+				engine.Update();
+			}
+			return PlayCount / stopwatch.Elapsed.TotalSeconds;
+		}
+
+		public override string ToString()
+		{
+			if (namePlaysPerSecond == 0)
+			{
+				return String.Empty;
+			}
+			return String.Format("{0:F0} plays/s by name, {1:F0} plays/s by handle",
+				namePlaysPerSecond, handlePlaysPerSecond);
+		}
+	}
+}
+#endif
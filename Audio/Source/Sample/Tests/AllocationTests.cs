@@ -0,0 +1,70 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using Bnoerj.Audio;
+using Microsoft.Xna.Framework;
+using Xunit;
+
+namespace Sample.Tests
+{
+	public class AllocationTests
+	{
+		const int FrameCount = 1000;
+		// Other threads of the test runner may allocate a little meanwhile
+		const long MemorySlack = 4096;
+
+		[Fact]
+		public void PerCallPathsDoNotAllocate()
+		{
+			using (SampleContent content = new SampleContent())
+			{
+				AudioEngine engine = content.Engine;
+				SoundBank soundBank = content.SoundBank;
+				CueHandle zap = soundBank.GetCueHandle("zap");
+				AudioListener listener = new AudioListener();
+				AudioEmitter emitter = engine.CreateEmitter();
+
+				// 3D settings must be applied before the cue plays
+				Cue cue = soundBank.GetCue(zap);
+				VariableHandle attackTime = cue.GetVariableHandle("AttackTime");
+				cue.Apply3D(listener, emitter);
+				cue.Play();
+
+				// Warms up the JIT, the name caches and the engine buffers
+				RunFrame(engine, soundBank, zap, cue, attackTime, listener, emitter, 0);
+
+				GC.Collect();
+				GC.WaitForPendingFinalizers();
+				GC.Collect();
+				int collectionCount = GC.CollectionCount(0);
+				long memory = GC.GetTotalMemory(false);
+
+				for (int i = 1; i <= FrameCount; i++)
+				{
+					RunFrame(engine, soundBank, zap, cue, attackTime, listener, emitter, i);
+				}
+
+				Assert.Equal(collectionCount, GC.CollectionCount(0));
+				Assert.InRange(GC.GetTotalMemory(false) - memory, 0, MemorySlack);
+			}
+		}
+
+		static void RunFrame(AudioEngine engine, SoundBank soundBank, CueHandle zap, Cue cue,
+			VariableHandle attackTime, AudioListener listener, AudioEmitter emitter, int frame)
+		{
+			soundBank.PlayCue(zap);
+			cue.SetVariable(attackTime, frame % 100);
+			// Moved every frame, so the 3D settings are calculated again
+			emitter.Position = new Vector3(frame % 50, 0, 10);
+			cue.Apply3D(listener, emitter);
+			engine.Update();
+		}
+	}
+}
+#endif
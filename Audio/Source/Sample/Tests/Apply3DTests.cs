@@ -0,0 +1,122 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using Bnoerj.Audio;
+using Microsoft.Xna.Framework;
+using Xunit;
+
+namespace Sample.Tests
+{
+	public class Apply3DTests
+	{
+		[Fact]
+		public void UnchangedCuesAreSkipped()
+		{
+			using (SampleContent content = new SampleContent())
+			{
+				AudioListener listener = new AudioListener();
+				AudioEmitter emitter = new AudioEmitter();
+				CheckSkips(content, listener, emitter, new AudioEmitter());
+			}
+		}
+
+		[Fact]
+		public void UnchangedCuesOfStoreEmittersAreSkipped()
+		{
+			using (SampleContent content = new SampleContent())
+			{
+				AudioListener listener = new AudioListener();
+				AudioEmitter emitter = content.Engine.CreateEmitter();
+				CheckSkips(content, listener, emitter, content.Engine.CreateEmitter());
+			}
+		}
+
+		[Fact]
+		public void BatchesSkipUnchangedCues()
+		{
+			using (SampleContent content = new SampleContent())
+			{
+				AudioEngine engine = content.Engine;
+				AudioListener listener = new AudioListener();
+				Cue[] cues = new Cue[3];
+				AudioEmitter[] emitters = new AudioEmitter[3];
+				for (int i = 0; i < cues.Length; i++)
+				{
+					cues[i] = content.SoundBank.GetCue("zap");
+					emitters[i] = engine.CreateEmitter();
+					emitters[i].Position = new Vector3(i, 0, 0);
+				}
+
+				engine.Apply3D(cues, listener, emitters, cues.Length);
+				AudioEngineStatistics before = engine.GetStatistics();
+
+				// Only the moved one is calculated again
+				emitters[1].Position = new Vector3(1, 0, 5);
+				engine.Apply3D(cues, listener, emitters, cues.Length);
+				AudioEngineStatistics after = engine.GetStatistics();
+				Assert.Equal(before.Apply3DCalculations + 1, after.Apply3DCalculations);
+				Assert.Equal(before.Apply3DSkips + 2, after.Apply3DSkips);
+			}
+		}
+
+		// Applies the settings of a cue again after changes of the listener
+		// and emitter that do and do not count, other is an emitter the cue
+		// was not positioned with
+		static void CheckSkips(SampleContent content, AudioListener listener, AudioEmitter emitter, AudioEmitter other)
+		{
+			AudioEngine engine = content.Engine;
+			Cue cue = content.SoundBank.GetCue("zap");
+			cue.Apply3D(listener, emitter);
+			AudioEngineStatistics statistics = engine.GetStatistics();
+
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 0, 1);
+
+			// Setting the same values again
+			emitter.Position = emitter.Position;
+			listener.Forward = listener.Forward;
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 0, 1);
+
+			// Moves within the epsilon count once they add up to more
+			emitter.PositionEpsilon = 1;
+			emitter.Position = new Vector3(0.6f, 0, 0);
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 0, 1);
+			emitter.Position = new Vector3(1.2f, 0, 0);
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 1, 0);
+
+			listener.Position = new Vector3(0, 0, 1);
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 1, 0);
+
+			emitter.DopplerScale = 2;
+			cue.Apply3D(listener, emitter);
+			statistics = CheckCounts(engine, statistics, 1, 0);
+
+			// Another emitter in the same place is not the same
+			other.Position = emitter.Position;
+			cue.Apply3D(listener, other);
+			statistics = CheckCounts(engine, statistics, 1, 0);
+			cue.Apply3D(listener, other);
+			CheckCounts(engine, statistics, 0, 1);
+		}
+
+		static AudioEngineStatistics CheckCounts(AudioEngine engine, AudioEngineStatistics before,
+			int calculations, int skips)
+		{
+			AudioEngineStatistics after = engine.GetStatistics();
+			Assert.Equal(before.Apply3DCalculations + calculations, after.Apply3DCalculations);
+			Assert.Equal(before.Apply3DSkips + skips, after.Apply3DSkips);
+			return after;
+		}
+	}
+}
+#endif
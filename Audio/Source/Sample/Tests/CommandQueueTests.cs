@@ -0,0 +1,42 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using Bnoerj.Audio;
+using Xunit;
+
+namespace Sample.Tests
+{
+	public class CommandQueueTests
+	{
+		[Fact]
+		public void DisposingSoundBankRunsQueuedCommands()
+		{
+			using (SampleContent content = new SampleContent())
+			{
+				content.Engine.DeferCommands = true;
+
+				Cue cue = content.SoundBank.GetCue("zap");
+				cue.Play();
+				Assert.Equal(1, content.Engine.GetStatistics().PendingCommandCount);
+
+				// The queued Play must reach XACT before the cue goes with
+				// its bank, not in the next Update
+				content.SoundBank.Dispose();
+				Assert.Equal(0, content.Engine.GetStatistics().PendingCommandCount);
+
+				content.Engine.Update();
+
+				AudioEngineStatistics statistics = content.Engine.GetStatistics();
+				Assert.Equal(0, statistics.PendingCommandCount);
+				Assert.Equal(0, statistics.CommandsFailed);
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,47 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+#if !XBOX
+using System;
+using System.IO;
+using Bnoerj.Audio;
+
+namespace Sample.Tests
+{
+	/// <summary>
+	/// The engine and banks of Content\Sample.xap, built by the content
+	/// project next to the assembly. Tests using it need audio hardware.
+	/// </summary>
+	class SampleContent : IDisposable
+	{
+		public static readonly string Directory = Path.Combine(
+			Path.GetDirectoryName(typeof(SampleContent).Assembly.Location), "Content");
+
+		public AudioEngine Engine;
+		public WaveBank InMemoryWaveBank;
+		public SoundBank SoundBank;
+
+		public SampleContent()
+		{
+			Engine = new AudioEngine(GetPath("Sample.xgs"));
+			InMemoryWaveBank = new WaveBank(Engine, GetPath("InMemoryWaveBank.xwb"));
+			SoundBank = new SoundBank(Engine, GetPath("Sounds.xsb"));
+		}
+
+		public static string GetPath(string fileName)
+		{
+			return Path.Combine(Directory, fileName);
+		}
+
+		public void Dispose()
+		{
+			// Disposing the engine disposes its banks and cues
+			Engine.Dispose();
+		}
+	}
+}
+#endif
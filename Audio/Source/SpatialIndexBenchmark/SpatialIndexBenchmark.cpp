@@ -0,0 +1,327 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the SpatialIndex of Bnoerj.Audio, see NativeSpatialIndex.h, on
+// a scene of randomly placed emitters: inserting them, moving all of them
+// a little every frame and finding the most audible ones around random
+// listener positions. The queries are repeated with a scan of all
+// emitters, which must find the same emitters.
+//
+// Plain C++ on top of NativeSpatialIndex.cpp, so it builds and runs on
+// any platform, for example with
+//   g++ -O2 -I../Bnoerj.Audio SpatialIndexBenchmark.cpp ../Bnoerj.Audio/NativeSpatialIndex.cpp
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "NativeSpatialIndex.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Edge length of the cube the emitters are placed in
+	const float WorldSize = 2000;
+	// Distance an emitter moves at most per frame
+	const float MaxStep = 1;
+
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int emitterCount;
+		unsigned int queryCount;
+		unsigned int resultCount;
+		unsigned int frameCount;
+		unsigned int radius;
+		unsigned int cellSize;
+	};
+
+	struct Emitter
+	{
+		float x;
+		float y;
+		float z;
+		float radius;
+	};
+
+	// Same numbers on every platform
+	class Random
+	{
+		unsigned int state;
+
+	public:
+		explicit Random(unsigned int seed)
+			: state(seed)
+		{}
+
+		// Between 0 and 1
+		float Next()
+		{
+			state = state * 1664525 + 1013904223;
+			return static_cast<float>(state >> 8) / 16777216.0f;
+		}
+
+		float Next(float minValue, float maxValue)
+		{
+			return minValue + Next() * (maxValue - minValue);
+		}
+	};
+
+	double GetSeconds(clock_t start)
+	{
+		return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	// The query of SpatialIndex done on every emitter, keeping the results
+	// sorted by insertion
+	unsigned int Scan(const std::vector<Emitter>& emitters, float x, float y, float z, unsigned int maxCount,
+		int32* pIds, float* pRelativeDistances)
+	{
+		unsigned int count = 0;
+		for (size_t id = 0; id < emitters.size(); id++)
+		{
+			const Emitter& emitter = emitters[id];
+			float dx = emitter.x - x;
+			float dy = emitter.y - y;
+			float dz = emitter.z - z;
+			float distanceSquared = dx * dx + dy * dy + dz * dz;
+			if (distanceSquared > emitter.radius * emitter.radius)
+			{
+				continue;
+			}
+
+			float relativeDistance = sqrtf(distanceSquared) / emitter.radius;
+			if (count == maxCount && relativeDistance >= pRelativeDistances[count - 1])
+			{
+				continue;
+			}
+			unsigned int index = count < maxCount ? count++ : count - 1;
+			while (index > 0 && pRelativeDistances[index - 1] > relativeDistance)
+			{
+				pIds[index] = pIds[index - 1];
+				pRelativeDistances[index] = pRelativeDistances[index - 1];
+				index--;
+			}
+			pIds[index] = static_cast<int32>(id);
+			pRelativeDistances[index] = relativeDistance;
+		}
+		return count;
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.emitterCount = 10000;
+		parameters.queryCount = 10000;
+		parameters.resultCount = 32;
+		parameters.frameCount = 60;
+		parameters.radius = 100;
+		parameters.cellSize = 0;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == false)
+			{
+				fprintf(stderr, "error: unexpected argument %s\n", arg);
+				return false;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'E': pValue = &parameters.emitterCount; break;
+			case 'Q': pValue = &parameters.queryCount; break;
+			case 'N': pValue = &parameters.resultCount; break;
+			case 'F': pValue = &parameters.frameCount; break;
+			case 'R': pValue = &parameters.radius; break;
+			case 'C': pValue = &parameters.cellSize; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		if (parameters.emitterCount == 0 || parameters.emitterCount > 0x7FFFFFFF ||
+			parameters.resultCount == 0 || parameters.radius == 0)
+		{
+			fprintf(stderr, "error: the emitter count, result count and radius must be at least 1\n");
+			return false;
+		}
+		if (parameters.cellSize == 0)
+		{
+			parameters.cellSize = parameters.radius;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Spatial Index Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: SPATIALINDEXBENCHMARK [options]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /E:<count>      Emitters, default is 10000.\n");
+		printf("   /Q:<count>      Queries, default is 10000.\n");
+		printf("   /N:<count>      Emitters a query returns at most, default is 32.\n");
+		printf("   /F:<count>      Frames all emitters are moved, default is 60.\n");
+		printf("   /R:<units>      Average audible radius, default is 100. The radii are\n");
+		printf("                   spread between half and one and a half of it.\n");
+		printf("   /C:<units>      Cell size of the index, default is the radius.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	float halfSize = WorldSize / 2;
+	float radius = static_cast<float>(parameters.radius);
+	Random random(1);
+
+	std::vector<Emitter> emitters(parameters.emitterCount);
+	for (size_t i = 0; i < emitters.size(); i++)
+	{
+		Emitter& emitter = emitters[i];
+		emitter.x = random.Next(-halfSize, halfSize);
+		emitter.y = random.Next(-halfSize, halfSize);
+		emitter.z = random.Next(-halfSize, halfSize);
+		emitter.radius = random.Next(radius / 2, radius * 3 / 2);
+	}
+
+	printf("%u emitters in a cube of %g units, radius %g, cell size %u\n\n",
+		parameters.emitterCount, WorldSize, radius, parameters.cellSize);
+
+	SpatialIndex index(static_cast<float>(parameters.cellSize));
+
+	clock_t start = clock();
+	for (size_t i = 0; i < emitters.size(); i++)
+	{
+		const Emitter& emitter = emitters[i];
+		index.Insert(static_cast<int32>(i), emitter.x, emitter.y, emitter.z, emitter.radius);
+	}
+	double seconds = GetSeconds(start);
+	printf("Insert   %10.3f ms %10.3f us per emitter\n", seconds * 1000, seconds * 1e6 / emitters.size());
+
+	start = clock();
+	for (unsigned int frame = 0; frame < parameters.frameCount; frame++)
+	{
+		for (size_t i = 0; i < emitters.size(); i++)
+		{
+			Emitter& emitter = emitters[i];
+			emitter.x += random.Next(-MaxStep, MaxStep);
+			emitter.y += random.Next(-MaxStep, MaxStep);
+			emitter.z += random.Next(-MaxStep, MaxStep);
+			index.Move(static_cast<int32>(i), emitter.x, emitter.y, emitter.z);
+		}
+	}
+	seconds = GetSeconds(start);
+	unsigned long long moveCount = static_cast<unsigned long long>(parameters.frameCount) * emitters.size();
+	if (moveCount > 0)
+	{
+		printf("Move     %10.3f ms %10.3f us per emitter, random steps included\n",
+			seconds * 1000, seconds * 1e6 / moveCount);
+	}
+
+	std::vector<float> listeners(parameters.queryCount * 3);
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i] = random.Next(-halfSize, halfSize);
+	}
+
+	std::vector<int32> ids(parameters.resultCount);
+	std::vector<float> relativeDistances(parameters.resultCount);
+	std::vector<unsigned int> counts(parameters.queryCount);
+	std::vector<float> farthest(parameters.queryCount);
+
+	unsigned long long found = 0;
+	start = clock();
+	for (unsigned int i = 0; i < parameters.queryCount; i++)
+	{
+		counts[i] = index.Query(listeners[i * 3], listeners[i * 3 + 1], listeners[i * 3 + 2],
+			SpatialIndex::Unbounded, parameters.resultCount, &ids[0], &relativeDistances[0]);
+		farthest[i] = counts[i] > 0 ? relativeDistances[counts[i] - 1] : 0;
+		found += counts[i];
+	}
+	double indexSeconds = GetSeconds(start);
+
+	unsigned int mismatches = 0;
+	start = clock();
+	for (unsigned int i = 0; i < parameters.queryCount; i++)
+	{
+		unsigned int count = Scan(emitters, listeners[i * 3], listeners[i * 3 + 1], listeners[i * 3 + 2],
+			parameters.resultCount, &ids[0], &relativeDistances[0]);
+		// Equal distances may be ordered differently, so compare the last
+		if (count != counts[i] || (count > 0 && relativeDistances[count - 1] != farthest[i]))
+		{
+			mismatches++;
+		}
+	}
+	double scanSeconds = GetSeconds(start);
+
+	if (parameters.queryCount > 0)
+	{
+		printf("Query    %10.3f ms %10.3f us per query, %.1f emitters found on average\n",
+			indexSeconds * 1000, indexSeconds * 1e6 / parameters.queryCount,
+			static_cast<double>(found) / parameters.queryCount);
+		printf("Scan     %10.3f ms %10.3f us per query\n",
+			scanSeconds * 1000, scanSeconds * 1e6 / parameters.queryCount);
+		if (indexSeconds > 0)
+		{
+			printf("Speedup  %10.1fx\n", scanSeconds / indexSeconds);
+		}
+	}
+
+	if (mismatches > 0)
+	{
+		fprintf(stderr, "error: %u queries found other emitters than the scan\n", mismatches);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,402 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the SpatialKernel of Bnoerj.Audio, see NativeSpatialKernel.h,
+// on randomly placed moving emitters around one listener:
+//
+//   Calculate   four emitters at a time with SSE, as Apply3D of many cues
+//               calculates their settings
+//   Reference   one emitter at a time with the C runtime math functions
+//   X3DAudio    X3DAudioCalculate for every emitter, as Cue::Apply3D did
+//               through XACT3DCalculate, on Windows only
+//
+// The results of Calculate are compared with the reference ones, which
+// they must match to within 1e-4.
+//
+// Plain C++ on top of NativeSpatialKernel.cpp, so it builds and runs on
+// any platform, for example with
+//   g++ -O2 -I../Bnoerj.Audio SpatialKernelBenchmark.cpp ../Bnoerj.Audio/NativeSpatialKernel.cpp
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <x3daudio.h>
+#else
+#include <time.h>
+#endif
+
+#include "NativeSpatialKernel.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// Edge length of the cube the emitters are placed in
+	const float WorldSize = 200;
+	const float MaxSpeed = 30;
+	const float SpeedOfSound = 343.5f;
+	// The accuracy SpatialKernel documents for Calculate
+	const float Tolerance = 1e-4f;
+
+#if defined(_WIN32)
+	// The speakers SpatialKernel::SetSpeakers places for a channel mask of
+	// 0, by channel count
+	const UINT32 ChannelMasks[SpatialKernel::MaxChannelCount + 1] =
+	{
+		0, SPEAKER_MONO, SPEAKER_STEREO, SPEAKER_2POINT1, SPEAKER_QUAD,
+		SPEAKER_4POINT1, SPEAKER_5POINT1, 0, SPEAKER_7POINT1,
+	};
+#endif
+
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int emitterCount;
+		unsigned int channelCount;
+		unsigned int frameCount;
+	};
+
+	// Same numbers on every platform
+	class Random
+	{
+		unsigned int state;
+
+	public:
+		explicit Random(unsigned int seed)
+			: state(seed)
+		{}
+
+		float Next(float minValue, float maxValue)
+		{
+			state = state * 1664525 + 1013904223;
+			return minValue + static_cast<float>(state >> 8) / 16777216.0f * (maxValue - minValue);
+		}
+	};
+
+	// The fields of all emitters, one array per component
+	struct Scene
+	{
+		std::vector<float> fields[10];
+		SpatialKernel::Emitters emitters;
+
+		explicit Scene(unsigned int count)
+		{
+			Random random(1);
+			for (int k = 0; k < 10; k++)
+			{
+				fields[k].resize(count);
+			}
+			for (unsigned int i = 0; i < count; i++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					fields[k][i] = random.Next(-WorldSize / 2, WorldSize / 2);
+					fields[6 + k][i] = random.Next(-MaxSpeed, MaxSpeed);
+				}
+				float x = random.Next(-1, 1);
+				float z = random.Next(-1, 1);
+				float length = sqrtf(x * x + z * z);
+				fields[3][i] = length > 0 ? x / length : 0.0f;
+				fields[5][i] = length > 0 ? z / length : 1.0f;
+				fields[9][i] = 1.0f;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				emitters.pPosition[k] = &fields[k][0];
+				emitters.pFront[k] = &fields[3 + k][0];
+				emitters.pVelocity[k] = &fields[6 + k][0];
+			}
+			emitters.pDopplerScaler = &fields[9][0];
+		}
+	};
+
+	struct Output
+	{
+		std::vector<float> distances;
+		std::vector<float> angles;
+		std::vector<float> dopplers;
+		std::vector<float> coefficients;
+		SpatialKernel::Results results;
+
+		Output(unsigned int count, unsigned int channelCount)
+			: distances(count)
+			, angles(count)
+			, dopplers(count)
+			, coefficients(count * channelCount)
+		{
+			results.pDistance = &distances[0];
+			results.pAngle = &angles[0];
+			results.pDoppler = &dopplers[0];
+			results.pCoefficients = &coefficients[0];
+		}
+	};
+
+#if defined(_WIN32)
+	double GetSeconds()
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&counter);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+#else
+	double GetSeconds()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+#endif
+
+	// The listener turns a little every frame
+	void SetListener(unsigned int frame, SpatialKernel::Listener& listener)
+	{
+		float angle = frame * 0.01f;
+		listener.position[0] = 0.0f;
+		listener.position[1] = 0.0f;
+		listener.position[2] = 0.0f;
+		listener.front[0] = sinf(angle);
+		listener.front[1] = 0.0f;
+		listener.front[2] = cosf(angle);
+		listener.top[0] = 0.0f;
+		listener.top[1] = 1.0f;
+		listener.top[2] = 0.0f;
+		listener.velocity[0] = 0.0f;
+		listener.velocity[1] = 0.0f;
+		listener.velocity[2] = 2.0f;
+	}
+
+	float MaxDifference(const std::vector<float>& a, const std::vector<float>& b)
+	{
+		float difference = 0;
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			float d = fabsf(a[i] - b[i]);
+			difference = d > difference ? d : difference;
+		}
+		return difference;
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.emitterCount = 10000;
+		parameters.channelCount = 6;
+		parameters.frameCount = 1000;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == false)
+			{
+				fprintf(stderr, "error: unexpected argument %s\n", arg);
+				return false;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'E': pValue = &parameters.emitterCount; break;
+			case 'C': pValue = &parameters.channelCount; break;
+			case 'F': pValue = &parameters.frameCount; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		if (parameters.emitterCount == 0 || parameters.emitterCount > 0x1000000 || parameters.frameCount == 0)
+		{
+			fprintf(stderr, "error: the emitter count and frame count must be at least 1\n");
+			return false;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Spatial Kernel Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: SPATIALKERNELBENCHMARK [options]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /E:<count>      Emitters, default is 10000.\n");
+		printf("   /C:<count>      Output channels, 1 to 8 but not 7, default is 6. The\n");
+		printf("                   speakers are the ones XACT uses for that many.\n");
+		printf("   /F:<count>      Frames the settings of all emitters are calculated,\n");
+		printf("                   default is 1000.\n");
+	}
+
+	void PrintTime(const char* name, double seconds, unsigned long long count)
+	{
+		printf("%-11s %10.3f ms %10.1f ns per emitter\n", name, seconds * 1000, seconds * 1e9 / count);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	SpatialKernel kernel;
+	if (kernel.SetSpeakers(0, static_cast<int>(parameters.channelCount)) == false)
+	{
+		fprintf(stderr, "error: no speaker layout for %u channels\n", parameters.channelCount);
+		return 1;
+	}
+	kernel.SetSpeedOfSound(SpeedOfSound);
+
+	unsigned int count = parameters.emitterCount;
+	unsigned int channelCount = parameters.channelCount;
+	Scene scene(count);
+	Output calculated(count, channelCount);
+	Output reference(count, channelCount);
+	SpatialKernel::Listener listener;
+	unsigned long long total = static_cast<unsigned long long>(count) * parameters.frameCount;
+
+	printf("%u emitters in a cube of %g units, %u channels, %u frames\n\n",
+		count, WorldSize, channelCount, parameters.frameCount);
+
+	double start = GetSeconds();
+	for (unsigned int frame = 0; frame < parameters.frameCount; frame++)
+	{
+		SetListener(frame, listener);
+		kernel.Calculate(listener, scene.emitters, 0, static_cast<int>(count), calculated.results);
+	}
+	double calculateSeconds = GetSeconds() - start;
+	PrintTime("Calculate", calculateSeconds, total);
+
+	start = GetSeconds();
+	for (unsigned int frame = 0; frame < parameters.frameCount; frame++)
+	{
+		SetListener(frame, listener);
+		kernel.CalculateReference(listener, scene.emitters, 0, static_cast<int>(count), reference.results);
+	}
+	double referenceSeconds = GetSeconds() - start;
+	PrintTime("Reference", referenceSeconds, total);
+
+#if defined(_WIN32)
+	// Mono emitters without cones and with flat distance curves, the part
+	// of X3DAudioCalculate SpatialKernel replaces
+	X3DAUDIO_HANDLE handle;
+	X3DAudioInitialize(ChannelMasks[channelCount], SpeedOfSound, handle);
+	X3DAUDIO_DISTANCE_CURVE_POINT flatPoints[2] = { { 0.0f, 1.0f }, { 1.0f, 1.0f } };
+	X3DAUDIO_DISTANCE_CURVE flatCurve = { flatPoints, 2 };
+	FLOAT32 azimuth = 0.0f;
+	FLOAT32 matrix[SpatialKernel::MaxChannelCount];
+
+	start = GetSeconds();
+	for (unsigned int frame = 0; frame < parameters.frameCount; frame++)
+	{
+		SetListener(frame, listener);
+		X3DAUDIO_LISTENER x3dListener = {};
+		x3dListener.OrientFront.x = listener.front[0];
+		x3dListener.OrientFront.z = listener.front[2];
+		x3dListener.OrientTop.y = 1.0f;
+		x3dListener.Velocity.z = listener.velocity[2];
+		for (unsigned int i = 0; i < count; i++)
+		{
+			X3DAUDIO_EMITTER emitter = {};
+			emitter.OrientFront.x = scene.fields[3][i];
+			emitter.OrientFront.z = scene.fields[5][i];
+			emitter.OrientTop.y = 1.0f;
+			emitter.Position.x = scene.fields[0][i];
+			emitter.Position.y = scene.fields[1][i];
+			emitter.Position.z = scene.fields[2][i];
+			emitter.Velocity.x = scene.fields[6][i];
+			emitter.Velocity.y = scene.fields[7][i];
+			emitter.Velocity.z = scene.fields[8][i];
+			emitter.ChannelCount = 1;
+			emitter.pChannelAzimuths = &azimuth;
+			emitter.pVolumeCurve = &flatCurve;
+			emitter.pLFECurve = &flatCurve;
+			emitter.CurveDistanceScaler = 1.0f;
+			emitter.DopplerScaler = 1.0f;
+
+			X3DAUDIO_DSP_SETTINGS settings = {};
+			settings.pMatrixCoefficients = matrix;
+			settings.SrcChannelCount = 1;
+			settings.DstChannelCount = channelCount;
+			X3DAudioCalculate(handle, &x3dListener, &emitter,
+				X3DAUDIO_CALCULATE_MATRIX | X3DAUDIO_CALCULATE_DOPPLER | X3DAUDIO_CALCULATE_EMITTER_ANGLE, &settings);
+		}
+	}
+	double x3dAudioSeconds = GetSeconds() - start;
+	PrintTime("X3DAudio", x3dAudioSeconds, total);
+#endif
+
+	if (calculateSeconds > 0)
+	{
+		printf("Speedup     %10.1fx over the reference\n", referenceSeconds / calculateSeconds);
+#if defined(_WIN32)
+		printf("Speedup     %10.1fx over X3DAudio\n", x3dAudioSeconds / calculateSeconds);
+#endif
+	}
+
+	// Both hold the results of the last frame
+	float maxDistance = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float d = fabsf(calculated.distances[i] - reference.distances[i]) / (reference.distances[i] > 1 ? reference.distances[i] : 1);
+		maxDistance = d > maxDistance ? d : maxDistance;
+	}
+	float maxAngle = MaxDifference(calculated.angles, reference.angles);
+	float maxDoppler = MaxDifference(calculated.dopplers, reference.dopplers);
+	float maxCoefficient = MaxDifference(calculated.coefficients, reference.coefficients);
+	printf("\nLargest difference to the reference: distance %g relative, angle %g, doppler %g, coefficient %g\n",
+		maxDistance, maxAngle, maxDoppler, maxCoefficient);
+
+	if (maxDistance > Tolerance || maxAngle > Tolerance || maxDoppler > Tolerance || maxCoefficient > Tolerance)
+	{
+		fprintf(stderr, "error: Calculate differs from the reference by more than %g\n", Tolerance);
+		return 1;
+	}
+	return 0;
+}
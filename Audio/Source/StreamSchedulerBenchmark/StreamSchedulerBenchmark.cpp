@@ -0,0 +1,668 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Measures the StreamScheduler of Bnoerj.Audio, see NativeStreamScheduler.h,
+// on a number of streams playing from one disk at different rates, as
+// music, ambience and dialogue streaming wave banks do:
+//
+//   Direct     every request is read on its own, in the order submitted,
+//              as XACT did with the files opened by the wave banks
+//   Scheduled  the requests go through a StreamScheduler, as StreamReader
+//              passes them on
+//
+// Each stream keeps a number of block sized requests out and needs block
+// k at its start time plus k + 1 block durations. A block that has not
+// arrived by then is late, which is a glitch in the sound.
+//
+// The benchmark runs on a simulated clock. The disk is a file written by
+// the benchmark, read for real, and a model taking the seek time whenever
+// a read does not continue the previous one, plus the transfer time. Every
+// stream reads the whole file, placed one after the other on the disk
+// model. The data every request receives is checked.
+//
+// Plain C++ on top of NativeStreamScheduler.cpp, so it builds and runs on
+// any platform, for example with
+//   g++ -O2 -I../Bnoerj.Audio StreamSchedulerBenchmark.cpp ../Bnoerj.Audio/NativeStreamScheduler.cpp
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "NativeStreamScheduler.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const int64 Never = 0x7FFFFFFFFFFFFFFFLL;
+	const char* const TestPath = "StreamSchedulerBenchmark.tmp";
+
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int streamCount;
+		unsigned int blockSize;
+		unsigned int queueDepth;
+		unsigned int prefetchDepth;
+		unsigned int seconds;
+		unsigned int seekMicroseconds;
+		unsigned int megabytesPerSecond;
+	};
+
+	// A request of a stream, one per block it keeps out
+	struct Block
+	{
+		uint32 index;
+		std::vector<uint8> buffer;
+		bool isDone;
+		uint32 bytesTransferred;
+		int64 submitTime;
+		int64 doneTime;
+	};
+
+	struct Consumer
+	{
+		uint32 stream;
+		uint32 bytesPerSecond;
+		int64 startTime;
+		uint32 blockCount;
+		uint32 nextPlay;
+		uint32 nextSubmit;
+		// Ring of queueDepth + 1, the one playing is not reused
+		std::vector<Block> blocks;
+	};
+
+	struct Result
+	{
+		uint64 requests;
+		uint64 reads;
+		uint64 bytesRead;
+		uint64 seeks;
+		uint64 lateBlocks;
+		int64 maxLateMicroseconds;
+		int64 totalLatencyMicroseconds;
+		int64 maxLatencyMicroseconds;
+		int64 diskBusyMicroseconds;
+		int64 endTime;
+		uint64 corruptBlocks;
+		double schedulerSeconds;
+		uint64 schedulerCalls;
+	};
+
+	struct DirectRequest
+	{
+		Consumer* pConsumer;
+		Block* pBlock;
+	};
+
+#if defined(_WIN32)
+	double GetSeconds()
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&counter);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+#else
+	double GetSeconds()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+#endif
+
+	uint8 GetPatternByte(uint64 offset)
+	{
+		return static_cast<uint8>((offset >> 9) + offset * 13);
+	}
+
+	bool WriteTestFile(uint64 size)
+	{
+		FILE* pFile = fopen(TestPath, "wb");
+		if (pFile == NULL)
+		{
+			return false;
+		}
+
+		std::vector<uint8> block(65536);
+		bool succeeded = true;
+		for (uint64 offset = 0; offset < size && succeeded == true; offset += block.size())
+		{
+			size_t length = size - offset < block.size() ? static_cast<size_t>(size - offset) : block.size();
+			for (size_t i = 0; i < length; i++)
+			{
+				block[i] = GetPatternByte(offset + i);
+			}
+			succeeded = fwrite(&block[0], 1, length, pFile) == length;
+		}
+		return fclose(pFile) == 0 && succeeded;
+	}
+
+	// The disk model: one read at a time, seeking unless the read starts
+	// where the previous one ended
+	class Disk
+	{
+		FILE* pFile;
+		uint64 fileSize;
+		uint64 headPosition;
+		int64 seekMicroseconds;
+		uint32 bytesPerMicrosecond;
+
+	public:
+		Disk(FILE* pFile, uint64 fileSize, const Parameters& parameters)
+			: pFile(pFile)
+			, fileSize(fileSize)
+			, headPosition(0)
+			, seekMicroseconds(parameters.seekMicroseconds)
+			, bytesPerMicrosecond(parameters.megabytesPerSecond > 0 ? parameters.megabytesPerSecond : 1)
+		{}
+
+		// Reads length bytes at offset of the stream's copy of the file,
+		// returns the bytes read and the time it takes
+		uint32 Read(uint32 stream, uint64 offset, uint32 length, void* pBuffer, Result& result, int64& duration)
+		{
+			uint64 position = stream * fileSize + offset;
+			duration = length / bytesPerMicrosecond;
+			if (position != headPosition)
+			{
+				duration += seekMicroseconds;
+				result.seeks++;
+			}
+			headPosition = position + length;
+
+			uint32 read = 0;
+			if (offset < fileSize && fseek(pFile, static_cast<long>(offset), SEEK_SET) == 0)
+			{
+				read = static_cast<uint32>(fread(pBuffer, 1, length, pFile));
+			}
+			result.reads++;
+			result.bytesRead += read;
+			result.diskBusyMicroseconds += duration;
+			return read;
+		}
+	};
+
+	bool IsValid(const Block& block, uint32 blockSize, uint64 fileSize)
+	{
+		uint64 offset = static_cast<uint64>(block.index) * blockSize;
+		uint64 expected = offset + blockSize <= fileSize ? blockSize : fileSize - offset;
+		if (block.bytesTransferred != expected)
+		{
+			return false;
+		}
+		for (uint32 i = 0; i < block.bytesTransferred; i++)
+		{
+			if (block.buffer[i] != GetPatternByte(offset + i))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void CompleteBlock(Block& block, uint32 bytesTransferred, int64 now, Result& result)
+	{
+		block.isDone = true;
+		block.bytesTransferred = bytesTransferred;
+		block.doneTime = now;
+		int64 latency = now - block.submitTime;
+		result.totalLatencyMicroseconds += latency;
+		if (latency > result.maxLatencyMicroseconds)
+		{
+			result.maxLatencyMicroseconds = latency;
+		}
+	}
+
+	int64 GetPlayTime(const Consumer& consumer, uint32 blockIndex, uint32 blockSize)
+	{
+		return consumer.startTime + (static_cast<int64>(blockIndex) + 1) * blockSize * 1000000 / consumer.bytesPerSecond;
+	}
+
+	void CreateConsumers(const Parameters& parameters, uint64 fileSize, std::vector<Consumer>& consumers)
+	{
+		uint32 blockCount = static_cast<uint32>((fileSize + parameters.blockSize - 1) / parameters.blockSize);
+		consumers.resize(parameters.streamCount);
+		for (uint32 i = 0; i < parameters.streamCount; i++)
+		{
+			// Mono to 6 channel PCM and ADPCM rates, streams starting a
+			// little apart
+			static const uint32 Rates[] = { 88200, 176400, 264600, 49612 };
+			Consumer& consumer = consumers[i];
+			consumer.stream = i;
+			consumer.bytesPerSecond = Rates[i % 4];
+			consumer.startTime = i * 50000;
+			uint64 needed = static_cast<uint64>(consumer.bytesPerSecond) * parameters.seconds;
+			consumer.blockCount = static_cast<uint32>((needed + parameters.blockSize - 1) / parameters.blockSize);
+			if (consumer.blockCount > blockCount)
+			{
+				consumer.blockCount = blockCount;
+			}
+			consumer.nextPlay = 0;
+			consumer.nextSubmit = 0;
+			consumer.blocks.resize(parameters.queueDepth + 1);
+			for (size_t j = 0; j < consumer.blocks.size(); j++)
+			{
+				consumer.blocks[j].buffer.resize(parameters.blockSize);
+			}
+		}
+	}
+
+	// Submits the blocks the consumer may have out, through submit
+	template<class Submitter>
+	void SubmitBlocks(Consumer& consumer, const Parameters& parameters, int64 now, Submitter& submitter, Result& result)
+	{
+		while (consumer.nextSubmit < consumer.blockCount && consumer.nextSubmit < consumer.nextPlay + parameters.queueDepth)
+		{
+			Block& block = consumer.blocks[consumer.nextSubmit % consumer.blocks.size()];
+			block.index = consumer.nextSubmit++;
+			block.isDone = false;
+			block.bytesTransferred = 0;
+			block.submitTime = now;
+			result.requests++;
+			submitter.Submit(consumer, block, static_cast<uint64>(block.index) * parameters.blockSize, now);
+		}
+	}
+
+	// Plays the blocks due, returns the time the next one is due
+	template<class Submitter>
+	int64 Play(Consumer& consumer, const Parameters& parameters, uint64 fileSize, int64 now, Submitter& submitter, Result& result)
+	{
+		while (consumer.nextPlay < consumer.blockCount)
+		{
+			int64 playTime = GetPlayTime(consumer, consumer.nextPlay, parameters.blockSize);
+			Block& block = consumer.blocks[consumer.nextPlay % consumer.blocks.size()];
+			if (playTime > now)
+			{
+				return playTime;
+			}
+			if (block.isDone == false)
+			{
+				// Played as soon as it arrives, see Deliver
+				return Never;
+			}
+
+			if (block.doneTime > playTime)
+			{
+				result.lateBlocks++;
+				if (block.doneTime - playTime > result.maxLateMicroseconds)
+				{
+					result.maxLateMicroseconds = block.doneTime - playTime;
+				}
+			}
+			if (IsValid(block, parameters.blockSize, fileSize) == false)
+			{
+				result.corruptBlocks++;
+			}
+			consumer.nextPlay++;
+			SubmitBlocks(consumer, parameters, now, submitter, result);
+		}
+		return Never;
+	}
+
+	// Requests read on their own in submission order
+	class DirectSubmitter
+	{
+	public:
+		std::deque<DirectRequest> queue;
+
+		void Submit(Consumer& consumer, Block& block, uint64, int64)
+		{
+			DirectRequest request = { &consumer, &block };
+			queue.push_back(request);
+		}
+	};
+
+	class ScheduledSubmitter
+	{
+		StreamScheduler& scheduler;
+		Result& result;
+
+	public:
+		ScheduledSubmitter(StreamScheduler& scheduler, Result& result)
+			: scheduler(scheduler)
+			, result(result)
+		{}
+
+		void Submit(Consumer& consumer, Block& block, uint64 offset, int64 now)
+		{
+			uint32 bytesTransferred;
+			double start = GetSeconds();
+			StreamSubmitResult submitResult = scheduler.Submit(consumer.stream, offset,
+				static_cast<uint32>(block.buffer.size()), &block.buffer[0], &block, now, bytesTransferred);
+			result.schedulerSeconds += GetSeconds() - start;
+			result.schedulerCalls++;
+			if (submitResult == StreamSubmitCompleted)
+			{
+				CompleteBlock(block, bytesTransferred, now, result);
+			}
+			else if (submitResult == StreamSubmitFailed)
+			{
+				// Never happens with fewer than MaxRequests blocks out
+				block.isDone = true;
+				result.corruptBlocks++;
+			}
+		}
+	};
+
+	// Every stream is prepared at once and starts playing a little later
+	template<class Submitter>
+	void Start(std::vector<Consumer>& consumers, const Parameters& parameters, Submitter& submitter, Result& result)
+	{
+		for (size_t i = 0; i < consumers.size(); i++)
+		{
+			SubmitBlocks(consumers[i], parameters, 0, submitter, result);
+		}
+	}
+
+	// Plays what is due at now, returns the next time a block is due
+	template<class Submitter>
+	int64 PlayAll(std::vector<Consumer>& consumers, const Parameters& parameters, uint64 fileSize, int64 now,
+		Submitter& submitter, Result& result)
+	{
+		int64 next = Never;
+		for (size_t i = 0; i < consumers.size(); i++)
+		{
+			int64 due = Play(consumers[i], parameters, fileSize, now, submitter, result);
+			if (due < next)
+			{
+				next = due;
+			}
+		}
+		return next;
+	}
+
+	bool IsFinished(const std::vector<Consumer>& consumers)
+	{
+		for (size_t i = 0; i < consumers.size(); i++)
+		{
+			if (consumers[i].nextPlay < consumers[i].blockCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Result RunDirect(FILE* pFile, uint64 fileSize, const Parameters& parameters)
+	{
+		Result result;
+		memset(&result, 0, sizeof(result));
+		Disk disk(pFile, fileSize, parameters);
+		std::vector<Consumer> consumers;
+		CreateConsumers(parameters, fileSize, consumers);
+		DirectSubmitter submitter;
+
+		int64 now = 0;
+		Start(consumers, parameters, submitter, result);
+		for (;;)
+		{
+			int64 next = PlayAll(consumers, parameters, fileSize, now, submitter, result);
+			if (IsFinished(consumers) == true)
+			{
+				break;
+			}
+
+			// Streams start later than the first submit
+			if (submitter.queue.empty() == false)
+			{
+				DirectRequest request = submitter.queue.front();
+				submitter.queue.pop_front();
+				Block& block = *request.pBlock;
+				int64 duration;
+				uint64 offset = static_cast<uint64>(block.index) * parameters.blockSize;
+				uint32 read = disk.Read(request.pConsumer->stream, offset, parameters.blockSize, &block.buffer[0], result, duration);
+				now += duration;
+				CompleteBlock(block, read, now, result);
+			}
+			else if (next != Never)
+			{
+				now = next;
+			}
+			else
+			{
+				break;
+			}
+		}
+		result.endTime = now;
+		return result;
+	}
+
+	Result RunScheduled(FILE* pFile, uint64 fileSize, const Parameters& parameters)
+	{
+		Result result;
+		memset(&result, 0, sizeof(result));
+		Disk disk(pFile, fileSize, parameters);
+		std::vector<Consumer> consumers;
+		CreateConsumers(parameters, fileSize, consumers);
+
+		StreamScheduler scheduler;
+		for (size_t i = 0; i < consumers.size(); i++)
+		{
+			consumers[i].stream = scheduler.AddStream(fileSize, parameters.blockSize, parameters.prefetchDepth);
+		}
+		ScheduledSubmitter submitter(scheduler, result);
+
+		int64 now = 0;
+		Start(consumers, parameters, submitter, result);
+		for (;;)
+		{
+			int64 next = PlayAll(consumers, parameters, fileSize, now, submitter, result);
+			if (IsFinished(consumers) == true)
+			{
+				break;
+			}
+
+			StreamRead read;
+			double start = GetSeconds();
+			bool hasRead = scheduler.BeginRead(now, read);
+			result.schedulerSeconds += GetSeconds() - start;
+			result.schedulerCalls++;
+			if (hasRead == true)
+			{
+				int64 duration;
+				uint32 bytesRead = disk.Read(read.stream, read.offset, read.length, read.pBuffer, result, duration);
+				now += duration;
+				start = GetSeconds();
+				scheduler.EndRead(read, bytesRead, true, now);
+				result.schedulerSeconds += GetSeconds() - start;
+				result.schedulerCalls++;
+			}
+
+			StreamCompletion completion;
+			while (scheduler.PopCompleted(completion) == true)
+			{
+				CompleteBlock(*static_cast<Block*>(completion.pContext), completion.bytesTransferred, now, result);
+			}
+
+			if (hasRead == false)
+			{
+				if (next == Never)
+				{
+					break;
+				}
+				now = next;
+			}
+		}
+		result.endTime = now;
+		return result;
+	}
+
+	void PrintResult(const char* mode, const Result& result)
+	{
+		printf("%-10s %7llu %7llu %8.1f %7llu %9.1f %9.1f %6.1f%% %7llu %9.1f\n", mode,
+			static_cast<unsigned long long>(result.requests),
+			static_cast<unsigned long long>(result.reads),
+			result.bytesRead / 1048576.0,
+			static_cast<unsigned long long>(result.seeks),
+			result.requests > 0 ? result.totalLatencyMicroseconds / 1000.0 / result.requests : 0.0,
+			result.maxLatencyMicroseconds / 1000.0,
+			result.endTime > 0 ? result.diskBusyMicroseconds * 100.0 / result.endTime : 0.0,
+			static_cast<unsigned long long>(result.lateBlocks),
+			result.maxLateMicroseconds / 1000.0);
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.streamCount = 12;
+		parameters.blockSize = 65536;
+		parameters.queueDepth = 2;
+		parameters.prefetchDepth = 2;
+		parameters.seconds = 60;
+		parameters.seekMicroseconds = 12000;
+		parameters.megabytesPerSecond = 30;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == false)
+			{
+				fprintf(stderr, "error: unexpected argument %s\n", arg);
+				return false;
+			}
+
+			arg++;
+			char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+			unsigned int* pValue = NULL;
+			switch (option)
+			{
+			case 'S': pValue = &parameters.streamCount; break;
+			case 'B': pValue = &parameters.blockSize; break;
+			case 'Q': pValue = &parameters.queueDepth; break;
+			case 'P': pValue = &parameters.prefetchDepth; break;
+			case 'F': pValue = &parameters.seconds; break;
+			case 'K': pValue = &parameters.seekMicroseconds; break;
+			case 'T': pValue = &parameters.megabytesPerSecond; break;
+			}
+
+			if (option == 'L' && arg[1] == '\0')
+			{
+				parameters.skipLogo = true;
+			}
+			else if (pValue == NULL || arg[1] != ':' || ParseNumber(arg + 2, *pValue) == false)
+			{
+				fprintf(stderr, "error: unknown option /%s\n", arg);
+				return false;
+			}
+		}
+
+		if (parameters.streamCount == 0 || parameters.streamCount > StreamScheduler::MaxStreams ||
+			parameters.queueDepth == 0 || parameters.queueDepth >= StreamScheduler::MaxRequests ||
+			parameters.blockSize == 0 || parameters.blockSize > 16 * 1048576 ||
+			parameters.seconds == 0 || parameters.seconds > 600 || parameters.megabytesPerSecond == 0)
+		{
+			fprintf(stderr, "error: 1 to %u streams, 1 to %u blocks out, blocks of at most 16 MB,\n"
+				"1 to 600 seconds and a disk of at least 1 MB/s\n",
+				StreamScheduler::MaxStreams, StreamScheduler::MaxRequests - 1);
+			return false;
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns Stream Scheduler Benchmark\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: STREAMSCHEDULERBENCHMARK [options]\n\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /S:<count>      Streams, default is 12.\n");
+		printf("   /B:<bytes>      Block size of the requests, default is 65536.\n");
+		printf("   /Q:<count>      Requests a stream keeps out, default is 2.\n");
+		printf("   /P:<count>      Prefetch depth of the scheduled streams, default is 2.\n");
+		printf("   /F:<seconds>    Seconds every stream plays, default is 60.\n");
+		printf("   /K:<us>         Seek time of the disk, default is 12000.\n");
+		printf("   /T:<MB/s>       Transfer rate of the disk, default is 30.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	// Long enough for the fastest stream, about 1.5 times 176400 bytes per
+	// second
+	uint64 fileSize = static_cast<uint64>(264600) * parameters.seconds;
+	if (WriteTestFile(fileSize) == false)
+	{
+		fprintf(stderr, "error: cannot write %s\n", TestPath);
+		return 1;
+	}
+	FILE* pFile = fopen(TestPath, "rb");
+	if (pFile == NULL)
+	{
+		fprintf(stderr, "error: cannot read %s\n", TestPath);
+		remove(TestPath);
+		return 1;
+	}
+
+	printf("%u streams of %u byte blocks, %u out, %u seconds, disk %u us seek and %u MB/s\n\n",
+		parameters.streamCount, parameters.blockSize, parameters.queueDepth, parameters.seconds,
+		parameters.seekMicroseconds, parameters.megabytesPerSecond);
+	printf("Mode       requests  reads     MB     seeks   latency       max   disk    late  max late\n");
+
+	Result direct = RunDirect(pFile, fileSize, parameters);
+	PrintResult("Direct", direct);
+	Result scheduled = RunScheduled(pFile, fileSize, parameters);
+	PrintResult("Scheduled", scheduled);
+
+	fclose(pFile);
+	remove(TestPath);
+
+	printf("\nLatency and late are in milliseconds of the simulated clock. The scheduler\n");
+	printf("took %.2f us per call, %llu calls.\n",
+		scheduled.schedulerCalls > 0 ? scheduled.schedulerSeconds * 1e6 / scheduled.schedulerCalls : 0.0,
+		static_cast<unsigned long long>(scheduled.schedulerCalls));
+
+	if (direct.corruptBlocks > 0 || scheduled.corruptBlocks > 0)
+	{
+		fprintf(stderr, "error: %llu blocks received wrong data\n",
+			static_cast<unsigned long long>(direct.corruptBlocks + scheduled.corruptBlocks));
+		return 1;
+	}
+	return 0;
+}
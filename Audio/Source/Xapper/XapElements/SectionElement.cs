@@ -1,21 +1,21 @@
-// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
-// All rights reserved.
-//
-// This software is licensed as described in the file license.txt, which
-// you should have received as part of this distribution. The terms
-// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
-
-using System;
-using System.Collections.Generic;
-using System.Text;
-
-namespace Bnoerj.Audio.XapElements
-{
-	class SectionElement : Element<Section>
-	{
-		public SectionElement(String name, Section value)
-			: base(name, value)
-		{
-		}
-	}
-}
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+using System;
+using System.Collections.Generic;
+using System.Text;
+
+namespace Bnoerj.Audio.XapElements
+{
+	class SectionElement : Element<Section>
+	{
+		public SectionElement(String name, Section value)
+			: base(name, value)
+		{
+		}
+	}
+}
@@ -0,0 +1,455 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Generates index constants for the categories, variables and cues in
+// built XACT3 global settings (.xgs) and sound banks (.xsb): a C++ header
+// with one strongly typed index per kind, and C# enums for the index
+// overloads of AudioEngine, SoundBank and Cue.
+//
+// Plain C++ on top of the bank parsers of Bnoerj.Audio, so it builds and
+// runs on any platform that runs the content build.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "NativeGlobalSettingsFile.h"
+#include "NativeSoundBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	const char* DefaultNamespace = "AudioIds";
+
+	// Words neither C++ nor C# accept as identifiers, and the name of the
+	// generated index type. Names matching one get an underscore appended.
+	const char* Keywords[] =
+	{
+		"Index", "abstract", "as", "auto", "base", "bool", "break", "byte", "case",
+		"catch", "char", "checked", "class", "const", "continue", "decimal",
+		"default", "delegate", "delete", "do", "double", "else", "enum",
+		"event", "explicit", "extern", "false", "finally", "fixed", "float",
+		"for", "foreach", "friend", "goto", "if", "implicit", "in", "inline",
+		"int", "interface", "internal", "is", "lock", "long", "namespace",
+		"new", "null", "object", "operator", "out", "override", "params",
+		"private", "protected", "public", "readonly", "ref", "register",
+		"return", "sbyte", "sealed", "short", "signed", "sizeof", "static",
+		"string", "struct", "switch", "template", "this", "throw", "true",
+		"try", "typedef", "typeof", "uint", "ulong", "union", "unchecked",
+		"unsafe", "unsigned", "ushort", "using", "virtual", "void",
+		"volatile", "while",
+	};
+
+	struct Constant
+	{
+		std::string name;
+		unsigned int index;
+	};
+
+	// One group of constants, a namespace in C++ and an enum in C#
+	struct Group
+	{
+		// C++ namespace, e.g. Categories or a sound bank name
+		std::string scope;
+		// C# enum name
+		std::string enumName;
+		// Comment in both outputs
+		std::string description;
+		std::vector<Constant> constants;
+	};
+
+	struct Parameters
+	{
+		bool skipLogo;
+		const char* nameSpace;
+		const char* headerFilename;
+		const char* enumFilename;
+		std::vector<const char*> inputFiles;
+	};
+
+	std::string MakeIdentifier(const char* name)
+	{
+		std::string identifier;
+		for (const char* p = name; *p != '\0'; p++)
+		{
+			unsigned char c = static_cast<unsigned char>(*p);
+			identifier += isalnum(c) != 0 || c == '_' ? static_cast<char>(c) : '_';
+		}
+		if (identifier.empty() == true || isdigit(static_cast<unsigned char>(identifier[0])) != 0)
+		{
+			identifier.insert(0, "_");
+		}
+		for (size_t i = 0; i < sizeof(Keywords) / sizeof(Keywords[0]); i++)
+		{
+			if (identifier == Keywords[i])
+			{
+				identifier += '_';
+				break;
+			}
+		}
+		return identifier;
+	}
+
+	// Names that collide once made identifiers get their index appended
+	void AddConstant(Group& group, const char* name, unsigned int index)
+	{
+		Constant constant;
+		constant.name = MakeIdentifier(name);
+		constant.index = index;
+		for (size_t i = 0; i < group.constants.size(); i++)
+		{
+			if (group.constants[i].name == constant.name)
+			{
+				char suffix[16];
+				sprintf(suffix, "_%u", index);
+				constant.name += suffix;
+				break;
+			}
+		}
+		group.constants.push_back(constant);
+	}
+
+	bool EndsWith(const char* text, const char* suffix)
+	{
+		size_t textLength = strlen(text);
+		size_t suffixLength = strlen(suffix);
+		if (suffixLength > textLength)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < suffixLength; i++)
+		{
+			if (tolower(static_cast<unsigned char>(text[textLength - suffixLength + i])) != suffix[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ReadFile(const char* filename, std::vector<char>& data)
+	{
+		FILE* file = fopen(filename, "rb");
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		bool result = true;
+		char buffer[64 * 1024];
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			data.insert(data.end(), buffer, buffer + count);
+		}
+		if (ferror(file) != 0)
+		{
+			result = false;
+		}
+		fclose(file);
+		return result;
+	}
+
+	const char* GetParseError(BankParseResult result)
+	{
+		switch (result)
+		{
+		case BankParseInvalidSignature:
+			return "not an XACT3 file of this kind";
+		case BankParseUnsupportedVersion:
+			return "unsupported file version";
+		case BankParseTruncated:
+			return "file is truncated";
+		default:
+			return "file holds invalid data";
+		}
+	}
+
+	bool ReadGlobalSettings(const char* filename, const std::vector<char>& data, std::vector<Group>& groups)
+	{
+		GlobalSettingsFile settings;
+		BankParseResult result = settings.Parse(data.empty() == false ? &data[0] : NULL, data.size());
+		if (result != BankParseOk)
+		{
+			fprintf(stderr, "%s: error: %s\n", filename, GetParseError(result));
+			return false;
+		}
+
+		Group categories;
+		categories.scope = "Categories";
+		categories.enumName = "Category";
+		categories.description = "Categories, for AudioEngine.GetCategory";
+		for (uint32 i = 0; i < settings.GetCategoryCount(); i++)
+		{
+			AddConstant(categories, settings.GetCategoryName(i), i);
+		}
+
+		// Global and cue variables share one index space
+		Group globalVariables;
+		globalVariables.scope = "GlobalVariables";
+		globalVariables.enumName = "GlobalVariable";
+		globalVariables.description = "Global variables, for AudioEngine.GetGlobalVariable and SetGlobalVariable";
+		Group cueVariables;
+		cueVariables.scope = "CueVariables";
+		cueVariables.enumName = "CueVariable";
+		cueVariables.description = "Cue instance variables, for Cue.GetVariable and SetVariable";
+		for (uint32 i = 0; i < settings.GetVariableCount(); i++)
+		{
+			Group& group = settings.IsGlobalVariable(i) == true ? globalVariables : cueVariables;
+			AddConstant(group, settings.GetVariableName(i), i);
+		}
+
+		groups.push_back(categories);
+		groups.push_back(globalVariables);
+		groups.push_back(cueVariables);
+		return true;
+	}
+
+	bool ReadSoundBank(const char* filename, const std::vector<char>& data, std::vector<Group>& groups)
+	{
+		SoundBankFile soundBank;
+		BankParseResult result = soundBank.Parse(data.empty() == false ? &data[0] : NULL, data.size());
+		if (result != BankParseOk)
+		{
+			fprintf(stderr, "%s: error: %s\n", filename, GetParseError(result));
+			return false;
+		}
+		if (soundBank.GetCueCount() > 0 && soundBank.GetCueName(0) == NULL)
+		{
+			fprintf(stderr, "%s: error: sound bank was built without cue names\n", filename);
+			return false;
+		}
+
+		std::string bankName = MakeIdentifier(soundBank.GetName());
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			if (groups[i].scope == bankName)
+			{
+				fprintf(stderr, "%s: error: a sound bank named %s was already read\n", filename, soundBank.GetName());
+				return false;
+			}
+		}
+
+		Group cues;
+		cues.scope = bankName;
+		cues.enumName = bankName + "Cue";
+		cues.description = "Cues of sound bank " + std::string(soundBank.GetName()) + ", for SoundBank.GetCue and PlayCue";
+		for (uint32 i = 0; i < soundBank.GetCueCount(); i++)
+		{
+			AddConstant(cues, soundBank.GetCueName(i), i);
+		}
+		groups.push_back(cues);
+		return true;
+	}
+
+	void WriteHeader(FILE* file, const Parameters& parameters, const std::vector<Group>& groups)
+	{
+		fprintf(file, "// Generated by Xidgen, do not edit.\n\n");
+		fprintf(file, "#pragma once\n\n");
+		fprintf(file, "#if !defined(XIDGEN_CONSTEXPR)\n");
+		fprintf(file, "#if (defined(_MSC_VER) && _MSC_VER >= 1900) || (!defined(_MSC_VER) && __cplusplus >= 201103L)\n");
+		fprintf(file, "#define XIDGEN_CONSTEXPR constexpr\n");
+		fprintf(file, "#else\n");
+		fprintf(file, "#define XIDGEN_CONSTEXPR const\n");
+		fprintf(file, "#endif\n");
+		fprintf(file, "#endif\n\n");
+		fprintf(file, "namespace %s {\n", parameters.nameSpace);
+
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			const Group& group = groups[i];
+			fprintf(file, "\n\t// %s\n", group.description.c_str());
+			fprintf(file, "\tnamespace %s {\n\n", group.scope.c_str());
+			fprintf(file, "\t\tstruct Index\n\t\t{\n\t\t\tunsigned short value;\n\t\t};\n\n");
+			for (size_t j = 0; j < group.constants.size(); j++)
+			{
+				fprintf(file, "\t\tXIDGEN_CONSTEXPR Index %s = { %u };\n", group.constants[j].name.c_str(), group.constants[j].index);
+			}
+			fprintf(file, "\t}\n");
+		}
+
+		fprintf(file, "}\n");
+	}
+
+	void WriteEnums(FILE* file, const Parameters& parameters, const std::vector<Group>& groups)
+	{
+		fprintf(file, "// Generated by Xidgen, do not edit.\n\n");
+		fprintf(file, "namespace %s\n{\n", parameters.nameSpace);
+
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			const Group& group = groups[i];
+			if (i > 0)
+			{
+				fprintf(file, "\n");
+			}
+			fprintf(file, "\t// %s\n", group.description.c_str());
+			fprintf(file, "\tpublic enum %s\n\t{\n", group.enumName.c_str());
+			for (size_t j = 0; j < group.constants.size(); j++)
+			{
+				fprintf(file, "\t\t%s = %u,\n", group.constants[j].name.c_str(), group.constants[j].index);
+			}
+			fprintf(file, "\t}\n");
+		}
+
+		fprintf(file, "}\n");
+	}
+
+	bool WriteFile(const char* filename, void (*pWrite)(FILE*, const Parameters&, const std::vector<Group>&),
+		const Parameters& parameters, const std::vector<Group>& groups)
+	{
+		FILE* file = fopen(filename, "w");
+		if (file == NULL)
+		{
+			fprintf(stderr, "%s: error: cannot open file for writing\n", filename);
+			return false;
+		}
+		pWrite(file, parameters, groups);
+		bool result = ferror(file) == 0;
+		if (fclose(file) != 0 || result == false)
+		{
+			fprintf(stderr, "%s: error: cannot write file\n", filename);
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.nameSpace = DefaultNamespace;
+		parameters.headerFilename = NULL;
+		parameters.enumFilename = NULL;
+
+		for (int i = 1; i < argc; i++)
+		{
+			// Options are a letter with an optional value, so absolute
+			// POSIX paths are still taken as input files
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == true)
+			{
+				arg++;
+				char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+				if (option == 'L' && arg[1] == '\0')
+				{
+					parameters.skipLogo = true;
+				}
+				else if (option == 'H' && arg[1] == ':' && arg[2] != '\0')
+				{
+					parameters.headerFilename = arg + 2;
+				}
+				else if (option == 'E' && arg[1] == ':' && arg[2] != '\0')
+				{
+					parameters.enumFilename = arg + 2;
+				}
+				else if (option == 'N' && arg[1] == ':' && arg[2] != '\0')
+				{
+					parameters.nameSpace = arg + 2;
+				}
+				else
+				{
+					fprintf(stderr, "error: unknown option /%s\n", arg);
+					return false;
+				}
+			}
+			else
+			{
+				parameters.inputFiles.push_back(arg);
+			}
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns XACT3 Index Generator\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+		printf("Generates category, variable and cue indices from XACT3 files.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: XIDGEN [options] <file> [file 2...]\n\n");
+		printf("   file            A global settings (.xgs) or sound bank (.xsb) file.\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /H:<file>       Write a C++ header with index constants.\n");
+		printf("   /E:<file>       Write C# enums with the indices.\n");
+		printf("   /N:<namespace>  Namespace of the generated code, default is %s.\n", DefaultNamespace);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	if (parameters.inputFiles.empty() == true ||
+		(parameters.headerFilename == NULL && parameters.enumFilename == NULL))
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	std::vector<Group> groups;
+	for (size_t i = 0; i < parameters.inputFiles.size(); i++)
+	{
+		const char* filename = parameters.inputFiles[i];
+
+		std::vector<char> data;
+		if (ReadFile(filename, data) == false)
+		{
+			fprintf(stderr, "%s: error: cannot read file\n", filename);
+			return 1;
+		}
+
+		bool result;
+		if (EndsWith(filename, ".xgs") == true)
+		{
+			result = ReadGlobalSettings(filename, data, groups);
+		}
+		else if (EndsWith(filename, ".xsb") == true)
+		{
+			result = ReadSoundBank(filename, data, groups);
+		}
+		else
+		{
+			fprintf(stderr, "%s: error: expected an .xgs or .xsb file\n", filename);
+			result = false;
+		}
+		if (result == false)
+		{
+			return 1;
+		}
+	}
+
+	if (parameters.headerFilename != NULL &&
+		WriteFile(parameters.headerFilename, WriteHeader, parameters, groups) == false)
+	{
+		return 1;
+	}
+	if (parameters.enumFilename != NULL &&
+		WriteFile(parameters.enumFilename, WriteEnums, parameters, groups) == false)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,431 @@
+// Copyright (C) 2008, Bjoern Graf <bjoern.graf@gmx.net>
+// All rights reserved.
+//
+// This software is licensed as described in the file license.txt, which
+// you should have received as part of this distribution. The terms
+// are also available at http://www.codeplex.com/Bnoerj/Project/License.aspx.
+
+// Packs built XACT3 global settings (.xgs), sound banks (.xsb) and wave
+// banks (.xwb) into one bank pack (.xpk), see NativeBankPackFile.h. Every
+// file is checked with the bank parsers of Bnoerj.Audio before it is
+// packed.
+//
+// In-memory banks are packed first and in the order given, so loading a
+// scene reads the pack front to back. Streaming wave banks follow.
+//
+// Plain C++ on top of the bank parsers of Bnoerj.Audio, so it builds and
+// runs on any platform that runs the content build.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "NativeBankPackFile.h"
+#include "NativeGlobalSettingsFile.h"
+#include "NativeSoundBankFile.h"
+#include "NativeWaveBankFile.h"
+
+using namespace Bnoerj::Audio::Native;
+
+namespace
+{
+	// 64 sectors of 2048 bytes, the reads XACT makes for each stream
+	const unsigned int DefaultPacketSize = 64;
+	const unsigned int MaxPacketSize = 0x7FFF;
+
+	struct InputFile
+	{
+		const char* filename;
+		std::string name;
+		BankPackEntryType type;
+		std::vector<char> data;
+	};
+
+	struct Parameters
+	{
+		bool skipLogo;
+		unsigned int alignment;
+		unsigned int packetSize;
+		const char* outputFilename;
+		std::vector<const char*> inputFiles;
+	};
+
+	bool EndsWith(const char* text, const char* suffix)
+	{
+		size_t textLength = strlen(text);
+		size_t suffixLength = strlen(suffix);
+		if (suffixLength > textLength)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < suffixLength; i++)
+		{
+			if (tolower(static_cast<unsigned char>(text[textLength - suffixLength + i])) != suffix[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool EqualsIgnoreCase(const std::string& a, const std::string& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i])))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// The file name without the directory, the name of the entry
+	std::string GetEntryName(const char* filename)
+	{
+		const char* name = filename;
+		for (const char* p = filename; *p != '\0'; p++)
+		{
+			if (*p == '/' || *p == '\\' || *p == ':')
+			{
+				name = p + 1;
+			}
+		}
+		return name;
+	}
+
+	bool ReadFile(const char* filename, std::vector<char>& data)
+	{
+		FILE* file = fopen(filename, "rb");
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		bool result = true;
+		char buffer[4096];
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			data.insert(data.end(), buffer, buffer + count);
+		}
+		if (ferror(file) != 0)
+		{
+			result = false;
+		}
+		fclose(file);
+		return result;
+	}
+
+	const char* GetParseError(BankParseResult result)
+	{
+		switch (result)
+		{
+		case BankParseInvalidSignature:
+			return "not an XACT3 file of this kind";
+		case BankParseUnsupportedVersion:
+			return "unsupported file version";
+		case BankParseTruncated:
+			return "file is truncated";
+		default:
+			return "file holds invalid data";
+		}
+	}
+
+	// Checks the file and sets its entry type
+	bool CheckFile(InputFile& input)
+	{
+		const char* pData = input.data.empty() == false ? &input.data[0] : NULL;
+		size_t size = input.data.size();
+
+		BankParseResult result;
+		if (EndsWith(input.filename, ".xgs") == true)
+		{
+			GlobalSettingsFile settings;
+			result = settings.Parse(pData, size);
+			input.type = BankPackEntrySettings;
+		}
+		else if (EndsWith(input.filename, ".xsb") == true)
+		{
+			SoundBankFile soundBank;
+			result = soundBank.Parse(pData, size);
+			input.type = BankPackEntrySoundBank;
+		}
+		else if (EndsWith(input.filename, ".xwb") == true)
+		{
+			WaveBankFile waveBank;
+			result = waveBank.Parse(pData, size);
+			input.type = waveBank.IsStreaming() == true ? BankPackEntryStreamingWaveBank : BankPackEntryWaveBank;
+		}
+		else
+		{
+			fprintf(stderr, "%s: error: expected an .xgs, .xsb or .xwb file\n", input.filename);
+			return false;
+		}
+
+		if (result != BankParseOk)
+		{
+			fprintf(stderr, "%s: error: %s\n", input.filename, GetParseError(result));
+			return false;
+		}
+		return true;
+	}
+
+	// Settings, in-memory wave banks, sound banks, streaming wave banks,
+	// each in the order given
+	int GetPackOrder(BankPackEntryType type)
+	{
+		switch (type)
+		{
+		case BankPackEntrySettings:
+			return 0;
+		case BankPackEntryWaveBank:
+			return 1;
+		case BankPackEntrySoundBank:
+			return 2;
+		default:
+			return 3;
+		}
+	}
+
+	void WriteUInt32(std::vector<char>& buffer, size_t offset, unsigned int value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			buffer[offset + i] = static_cast<char>(value >> (i * 8));
+		}
+	}
+
+	void WriteUInt64(std::vector<char>& buffer, size_t offset, unsigned long long value)
+	{
+		WriteUInt32(buffer, offset, static_cast<unsigned int>(value));
+		WriteUInt32(buffer, offset + 4, static_cast<unsigned int>(value >> 32));
+	}
+
+	bool WritePack(const Parameters& parameters, const std::vector<InputFile*>& inputs)
+	{
+		// Header and table of contents, entries laid out back to back at
+		// the next multiple of the alignment
+		size_t tableSize = BankPackFile::HeaderSize + inputs.size() * BankPackFile::EntrySize;
+		std::vector<char> table(tableSize, 0);
+		memcpy(&table[0], "XPAK", 4);
+		WriteUInt32(table, 4, BankPackFile::Version);
+		WriteUInt32(table, 8, parameters.alignment);
+		WriteUInt32(table, 12, static_cast<unsigned int>(inputs.size()));
+
+		std::vector<unsigned long long> offsets;
+		unsigned long long offset = tableSize;
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const InputFile& input = *inputs[i];
+			offset = (offset + parameters.alignment - 1) / parameters.alignment * parameters.alignment;
+			offsets.push_back(offset);
+
+			size_t entryOffset = BankPackFile::HeaderSize + i * BankPackFile::EntrySize;
+			memcpy(&table[entryOffset], input.name.c_str(), input.name.size());
+			WriteUInt32(table, entryOffset + 64, input.type);
+			WriteUInt32(table, entryOffset + 68,
+				input.type == BankPackEntryStreamingWaveBank ? parameters.packetSize : 0);
+			WriteUInt64(table, entryOffset + 72, offset);
+			WriteUInt64(table, entryOffset + 80, input.data.size());
+			offset += input.data.size();
+		}
+
+		FILE* file = fopen(parameters.outputFilename, "wb");
+		if (file == NULL)
+		{
+			fprintf(stderr, "%s: error: cannot open file for writing\n", parameters.outputFilename);
+			return false;
+		}
+
+		fwrite(&table[0], 1, table.size(), file);
+		unsigned long long position = table.size();
+		static const char padding[BankPackFile::SectorSize] = { 0 };
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			for (; position < offsets[i]; )
+			{
+				size_t count = offsets[i] - position < sizeof(padding)
+					? static_cast<size_t>(offsets[i] - position) : sizeof(padding);
+				fwrite(padding, 1, count, file);
+				position += count;
+			}
+			if (inputs[i]->data.empty() == false)
+			{
+				fwrite(&inputs[i]->data[0], 1, inputs[i]->data.size(), file);
+				position += inputs[i]->data.size();
+			}
+		}
+
+		bool result = ferror(file) == 0;
+		if (fclose(file) != 0 || result == false)
+		{
+			fprintf(stderr, "%s: error: cannot write file\n", parameters.outputFilename);
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseNumber(const char* text, unsigned int& value)
+	{
+		char* end;
+		unsigned long number = strtoul(text, &end, 10);
+		if (*text == '\0' || *end != '\0' || number > 0xFFFFFFFFUL)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(number);
+		return true;
+	}
+
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		parameters.skipLogo = false;
+		parameters.alignment = BankPackFile::DefaultAlignment;
+		parameters.packetSize = DefaultPacketSize;
+		parameters.outputFilename = NULL;
+
+		for (int i = 1; i < argc; i++)
+		{
+			// Options are a letter with an optional value, so absolute
+			// POSIX paths are still taken as files
+			const char* arg = argv[i];
+			bool isOption = (arg[0] == '/' || arg[0] == '-') &&
+				arg[1] != '\0' && (arg[2] == '\0' || arg[2] == ':');
+			if (isOption == true)
+			{
+				arg++;
+				char option = static_cast<char>(toupper(static_cast<unsigned char>(arg[0])));
+				if (option == 'L' && arg[1] == '\0')
+				{
+					parameters.skipLogo = true;
+				}
+				else if (option == 'A' && arg[1] == ':' && ParseNumber(arg + 2, parameters.alignment) == true)
+				{
+					if (parameters.alignment < BankPackFile::SectorSize ||
+						(parameters.alignment & (parameters.alignment - 1)) != 0)
+					{
+						fprintf(stderr, "error: the alignment must be a power of two of at least %u\n",
+							BankPackFile::SectorSize);
+						return false;
+					}
+				}
+				else if (option == 'P' && arg[1] == ':' && ParseNumber(arg + 2, parameters.packetSize) == true)
+				{
+					if (parameters.packetSize < 2 || parameters.packetSize > MaxPacketSize)
+					{
+						fprintf(stderr, "error: the packet size must be between 2 and %u sectors\n", MaxPacketSize);
+						return false;
+					}
+				}
+				else
+				{
+					fprintf(stderr, "error: unknown option /%s\n", arg);
+					return false;
+				}
+			}
+			else if (parameters.outputFilename == NULL)
+			{
+				parameters.outputFilename = arg;
+			}
+			else
+			{
+				parameters.inputFiles.push_back(arg);
+			}
+		}
+		return true;
+	}
+
+	void PrintLogo()
+	{
+		printf("Bjoerns XACT3 Bank Packer\n");
+		printf("Copyright (C) 2008 Bjoern Graf.\n\n");
+		printf("Packs the XACT3 files of a scene into one bank pack.\n\n");
+	}
+
+	void PrintHelp()
+	{
+		printf("Usage: XPACK [options] <pack> <file> [file 2...]\n\n");
+		printf("   pack            The bank pack (.xpk) to write.\n");
+		printf("   file            A global settings (.xgs), sound bank (.xsb) or wave bank\n");
+		printf("                   (.xwb) file.\n");
+		printf("   /L              Do not print the banner.\n");
+		printf("   /A:<bytes>      Alignment of the files in the pack, a power of two of at\n");
+		printf("                   least %u, default is %u.\n", BankPackFile::SectorSize, BankPackFile::DefaultAlignment);
+		printf("   /P:<sectors>    Packet size of streaming wave banks, default is %u.\n", DefaultPacketSize);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters parameters;
+	if (ParseParameters(argc, argv, parameters) == false)
+	{
+		return 1;
+	}
+
+	if (parameters.skipLogo == false)
+	{
+		PrintLogo();
+	}
+
+	if (parameters.outputFilename == NULL || parameters.inputFiles.empty() == true)
+	{
+		PrintHelp();
+		return 1;
+	}
+
+	std::vector<InputFile> inputs(parameters.inputFiles.size());
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		InputFile& input = inputs[i];
+		input.filename = parameters.inputFiles[i];
+		input.name = GetEntryName(input.filename);
+		if (input.name.size() > BankPackFile::MaxNameLength)
+		{
+			fprintf(stderr, "%s: error: file names are limited to %u characters\n",
+				input.filename, BankPackFile::MaxNameLength);
+			return 1;
+		}
+		for (size_t j = 0; j < i; j++)
+		{
+			if (EqualsIgnoreCase(inputs[j].name, input.name) == true)
+			{
+				fprintf(stderr, "%s: error: a file named %s was already packed\n", input.filename, input.name.c_str());
+				return 1;
+			}
+		}
+
+		if (ReadFile(input.filename, input.data) == false)
+		{
+			fprintf(stderr, "%s: error: cannot read file\n", input.filename);
+			return 1;
+		}
+		if (CheckFile(input) == false)
+		{
+			return 1;
+		}
+	}
+
+	std::vector<InputFile*> ordered;
+	for (int order = 0; order < 4; order++)
+	{
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			if (GetPackOrder(inputs[i].type) == order)
+			{
+				ordered.push_back(&inputs[i]);
+			}
+		}
+	}
+
+	return WritePack(parameters, ordered) == true ? 0 : 1;
+}